@@ -0,0 +1,104 @@
+#include "UniformBuffers.inc.shader"
+
+#define USE_GBUFFER_WRITE
+#include "Deferred.inc.shader"
+
+// The number of frames along each side of an impostor atlas
+#define IMPOSTOR_FRAMES_PER_SIDE 8.0
+
+#ifdef VERTEX_SHADER
+
+// The root transform of every instance. Each draw reads from _InstanceOffset.x onwards.
+layout(std430, binding = 0) readonly buffer instance_data
+{
+	mat4x4 _InstanceLocalToWorld[];
+};
+
+// Interpolated values to fragment shader
+out vec2 texcoord;
+flat out mat3 rootToWorldRotation;
+flat out float meshOpacity;
+
+// The direction a frame of the atlas was baked from, relative to the root
+vec3 frameDirection(vec2 frame)
+{
+    vec2 uv = (frame + 0.5) / IMPOSTOR_FRAMES_PER_SIDE * 2.0 - 1.0;
+    vec2 xz = vec2(uv.x + uv.y, uv.x - uv.y) * 0.5;
+    return normalize(vec3(xz.x, 1.0 - abs(xz.x) - abs(xz.y), xz.y));
+}
+
+// The frame baked from the direction closest to the given one
+vec2 findFrame(vec3 direction)
+{
+    direction.y = max(direction.y, 0.0);
+    vec2 xz = direction.xz / max(abs(direction.x) + direction.y + abs(direction.z), 1e-6);
+    vec2 uv = vec2(xz.x + xz.y, xz.x - xz.y) * 0.5 + 0.5;
+    return clamp(floor(uv * IMPOSTOR_FRAMES_PER_SIDE), 0.0, IMPOSTOR_FRAMES_PER_SIDE - 1.0);
+}
+
+void main()
+{
+	// Two triangles for each billboard, made from the vertex id
+	const vec2 corners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+	vec2 corner = corners[gl_VertexID];
+
+	mat4x4 rootToWorld = _InstanceLocalToWorld[_InstanceOffset.x + gl_InstanceID];
+	vec3 worldCentre = (rootToWorld * vec4(_ImpostorBounds.xyz, 1.0)).xyz;
+
+	// Find the direction towards the viewer. Orthographic views, such as shadow cascades,
+	// all look the same way, which is found by unprojecting the near and far planes.
+	vec3 toViewer = _CameraPosition.xyz - worldCentre;
+	if (_ViewProjectionMatrix[0][3] == 0.0 && _ViewProjectionMatrix[1][3] == 0.0 && _ViewProjectionMatrix[2][3] == 0.0)
+	{
+		toViewer = (_ClipToWorld * vec4(0.0, 0.0, -1.0, 1.0)).xyz - (_ClipToWorld * vec4(0.0, 0.0, 1.0, 1.0)).xyz;
+	}
+
+	// Use the frame baked from the closest direction, relative to the root
+	vec2 frame = findFrame(inverse(mat3(rootToWorld)) * toViewer);
+
+	// Face the billboard the same way as the frame's view, so the frame maps straight onto it
+	vec3 forward = -frameDirection(frame);
+	vec3 up = (abs(forward.y) > 0.999) ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+	vec3 right = normalize(cross(up, forward));
+	up = cross(forward, right);
+
+	vec3 rootPosition = _ImpostorBounds.xyz + (right * corner.x + up * corner.y) * _ImpostorBounds.w;
+	gl_Position = _ViewProjectionMatrix * (rootToWorld * vec4(rootPosition, 1.0));
+
+	texcoord = (frame + corner * 0.5 + 0.5) / IMPOSTOR_FRAMES_PER_SIDE;
+	rootToWorldRotation = mat3(normalize(rootToWorld[0].xyz), normalize(rootToWorld[1].xyz), normalize(rootToWorld[2].xyz));
+
+	// Impostors fade in as the meshes they replace fade out
+	meshOpacity = instanceMeshOpacity(rootToWorld[3].xyz);
+}
+
+#endif // VERTEX_SHADER
+
+#ifdef FRAGMENT_SHADER
+
+layout(binding = 3) uniform sampler2D _ImpostorAlbedo;
+layout(binding = 4) uniform sampler2D _ImpostorNormals;
+
+// Interpolated values from vertex shader
+in vec2 texcoord;
+flat in mat3 rootToWorldRotation;
+flat in float meshOpacity;
+
+void main()
+{
+	// Only cover the pixels the meshes leave as they fade out
+	vec4 albedoCoverage = texture(_ImpostorAlbedo, texcoord);
+	if (albedoCoverage.a < 0.5 || meshOpacity > ditherThreshold(gl_FragCoord.xy))
+	{
+		discard;
+	}
+
+	// The frames were baked in the gbuffer layout, with normals relative to the root
+	SurfaceProperties surface = unpackGBuffer(vec4(albedoCoverage.rgb, 1.0), texture(_ImpostorNormals, texcoord));
+	surface.worldNormal = normalize(rootToWorldRotation * surface.worldNormal);
+
+	// Output surface properties to the gbuffer
+	writeToGBuffer(surface);
+}
+
+#endif // FRAGMENT_SHADER
\ No newline at end of file
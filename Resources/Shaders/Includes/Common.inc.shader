@@ -62,4 +62,30 @@ vec3 applyVolumetricFog(vec3 light, float fogDensity, vec3 fogColor)
     return mix(light, fogColor, fogDensity);
 }
 
+/*
+ * A threshold between 0 and 1 for each pixel, from a repeating 4x4 ordered dither pattern.
+ * Cross-fading surfaces discard the pixels whose threshold is above their opacity,
+ * so the surface fading in covers exactly the pixels the one fading out leaves.
+ */
+float ditherThreshold(vec2 fragCoord)
+{
+    const float bayer[16] = float[](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 pixel = ivec2(fragCoord) & 3;
+    return (bayer[pixel.x + pixel.y * 4] + 0.5) / 16.0;
+}
+
+/*
+ * The opacity of an instanced mesh at the given position as it fades out to its impostor.
+ * Impostors fade in with the opposite opacity.
+ */
+float instanceMeshOpacity(vec3 instancePosition)
+{
+    if (_InstanceFade.y <= 0.0)
+    {
+        return 1.0;
+    }
+
+    return clamp(1.0 - (distance(instancePosition, _ViewerPosition.xyz) - _InstanceFade.x) * _InstanceFade.y, 0.0, 1.0);
+}
+
 #endif // COMMON_SHADER_CODE_INCLUDED
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef TERRAIN_LOD_SHADER_CODE_INCLUDED
+#define TERRAIN_LOD_SHADER_CODE_INCLUDED
+
+#include "UniformBuffers.inc.shader"
+
+// The patches being drawn, one per instance of the patch grid.
+// xy = corner, z = size, both as fractions of the area the patches cover
+// w = level of detail, where 0 is the finest
+layout(std430, binding = 3) readonly buffer terrain_patches
+{
+    vec4 _TerrainPatches[];
+};
+
+/*
+ * Finds how far a vertex has morphed towards the grid of the level above its patch.
+ * Vertices morph over the end of their level's range, measured from the viewer.
+ */
+float patchMorphFactor(vec4 terrainPatch, vec3 worldPosition, float finestRange)
+{
+    float range = finestRange * exp2(terrainPatch.w);
+    float morphStart = range * (1.0 - 0.5 * _TerrainLod.z);
+    return clamp((distance(worldPosition, _ViewerPosition.xyz) - morphStart) / (range - morphStart), 0.0, 1.0);
+}
+
+/*
+ * Moves a grid position within a patch towards the grid of the level above.
+ * Fully morphed, every odd vertex sits on the even vertex before it, leaving
+ * the vertices of a grid with half the resolution.
+ */
+vec2 morphGridPosition(vec2 gridPosition, float morph)
+{
+    vec2 oddOffset = fract(gridPosition * _TerrainLod.w * 0.5) * 2.0 / _TerrainLod.w;
+    return gridPosition - oddOffset * morph;
+}
+
+#endif // TERRAIN_LOD_SHADER_CODE_INCLUDED
\ No newline at end of file
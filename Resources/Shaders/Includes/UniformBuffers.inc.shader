@@ -49,6 +49,15 @@ layout(std140, binding = 3) uniform per_draw_data
     uniform vec4 _Color; // rgb = color, a = smoothness
     sampler2D _AlbedoTexture;
     sampler2D _NormalMapTexture;
+    uniform ivec4 _InstanceOffset; // x = first transform of an instanced draw in the instance buffer
+
+    // Instanced meshes cross-fade to impostors by their distance from the viewer
+    // x = distance the fade starts, y = 1 / length of the fade, 0 when they never fade
+    uniform vec4 _InstanceFade;
+
+    // The sphere an impostor's frames are centred on, relative to its root
+    // xyz = centre, w = radius
+    uniform vec4 _ImpostorBounds;
 };
 
 //Terrain uniform buffer
@@ -60,6 +69,23 @@ layout(std140, binding = 5) uniform terrain_data
     // rgb = base color
     // a = max depth, m
     uniform vec4 _WaterColorDepth;
+
+    // The layout of the streamed heightmap tiles
+    // x = tiles per side, 0 when the terrain isn't streamed
+    // y = tile size in texels, not counting the border
+    // z = resolution of the streamed heightmap
+    uniform vec4 _TerrainStreaming;
+
+    // The viewer's position, even when drawing shadows.
+    // Terrain details fade out, and terrain patches morph between levels, by distance from it.
+    uniform vec4 _ViewerPosition;
+
+    // The level of detail ranges of the terrain and water patches
+    // x = distance the finest terrain level is drawn to, doubling with each level
+    // y = distance the finest water level is drawn to, doubling with each level
+    // z = fraction of each level's range its vertices morph over
+    // w = number of quads along each side of a patch
+    uniform vec4 _TerrainLod;
 	
     // The blending settings for each terrain layer
     // x = altitude border, y = altitude transition
@@ -79,13 +105,4 @@ layout(std140, binding = 5) uniform terrain_data
     sampler2D _TerrainNormalMapTextures[MAX_TERRAIN_LAYERS];
 };
 
-// Terrain details uniform buffer.
-// The buffer is updated once per details batch.
-layout(std140, binding = 6) uniform terrain_details_data
-{
-    // World-space offsets for each terrain detail.
-    // Once per detail mesh instance, up to 1024 in total.
-    uniform vec4 _TerrainDetailPositions[1024];
-};
-
 #endif // UNIFORM_BUFFERS_INCLUDED
\ No newline at end of file
@@ -22,15 +22,34 @@ out vec3 tangentToWorld[3];
 out vec3 worldNormal;
 #endif
 
+#ifdef INSTANCING_ON
+// The transforms of instanced draws. Each draw reads from _InstanceOffset.x onwards.
+layout(std430, binding = 0) readonly buffer instance_data
+{
+	mat4x4 _InstanceLocalToWorld[];
+};
+
+// How far the instance has faded out to its impostor
+flat out float instanceOpacity;
+#endif
+
 void main()
 {
+	// Instanced draws read the transform of each instance from the instance buffer
+#ifdef INSTANCING_ON
+	mat4x4 localToWorld = _InstanceLocalToWorld[_InstanceOffset.x + gl_InstanceID];
+	instanceOpacity = instanceMeshOpacity(localToWorld[3].xyz);
+#else
+	mat4x4 localToWorld = _LocalToWorld;
+#endif
+
 	// Project the vertex position to clip space
-	gl_Position = _ViewProjectionMatrix * (_LocalToWorld * _position);
+	gl_Position = _ViewProjectionMatrix * (localToWorld * _position);
 
 #ifdef NORMAL_MAP_ON
 	// Get the normal, tangent and bitangent in world space
-	vec3 worldNormal = normalize(mat3(_LocalToWorld) * _normal);
-	vec3 worldTangent = normalize(mat3(_LocalToWorld) * _tangent.xyz);
+	vec3 worldNormal = normalize(mat3(localToWorld) * _normal);
+	vec3 worldTangent = normalize(mat3(localToWorld) * _tangent.xyz);
 	vec3 worldBitangent = cross(worldNormal, worldTangent);
 
 	// Construct a (worldtangent, worldnormal, worldbitangent) basis
@@ -40,7 +59,7 @@ void main()
 	tangentToWorld[2] = vec3(worldTangent.z, worldBitangent.z, worldNormal.z);
 #else
 	// No normal mapping. Send the world space normal directly to the fragment shader.
-	worldNormal = normalize(mat3(_LocalToWorld) * _normal);
+	worldNormal = normalize(mat3(localToWorld) * _normal);
 #endif
 
 	// Texcoord does not need to be modified.
@@ -61,8 +80,20 @@ in vec3 tangentToWorld[3];
 in vec3 worldNormal;
 #endif
 
+#ifdef INSTANCING_ON
+flat in float instanceOpacity;
+#endif
+
 void main()
 {
+#ifdef INSTANCING_ON
+    // Leave the pixels the impostor covers as the instance fades out to it
+    if (instanceOpacity <= ditherThreshold(gl_FragCoord.xy))
+    {
+        discard;
+    }
+#endif
+
     SurfaceProperties surface;
     surface.occlusion = 1.0;
     surface.translucency = 0.0;
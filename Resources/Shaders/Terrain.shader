@@ -5,48 +5,10 @@
 
 #ifdef VERTEX_SHADER
 
-// Vertex attributes
-layout(location = 0) in vec4 _position;
+#include "TerrainLod.inc.shader"
 
-void main()
-{
-    gl_Position = _position;
-}
-
-#endif // VERTEX_SHADER
-
-#ifdef TESS_CONTROL_SHADER
-
-layout(vertices = 3) out;
-
-void main()
-{
-    if (gl_InvocationID == 0)
-    {
-        // Use the same amount of tessellation across the entire terrain to prevent
-        // popping / waving artifacts
-
-#ifdef HIGH_TESSELLATION
-        float tessFactor = 64.0;
-#else
-        float tessFactor = 8.0;
-#endif
-
-        gl_TessLevelOuter[0] = tessFactor;
-        gl_TessLevelOuter[1] = tessFactor;
-        gl_TessLevelOuter[2] = tessFactor;
-        gl_TessLevelInner[0] = tessFactor;
-        gl_TessLevelInner[1] = tessFactor;
-    }
-
-    gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
-}
-
-#endif // TESS_CONTROL_SHADER
-
-#ifdef TESS_EVALUATION_SHADER
-
-layout(triangles, fractional_odd_spacing, ccw) in;
+// The position of the vertex within its patch, from 0 to 1
+layout(location = 0) in vec2 _gridPosition;
 
 // Interpolated values to fragment shader
 out vec4 worldPosition;
@@ -60,14 +22,45 @@ out vec3 tangentToWorld[3];
 
 layout(binding = 8) uniform sampler2D _TerrainHeightmap;
 
+// The streamed heightmap tiles, and the page table giving the layer of each tile
+layout(binding = 9) uniform sampler2DArray _TerrainTiles;
+layout(binding = 11) uniform sampler2D _TerrainTilePages;
+
+// Samples the normalized terrain height, using the streamed tiles where they are resident
+float sampleTerrainHeight(vec2 uv)
+{
+    if (_TerrainStreaming.x > 0.0)
+    {
+        // Find the tile and the layer it is stored in
+        ivec2 tile = ivec2(clamp(floor(uv * _TerrainStreaming.x), 0.0, _TerrainStreaming.x - 1.0));
+        float layer = texelFetch(_TerrainTilePages, tile, 0).r;
+        if (layer >= 0.0)
+        {
+            // Convert to texels within the tile, skipping over the one texel border
+            vec2 texel = uv * _TerrainStreaming.z - 0.5 - vec2(tile) * _TerrainStreaming.y;
+            vec2 tileUV = (texel + 1.5) / (_TerrainStreaming.y + 2.0);
+            return texture(_TerrainTiles, vec3(tileUV, layer)).r;
+        }
+    }
+
+    return texture(_TerrainHeightmap, uv).r;
+}
+
 void main()
 {
+    // Find the vertex's position on the terrain, ranging from 0 to 1 in x and z
+    vec4 terrainPatch = _TerrainPatches[gl_InstanceID];
+    vec2 patchPosition = terrainPatch.xy + _gridPosition * terrainPatch.z;
+
+    // Morph towards the level above, by the distance to where the vertex would be without morphing
+    vec3 unmorphedPosition = vec3(patchPosition.x, sampleTerrainHeight(patchPosition), patchPosition.y) * _TerrainSize.xyz;
+    unmorphedPosition.y -= _WaterColorDepth.a;
+    float morph = patchMorphFactor(terrainPatch, unmorphedPosition, _TerrainLod.x);
+    patchPosition = terrainPatch.xy + morphGridPosition(_gridPosition, morph) * terrainPatch.z;
+
     // Compute normalized position of the terrain. This ranges from 0,1 in XYZ
     // Use the x and z and take the y from the heightmap
-    vec4 normalizedPosition = gl_in[0].gl_Position * gl_TessCoord.x
-        + gl_in[1].gl_Position * gl_TessCoord.y
-        + gl_in[2].gl_Position * gl_TessCoord.z;;
-    normalizedPosition.y = texture(_TerrainHeightmap, normalizedPosition.xz).r;
+    vec4 normalizedPosition = vec4(patchPosition.x, sampleTerrainHeight(patchPosition), patchPosition.y, 1.0);
 
 	// The normalized position is only in the range 0 to 1.
 	// This causes the underwater terrain to abruptly stop a few m away from the shore.
@@ -89,14 +82,15 @@ void main()
     texcoord = normalizedPosition.xz;
 
     // Compute the offset from the normalized position to get the adjacent heightmap pixels
+    // When streaming, use the texel size of the streamed heightmap to pick up its finer detail
     ivec2 heightmapRes = textureSize(_TerrainHeightmap, 0);
-    vec2 heightmapTexelSize = 1.0 / heightmapRes;
+    vec2 heightmapTexelSize = (_TerrainStreaming.x > 0.0) ? vec2(1.0 / _TerrainStreaming.z) : 1.0 / heightmapRes;
 
     // Determine the gradient along x and z at the vertex position
-    float x1 = texture(_TerrainHeightmap, normalizedPosition.xz + heightmapTexelSize * vec2(-1.0, 0.0)).r;
-    float x2 = texture(_TerrainHeightmap, normalizedPosition.xz + heightmapTexelSize * vec2(1.0, 0.0)).r;
-    float z1 = texture(_TerrainHeightmap, normalizedPosition.xz + heightmapTexelSize * vec2(0.0, -1.0)).r;
-    float z2 = texture(_TerrainHeightmap, normalizedPosition.xz + heightmapTexelSize * vec2(0.0, 1.0)).r;
+    float x1 = sampleTerrainHeight(normalizedPosition.xz + heightmapTexelSize * vec2(-1.0, 0.0));
+    float x2 = sampleTerrainHeight(normalizedPosition.xz + heightmapTexelSize * vec2(1.0, 0.0));
+    float z1 = sampleTerrainHeight(normalizedPosition.xz + heightmapTexelSize * vec2(0.0, -1.0));
+    float z2 = sampleTerrainHeight(normalizedPosition.xz + heightmapTexelSize * vec2(0.0, 1.0));
     float dydx = x2 - x1;
     float dydz = z2 - z1;
     dydx *= _TerrainSize.y;
@@ -119,7 +113,7 @@ void main()
 #endif
 }
 
-#endif // TESS_EVALUATION_SHADER
+#endif // VERTEX_SHADER
 
 #ifdef FRAGMENT_SHADER
 
@@ -1,4 +1,8 @@
 
+// Each batch's instances are found from the base instance of its indirect draw,
+// and its fade distances from the draw id
+#extension GL_ARB_shader_draw_parameters : require
+
 #include "UniformBuffers.inc.shader"
 
 #define USE_GBUFFER_WRITE
@@ -8,6 +12,20 @@
 
 layout(binding = 8) uniform sampler2D _TerrainHeightmap;
 
+// World-space offset and scale of every terrain detail, for all batches.
+// It is only uploaded when the details are placed again.
+layout(std430, binding = 1) readonly buffer terrain_details_data
+{
+    vec4 _TerrainDetailPositions[];
+};
+
+// The distances each batch fades out over, once per draw.
+// x = distance the fade starts, y = 1 / length of the fade
+layout(std430, binding = 2) readonly buffer terrain_detail_fades
+{
+    vec4 _TerrainDetailFades[];
+};
+
 layout(location = 0) in vec4 _position;
 layout(location = 1) in vec3 _normal;
 layout(location = 3) in vec2 _texcoord;
@@ -30,9 +48,13 @@ void main()
     );
 
     // Apply the scale and offset to the local-space position
-    vec4 instanceOffsetScale = _TerrainDetailPositions[gl_InstanceID];
+    vec4 instanceOffsetScale = _TerrainDetailPositions[gl_BaseInstanceARB + gl_InstanceID];
     vec3 offset = instanceOffsetScale.xyz;
     float scale = instanceOffsetScale.a;
+
+    // Shrink the details away as they reach the draw distance of their batch
+    vec4 fade = _TerrainDetailFades[gl_DrawIDARB];
+    scale *= clamp(1.0 - (distance(offset, _ViewerPosition.xyz) - fade.x) * fade.y, 0.0, 1.0);
     vec3 worldPosition = (localPosition * scale) + offset;
 
     // Apply a wind offset to the world position
@@ -11,48 +11,10 @@
 
 #ifdef VERTEX_SHADER
 
-// Vertex attributes
-layout(location = 0) in vec4 _position;
+#include "TerrainLod.inc.shader"
 
-void main()
-{
-    gl_Position = _position;
-}
-
-#endif // VERTEX_SHADER
-
-#ifdef TESS_CONTROL_SHADER
-
-layout(vertices = 3) out;
-
-void main()
-{
-    if (gl_InvocationID == 0)
-    {
-        // Use the same amount of tessellation across the entire water surface to prevent
-        // popping / waving artifacts
-
-#ifdef HIGH_TESSELLATION
-        float tessFactor = 64.0;
-#else
-        float tessFactor = 8.0;
-#endif
-
-        gl_TessLevelOuter[0] = tessFactor;
-        gl_TessLevelOuter[1] = tessFactor;
-        gl_TessLevelOuter[2] = tessFactor;
-        gl_TessLevelInner[0] = tessFactor;
-        gl_TessLevelInner[1] = tessFactor;
-    }
-
-    gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
-}
-
-#endif // TESS_CONTROL_SHADER
-
-#ifdef TESS_EVALUATION_SHADER
-
-layout(triangles, fractional_odd_spacing, ccw) in;
+// The position of the vertex within its patch, from 0 to 1
+layout(location = 0) in vec2 _gridPosition;
 
 layout(binding = 8) uniform sampler2D _TerrainHeightmap;
 
@@ -118,14 +80,18 @@ float getWaveDisplacement(vec2 position)
 
 void main()
 {
-    // Compute normalized position of the terrain. This ranges from 0,1 in XYZ
-    // Use the x and z and take the y from the heightmap
-    vec4 normalizedPosition = gl_in[0].gl_Position * gl_TessCoord.x
-        + gl_in[1].gl_Position * gl_TessCoord.y
-        + gl_in[2].gl_Position * gl_TessCoord.z;
+    // Find the vertex's position on the water, which covers 16 times the terrain along each side
+    vec4 waterPatch = _TerrainPatches[gl_InstanceID];
+    vec2 patchPosition = waterPatch.xy + _gridPosition * waterPatch.z;
 
+    // Morph towards the level above, by the distance to the undisplaced water surface
+    vec3 unmorphedPosition = vec3(patchPosition.x * 16.0 - 8.0, 0.0, patchPosition.y * 16.0 - 8.0) * _TerrainSize.xyz;
+    float morph = patchMorphFactor(waterPatch, unmorphedPosition, _TerrainLod.y);
+    patchPosition = waterPatch.xy + morphGridPosition(_gridPosition, morph) * waterPatch.z;
+
+    // Compute normalized position of the water, relative to the terrain
     // Make the water extend further than the terrain
-    normalizedPosition.xz = normalizedPosition.xz * 16.0 - 8.0;
+    vec4 normalizedPosition = vec4(patchPosition.x * 16.0 - 8.0, 0.0, patchPosition.y * 16.0 - 8.0, 1.0);
 
     // Scale by the terrain size to get the world position
     worldPosition = normalizedPosition.xyz * _TerrainSize.xyz;
@@ -172,7 +138,7 @@ void main()
 #endif
 }
 
-#endif // TESS_EVALUATION_SHADER
+#endif // VERTEX_SHADER
 
 #ifdef FRAGMENT_SHADER
 
@@ -4,6 +4,7 @@
 #include <GLFW/glfw3.h>
 
 #include "Utils/Clock.h"
+#include "Utils/JobSystem.h"
 #include "EditorManager.h"
 #include "InputManager.h"
 #include "ResourceManager.h"
@@ -11,6 +12,7 @@
 #include "RenderManager.h"
 #include "VRManager.h"
 #include "PhysicsManager.h"
+#include "ReplayManager.h"
 
 Application::Application(const std::string &name, GLFWwindow* window)
     : name_(name),
@@ -22,6 +24,9 @@ Application::Application(const std::string &name, GLFWwindow* window)
     fullScreenColorTexture_(nullptr),
     fullScreenFramebuffer_(nullptr)
 {
+    // Create the job system before the modules that queue work on it
+    jobSystem_ = new JobSystem();
+
     // Create engine modules
     editorManager_ = new EditorManager(window, true);
     inputManager_ = new InputManager(window);
@@ -35,8 +40,11 @@ Application::Application(const std::string &name, GLFWwindow* window)
     clock_ = new Clock();
     clock_->setPaused(true);
 
+    // Create the replay manager after the modules it drives
+    replayManager_ = new ReplayManager();
+
     // Create a Quit menu item
-    MainWindowMenu::instance()->addMenuItem("File/Exit", [&] { glfwSetWindowShouldClose(window_, GLFW_TRUE); });
+    MainWindowMenu::instance()->addMenuItem("File/Exit", [&] { quit(); });
 
     // Create a menu item for toggling between play & edit modes
     MainWindowMenu::instance()->addMenuItem("Game/Toggle Playing", [&]
@@ -70,6 +78,7 @@ Application::~Application()
 
     // Delete modules in opposite order to
     // how they were created.
+    delete replayManager_;
     delete physicsManager_;
     delete vrManager_;
     delete sceneManager_;
@@ -78,6 +87,8 @@ Application::~Application()
     delete clock_;
 
     destroyFullScreenRenderer();
+
+    delete jobSystem_;
 }
 
 bool Application::running() const
@@ -85,6 +96,11 @@ bool Application::running() const
     return !glfwWindowShouldClose(window_);
 }
 
+void Application::quit()
+{
+    glfwSetWindowShouldClose(window_, GLFW_TRUE);
+}
+
 void Application::enterPlayMode()
 {
     // Do nothing if already in play mode.
@@ -154,10 +170,37 @@ void Application::frameStart()
 
     // Update each module manager
     clock_->frameStart();
+    replayManager_->frameStart();
     inputManager_->frameStart();
+
+    // Step the simulation at a fixed rate, so it behaves the same at any frame rate.
+    // When in play mode, each tick dispatches user input first,
+    // or the recorded input when a session is being replayed.
+    for (int tick = 0; tick < clock_->tickCount(); ++tick)
+    {
+        sceneManager_->startTick();
+        if (isPlaying())
+        {
+            if (replayManager_->isReplaying())
+                replayManager_->dispatchRecordedInput(tick == 0);
+            else
+                inputManager_->dispatchInput(clock_->fixedDeltaTime());
+        }
+        sceneManager_->tick(clock_->fixedDeltaTime());
+    }
+
+    // Mouse movement is only kept for the next tick while playing
+    if (!isPlaying())
+    {
+        inputManager_->discardUndispatchedInput();
+    }
+
     sceneManager_->frameStart();
     vrManager_->frameStart();
 
+    // Run the work that other threads queued for the main thread, such as OpenGL calls
+    jobSystem_->runMainThreadJobs();
+
     // Let a user press G + C + L simultenously to exit full screen play mode
     if (InputManager::instance()->isKeyDown(InputKey::G)
         && InputManager::instance()->isKeyDown(InputKey::C)
@@ -166,11 +209,7 @@ void Application::frameStart()
         setPlayType(ApplicationPlayType::InEditorPreview);
     }
 
-    // When in play mode, dispatch user input
-    if(isPlaying())
-    {
-        inputManager_->dispatchInput(clock_->deltaTime());
-    }
+    replayManager_->frameUpdated();
 
     // Put the FPS in the window title.
     // Update every 20 frames (start at frame 1)
@@ -203,14 +242,14 @@ void Application::drawFrame()
             0, 0, Framebuffer::backbuffer()->width(), Framebuffer::backbuffer()->height(),
             0, 0, Framebuffer::backbuffer()->width(), Framebuffer::backbuffer()->height(),
             GL_COLOR_BUFFER_BIT, GL_NEAREST);
-        return;
     }
-
-    // Re-draw the editor window
-    if (!isPlaying() || playType_ != ApplicationPlayType::FullScreen)
+    else
     {
+        // Re-draw the editor window
         editorManager_->render();
     }
+
+    replayManager_->frameEnd();
 }
 
 void Application::createFullScreenRenderer()
@@ -8,6 +8,7 @@
 struct GLFWwindow;
 
 class Clock;
+class JobSystem;
 class EditorManager;
 class InputManager;
 class ResourceManager;
@@ -15,6 +16,7 @@ class SceneManager;
 class RenderManager;
 class VRManager;
 class PhysicsManager;
+class ReplayManager;
 
 enum class ApplicationMode
 {
@@ -38,6 +40,9 @@ public:
     ~Application();
 
     bool running() const;
+
+    // Closes the main window, ending the game loop.
+    void quit();
     bool isEditing() const { return (mode_ == ApplicationMode::Edit); }
     bool isPlaying() const { return (mode_ == ApplicationMode::Play); }
 
@@ -71,6 +76,9 @@ private:
     // The main window
     GLFWwindow* window_;
 
+    // Runs work across every core, used by the modules below
+    JobSystem* jobSystem_;
+
     // Module managers
     EditorManager* editorManager_;
     InputManager* inputManager_;
@@ -79,6 +87,7 @@ private:
     RenderManager* renderManager_;
     VRManager* vrManager_;
     PhysicsManager* physicsManager_;
+    ReplayManager* replayManager_;
 
     // The clock manager
     Clock* clock_;
@@ -8,6 +8,10 @@
 #include "Scene/Freecam.h"
 #include "Editor/MainWindowMenu.h"
 #include "PhysicsManager.h"
+#include "Editor/PropertiesPanel.h"
+#include "Scene/Terrain.h"
+#include "Scene/Transform.h"
+#include "Utils/JobSystem.h"
 
 GamePanel::GamePanel()
     : frameBuffer_(nullptr)
@@ -16,11 +20,16 @@ GamePanel::GamePanel()
     , renderer_(nullptr)
     , camera_(nullptr)
 	, alwaysUseSceneCamera_(false)
+    , showCullingStats_(false)
 {
 	MainWindowMenu::instance()->addMenuItem("View/Force Scene Camera", [&]
 	{
 		alwaysUseSceneCamera_ = !alwaysUseSceneCamera_;
 	}, [&] { return alwaysUseSceneCamera_; });
+    MainWindowMenu::instance()->addMenuItem("View/Show Culling Stats", [&]
+    {
+        showCullingStats_ = !showCullingStats_;
+    }, [&] { return showCullingStats_; });
 }
 
 GamePanel::~GamePanel()
@@ -79,7 +88,72 @@ void GamePanel::draw()
     }
 
     // Draw the texture
+    const ImVec2 imagePosition = ImGui::GetCursorScreenPos();
     ImGui::Image((ImTextureID)(uint64_t)colorBuffer_->glid(), ImGui::GetContentRegionAvail(), ImVec2(0.0f, 1.0f), ImVec2(1.0f, 0.0f));
+
+    // In edit mode, ctrl + clicking the terrain moves the selected object to the clicked point
+    if (Application::instance()->isEditing() && ImGui::IsItemHovered() && ImGui::IsMouseClicked(0) && ImGui::GetIO().KeyCtrl)
+    {
+        const ImVec2 mousePosition = ImGui::GetMousePos();
+        placeSelectionOnTerrain((mousePosition.x - imagePosition.x) / regionSize.x, (mousePosition.y - imagePosition.y) / regionSize.y);
+    }
+
+    // Show how many terrain details were drawn in the top left of the view
+    if (showCullingStats_)
+    {
+        const DetailCullingStats& stats = renderer_->detailCullingStats();
+        ImGui::SetCursorScreenPos(ImVec2(imagePosition.x + 8.0f, imagePosition.y + 8.0f));
+        ImGui::Text("Detail batches: %d drawn, %d outside the view, %d too far away",
+            stats.visibleBatches, stats.frustumCulledBatches, stats.distanceCulledBatches);
+        ImGui::Text("Detail instances: %d", stats.visibleInstances);
+
+        const TerrainLodStats& terrainStats = renderer_->terrainLodStats();
+        ImGui::Text("Terrain patches: %d drawn, %d nodes outside the view",
+            terrainStats.selectedPatches, terrainStats.frustumCulledNodes);
+
+        ImGui::Text("Last scene change: %.2fms closing, %.2fms opening",
+            SceneManager::instance()->lastSceneCloseMilliseconds(), SceneManager::instance()->lastSceneOpenMilliseconds());
+
+        // The jobs run since this was last drawn, usually the previous frame
+        for (const JobTiming& timing : JobSystem::instance()->takeTimings())
+        {
+            ImGui::Text("Job %s: %d runs, %.2fms", timing.name.c_str(), timing.count, timing.milliseconds);
+        }
+    }
+}
+
+void GamePanel::placeSelectionOnTerrain(float screenX, float screenY) const
+{
+    GameObject* selected = dynamic_cast<GameObject*>(PropertiesPanel::instance()->current());
+    if (selected == nullptr)
+    {
+        return;
+    }
+
+    // Find the direction through the clicked point, using the size of the view one unit in front of the camera
+    Point3 corners[4];
+    camera_->getFrustumCorners(1.0f, corners, (float)colorBuffer_->width() / colorBuffer_->height());
+    const Vector3 localDirection(corners[0].x * (screenX * 2.0f - 1.0f), corners[0].y * (1.0f - screenY * 2.0f), 1.0f);
+    const Transform* cameraTransform = camera_->gameObject()->transform();
+    const Point3 origin = cameraTransform->positionWorld();
+    const Vector3 direction = cameraTransform->localToWorld() * localDirection;
+
+    // Find the closest terrain under the cursor
+    HeightfieldHit closest;
+    closest.hit = false;
+    for (Terrain* terrain : SceneManager::instance()->findAllComponentsInScene<Terrain>())
+    {
+        HeightfieldHit hit;
+        if (terrain->raycast(origin, direction, camera_->farPlane(), hit) && (!closest.hit || hit.distance < closest.distance))
+        {
+            closest = hit;
+        }
+    }
+
+    if (closest.hit)
+    {
+        selected->transform()->translateWorld(closest.point - selected->transform()->positionWorld());
+    }
 }
 
 void GamePanel::createFramebuffer(int width, int height)
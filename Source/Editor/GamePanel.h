@@ -29,6 +29,9 @@ private:
 
 	// Flag to force rendering with scene camera, even in play mode
 	bool alwaysUseSceneCamera_;
+
+    // Whether to show what the renderer culled on top of the view
+    bool showCullingStats_;
 	
     void createFramebuffer(int width, int height);
 
@@ -37,4 +40,8 @@ private:
 
     // Draws a toggle for picking the current debugging mode
     void drawDebugModeToggle(RenderDebugMode mode, const char* label) const;
+
+    // Moves the selected object to the terrain under a point in the panel.
+    // The point is given as a fraction of the panel width and height, from the top left.
+    void placeSelectionOnTerrain(float screenX, float screenY) const;
 };
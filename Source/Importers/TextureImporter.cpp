@@ -1,10 +1,15 @@
 #include "TextureImporter.h"
 
+#include <algorithm>
+#include <thread>
+
 #include <crunch/inc/crnlib.h>
 #include <crunch/crnlib/crn_mipmapped_texture.h>
 #include <crunch/crnlib/crn_texture_conversion.h>
 #include <crunch/crnlib/crn_console.h>
 
+#include "Utils/JobSystem.h"
+
 bool TextureImporter::importFile(const std::string &sourceFile, const std::string &outputFile) const
 {
 	// Read the texture file.
@@ -34,7 +39,9 @@ bool TextureImporter::importFile(const std::string &sourceFile, const std::strin
 	settings.m_comp_params.m_quality_level = cCRNMaxQualityLevel;
 	settings.m_comp_params.m_dxt_quality = cCRNDXTQualityFast;
 	settings.m_comp_params.set_flag(cCRNCompFlagPerceptual, !isNormalMap);
-	settings.m_comp_params.m_num_helper_threads = 7;
+	// Crunch runs its own helper threads, so give it one for each core the job system would use
+	const int threadCount = (JobSystem::instance() != nullptr) ? JobSystem::instance()->threadCount() : (int)std::thread::hardware_concurrency();
+	settings.m_comp_params.m_num_helper_threads = std::min(std::max(threadCount - 1, 0), (int)cCRNMaxHelperThreads);
 	settings.m_mipmap_params.m_mode = cCRNMipModeGenerateMips;
     settings.m_mipmap_params.m_scale_mode = cCRNSMNearestPow2;
     settings.m_mipmap_params.m_gamma_filtering = sRGB;
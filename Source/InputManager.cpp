@@ -1,5 +1,6 @@
 #include "InputManager.h"
 #include "SceneManager.h"
+#include "ReplayManager.h"
 
 #include <GLFW/glfw3.h>
 
@@ -15,6 +16,8 @@ InputManager::InputManager(GLFWwindow* window)
     glfwGetCursorPos(window, &prevMouseX_, &prevMouseY_);
     mouseDeltaX_ = 0.0;
     mouseDeltaY_ = 0.0;
+    undispatchedMouseDeltaX_ = 0.0;
+    undispatchedMouseDeltaY_ = 0.0;
 
     // Setup Xbox Controller
     JoystickMapping mapping;
@@ -66,7 +69,7 @@ void InputManager::frameStart()
     pollMouse();
 }
 
-void InputManager::dispatchInput(float deltaTime) const
+void InputManager::dispatchInput(float deltaTime)
 {
     InputCmd inputs;
     inputs.deltaTime = deltaTime;
@@ -75,8 +78,9 @@ void InputManager::dispatchInput(float deltaTime) const
     inputs.forwardsMovement = getAxis(InputKey::W, InputKey::S);
     inputs.sidewaysMovement = getAxis(InputKey::D, InputKey::A);
     inputs.verticalMovement = getAxis(InputKey::Space, InputKey::LCtrl);
-    inputs.horizontalRotation = mouseDeltaX();
-    inputs.verticalRotation = mouseDeltaY();
+    inputs.horizontalRotation = (float)undispatchedMouseDeltaX_;
+    inputs.verticalRotation = (float)undispatchedMouseDeltaY_;
+    discardUndispatchedInput();
 
     // Joystick inputs
     // They override any keyboard/mouse inputs set to zero.
@@ -86,11 +90,23 @@ void InputManager::dispatchInput(float deltaTime) const
 	if (fabs(inputs.horizontalRotation) < 0.001f) inputs.horizontalRotation = getJoystickAxis(JoystickAxis::RightStickHorizontal);
 	if (fabs(inputs.verticalRotation) < 0.001f) inputs.verticalRotation = getJoystickAxis(JoystickAxis::RightStickVertical);
 
+    // Store the input when a session is being recorded
+    if (ReplayManager::instance()->isRecording())
+    {
+        ReplayManager::instance()->recordInput(inputs);
+    }
+
     // The scene manager passes the input to all components
     // They can use the input by implementing the handleInput callback.
     SceneManager::instance()->handleInput(inputs);
 }
 
+void InputManager::discardUndispatchedInput()
+{
+    undispatchedMouseDeltaX_ = 0.0;
+    undispatchedMouseDeltaY_ = 0.0;
+}
+
 void InputManager::enableInput()
 {
     ignoringInput_ = false;
@@ -248,6 +264,8 @@ void InputManager::pollMouse()
 
     mouseDeltaX_ = mouseX - prevMouseX_;
     mouseDeltaY_ = mouseY - prevMouseY_;
+    undispatchedMouseDeltaX_ += mouseDeltaX_;
+    undispatchedMouseDeltaY_ += mouseDeltaY_;
 
     prevMouseX_ = mouseX;
     prevMouseY_ = mouseY;
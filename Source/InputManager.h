@@ -171,9 +171,14 @@ public:
     // Called every frame
     void frameStart();
 
-    // Sends the current input to all components in the scene
-    // This sends the input to the handleInput() component functions
-    void dispatchInput(float deltaTime) const;
+    // Sends the current input to all components in the scene, for one simulation tick.
+    // This sends the input to the handleInput() component functions.
+    // Mouse movement is sent once, by the first dispatch after it happened, so frames
+    // with several ticks don't apply it several times and frames with none don't lose it.
+    void dispatchInput(float deltaTime);
+
+    // Forgets the mouse movement waiting to be dispatched, when no ticks will use it
+    void discardUndispatchedInput();
 
     // Allows all input to be enabled and disabled.
     // This should be used when the game is paused, or the game panel does not have focus.
@@ -219,6 +224,10 @@ private:
     double prevMouseX_;
     double prevMouseY_;
 
+    // Mouse movement since the last call to dispatchInput
+    double undispatchedMouseDeltaX_;
+    double undispatchedMouseDeltaY_;
+
     std::vector<JoystickMapping> mappings_;
 
     void pollMouse();
@@ -1,6 +1,7 @@
 #include "Bounds.h"
 
 #include <algorithm>
+#include <cmath>
 
 Bounds::Bounds()
     : min_(Point3::origin()),
@@ -39,6 +40,22 @@ void Bounds::expandToCover(const Point3& point)
     max_.z = std::max(max_.z, point.z);
 }
 
+float Bounds::sqrDistance(const Point3& point) const
+{
+    const float dx = std::max(std::max(min_.x - point.x, point.x - max_.x), 0.0f);
+    const float dy = std::max(std::max(min_.y - point.y, point.y - max_.y), 0.0f);
+    const float dz = std::max(std::max(min_.z - point.z, point.z - max_.z), 0.0f);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+float Bounds::sqrFarthestDistance(const Point3& point) const
+{
+    const float dx = std::max(fabsf(min_.x - point.x), fabsf(max_.x - point.x));
+    const float dy = std::max(fabsf(min_.y - point.y), fabsf(max_.y - point.y));
+    const float dz = std::max(fabsf(min_.z - point.z), fabsf(max_.z - point.z));
+    return dx * dx + dy * dy + dz * dz;
+}
+
 Bounds Bounds::covering(const Point3* points, int count)
 {
     // Cover the first point initially
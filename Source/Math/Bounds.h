@@ -20,6 +20,11 @@ public:
     // Expands the bounds to cover the given point
     void expandToCover(const Point3 &point);
 
+    // The squared distances from a point to the closest and farthest points in the bounds.
+    // The closest distance is 0 for points inside the bounds.
+    float sqrDistance(const Point3 &point) const;
+    float sqrFarthestDistance(const Point3 &point) const;
+
     // Creates a Bounds instance covering the given points
     static Bounds covering(const Point3* points, int count);
 
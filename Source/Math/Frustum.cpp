@@ -0,0 +1,72 @@
+#include "Frustum.h"
+
+Frustum::Frustum()
+{
+    // Planes with no normal contain every point
+    for (Vector4& plane : planes_)
+    {
+        plane = Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const Matrix4x4 &worldToClip)
+{
+    // A point is inside when -w <= x, y, z <= w in clip space.
+    // Each of those conditions is a plane formed from the rows of the matrix.
+    for (int i = 0; i < 3; ++i)
+    {
+        planes_[i * 2] = Vector4(
+            worldToClip.get(3, 0) + worldToClip.get(i, 0),
+            worldToClip.get(3, 1) + worldToClip.get(i, 1),
+            worldToClip.get(3, 2) + worldToClip.get(i, 2),
+            worldToClip.get(3, 3) + worldToClip.get(i, 3));
+
+        planes_[i * 2 + 1] = Vector4(
+            worldToClip.get(3, 0) - worldToClip.get(i, 0),
+            worldToClip.get(3, 1) - worldToClip.get(i, 1),
+            worldToClip.get(3, 2) - worldToClip.get(i, 2),
+            worldToClip.get(3, 3) - worldToClip.get(i, 3));
+    }
+}
+
+bool Frustum::intersects(const Bounds &bounds) const
+{
+    const Point3 min = bounds.min();
+    const Point3 max = bounds.max();
+
+    for (const Vector4& plane : planes_)
+    {
+        // Test the corner furthest along the plane normal.
+        // If that is behind the plane, the whole box is.
+        const float x = (plane.x >= 0.0f) ? max.x : min.x;
+        const float y = (plane.y >= 0.0f) ? max.y : min.y;
+        const float z = (plane.z >= 0.0f) ? max.z : min.z;
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Frustum::contains(const Bounds &bounds) const
+{
+    const Point3 min = bounds.min();
+    const Point3 max = bounds.max();
+
+    for (const Vector4& plane : planes_)
+    {
+        // Test the corner furthest against the plane normal.
+        // If that is in front of the plane, the whole box is.
+        const float x = (plane.x >= 0.0f) ? min.x : max.x;
+        const float y = (plane.y >= 0.0f) ? min.y : max.y;
+        const float z = (plane.z >= 0.0f) ? min.z : max.z;
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Bounds.h"
+#include "Matrix4x4.h"
+#include "Vector4.h"
+
+// The volume that can be seen through a camera, bounded by six planes.
+class Frustum
+{
+public:
+    // Creates a frustum that contains everything
+    Frustum();
+
+    // Creates the frustum of a camera from its world to clip space matrix
+    explicit Frustum(const Matrix4x4 &worldToClip);
+
+    // Whether a box may be inside the frustum.
+    // This is conservative - some boxes just outside the corners are reported as inside.
+    bool intersects(const Bounds &bounds) const;
+
+    // Whether a box is entirely inside the frustum
+    bool contains(const Bounds &bounds) const;
+
+    // The planes facing into the frustum, in the order left, right, bottom, top, near, far.
+    // xyz is the normal, which is not normalized, and w is the distance.
+    const Vector4& plane(int index) const { return planes_[index]; }
+
+private:
+    Vector4 planes_[6];
+};
\ No newline at end of file
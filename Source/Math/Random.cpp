@@ -1,16 +1,109 @@
 #include "Random.h"
 
-float random_float()
+#include <assert.h>
+#include <emmintrin.h>
+#include <math.h>
+#include <thread>
+
+namespace
 {
-    return rand() / (float)RAND_MAX;
+    // Scale to convert the upper 24 bits of a random integer to a float in [0, 1)
+    const float UINT24_TO_FLOAT = 1.0f / 16777216.0f;
+
+    // splitmix64 finalizer, used to turn seeds into well distributed stream keys
+    uint64_t mixSeed(uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // A 32 bit integer hash with low bias (by Chris Wellons)
+    uint32_t hash32(uint32_t value)
+    {
+        value ^= value >> 16;
+        value *= 0x7FEB352Du;
+        value ^= value >> 15;
+        value *= 0x846CA68Bu;
+        value ^= value >> 16;
+        return value;
+    }
+
+    // Combines the stream key with a counter.
+    // Two rounds of the hash are used so that nearby keys produce unrelated streams.
+    uint32_t hashCounter(uint32_t keyLow, uint32_t keyHigh, uint32_t counter)
+    {
+        return hash32(hash32(counter + keyLow) ^ keyHigh);
+    }
+
+    // SSE2 has no 32 bit multiply that keeps the low bits, so emulate it using two 64 bit multiplies.
+    __m128i mullo32(__m128i a, __m128i b)
+    {
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    // hash32 for four values at once
+    __m128i hash32x4(__m128i value)
+    {
+        const __m128i multiplier0 = _mm_set1_epi32(0x7FEB352D);
+        const __m128i multiplier1 = _mm_set1_epi32((int)0x846CA68Bu);
+        value = _mm_xor_si128(value, _mm_srli_epi32(value, 16));
+        value = mullo32(value, multiplier0);
+        value = _mm_xor_si128(value, _mm_srli_epi32(value, 15));
+        value = mullo32(value, multiplier1);
+        value = _mm_xor_si128(value, _mm_srli_epi32(value, 16));
+        return value;
+    }
+
+    // The stream used by the global random functions.
+    // It's shared by every thread, so it's only used from the thread that first calls one of them (the main thread).
+    RandomStream globalStreamInstance(0);
+    std::thread::id globalStreamThread;
+
+    RandomStream& globalStream()
+    {
+        const std::thread::id thread = std::this_thread::get_id();
+        if (globalStreamThread == std::thread::id())
+        {
+            globalStreamThread = thread;
+        }
+        assert(globalStreamThread == thread && "The global random functions are main thread only, jobs should use their own RandomStream");
+        return globalStreamInstance;
+    }
 }
 
-float random_float(float min, float max)
+RandomStream::RandomStream(uint64_t seed, uint64_t streamId)
+    : counter_(0)
 {
-    return min + (random_float() * (max - min));
+    const uint64_t key = mixSeed(seed ^ mixSeed(streamId));
+    keyLow_ = (uint32_t)key;
+    keyHigh_ = (uint32_t)(key >> 32);
 }
 
-Vector2 random_in_unit_circle()
+RandomStream RandomStream::split(uint64_t streamId) const
+{
+    return RandomStream(((uint64_t)keyHigh_ << 32) | keyLow_, streamId);
+}
+
+uint32_t RandomStream::nextUint()
+{
+    return hashCounter(keyLow_, keyHigh_, counter_++);
+}
+
+float RandomStream::nextFloat()
+{
+    return (float)(nextUint() >> 8) * UINT24_TO_FLOAT;
+}
+
+float RandomStream::nextFloat(float min, float max)
+{
+    return min + nextFloat() * (max - min);
+}
+
+Vector2 RandomStream::nextInUnitCircle()
 {
     // Find a random direction using monte carlo
     Vector2 dir;
@@ -18,8 +111,8 @@ Vector2 random_in_unit_circle()
 
     do
     {
-        dir.x = random_float(-1.0f, 1.0f);
-        dir.y = random_float(-1.0f, 1.0f);
+        dir.x = nextFloat(-1.0f, 1.0f);
+        dir.y = nextFloat(-1.0f, 1.0f);
         sqrMagnitude = dir.sqrMagnitude();
     } while (sqrMagnitude > 1.0f || sqrMagnitude < 0.1f);
 
@@ -27,13 +120,7 @@ Vector2 random_in_unit_circle()
     return dir;
 }
 
-Vector2 random_direction_2d()
-{
-    float angle = random_float();
-    return Vector2(cosf(angle), sinf(angle));
-}
-
-Vector3 random_direction_3d()
+Vector3 RandomStream::nextDirection3d()
 {
     // Find a random direction using monte carlo
     Vector3 dir;
@@ -41,13 +128,110 @@ Vector3 random_direction_3d()
 
     do
     {
-        dir.x = random_float(-1.0f, 1.0f);
-        dir.y = random_float(-1.0f, 1.0f);
-        dir.z = random_float(-1.0f, 1.0f);
+        dir.x = nextFloat(-1.0f, 1.0f);
+        dir.y = nextFloat(-1.0f, 1.0f);
+        dir.z = nextFloat(-1.0f, 1.0f);
         sqrMagnitude = dir.sqrMagnitude();
     }
     while(sqrMagnitude > 1.0f || sqrMagnitude < 0.05f);
 
     // Normalize and return
     return dir / sqrtf(sqrMagnitude);
+}
+
+uint32_t RandomStream::uintAt(uint32_t position) const
+{
+    return hashCounter(keyLow_, keyHigh_, position);
+}
+
+float RandomStream::floatAt(uint32_t position) const
+{
+    return (float)(uintAt(position) >> 8) * UINT24_TO_FLOAT;
+}
+
+float RandomStream::floatAt(uint32_t position, float min, float max) const
+{
+    return min + floatAt(position) * (max - min);
+}
+
+void RandomStream::fillUint(uint32_t* values, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        values[i] = nextUint();
+    }
+}
+
+void RandomStream::fillFloat(float* values, int count)
+{
+    fillFloat(values, count, 0.0f, 1.0f);
+}
+
+void RandomStream::fillFloat(float* values, int count, float min, float max)
+{
+    const __m128i keyLow = _mm_set1_epi32((int)keyLow_);
+    const __m128i keyHigh = _mm_set1_epi32((int)keyHigh_);
+    const __m128 scale = _mm_set1_ps(UINT24_TO_FLOAT);
+    const __m128 rangeMin = _mm_set1_ps(min);
+    const __m128 rangeSize = _mm_set1_ps(max - min);
+
+    // Generate four values at a time.
+    // The operations match the scalar version exactly, so the results are identical.
+    __m128i counter = _mm_add_epi32(_mm_set1_epi32((int)counter_), _mm_setr_epi32(0, 1, 2, 3));
+    const __m128i counterStep = _mm_set1_epi32(4);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i hash = hash32x4(_mm_add_epi32(counter, keyLow));
+        hash = hash32x4(_mm_xor_si128(hash, keyHigh));
+
+        const __m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(hash, 8)), scale);
+        _mm_storeu_ps(values + i, _mm_add_ps(rangeMin, _mm_mul_ps(unit, rangeSize)));
+
+        counter = _mm_add_epi32(counter, counterStep);
+    }
+    counter_ += (uint32_t)i;
+
+    // Finish any remaining values
+    for (; i < count; ++i)
+    {
+        values[i] = nextFloat(min, max);
+    }
+}
+
+void random_seed(uint64_t seed)
+{
+    globalStream() = RandomStream(seed);
+}
+
+uint32_t random_uint()
+{
+    return globalStream().nextUint();
+}
+
+float random_float()
+{
+    return globalStream().nextFloat();
+}
+
+float random_float(float min, float max)
+{
+    return globalStream().nextFloat(min, max);
+}
+
+Vector2 random_in_unit_circle()
+{
+    return globalStream().nextInUnitCircle();
+}
+
+Vector2 random_direction_2d()
+{
+    float angle = random_float();
+    return Vector2(cosf(angle), sinf(angle));
+}
+
+Vector3 random_direction_3d()
+{
+    return globalStream().nextDirection3d();
 }
\ No newline at end of file
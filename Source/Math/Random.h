@@ -1,8 +1,67 @@
 #pragma once
 
+#include <cstdint>
+
 #include "Vector2.h"
 #include "Vector3.h"
 
+// A counter based random number stream.
+//
+// Each value is a pure function of the stream key and its index, so streams have
+// no hidden global state, can be copied freely, and a value can be computed at any
+// position without generating the ones before it. Only integer operations are used,
+// so the same seed produces bit-identical results on every platform and compiler.
+//
+// Separate streams for the same seed can be created with different stream ids,
+// which lets work be split across threads and still give deterministic results.
+class RandomStream
+{
+public:
+    explicit RandomStream(uint64_t seed, uint64_t streamId = 0);
+
+    // Creates an independent stream derived from this one.
+    RandomStream split(uint64_t streamId) const;
+
+    // The index of the next value returned by the stream.
+    uint32_t position() const { return counter_; }
+    void seek(uint32_t position) { counter_ = position; }
+
+    // Returns the next value in the stream.
+    uint32_t nextUint();
+    float nextFloat();
+    float nextFloat(float min, float max);
+
+    // Returns a random vector inside the unit circle, without normalizing it.
+    Vector2 nextInUnitCircle();
+
+    // Returns a random direction vector of unit length.
+    Vector3 nextDirection3d();
+
+    // Returns the value at a specific position, without moving the stream.
+    uint32_t uintAt(uint32_t position) const;
+    float floatAt(uint32_t position) const;
+    float floatAt(uint32_t position, float min, float max) const;
+
+    // Fills an array with the next count values in the stream.
+    // The float versions use SSE2 and give the same results as calling nextFloat repeatedly.
+    void fillUint(uint32_t* values, int count);
+    void fillFloat(float* values, int count);
+    void fillFloat(float* values, int count, float min, float max);
+
+private:
+    uint32_t keyLow_;
+    uint32_t keyHigh_;
+    uint32_t counter_;
+};
+
+// Reseeds the random stream used by the functions below.
+// These share one stream, so they must only be called from the main thread.
+// Work run on the job system should use its own RandomStream (see RandomStream::split).
+void random_seed(uint64_t seed);
+
+// Returns a random 32 bit unsigned integer.
+uint32_t random_uint();
+
 // Returns a random number between 0 and 1.
 float random_float();
 
@@ -16,5 +75,4 @@ Vector2 random_in_unit_circle();
 Vector2 random_direction_2d();
 
 // Returns a random direction vector of unit length.
-Vector3 random_direction_3d();
-
+Vector3 random_direction_3d();
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "InterestGrid.h"
+
+#include <algorithm>
+#include <math.h>
+
+InterestGrid::InterestGrid(const Rect &worldArea, float cellSize)
+    : worldArea_(worldArea),
+    inverseCellSize_(1.0f / cellSize)
+{
+    cellsX_ = std::max(1, (int)ceilf(worldArea.width / cellSize));
+    cellsZ_ = std::max(1, (int)ceilf(worldArea.height / cellSize));
+    cellStart_.resize(cellsX_ * cellsZ_ + 1);
+}
+
+void InterestGrid::build(const Point3* positions, int count)
+{
+    sortedEntities_.resize(count);
+    sortedPositions_.resize(count);
+    entityCells_.resize(count);
+
+    // First, count the number of entities in each cell.
+    // The counts are stored one place along, so the prefix sum below gives each cell's start.
+    std::fill(cellStart_.begin(), cellStart_.end(), 0);
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t cell = cellX(positions[i].x) + cellZ(positions[i].z) * cellsX_;
+        entityCells_[i] = cell;
+        cellStart_[cell + 1]++;
+    }
+
+    // Convert the counts into start offsets
+    for (unsigned int cell = 1; cell < cellStart_.size(); ++cell)
+    {
+        cellStart_[cell] += cellStart_[cell - 1];
+    }
+
+    // Scatter each entity into its cell's range.
+    // Each cell's start offset is used as its running write position,
+    // and is restored once every entity has been placed.
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t slot = cellStart_[entityCells_[i]]++;
+        sortedEntities_[slot] = (uint32_t)i;
+        sortedPositions_[slot] = positions[i];
+    }
+
+    // Every start offset has now been advanced to the next cell's start. Shift back.
+    for (size_t cell = cellStart_.size() - 1; cell > 0; --cell)
+    {
+        cellStart_[cell] = cellStart_[cell - 1];
+    }
+    cellStart_[0] = 0;
+}
+
+int InterestGrid::cellX(float x) const
+{
+    const int cell = (int)floorf((x - worldArea_.minx) * inverseCellSize_);
+    return std::min(std::max(cell, 0), cellsX_ - 1);
+}
+
+int InterestGrid::cellZ(float z) const
+{
+    const int cell = (int)floorf((z - worldArea_.miny) * inverseCellSize_);
+    return std::min(std::max(cell, 0), cellsZ_ - 1);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Point3.h"
+#include "Math/Rect.h"
+
+// A uniform grid over the XZ plane, used to find replicated entities close to a point.
+// The grid is rebuilt from scratch every network tick using a counting sort, so the
+// entities in each cell are stored contiguously and no per-cell allocations are made.
+class InterestGrid
+{
+public:
+    // Creates a grid covering the specified area of the XZ plane.
+    // Entities outside the area are placed in the nearest edge cell.
+    InterestGrid(const Rect &worldArea, float cellSize);
+
+    // Rebuilds the grid from a list of entity positions.
+    // Entities are identified by their index in the positions array.
+    void build(const Point3* positions, int count);
+
+    // Calls visitor(entityIndex, sqrDistance) for every entity within radius of centre.
+    template<typename Visitor>
+    void query(const Point3 &centre, float radius, Visitor visitor) const
+    {
+        const float sqrRadius = radius * radius;
+
+        // Only visit the cells overlapped by the query circle's bounding square
+        const int minX = cellX(centre.x - radius);
+        const int maxX = cellX(centre.x + radius);
+        const int minZ = cellZ(centre.z - radius);
+        const int maxZ = cellZ(centre.z + radius);
+
+        for (int z = minZ; z <= maxZ; ++z)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                const int cell = x + z * cellsX_;
+                for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i)
+                {
+                    const float dx = sortedPositions_[i].x - centre.x;
+                    const float dz = sortedPositions_[i].z - centre.z;
+                    const float sqrDistance = dx * dx + dz * dz;
+                    if (sqrDistance <= sqrRadius)
+                    {
+                        visitor(sortedEntities_[i], sqrDistance);
+                    }
+                }
+            }
+        }
+    }
+
+    // The number of cells along each axis
+    int cellsX() const { return cellsX_; }
+    int cellsZ() const { return cellsZ_; }
+
+private:
+    Rect worldArea_;
+    float inverseCellSize_;
+    int cellsX_;
+    int cellsZ_;
+
+    // The first sorted entity in each cell. Has one extra entry so that
+    // the end of cell i is always cellStart_[i + 1].
+    std::vector<uint32_t> cellStart_;
+
+    // Entity indices and positions, sorted by cell.
+    // Positions are duplicated here so queries read memory in order.
+    std::vector<uint32_t> sortedEntities_;
+    std::vector<Point3> sortedPositions_;
+
+    // The cell each entity was placed in during the last build
+    std::vector<uint32_t> entityCells_;
+
+    // Converts a world position to a cell coordinate, clamped to the grid.
+    int cellX(float x) const;
+    int cellZ(float z) const;
+};
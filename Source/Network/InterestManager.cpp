@@ -0,0 +1,166 @@
+#include "InterestManager.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+#include "Serialization/BitWriter.h"
+
+const int InterestManager::MAX_ENTITIES;
+const uint32_t InterestManager::FREE_INDEX;
+
+InterestManager::InterestManager(const Rect &worldArea, float cellSize)
+    : grid_(worldArea, cellSize),
+    tick_(1)
+{
+
+}
+
+int InterestManager::addEntity(const ReplicatedEntity &entity)
+{
+    // Hand out every ID before reusing any, so a client is less likely to confuse a new object with an old one
+    uint32_t id;
+    if (entityIndices_.size() < MAX_ENTITIES)
+    {
+        id = (uint32_t)entityIndices_.size();
+        entityIndices_.push_back(FREE_INDEX);
+    }
+    else if (freeIds_.empty())
+    {
+        // Any more and the IDs written into packets would be truncated
+        printf("Can't replicate more than %d objects\n", MAX_ENTITIES);
+        return -1;
+    }
+    else
+    {
+        id = freeIds_.front();
+        freeIds_.pop_front();
+    }
+
+    entityIndices_[id] = (uint32_t)entities_.size();
+    entityIds_.push_back(id);
+    entities_.push_back(entity);
+
+    // Every client needs an accumulator for the new object
+    for (ClientState &client : clients_)
+    {
+        client.accumulators.push_back(0.0f);
+        client.lastRelevantTick.push_back(0);
+    }
+
+    return (int)id;
+}
+
+void InterestManager::removeEntity(int id)
+{
+    const uint32_t index = entityIndices_[id];
+    assert(index != FREE_INDEX);
+
+    // Swap & pop, keeping the IDs and client accumulators in step with the entity list
+    entityIndices_[entityIds_.back()] = index;
+    entityIndices_[id] = FREE_INDEX;
+    freeIds_.push_back((uint32_t)id);
+
+    std::swap(entityIds_[index], entityIds_.back());
+    entityIds_.pop_back();
+    std::swap(entities_[index], entities_.back());
+    entities_.pop_back();
+
+    for (ClientState &client : clients_)
+    {
+        std::swap(client.accumulators[index], client.accumulators.back());
+        client.accumulators.pop_back();
+        std::swap(client.lastRelevantTick[index], client.lastRelevantTick.back());
+        client.lastRelevantTick.pop_back();
+    }
+}
+
+int InterestManager::addClient(const InterestClient &client)
+{
+    ClientState state;
+    state.settings = client;
+    state.accumulators.resize(entities_.size(), 0.0f);
+    state.lastRelevantTick.resize(entities_.size(), 0);
+    clients_.push_back(state);
+    return (int)clients_.size() - 1;
+}
+
+void InterestManager::update(float deltaTime)
+{
+    // Rebuild the grid using the latest object positions
+    positions_.resize(entities_.size());
+    for (unsigned int i = 0; i < entities_.size(); ++i)
+    {
+        positions_[i] = entities_[i].position;
+    }
+    grid_.build(positions_.data(), (int)positions_.size());
+
+    // Each client is independent of the others
+    for (ClientState &client : clients_)
+    {
+        updateClient(client, deltaTime);
+    }
+
+    tick_++;
+}
+
+void InterestManager::updateClient(ClientState &client, float deltaTime)
+{
+    const InterestClient &settings = client.settings;
+    const float inverseSqrRadius = 1.0f / (settings.viewRadius * settings.viewRadius);
+    const uint32_t previousTick = tick_ - 1;
+
+    // Find every relevant object and grow its accumulator.
+    // Closer objects gain priority faster, falling off to nothing at the view radius.
+    client.candidates.clear();
+    grid_.query(settings.viewPosition, settings.viewRadius, [&](uint32_t index, float sqrDistance)
+    {
+        // Objects that were not relevant last tick have just entered the view radius
+        if (client.lastRelevantTick[index] != previousTick)
+        {
+            client.accumulators[index] = 0.0f;
+        }
+        client.lastRelevantTick[index] = tick_;
+
+        const ReplicatedEntity &entity = entities_[index];
+        if (entity.deltaSizeBits > 0)
+        {
+            const float falloff = 1.0f - sqrDistance * inverseSqrRadius;
+            client.accumulators[index] += entity.priority * falloff * deltaTime;
+            client.candidates.push_back(index);
+        }
+    });
+
+    // Most important objects first
+    const float* accumulators = client.accumulators.data();
+    std::sort(client.candidates.begin(), client.candidates.end(), [accumulators](uint32_t a, uint32_t b)
+    {
+        return accumulators[a] > accumulators[b];
+    });
+
+    // Fill the packet until the budget is used up.
+    // Large deltas that do not fit are skipped so smaller ones can still use the space.
+    client.sendList.clear();
+    client.sendBits = 0;
+    for (uint32_t index : client.candidates)
+    {
+        const int bits = ENTITY_HEADER_BITS + entities_[index].deltaSizeBits;
+        if (client.sendBits + bits > settings.packetBudgetBits)
+        {
+            continue;
+        }
+
+        client.sendList.push_back(entityIds_[index]);
+        client.sendBits += bits;
+        client.accumulators[index] = 0.0f;
+    }
+}
+
+void InterestManager::writePacket(int client, BitWriter &writer, const std::function<void(uint32_t, BitWriter&)> &writeDelta) const
+{
+    for (uint32_t id : clients_[client].sendList)
+    {
+        writer.writeBits(id, ENTITY_HEADER_BITS);
+        writeDelta(id, writer);
+    }
+}
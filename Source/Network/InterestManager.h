@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "Network/InterestGrid.h"
+
+class BitWriter;
+
+// A single replicated object, as seen by the interest manager.
+struct ReplicatedEntity
+{
+    // The current world-space position of the object
+    Point3 position;
+
+    // How quickly the object's priority grows while it has unsent changes.
+    // Important objects (eg. players, projectiles) should use larger values.
+    float priority = 1.0f;
+
+    // The size of the object's pending state delta.
+    // 0 means the object has no changes and does not need sending.
+    int deltaSizeBits = 0;
+};
+
+// A client receiving replicated objects from the server.
+struct InterestClient
+{
+    // The point the client is viewing the world from
+    Point3 viewPosition;
+
+    // Objects further than this from the view position are not sent
+    float viewRadius = 300.0f;
+
+    // The maximum size of a single packet sent to the client
+    int packetBudgetBits = 1200 * 8;
+};
+
+// Decides which replicated objects are sent to each client on each network tick.
+//
+// Objects are only relevant to a client when they are inside its view radius.
+// Each client keeps a priority accumulator per object, which grows every tick that the object
+// has unsent changes, faster for important and nearby objects. When a packet is built,
+// the objects with the largest accumulators are written first until the packet's bit budget
+// is used up. Objects that miss out keep their accumulated priority, so they are guaranteed
+// to be sent eventually.
+class InterestManager
+{
+public:
+    // The number of bits written before each object's delta to identify it.
+    const static int ENTITY_HEADER_BITS = 16;
+
+    // The most objects that can be identified by the header
+    const static int MAX_ENTITIES = 1 << ENTITY_HEADER_BITS;
+
+    InterestManager(const Rect &worldArea, float cellSize);
+
+    // Adds an object and returns its ID, or -1 if there are already MAX_ENTITIES objects.
+    // The ID is what identifies the object in packets, and doesn't change while the object exists.
+    // IDs of removed objects are reused, oldest first, once every ID has been handed out.
+    int addEntity(const ReplicatedEntity &entity);
+    void removeEntity(int id);
+    ReplicatedEntity& entity(int id) { return entities_[entityIndices_[id]]; }
+    int entityCount() const { return (int)entities_.size(); }
+
+    // Adds a client and returns its index.
+    int addClient(const InterestClient &client);
+    InterestClient& client(int index) { return clients_[index].settings; }
+    int clientCount() const { return (int)clients_.size(); }
+
+    // Runs a single network tick.
+    // Rebuilds the spatial grid, updates priority accumulators and picks the objects sent to each client.
+    void update(float deltaTime);
+
+    // The IDs of the objects picked for a client in the last update, highest priority first.
+    const std::vector<uint32_t>& sendList(int client) const { return clients_[client].sendList; }
+
+    // The number of bits picked for a client in the last update, including headers.
+    int sendBits(int client) const { return clients_[client].sendBits; }
+
+    // Writes the objects picked for a client into a packet.
+    // writeDelta is called with each object's ID, and must write exactly deltaSizeBits bits.
+    void writePacket(int client, BitWriter &writer, const std::function<void(uint32_t, BitWriter&)> &writeDelta) const;
+
+private:
+    struct ClientState
+    {
+        InterestClient settings;
+
+        // Per-object priority accumulators, and the tick each object was last relevant.
+        // Objects that leave and re-enter the view radius start again from 0.
+        std::vector<float> accumulators;
+        std::vector<uint32_t> lastRelevantTick;
+
+        // Scratch list of relevant objects with changes, reused every tick
+        std::vector<uint32_t> candidates;
+
+        // Results of the last update
+        std::vector<uint32_t> sendList;
+        int sendBits = 0;
+    };
+
+    // Objects are stored densely, so removing one moves the last object into its place.
+    // The IDs map to and from the dense indices, so they stay the same when that happens.
+    // IDs that aren't in use map to FREE_INDEX.
+    const static uint32_t FREE_INDEX = UINT32_MAX;
+
+    InterestGrid grid_;
+    std::vector<ReplicatedEntity> entities_;
+    std::vector<uint32_t> entityIds_;
+    std::vector<uint32_t> entityIndices_;
+    std::deque<uint32_t> freeIds_;
+    std::vector<Point3> positions_;
+    std::vector<ClientState> clients_;
+    uint32_t tick_;
+
+    // Picks the objects sent to a single client
+    void updateClient(ClientState &client, float deltaTime);
+};
@@ -6,6 +6,9 @@
 class BoxCollider : public Collider
 {
 public:
+    const static ComponentType TYPE = ComponentType::BoxCollider;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit BoxCollider(GameObject* gameObject);
 
     void drawProperties() override;
@@ -4,4 +4,10 @@ Collider::Collider(GameObject* gameObject)
     : Component(gameObject)
 {
 
+}
+
+bool Collider::checkForCollision(const Point3 &, const Point3 &end, float &hitFraction) const
+{
+    hitFraction = 1.0f;
+    return checkForCollision(end);
 }
\ No newline at end of file
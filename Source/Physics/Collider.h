@@ -8,12 +8,19 @@
 class Collider : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Collider;
+
     explicit Collider(GameObject* gameObject);
 
     // Checks if a world-space point intersects with the collider.
     // If true, the ColliderHit struct will be filled in.
     virtual bool checkForCollision(const Point3 &point) const = 0;
 
+    // Checks if a world-space point moving from start to end intersects with the collider.
+    // If true, hitFraction is set to how far along the movement the collision happens.
+    // By default only the end point is checked, so fast moving points can pass through thin colliders.
+    virtual bool checkForCollision(const Point3 &start, const Point3 &end, float &hitFraction) const;
+
 private:
 
 };
\ No newline at end of file
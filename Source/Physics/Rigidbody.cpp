@@ -19,14 +19,16 @@ void Rigidbody::update(float deltaTime)
     velocity_.y -= 9.81f * deltaTime;
 
     // Then apply the velocity to the transform position
+    const Point3 previousPoint = gameObject()->transform()->positionWorld();
     gameObject()->transform()->translateWorld(velocity_ * deltaTime);
 
-    // Check for a collision with the scene
+    // Check for a collision with the scene along the path moved this frame
 	// The rigidbody is approximated as a point, for simplicity.
     const Point3 rigidbodyPoint = gameObject()->transform()->positionWorld();
     for(Collider* collider : SceneManager::instance()->findAllComponentsInScene<Collider>())
     {
-        if(collider->checkForCollision(rigidbodyPoint))
+        float hitFraction;
+        if(collider->checkForCollision(previousPoint, rigidbodyPoint, hitFraction))
 		{
 			// Move the rigidbody back one timestep to before there was a collision
 			gameObject()->transform()->translateWorld(velocity_ * -deltaTime);
@@ -45,6 +47,11 @@ void Rigidbody::update(float deltaTime)
     }
 }
 
+void Rigidbody::resetForReuse()
+{
+    velocity_ = Vector3::zero();
+}
+
 void Rigidbody::setVelocity(const Vector3& value)
 {
     velocity_ = value;
@@ -8,9 +8,13 @@ class Transform;
 class Rigidbody : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Rigidbody;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit Rigidbody(GameObject* gameObject);
 
     void update(float deltaTime) override;
+    void resetForReuse() override;
 
     // The world-space velocity of the rigidbody
     // This is affected by the simulation over time, due to gravity
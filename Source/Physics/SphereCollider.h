@@ -6,6 +6,9 @@
 class SphereCollider : public Collider
 {
 public:
+    const static ComponentType TYPE = ComponentType::SphereCollider;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit SphereCollider(GameObject* gameObject);
 
     void drawProperties() override;
@@ -24,3 +24,23 @@ bool TerrainCollider::checkForCollision(const Point3 &point) const
 	return (point.y < heightmapHeight);
 }
 
+bool TerrainCollider::checkForCollision(const Point3 &start, const Point3 &end, float &hitFraction) const
+{
+	const Terrain* terrain = gameObject()->findComponent<Terrain>();
+	if(terrain == nullptr)
+	{
+		return false;
+	}
+
+	// Sweep the movement through the terrain, so fast objects can't skip over thin ridges
+	HeightfieldHit hit;
+	if(terrain->sweepSegment(start, end, hit))
+	{
+		hitFraction = hit.distance;
+		return true;
+	}
+
+	// The quadtree only covers the heightmap area, and the heightmap is clamped outside it
+	hitFraction = 1.0f;
+	return checkForCollision(end);
+}
\ No newline at end of file
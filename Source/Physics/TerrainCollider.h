@@ -6,8 +6,14 @@
 class TerrainCollider : public Collider
 {
 public:
+    const static ComponentType TYPE = ComponentType::TerrainCollider;
+    ComponentType componentType() const override { return TYPE; }
+
 	explicit TerrainCollider(GameObject* gameObject);
 
 	// Checks if the terrain is intersecting with a point
 	bool checkForCollision(const Point3 &point) const override;
+
+	// Checks if a point moving between two positions passes below the terrain, using the heightmap quadtree
+	bool checkForCollision(const Point3 &start, const Point3 &end, float &hitFraction) const override;
 };
@@ -28,7 +28,7 @@ RenderManager::RenderManager()
     addShaderFeatureMenuItem(SF_Shadows, "Shadows");
     addShaderFeatureMenuItem(SF_SoftShadows, "Soft Shadows");
     addShaderFeatureMenuItem(SF_ShadowCascadeBlending, "Shadow Cascade Blending");
-    addShaderFeatureMenuItem(SF_HighTessellation, "Extra Tessellation");
+    addShaderFeatureMenuItem(SF_HighTessellation, "High Terrain Detail");
     addShaderFeatureMenuItem(SF_TerrainDetailMeshes, "Terrain Details");
     addShaderFeatureMenuItem(SF_ExtraTerrainDetails, "Extra Terrain Details");
     addShaderFeatureMenuItem(SF_Translucency, "Translucency");
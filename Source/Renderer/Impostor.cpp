@@ -0,0 +1,149 @@
+#include "Impostor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Math/Bounds.h"
+#include "Renderer/Framebuffer.h"
+#include "Renderer/Material.h"
+#include "Renderer/Mesh.h"
+#include "Renderer/Shader.h"
+#include "Renderer/UniformBuffer.h"
+#include "ResourceManager.h"
+
+Impostor::Impostor()
+    : albedoTexture_(TextureFormat::RGBA8, FRAMES_PER_SIDE * FRAME_RESOLUTION, FRAMES_PER_SIDE * FRAME_RESOLUTION),
+    normalTexture_(TextureFormat::RGBA1010102, FRAMES_PER_SIDE * FRAME_RESOLUTION, FRAMES_PER_SIDE * FRAME_RESOLUTION),
+    centre_(Point3::origin()),
+    radius_(1.0f)
+{
+    // Packed normals can't be blended between texels, but the albedo and coverage can
+    albedoTexture_.setFilterMode(TextureFilterMode::Bilinear);
+}
+
+void Impostor::bake(const std::vector<Part> &parts)
+{
+    // Find a sphere around the corners of every part
+    Bounds bounds(Point3::origin(), Point3::origin());
+    bool first = true;
+    for (const Part& part : parts)
+    {
+        const Point3 min = part.mesh->bounds().min();
+        const Point3 max = part.mesh->bounds().max();
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const Point3 local((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+            const Point3 root = part.localToRoot * local;
+            if (first)
+            {
+                bounds = Bounds(root, root);
+                first = false;
+            }
+            else
+            {
+                bounds.expandToCover(root);
+            }
+        }
+    }
+    centre_ = bounds.centre();
+    radius_ = std::max(bounds.size().magnitude() * 0.5f, 0.01f);
+
+    // Render into the atlas, with a depth buffer that is only needed while baking
+    const int atlasResolution = FRAMES_PER_SIDE * FRAME_RESOLUTION;
+    Texture depthTexture(TextureFormat::Depth, atlasResolution, atlasResolution);
+    const Texture* colorTextures[2] = { &albedoTexture_, &normalTexture_ };
+    Framebuffer framebuffer;
+    framebuffer.attachColorTexturesMRT(2, colorTextures);
+    framebuffer.attachDepthTexture(&depthTexture);
+
+    // Keep the framebuffer and viewport in use, to put them back afterwards
+    GLint previousFramebuffer;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    framebuffer.use();
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(true);
+    glDisable(GL_BLEND);
+
+    // The standard shader writes an occlusion of 1 into the albedo alpha,
+    // so texels left with the cleared alpha of 0 are outside the meshes
+    const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearNamedFramebufferfv(framebuffer.glid(), GL_COLOR, 0, clearColor);
+    glClearNamedFramebufferfv(framebuffer.glid(), GL_COLOR, 1, clearColor);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    UniformBuffer<CameraUniformData> cameraUniformBuffer(UniformBufferType::CameraBuffer);
+    UniformBuffer<PerDrawUniformData> perDrawUniformBuffer(UniformBufferType::PerDrawBuffer);
+    cameraUniformBuffer.use();
+    perDrawUniformBuffer.use();
+
+    Shader* standardShader = ResourceManager::instance()->load<Shader>("Resources/Shaders/Standard.shader");
+
+    // Every frame is an orthographic view of the whole sphere
+    const Matrix4x4 projection = Matrix4x4::orthographic(-radius_, radius_, -radius_, radius_, -radius_, radius_);
+    for (int frameY = 0; frameY < FRAMES_PER_SIDE; ++frameY)
+    {
+        for (int frameX = 0; frameX < FRAMES_PER_SIDE; ++frameX)
+        {
+            glViewport(frameX * FRAME_RESOLUTION, frameY * FRAME_RESOLUTION, FRAME_RESOLUTION, FRAME_RESOLUTION);
+
+            CameraUniformData cameraData;
+            cameraData.screenResolution = Vector4((float)FRAME_RESOLUTION, (float)FRAME_RESOLUTION, 1.0f / FRAME_RESOLUTION, 1.0f / FRAME_RESOLUTION);
+            cameraData.cameraPosition = Vector4(centre_ + frameDirection(frameX, frameY) * radius_);
+            cameraData.worldToClip = projection * frameView(frameX, frameY);
+            cameraData.clipToWorld = cameraData.worldToClip.invert();
+            cameraUniformBuffer.update(cameraData);
+
+            for (const Part& part : parts)
+            {
+                standardShader->bindVariant(part.material->supportedFeatures());
+                part.mesh->bind();
+
+                PerDrawUniformData data;
+                data.localToWorld = part.localToRoot;
+                data.colorSmoothness = part.material->color();
+                data.colorSmoothness.a = part.material->smoothness();
+                data.albedoTexture = (part.material->albedoTexture() == nullptr) ? 0 : part.material->albedoTexture()->bindlessHandle();
+                data.normalMapTexture = (part.material->normalMapTexture() == nullptr) ? 0 : part.material->normalMapTexture()->bindlessHandle();
+                data.instanceOffset[0] = 0;
+                data.instanceFade = Vector4::zero();
+                data.impostorBounds = Vector4::zero();
+                perDrawUniformBuffer.update(data);
+
+                glDrawElements(GL_TRIANGLES, part.mesh->elementsCount(), GL_UNSIGNED_SHORT, (void*)0);
+            }
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+Vector3 Impostor::frameDirection(int frameX, int frameY)
+{
+    // The centre of the frame in the atlas, from -1 to 1
+    const float u = (frameX + 0.5f) / FRAMES_PER_SIDE * 2.0f - 1.0f;
+    const float v = (frameY + 0.5f) / FRAMES_PER_SIDE * 2.0f - 1.0f;
+
+    // Undo the 45 degree rotation of the octahedron's upper half, then lift the point onto it
+    const float x = (u + v) * 0.5f;
+    const float z = (u - v) * 0.5f;
+    return Vector3(x, 1.0f - fabsf(x) - fabsf(z), z).normalized();
+}
+
+Matrix4x4 Impostor::frameView(int frameX, int frameY) const
+{
+    // Look back along the frame direction. Views from straight above keep +z as up.
+    const Vector3 forward = frameDirection(frameX, frameY) * -1.0f;
+    const Vector3 worldUp = (fabsf(forward.y) > 0.999f) ? Vector3::forwards() : Vector3::up();
+    const Vector3 right = Vector3::cross(worldUp, forward).normalized();
+    const Vector3 up = Vector3::cross(forward, right);
+
+    Matrix4x4 view = Matrix4x4::identity();
+    view.setRow(0, right.x, right.y, right.z, 0.0f);
+    view.setRow(1, up.x, up.y, up.z, 0.0f);
+    view.setRow(2, forward.x, forward.y, forward.z, 0.0f);
+    return view * Matrix4x4::translation(Point3::origin() - centre_);
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include "Math/Matrix4x4.h"
+#include "Math/Point3.h"
+#include "Math/Vector3.h"
+#include "Renderer/Texture.h"
+
+class Mesh;
+class Material;
+
+// Views of a group of static meshes from every direction in the upper hemisphere, baked into an
+// atlas and drawn as a single billboard in place of the meshes when they are far from the viewer.
+//
+// The atlas is a square of FRAMES_PER_SIDE frames. The direction each frame is seen from comes from
+// a hemi-octahedral mapping of its position in the atlas, which spreads the views evenly over the
+// hemisphere. The frames hold the albedo and the normals of the meshes, in the space of their root,
+// packed the same way as the gbuffer, so billboards are lit like any other surface.
+class Impostor
+{
+public:
+    // The number of frames along each side of the atlas
+    const static int FRAMES_PER_SIDE = 8;
+
+    // The width and height of each frame, in texels
+    const static int FRAME_RESOLUTION = 128;
+
+    // A mesh to bake, placed relative to the root of the group
+    struct Part
+    {
+        const Mesh* mesh;
+        const Material* material;
+        Matrix4x4 localToRoot;
+    };
+
+    Impostor();
+
+    // Prevent the impostor from being copied
+    Impostor(const Impostor&) = delete;
+    Impostor& operator=(const Impostor&) = delete;
+
+    // Renders the parts into every frame of the atlas with the standard shader.
+    // It binds its own camera and per-draw uniform buffers, so it must not be called while the renderer is drawing.
+    void bake(const std::vector<Part> &parts);
+
+    // Albedo (rgb) and coverage (a) of every frame
+    const Texture& albedoTexture() const { return albedoTexture_; }
+
+    // Normals and gloss of every frame, packed like the second gbuffer target
+    const Texture& normalTexture() const { return normalTexture_; }
+
+    // The sphere around the parts, relative to the root, that every frame is centred on
+    const Point3& centre() const { return centre_; }
+    float radius() const { return radius_; }
+
+    // The direction, relative to the root, that a frame is seen from.
+    // The impostor shader uses the same mapping to find the frame closest to the view direction.
+    static Vector3 frameDirection(int frameX, int frameY);
+
+private:
+    Texture albedoTexture_;
+    Texture normalTexture_;
+    Point3 centre_;
+    float radius_;
+
+    // The transform from root space to the view of a frame, looking at the centre
+    Matrix4x4 frameView(int frameX, int frameY) const;
+};
\ No newline at end of file
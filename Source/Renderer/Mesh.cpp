@@ -11,6 +11,7 @@ Mesh::Mesh(ResourceID id)
     : Resource(id),
     loaded_(false),
     settings_(),
+    bounds_(),
     vertexArray_(0),
     attributeBuffers_(),
     elementsBuffer_(0)
@@ -47,6 +48,7 @@ void Mesh::load(std::ifstream& file)
         const int positionsSize = sizeof(Point3) * vertexCount();
         std::unique_ptr<Point3[]> positionsData(new Point3[vertexCount()]);
         file.read((char*)positionsData.get(), positionsSize);
+        bounds_ = Bounds::covering(positionsData.get(), vertexCount());
 
         // Create a buffer to hold the data.
         glCreateBuffers(1, &attributeBuffers_[PositionsBuffer]);      
@@ -2,6 +2,8 @@
 
 #include "ResourceManager.h"
 
+#include "Math/Bounds.h"
+
 #include <GL/gl3w.h>
 
 struct MeshSettings
@@ -40,12 +42,16 @@ public:
     bool hasTangents() const { return settings_.hasTangents; }
     bool hasTexcoords() const { return settings_.hasTexcoords; }
 
+    // The bounds of the vertex positions in local space
+    const Bounds& bounds() const { return bounds_; }
+
     // Attaches the vbo and elements buffer for use.
     void bind() const;
 
 private:
     bool loaded_;
     MeshSettings settings_;
+    Bounds bounds_;
     GLuint vertexArray_;
     GLuint attributeBuffers_[AttributeBufferCount];
     GLuint elementsBuffer_;
@@ -5,6 +5,7 @@
 #include <assert.h>
 
 #include "Math/Random.h"
+#include "Renderer/Impostor.h"
 #include "RenderManager.h"
 #include "ResourceManager.h"
 #include "SceneManager.h"
@@ -12,6 +13,15 @@
 #include "Scene/Transform.h"
 #include "Scene/Shield.h"
 
+// Extra terrain details are drawn about two and a half times further away
+static const float EXTRA_DETAIL_DISTANCE_SCALE = 2.45f;
+
+// The fraction of its draw distance each terrain detail tier fades out over
+static const float DETAIL_FADE_FRACTION = 0.25f;
+
+// With extra tessellation, each terrain level of detail, and each placed mesh before its impostor, is drawn twice as far away
+static const float HIGH_DETAIL_LOD_SCALE = 2.0f;
+
 Renderer::Renderer()
     : Renderer(Framebuffer::backbuffer())
 {
@@ -33,15 +43,45 @@ Renderer::Renderer(std::vector<Framebuffer*> targetFramebuffers)
     cameraUniformBuffer_(UniformBufferType::CameraBuffer),
     perDrawUniformBuffer_(UniformBufferType::PerDrawBuffer),
     terrainUniformBuffer_(UniformBufferType::TerrainBuffer),
-    terrainDetailsUniformBuffer_(UniformBufferType::TerrainDetailsBuffer),
+    instanceBuffer_(0),
+    instanceBufferSource_(nullptr),
+    instanceBufferVersion_(0),
+    detailInstanceBuffer_(0),
+    detailInstanceSource_(nullptr),
+    detailInstanceVersion_(0),
+    detailCommandBuffer_(0),
+    detailFadeBuffer_(0),
+    detailCullingStats_(),
+    viewerPosition_(Point3::origin()),
+    terrainGridVertexArray_(0),
+    terrainGridVertexBuffer_(0),
+    terrainGridElementsBuffer_(0),
+    terrainGridElementsCount_(0),
+    terrainPatchBuffer_(0),
+    terrainLodStats_(),
+    terrainLodScale_(1.0f),
+    impostorVertexArray_(0),
     skyTransmittanceLUT_(TextureFormat::RGB16F, 256, 256)
 {
+    // Create the storage buffers for instance transforms and detail positions, and the buffers for indirect detail draws.
+    // They are filled when there is something to draw.
+    glCreateBuffers(1, &instanceBuffer_);
+    glCreateBuffers(1, &detailInstanceBuffer_);
+    glCreateBuffers(1, &detailCommandBuffer_);
+    glCreateBuffers(1, &detailFadeBuffer_);
+
+    // Every terrain and water patch is an instance of the same grid, placed by the patch buffer
+    createTerrainGrid();
+    glCreateBuffers(1, &terrainPatchBuffer_);
+    glCreateVertexArrays(1, &impostorVertexArray_);
+
     fullScreenMesh_ = ResourceManager::instance()->load<Mesh>("Resources/Meshes/full_screen_mesh.mesh");
 
     // Load the shaders required for each render pass
     standardShader_ = ResourceManager::instance()->load<Shader>("Resources/Shaders/Standard.shader");
     terrainShader_ = ResourceManager::instance()->load<Shader>("Resources/Shaders/Terrain.shader");
     terrainDetailMeshShader_ = ResourceManager::instance()->load<Shader>("Resources/Shaders/TerrainDetail.shader");
+    impostorShader_ = ResourceManager::instance()->load<Shader>("Resources/Shaders/Impostor.shader");
     waterShader_ = ResourceManager::instance()->load<Shader>("Resources/Shaders/Water.shader");
     deferredAmbientOcclusionShader_ = ResourceManager::instance()->load<Shader>("Resources/Shaders/Deferred-AmbientOcclusion.shader");
     deferredLightingShader_ = ResourceManager::instance()->load<Shader>("Resources/Shaders/Deferred-Lighting.shader");
@@ -87,6 +127,15 @@ Renderer::Renderer(std::vector<Framebuffer*> targetFramebuffers)
 Renderer::~Renderer()
 {
     destroyGBuffer();
+    glDeleteBuffers(1, &instanceBuffer_);
+    glDeleteBuffers(1, &detailInstanceBuffer_);
+    glDeleteBuffers(1, &detailCommandBuffer_);
+    glDeleteBuffers(1, &detailFadeBuffer_);
+    glDeleteBuffers(1, &terrainPatchBuffer_);
+    glDeleteBuffers(1, &terrainGridVertexBuffer_);
+    glDeleteBuffers(1, &terrainGridElementsBuffer_);
+    glDeleteVertexArrays(1, &terrainGridVertexArray_);
+    glDeleteVertexArrays(1, &impostorVertexArray_);
 }
 
 void Renderer::renderFrame(const Camera* camera)
@@ -98,12 +147,33 @@ void Renderer::renderFrame(const Camera* camera)
     cameraUniformBuffer_.use();
     perDrawUniformBuffer_.use();
     terrainUniformBuffer_.use();
-    terrainDetailsUniformBuffer_.use();
 
     // Ensure the contents of the uniform buffers is up to date
     // The per-draw buffer is handled separately
     updateSceneUniformBuffer();
 
+    // Every pass culls details and picks terrain levels of detail by their distance from the viewer
+    viewerPosition_ = camera->gameObject()->transform()->renderPositionWorld();
+    terrainLodScale_ = RenderManager::instance()->isFeatureGloballyEnabled(SF_HighTessellation) ? HIGH_DETAIL_LOD_SCALE : 1.0f;
+
+    // Stream in the terrain tiles around the camera before any pass draws the terrain
+    const Terrain* terrain = SceneManager::instance()->findComponentInScene<Terrain>();
+    if (terrain != nullptr && terrain->tileStreamer() != nullptr)
+    {
+        const Point3 cameraPosition = camera->gameObject()->transform()->renderPositionWorld();
+        terrain->tileStreamer()->update(cameraPosition.x / terrain->size().x, cameraPosition.z / terrain->size().z);
+    }
+
+    // Upload the transforms of the objects placed on the terrain when they change
+    if (terrain != nullptr)
+    {
+        updateInstanceBuffer(terrain->placedInstances());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer_);
+
+        updateDetailInstanceBuffer(terrain);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, detailInstanceBuffer_);
+    }
+
     // Compute the aspect ratio using one of the framebuffers
     // All of the framebuffers are the same size anyway
     const float aspectRatio = targetFramebuffers_[0]->width() / (float)targetFramebuffers_[0]->height();
@@ -118,7 +188,7 @@ void Renderer::renderFrame(const Camera* camera)
         {
             shadowMap_.cascadeFramebuffer(cascade).use();
             updateCameraUniformBuffer(shadowMap_.cascadeCamera(cascade), EyeType::None);
-            executeGeometryPass(shadowMap_.cascadeCamera(cascade), SF_HighTessellation);
+            executeGeometryPass(shadowMap_.cascadeCamera(cascade), 0);
         }
     }
 
@@ -295,6 +365,51 @@ void Renderer::destroyGBuffer()
     }
 }
 
+void Renderer::createTerrainGrid()
+{
+    // A square of GRID_RESOLUTION quads, with positions from 0 to 1
+    const int verticesPerSide = TerrainLodTree::GRID_RESOLUTION + 1;
+    std::vector<Vector2> positions;
+    positions.reserve(verticesPerSide * verticesPerSide);
+    for (int z = 0; z < verticesPerSide; ++z)
+    {
+        for (int x = 0; x < verticesPerSide; ++x)
+        {
+            positions.push_back(Vector2((float)x, (float)z) / (float)TerrainLodTree::GRID_RESOLUTION);
+        }
+    }
+
+    // Two triangles per quad, wound counter clockwise when seen from above
+    std::vector<MeshElementIndex> elements;
+    elements.reserve(TerrainLodTree::GRID_RESOLUTION * TerrainLodTree::GRID_RESOLUTION * 6);
+    for (int z = 0; z < TerrainLodTree::GRID_RESOLUTION; ++z)
+    {
+        for (int x = 0; x < TerrainLodTree::GRID_RESOLUTION; ++x)
+        {
+            const MeshElementIndex i = (MeshElementIndex)(x + z * verticesPerSide);
+            elements.push_back(i);
+            elements.push_back(i + 1);
+            elements.push_back(i + verticesPerSide);
+            elements.push_back(i + 1);
+            elements.push_back(i + verticesPerSide + 1);
+            elements.push_back(i + verticesPerSide);
+        }
+    }
+    terrainGridElementsCount_ = (GLsizei)elements.size();
+
+    glCreateBuffers(1, &terrainGridVertexBuffer_);
+    glNamedBufferData(terrainGridVertexBuffer_, sizeof(Vector2) * positions.size(), positions.data(), GL_STATIC_DRAW);
+    glCreateBuffers(1, &terrainGridElementsBuffer_);
+    glNamedBufferData(terrainGridElementsBuffer_, sizeof(MeshElementIndex) * elements.size(), elements.data(), GL_STATIC_DRAW);
+
+    glCreateVertexArrays(1, &terrainGridVertexArray_);
+    glVertexArrayVertexBuffer(terrainGridVertexArray_, 0, terrainGridVertexBuffer_, 0, sizeof(Vector2));
+    glVertexArrayAttribFormat(terrainGridVertexArray_, 0, 2, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(terrainGridVertexArray_, 0, 0);
+    glEnableVertexArrayAttrib(terrainGridVertexArray_, 0);
+    glVertexArrayElementBuffer(terrainGridVertexArray_, terrainGridElementsBuffer_);
+}
+
 void Renderer::updateSceneUniformBuffer() const
 {
     const Scene* scene = SceneManager::instance()->currentScene();
@@ -332,15 +447,19 @@ void Renderer::updateCameraUniformBuffer(const Camera* camera, EyeType eye) cons
     // Gather the new contents of the camera buffer
     CameraUniformData data;
     data.screenResolution = Vector4(width, height, 1.0f / width, 1.0f / height);
-    data.cameraPosition = Vector4(camera->gameObject()->transform()->positionWorld());
+    data.cameraPosition = Vector4(camera->gameObject()->transform()->renderPositionWorld());
     data.worldToClip = camera->getWorldToCameraMatrix(aspect, eye);
     data.clipToWorld = data.worldToClip.invert();
 
+    // Instanced objects are culled against the same view
+    cameraFrustum_ = Frustum(data.worldToClip);
+
     // Update the uniform buffer.
     cameraUniformBuffer_.update(data);
 }
 
-void Renderer::updatePerDrawUniformBuffer(const Matrix4x4 &localToWorld, const Material* material) const
+void Renderer::updatePerDrawUniformBuffer(const Matrix4x4 &localToWorld, const Material* material, int instanceOffset,
+    const Vector4 &instanceFade, const Vector4 &impostorBounds) const
 {
     // Use the default material if none was specified
     if(material == nullptr)
@@ -355,6 +474,9 @@ void Renderer::updatePerDrawUniformBuffer(const Matrix4x4 &localToWorld, const M
     data.colorSmoothness.a = material->smoothness();
     data.albedoTexture = (material->albedoTexture() == nullptr) ? 0 : material->albedoTexture()->bindlessHandle();
     data.normalMapTexture = (material->normalMapTexture() == nullptr) ? 0 : material->normalMapTexture()->bindlessHandle();
+    data.instanceOffset[0] = instanceOffset;
+    data.instanceFade = instanceFade;
+    data.impostorBounds = impostorBounds;
 
     // Update the uniform buffer.
     perDrawUniformBuffer_.update(data);
@@ -365,6 +487,13 @@ void Renderer::updateTerrainUniformBuffer(const Terrain* terrain) const
     TerrainUniformData data;
     data.terrainSize = Vector4(terrain->size().x, terrain->size().y, terrain->size().z, (float)terrain->layerCount());
     data.waterColorDepth = Vector4(terrain->waterColor().r, terrain->waterColor().g, terrain->waterColor().b, terrain->waterDepth());
+    data.viewerPosition = Vector4(viewerPosition_);
+    data.terrainLod = Vector4(terrain->lodTree().finestRange() * terrainLodScale_, terrain->waterLodTree().finestRange() * terrainLodScale_,
+        TerrainLodTree::MORPH_FRACTION, (float)TerrainLodTree::GRID_RESOLUTION);
+
+    const TerrainTileStreamer* streamer = terrain->tileStreamer();
+    data.terrainStreaming = (streamer == nullptr) ? Vector4::zero() : Vector4((float)streamer->tilesPerSide(),
+        (float)TerrainTileCache::TILE_SIZE, (float)(streamer->tilesPerSide() * TerrainTileCache::TILE_SIZE), 0.0f);
 
     for (int i = 0; i < terrain->layerCount(); ++i)
     {
@@ -384,11 +513,33 @@ void Renderer::updateTerrainUniformBuffer(const Terrain* terrain) const
     terrainUniformBuffer_.update(data);
 }
 
-void Renderer::updateTerrainDetailsUniformBuffer(const DetailBatch& details) const
+void Renderer::updateDetailInstanceBuffer(const Terrain* terrain)
 {
-    TerrainDetailsData detailsData;
-    std::memcpy(detailsData.detailPositions, details.instancePositions, sizeof(Vector4) * details.count);
-    terrainDetailsUniformBuffer_.update(detailsData);
+    if (terrain == detailInstanceSource_ && terrain->detailVersion() == detailInstanceVersion_)
+    {
+        return;
+    }
+
+    const std::vector<Vector4>& positions = terrain->detailPositions();
+    glNamedBufferData(detailInstanceBuffer_, sizeof(Vector4) * positions.size(), positions.data(), GL_STATIC_DRAW);
+
+    detailInstanceSource_ = terrain;
+    detailInstanceVersion_ = terrain->detailVersion();
+}
+
+void Renderer::updateInstanceBuffer(const PlacedInstances &instances)
+{
+    if (&instances == instanceBufferSource_ && instances.version() == instanceBufferVersion_)
+    {
+        return;
+    }
+
+    // Matrix4x4 is column major, the same as mat4x4 in the shader
+    const std::vector<Matrix4x4>& transforms = instances.transforms();
+    glNamedBufferData(instanceBuffer_, sizeof(Matrix4x4) * transforms.size(), transforms.data(), GL_STATIC_DRAW);
+
+    instanceBufferSource_ = &instances;
+    instanceBufferVersion_ = instances.version();
 }
 
 void Renderer::executeGeometryPass(const Camera* camera, ShaderFeatureList shaderFeatures) const
@@ -418,26 +569,37 @@ void Renderer::executeGeometryPass(const Camera* camera, ShaderFeatureList shade
         staticMesh->mesh()->bind();
 
         // Update the per draw uniform buffer
-        const Matrix4x4 localToWorld = staticMesh->gameObject()->transform()->localToWorld();
+        const Matrix4x4 localToWorld = staticMesh->gameObject()->transform()->renderLocalToWorld();
         updatePerDrawUniformBuffer(localToWorld, staticMesh->material());
 
         // Draw the mesh
         glDrawElements(GL_TRIANGLES, staticMesh->mesh()->elementsCount(), GL_UNSIGNED_SHORT, (void*)0);
     }
 
-    // Draw terrain
+    // Draw the objects placed on the terrain
     const Terrain* terrain = SceneManager::instance()->findComponentInScene<Terrain>();
     if (terrain != nullptr)
+    {
+        drawPlacedInstances(terrain->placedInstances(), shaderFeatures);
+    }
+
+    // Draw terrain
+    if (terrain != nullptr)
     {
         terrainShader_->bindVariant(shaderFeatures);
 
-        //Set mesh and heightmap
-        terrain->mesh()->bind();
+        // Set heightmap
         terrain->heightmap()->bind(8);
+        if (terrain->tileStreamer() != nullptr)
+        {
+            terrain->tileStreamer()->tileTexture()->bind(9);
+            terrain->tileStreamer()->pageTable()->bind(11);
+        }
         updateTerrainUniformBuffer(terrain);
 
-        // Render the terrain with tessellation
-        glDrawElements(GL_PATCHES, terrain->mesh()->elementsCount(), GL_UNSIGNED_SHORT, (void*)0);
+        // Pick the patches in view of this pass, with levels of detail by their distance from the viewer
+        terrain->lodTree().select(cameraFrustum_, viewerPosition_, terrainLodScale_, terrainPatches_, terrainLodStats_);
+        drawTerrainPatches(terrainPatches_);
     }
 
     // Draw terrain details
@@ -457,24 +619,103 @@ void Renderer::executeGeometryPass(const Camera* camera, ShaderFeatureList shade
         // Use the terrain's detail shader
         terrainDetailMeshShader_->bindVariant(terrain->detailMaterial()->supportedFeatures() & shaderFeatures);
 
-        // Render each terrain details batch
-        const Point3 cameraPosition = camera->gameObject()->transform()->positionWorld();
-        const float distanceScale = RenderManager::instance()->isFeatureGloballyEnabled(SF_ExtraTerrainDetails) ? 6.0f : 1.0f;
-        for (const DetailBatch& batch : terrain->detailBatches())
+        // Find the batches in view and within their draw distance.
+        // Each pass culls with its own frustum, but distances are always from the viewer.
+        const float distanceScale = RenderManager::instance()->isFeatureGloballyEnabled(SF_ExtraTerrainDetails) ? EXTRA_DETAIL_DISTANCE_SCALE : 1.0f;
+        terrain->detailBatchTree().findVisible(cameraFrustum_, viewerPosition_, distanceScale, visibleDetailBatches_, detailCullingStats_);
+
+        detailCommands_.clear();
+        detailFades_.clear();
+        for (int index : visibleDetailBatches_)
         {
-            // Skip batches that are further than the draw distance
-            if ((batch.bounds.centre() - cameraPosition).sqrMagnitude() > batch.drawDistance * batch.drawDistance * distanceScale)
+            const DetailBatch& batch = terrain->detailBatches()[index];
+
+            // When streaming, details are only drawn over resident tiles
+            const Point3 batchCentre = batch.bounds.centre();
+            if (terrain->tileStreamer() != nullptr
+                && !terrain->tileStreamer()->isResident(batchCentre.x / terrain->size().x, batchCentre.z / terrain->size().z))
             {
+                detailCullingStats_.visibleBatches--;
+                detailCullingStats_.visibleInstances -= batch.count;
                 continue;
             }
 
-            // Draw the batch data using an instanced draw call
-            updateTerrainDetailsUniformBuffer(batch);
-            glDrawElementsInstanced(GL_TRIANGLES, elementsCount, GL_UNSIGNED_SHORT, (void*)0, batch.count);
+            // The shader finds the batch's positions from its base instance
+            detailCommands_.push_back({ (GLuint)elementsCount, (GLuint)batch.count, 0, 0, batch.firstInstance });
+
+            // Each tier fades out over the end of its draw distance, so the density changes smoothly
+            const float fadeEnd = batch.drawDistance * distanceScale;
+            const float fadeLength = fadeEnd * DETAIL_FADE_FRACTION;
+            detailFades_.push_back(Vector4(fadeEnd - fadeLength, 1.0f / fadeLength, 0.0f, 0.0f));
+        }
+
+        // Draw every visible batch with a single call
+        if (!detailCommands_.empty())
+        {
+            glNamedBufferData(detailCommandBuffer_, sizeof(DrawElementsIndirectCommand) * detailCommands_.size(), detailCommands_.data(), GL_STREAM_DRAW);
+            glNamedBufferData(detailFadeBuffer_, sizeof(Vector4) * detailFades_.size(), detailFades_.data(), GL_STREAM_DRAW);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, detailFadeBuffer_);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, detailCommandBuffer_);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void*)0, (GLsizei)detailCommands_.size(), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
         }
     }
 }
 
+void Renderer::drawPlacedInstances(const PlacedInstances &instances, ShaderFeatureList shaderFeatures) const
+{
+    // Each run of visible instances of a mesh or impostor is drawn with a single call.
+    // Meshes give way to impostors by their distance from the viewer, so every pass draws the same ones.
+    instances.findVisible(cameraFrustum_, viewerPosition_, terrainLodScale_, visibleInstances_);
+    for (const PlacedInstances::DrawRange& range : visibleInstances_)
+    {
+        const PlacedInstances::Group& group = instances.groups()[range.group];
+
+        // Instances with impostors cross-fade to them over the fade
+        float fadeStart, fadeLength;
+        PlacedInstances::impostorFade(group, terrainLodScale_, fadeStart, fadeLength);
+        const Vector4 fade = (fadeLength > 0.0f) ? Vector4(fadeStart, 1.0f / fadeLength, 0.0f, 0.0f) : Vector4::zero();
+
+        if (group.mesh == nullptr)
+        {
+            // Draw a billboard for each instance, showing the frame of the impostor closest to the view direction
+            const Impostor* impostor = group.impostor;
+            impostorShader_->bindVariant(shaderFeatures);
+            impostor->albedoTexture().bind(3);
+            impostor->normalTexture().bind(4);
+            glBindVertexArray(impostorVertexArray_);
+
+            const Vector4 bounds(impostor->centre().x, impostor->centre().y, impostor->centre().z, impostor->radius());
+            updatePerDrawUniformBuffer(Matrix4x4::identity(), nullptr, (int)range.firstInstance, fade, bounds);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, range.count);
+            continue;
+        }
+
+        // Use the instanced variant of the standard shader
+        standardShader_->bindVariant((group.material->supportedFeatures() & shaderFeatures) | SF_Instancing);
+        group.mesh->bind();
+
+        // The shader reads the transforms from the instance buffer, starting at the first instance in the range
+        updatePerDrawUniformBuffer(Matrix4x4::identity(), group.material, (int)range.firstInstance, fade);
+        glDrawElementsInstanced(GL_TRIANGLES, group.mesh->elementsCount(), GL_UNSIGNED_SHORT, (void*)0, range.count);
+    }
+}
+
+void Renderer::drawTerrainPatches(const std::vector<TerrainPatch> &patches) const
+{
+    if (patches.empty())
+    {
+        return;
+    }
+
+    // The shader places each instance of the grid from its patch
+    glNamedBufferData(terrainPatchBuffer_, sizeof(TerrainPatch) * patches.size(), patches.data(), GL_STREAM_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, terrainPatchBuffer_);
+
+    glBindVertexArray(terrainGridVertexArray_);
+    glDrawElementsInstanced(GL_TRIANGLES, terrainGridElementsCount_, GL_UNSIGNED_SHORT, (void*)0, (GLsizei)patches.size());
+}
+
 void Renderer::executeFullScreen(Shader* shader, ShaderFeatureList shaderFeatures) const
 {
     // "Full Screen" passes should write to all pixels that are not sky.
@@ -544,11 +785,12 @@ void Renderer::executeWaterPass() const
     glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
     glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
 
-    // Render the terrain mesh, using the water shader, with tessellation
+    // Render the water's patches in view, using the water shader
     waterShader_->bindVariant(ALL_SHADER_FEATURES);
-    terrain->mesh()->bind();
     terrain->heightmap()->bind(8);
-    glDrawElements(GL_PATCHES, terrain->mesh()->elementsCount(), GL_UNSIGNED_SHORT, (void*)0);
+    TerrainLodStats waterStats;
+    terrain->waterLodTree().select(cameraFrustum_, viewerPosition_, terrainLodScale_, terrainPatches_, waterStats);
+    drawTerrainPatches(terrainPatches_);
 
     // Reset blending state
     glDisable(GL_BLEND);
@@ -577,7 +819,7 @@ void Renderer::executeSkyboxPass(const Camera* camera) const
 
     // Compute position of skydome -
     // ensure the skybox is centered on the camera
-    const Matrix4x4 translationMatrix = Matrix4x4::translation(camera->gameObject()->transform()->positionWorld());
+    const Matrix4x4 translationMatrix = Matrix4x4::translation(camera->gameObject()->transform()->renderPositionWorld());
 
     // Set the local to world matrix in per draw data
     PerDrawUniformData data;
@@ -611,7 +853,7 @@ void Renderer::executeShieldPass() const
     for (const Shield* shield : SceneManager::instance()->findAllComponentsInScene<Shield>())
     {
         // Create the shield matrix using the transform + radius.
-        const Matrix4x4 transformMat = shield->gameObject()->transform()->localToWorld();
+        const Matrix4x4 transformMat = shield->gameObject()->transform()->renderLocalToWorld();
         const Matrix4x4 radiusMat = Matrix4x4::scale(Vector3(shield->radius(), shield->radius(), shield->radius()));
         const Matrix4x4 localToWorld = transformMat * radiusMat;
 
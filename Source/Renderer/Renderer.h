@@ -6,7 +6,10 @@
 #include "Renderer/Shader.h"
 #include "Renderer/UniformBuffer.h"
 
+#include "Math/Frustum.h"
 #include "Scene/Camera.h"
+#include "Scene/PlacedInstances.h"
+#include "Scene/TerrainLodTree.h"
 #include "Renderer/Mesh.h"
 #include "Renderer/ShadowMap.h"
 
@@ -15,6 +18,16 @@ class Renderer
 private:
     const static int GBUFFER_RENDER_TARGETS = 2;
 
+    // The layout glMultiDrawElementsIndirect reads each draw from
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
 public:
     // Creates a renderer that draws directly to the back buffer
     Renderer();
@@ -33,6 +46,12 @@ public:
     // of the currently rendered objects.
     void renderPhysicsObjects(const Camera* camera);
 
+    // The terrain detail batches drawn and culled by the last pass that drew details
+    const DetailCullingStats& detailCullingStats() const { return detailCullingStats_; }
+
+    // The terrain patches drawn and the nodes culled by the last geometry pass
+    const TerrainLodStats& terrainLodStats() const { return terrainLodStats_; }
+
 private:
     // The framebuffer being rendered to
     const std::vector<Framebuffer*> targetFramebuffers_;
@@ -55,12 +74,55 @@ private:
     UniformBuffer<CameraUniformData> cameraUniformBuffer_;
     UniformBuffer<PerDrawUniformData> perDrawUniformBuffer_;
     UniformBuffer<TerrainUniformData> terrainUniformBuffer_;
-    UniformBuffer<TerrainDetailsData> terrainDetailsUniformBuffer_;
+
+    // The transforms of the instances placed on the terrain, and the instances they were uploaded from
+    GLuint instanceBuffer_;
+    const PlacedInstances* instanceBufferSource_;
+    uint64_t instanceBufferVersion_;
+
+    // The positions of the terrain's detail meshes, and the terrain and version they were uploaded from
+    GLuint detailInstanceBuffer_;
+    const Terrain* detailInstanceSource_;
+    uint64_t detailInstanceVersion_;
+
+    // The indirect draws for the visible detail batches and the distances they fade over, rebuilt for each geometry pass
+    GLuint detailCommandBuffer_;
+    GLuint detailFadeBuffer_;
+    mutable std::vector<DrawElementsIndirectCommand> detailCommands_;
+    mutable std::vector<Vector4> detailFades_;
+    mutable std::vector<int> visibleDetailBatches_;
+    mutable DetailCullingStats detailCullingStats_;
+
+    // Where the viewer is. Details are culled and faded, and terrain levels of detail are picked,
+    // by their distance from here in every pass, including shadows.
+    Point3 viewerPosition_;
+
+    // The grid of quads every terrain and water patch is drawn with
+    GLuint terrainGridVertexArray_;
+    GLuint terrainGridVertexBuffer_;
+    GLuint terrainGridElementsBuffer_;
+    GLsizei terrainGridElementsCount_;
+
+    // The terrain or water patches being drawn, rebuilt for each pass
+    GLuint terrainPatchBuffer_;
+    mutable std::vector<TerrainPatch> terrainPatches_;
+    mutable TerrainLodStats terrainLodStats_;
+
+    // The multiple of their normal range that terrain and water levels of detail are drawn to
+    float terrainLodScale_;
+
+    // The frustum of the camera being drawn, and the instances visible to it
+    mutable Frustum cameraFrustum_;
+    mutable std::vector<PlacedInstances::DrawRange> visibleInstances_;
 
     // Shaders used for gbuffer pass
     Shader* standardShader_;
     Shader* terrainShader_;
     Shader* terrainDetailMeshShader_;
+    Shader* impostorShader_;
+
+    // Impostor billboards are made in the vertex shader, so they are drawn without any vertex buffers
+    GLuint impostorVertexArray_;
 
     // Shaders used for deferred passes
     Shader* deferredAmbientOcclusionShader_;
@@ -98,16 +160,32 @@ private:
     void createGBuffer();
     void destroyGBuffer();
 
+    // Creates the grid used to draw terrain patches
+    void createTerrainGrid();
+
     // Methods for updating the contents of uniform buffers
     void updateSceneUniformBuffer() const;
     void updateCameraUniformBuffer(const Camera* camera, EyeType eye) const;
-    void updatePerDrawUniformBuffer(const Matrix4x4 &localToWorld, const Material* material) const;
+    void updatePerDrawUniformBuffer(const Matrix4x4 &localToWorld, const Material* material, int instanceOffset = 0,
+        const Vector4 &instanceFade = Vector4::zero(), const Vector4 &impostorBounds = Vector4::zero()) const;
     void updateTerrainUniformBuffer(const Terrain* terrain) const;
-    void updateTerrainDetailsUniformBuffer(const DetailBatch& details) const;
+
+    // Uploads the transforms of placed instances if they have changed since they were last uploaded
+    void updateInstanceBuffer(const PlacedInstances &instances);
+
+    // Uploads the positions of the terrain's detail meshes if they have changed since they were last uploaded
+    void updateDetailInstanceBuffer(const Terrain* terrain);
 
     // Renders a full geometry pass using the specified camera
     void executeGeometryPass(const Camera* camera, ShaderFeatureList shaderFeatures) const;
 
+    // Draws the placed instances in view of the current camera with instanced draw calls.
+    // Far from the viewer, instances with impostors are drawn as impostors instead.
+    void drawPlacedInstances(const PlacedInstances &instances, ShaderFeatureList shaderFeatures) const;
+
+    // Draws an instance of the terrain grid for each patch, with the shader already bound
+    void drawTerrainPatches(const std::vector<TerrainPatch> &patches) const;
+
     // Renders a full screen pass using the specifed shader
     void executeFullScreen(Shader* shader, ShaderFeatureList shaderFeatures) const;
 
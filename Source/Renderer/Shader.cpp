@@ -197,6 +197,7 @@ std::string ShaderVariant::createFeatureDefines() const
     if (hasFeature(SF_DebugShadows)) defines += "#define DEBUG_SHADOWS \n";
     if (hasFeature(SF_DebugShadowCascades)) defines += "#define DEBUG_SHADOW_CASCADES \n";
     if (hasFeature(SF_AmbientOcclusion)) defines += "#define AMBIENT_OCCLUSION_ON \n";
+    if (hasFeature(SF_Instancing)) defines += "#define INSTANCING_ON \n";
 
     return defines;
 }
@@ -18,7 +18,7 @@ enum ShaderFeature
 
     SF_Fog = 16,
 
-    // Causes a large amount of tessellation to be used on the terrain
+    // Draws each terrain and water level of detail, and placed meshes before their impostors, twice as far away
     SF_HighTessellation = 32,
 
     // Enables shadow sampling for the sun
@@ -45,6 +45,10 @@ enum ShaderFeature
     // Enables sky rendering
     SF_Sky = 1048576,
 
+    // Reads the transform of each instance from the instance buffer.
+    // Set by the renderer for instanced draws, rather than by materials.
+    SF_Instancing = 4194304,
+
     // GBuffer debugging modes
     SF_DebugGBufferDepth = 32768,
     SF_DebugGBufferAlbedo = 256,
@@ -70,7 +70,7 @@ void ShadowMap::updatePosition(const Camera* viewCamera, float viewCameraAspect,
     lightToWorld.set(2, 3, 0.0);
 
     // Compute the view to light matrix
-    Matrix4x4 viewToLight = worldToLight * viewCamera->gameObject()->transform()->localToWorld();
+    Matrix4x4 viewToLight = worldToLight * viewCamera->gameObject()->transform()->renderLocalToWorld();
     if (vr)
     {
         // Ideally we should use matrix without the eye offset, but its close enough
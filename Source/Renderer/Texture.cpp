@@ -73,7 +73,8 @@ ArrayTexture::ArrayTexture(TextureFormat format, int width, int height, int laye
     : format_(format),
     filterMode_(TextureFilterMode::Bilinear),
     width_(width),
-    height_(height)
+    height_(height),
+    layers_(layers)
 {
     // Get details for the texture format.
     TextureFormatData* formatData = getFormatData(format);
@@ -95,6 +96,14 @@ ArrayTexture::ArrayTexture(TextureFormat format, int width, int height, int laye
         const float borderValues[] = { 1.0f, 1.0f, 1.0f, 1.0f };
         glTextureParameterfv(glid_, GL_TEXTURE_BORDER_COLOR, borderValues);
     }
+    else
+    {
+        // Other array textures hold separate images in each layer, so they shouldn't wrap
+        glTextureParameteri(glid_, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(glid_, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(glid_, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(glid_, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
 }
 
 ArrayTexture::~ArrayTexture()
@@ -140,6 +149,16 @@ void ArrayTexture::bind(int slot) const
     glBindTexture(GL_TEXTURE_2D_ARRAY, glid_);
 }
 
+void ArrayTexture::setLayerData(const void* data, int layer)
+{
+    assert(layer >= 0 && layer < layers_);
+
+    // This currently only works for R16 textures (for the terrain)
+    assert(format_ == TextureFormat::R16);
+
+    glTextureSubImage3D(glid_, 0, 0, 0, layer, width_, height_, 1, GL_RED, GL_UNSIGNED_SHORT, data);
+}
+
 Texture::Texture(TextureFormat format, int width, int height)
     : Resource(NOT_SAVED_RESOURCE)
 {
@@ -391,6 +410,21 @@ void Texture::setData(const void* data, int dataSizeBytes, int mipLevel)
         GL_RED, GL_UNSIGNED_SHORT, data);
 }
 
+void Texture::setSubData(const void* data, int x, int y, int width, int height, int rowLength, int mipLevel)
+{
+    assert(!isCompressed());
+    assert(x >= 0 && y >= 0 && x + width <= getMipWidth(width_, mipLevel) && y + height <= getMipHeight(height_, mipLevel));
+
+    // This currently only works for R16 and RFloat textures (for the terrain)
+    assert(format_ == TextureFormat::R16 || format_ == TextureFormat::RFloat);
+    const GLenum type = (format_ == TextureFormat::R16) ? GL_UNSIGNED_SHORT : GL_FLOAT;
+
+    // Let gl read the rectangle directly out of the larger image
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+    glTextureSubImage2D(glid_, mipLevel, x, y, width, height, GL_RED, type, data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
 const std::string& Texture::getFormatName(TextureFormat format)
 {
     return getFormatData(format)->name;
@@ -74,6 +74,10 @@ public:
     // Attaches the texture to the specified slot for use.
     void bind(int slot) const;
 
+    // Replaces the data in one layer.
+    // The data must be the correct format and size to fill the layer.
+    void setLayerData(const void* data, int layer);
+
     // Basic settings
     TextureFormat format() const { return format_; }
     TextureFilterMode filterMode() const { return filterMode_; }
@@ -140,6 +144,10 @@ public:
     // Updates the data in the heightmap.
     // The data must be the correct format and size to replace the entire mip level.
     void setData(const void* data, int dataSizeBytes, int mipLevel);
+
+    // Updates a rectangle of the data in the heightmap.
+    // data points to the first texel of the rectangle, and rows are rowLength texels apart.
+    void setSubData(const void* data, int x, int y, int width, int height, int rowLength, int mipLevel);
     
     // Converts a texture format to a human-readable name.
     static const std::string& getFormatName(TextureFormat format);
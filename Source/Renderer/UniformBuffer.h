@@ -20,7 +20,6 @@ enum class UniformBufferType
     PerDrawBuffer = 3,
     PerMaterialBuffer = 4,
     TerrainBuffer = 5,
-    TerrainDetailsBuffer = 6,
 };
 
 // Plain old uniform data for scene
@@ -69,6 +68,16 @@ struct TerrainUniformData
     // rgb = Water color, a = water depth
     Vector4 waterColorDepth;
 
+    // x = streamed tiles per side (0 when not streaming), y = tile size in texels, z = streamed resolution
+    Vector4 terrainStreaming;
+
+    // xyz = the viewer's position, which terrain details fade and terrain patches morph by distance from
+    Vector4 viewerPosition;
+
+    // x = distance the finest terrain patches are drawn to, y = distance the finest water patches are drawn to,
+    // z = fraction of each level's range its vertices morph over, w = quads along each side of a patch
+    Vector4 terrainLod;
+
     // Per-layer data
     Vector4 terrainLayerBlendData[Terrain::MAX_LAYERS];
     Vector4 terrainLayerScale[Terrain::MAX_LAYERS]; // xy for scale, zw unused
@@ -84,11 +93,13 @@ struct PerDrawUniformData
     Color colorSmoothness;
     BindlessTextureHandle albedoTexture;
     BindlessTextureHandle normalMapTexture;
-};
+    int instanceOffset[4];
 
-struct TerrainDetailsData
-{
-    Vector4 detailPositions[DetailBatch::MaxInstancesPerBatch];
+    // x = distance from the viewer instanced meshes start fading out at, y = 1 / length of the fade, 0 when they never fade
+    Vector4 instanceFade;
+
+    // xyz = centre of an impostor relative to its root, w = radius
+    Vector4 impostorBounds;
 };
 
 struct PerMaterialUniformData
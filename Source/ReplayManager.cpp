@@ -0,0 +1,445 @@
+#include "ReplayManager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "Application.h"
+#include "EditorManager.h"
+#include "SceneManager.h"
+
+#include "Editor/MainWindowMenu.h"
+#include "Math/Random.h"
+#include "Scene/Freecam.h"
+#include "Scene/HelicopterView.h"
+#include "Scene/Transform.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "Utils/Clock.h"
+
+namespace
+{
+    // Identifies replay log files ("GRPL") and the version of the format
+    const uint32_t REPLAY_MAGIC = 0x4C505247;
+    const uint32_t REPLAY_VERSION = 3;
+
+    // Input values are nearly always -1, 0 or 1, so they are stored using a 2 bit code
+    // followed by the full 32 bit float only when the value is something else.
+    enum InputValueCode
+    {
+        InputValueZero = 0,
+        InputValueOne = 1,
+        InputValueMinusOne = 2,
+        InputValueRaw = 3,
+    };
+
+    uint32_t floatBits(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float bitsFloat(uint32_t bits)
+    {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void writeInputValue(BitWriter &writer, float value)
+    {
+        if (value == 0.0f) writer.writeBits(InputValueZero, 2);
+        else if (value == 1.0f) writer.writeBits(InputValueOne, 2);
+        else if (value == -1.0f) writer.writeBits(InputValueMinusOne, 2);
+        else
+        {
+            writer.writeBits(InputValueRaw, 2);
+            writer.writeInt(floatBits(value));
+        }
+    }
+
+    float readInputValue(BitReader &reader)
+    {
+        switch (reader.readBits(2))
+        {
+            case InputValueOne: return 1.0f;
+            case InputValueMinusOne: return -1.0f;
+            case InputValueRaw: return bitsFloat(reader.readInt());
+            default: return 0.0f;
+        }
+    }
+
+    // FNV-1a hash, used for hashing the scene state
+    void hashBytes(uint32_t &hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+    }
+}
+
+ReplayManager::ReplayManager()
+    : state_(ReplayState::Idle),
+    seed_(0),
+    tickRate_(0.0f),
+    maxTicksPerFrame_(0),
+    replayFrameIndex_(0),
+    quitWhenFinished_(false),
+    expectedStateHash_(0)
+{
+    MainWindowMenu::instance()->addMenuItem("Game/Record Session", [&]
+    {
+        if (isRecording())
+        {
+            const std::string path = EditorManager::instance()->showSaveDialog("Save Recording", "session", "replay");
+            stopRecording(path);
+        }
+        else if (!isReplaying())
+        {
+            startRecording();
+        }
+    }, [&] { return isRecording(); });
+
+    MainWindowMenu::instance()->addMenuItem("Game/Replay Last Recording", [&]
+    {
+        if (state_ == ReplayState::Idle && !replayPath_.empty())
+        {
+            startReplay(replayPath_, false);
+        }
+    }, [&] { return isReplaying(); });
+}
+
+void ReplayManager::startRecording()
+{
+    // Snapshot the scene as it is in the editor, including unsaved changes, so the replay
+    // can start from exactly the same state without writing anything to disk.
+    if (Application::instance()->isPlaying())
+    {
+        Application::instance()->enterEditMode();
+    }
+    PropertyTable snapshot(PropertyTableMode::Writing);
+    SceneManager::instance()->snapshotScene(snapshot);
+    sceneSnapshot_ = snapshot.toString();
+
+    scenePath_ = SceneManager::instance()->scenePath();
+    seed_ = (uint32_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    tickRate_ = Clock::instance()->tickRate();
+    maxTicksPerFrame_ = Clock::instance()->maxTicksPerFrame();
+    frames_.clear();
+    currentFrame_.hasInput = false;
+
+    resetSimulation();
+    state_ = ReplayState::Recording;
+}
+
+void ReplayManager::stopRecording(const std::string &logPath)
+{
+    if (!isRecording())
+    {
+        return;
+    }
+
+    state_ = ReplayState::Idle;
+    if (!logPath.empty())
+    {
+        writeLog(logPath, computeStateHash());
+        replayPath_ = logPath;
+        printf("Recorded %d frames to %s\n", (int)frames_.size(), logPath.c_str());
+    }
+
+    // Leaving play mode reopens the scene file, so restore the snapshot to keep any unsaved changes
+    Application::instance()->enterEditMode();
+    PropertyTable snapshot(PropertyTableMode::Reading);
+    snapshot.addPropertyData(sceneSnapshot_);
+    SceneManager::instance()->restoreScene(snapshot);
+}
+
+bool ReplayManager::startReplay(const std::string &logPath, bool quitWhenFinished)
+{
+    if (!readLog(logPath))
+    {
+        printf("Unable to read replay %s\n", logPath.c_str());
+        return false;
+    }
+
+    if (Application::instance()->isPlaying())
+    {
+        Application::instance()->enterEditMode();
+    }
+
+    replayPath_ = logPath;
+    quitWhenFinished_ = quitWhenFinished;
+    replayFrameIndex_ = 0;
+    timings_.clear();
+    timings_.reserve(frames_.size());
+
+    // The same frame times only give the same ticks with the same tick settings
+    Clock::instance()->setTickRate(tickRate_);
+    Clock::instance()->setMaxTicksPerFrame(maxTicksPerFrame_);
+
+    resetSimulation();
+    state_ = ReplayState::Replaying;
+
+    // Live input must not affect the replayed session
+    InputManager::instance()->disableInput();
+    return true;
+}
+
+void ReplayManager::frameStart()
+{
+    frameStartTime_ = std::chrono::high_resolution_clock::now();
+
+    if (isRecording())
+    {
+        currentFrame_.realDeltaTime = Clock::instance()->realDeltaTime();
+        currentFrame_.hasInput = false;
+    }
+    else if (isReplaying())
+    {
+        if (replayFrameIndex_ >= (int)frames_.size())
+        {
+            finishReplay();
+            return;
+        }
+
+        currentFrame_ = frames_[replayFrameIndex_];
+        Clock::instance()->overrideRealDeltaTime(currentFrame_.realDeltaTime);
+    }
+}
+
+void ReplayManager::frameUpdated()
+{
+    if (isReplaying())
+    {
+        const auto now = std::chrono::high_resolution_clock::now();
+
+        ReplayFrameTiming timing;
+        timing.deltaTime = currentFrame_.realDeltaTime;
+        timing.updateMilliseconds = std::chrono::duration<float, std::milli>(now - frameStartTime_).count();
+        timing.frameMilliseconds = timing.updateMilliseconds;
+        timings_.push_back(timing);
+    }
+}
+
+void ReplayManager::frameEnd()
+{
+    if (isRecording())
+    {
+        frames_.push_back(currentFrame_);
+    }
+    else if (isReplaying())
+    {
+        const auto now = std::chrono::high_resolution_clock::now();
+        if (!timings_.empty())
+        {
+            timings_.back().frameMilliseconds = std::chrono::duration<float, std::milli>(now - frameStartTime_).count();
+        }
+
+        replayFrameIndex_++;
+    }
+}
+
+void ReplayManager::recordInput(const InputCmd &inputs)
+{
+    if (isRecording() && !currentFrame_.hasInput)
+    {
+        currentFrame_.hasInput = true;
+        currentFrame_.input = inputs;
+    }
+}
+
+void ReplayManager::dispatchRecordedInput(bool firstTick) const
+{
+    if (isReplaying() && currentFrame_.hasInput)
+    {
+        InputCmd inputs = currentFrame_.input;
+        inputs.deltaTime = Clock::instance()->fixedDeltaTime();
+
+        // Mouse movement is only dispatched in the first tick of the frame, as it was when recording
+        if (!firstTick)
+        {
+            inputs.horizontalRotation = 0.0f;
+            inputs.verticalRotation = 0.0f;
+        }
+
+        SceneManager::instance()->handleInput(inputs);
+    }
+}
+
+uint32_t ReplayManager::computeStateHash() const
+{
+    uint32_t hash = 2166136261u;
+
+    // Hash the local transform of every object, children included.
+    // Cameras steered by the mouse are skipped, as mouse look isn't recorded.
+    for (GameObject* gameObject : SceneManager::instance()->gameObjects())
+    {
+        if (gameObject->findComponent<HelicopterView>() != nullptr || gameObject->findComponent<Freecam>() != nullptr)
+        {
+            continue;
+        }
+
+        const Transform* transform = gameObject->transform();
+        const Point3 position = transform->positionLocal();
+        const Quaternion rotation = transform->rotationLocal();
+        hashBytes(hash, gameObject->name().data(), gameObject->name().size());
+        hashBytes(hash, &position, sizeof(position));
+        hashBytes(hash, &rotation, sizeof(rotation));
+    }
+
+    return hash;
+}
+
+void ReplayManager::resetSimulation() const
+{
+    // The snapshot replaces the scene in memory only, and leaving play mode reopens the scene file
+    if (SceneManager::instance()->scenePath() != scenePath_)
+    {
+        SceneManager::instance()->openScene(scenePath_);
+    }
+    PropertyTable snapshot(PropertyTableMode::Reading);
+    snapshot.addPropertyData(sceneSnapshot_);
+    SceneManager::instance()->restoreScene(snapshot);
+
+    random_seed(seed_);
+    Application::instance()->enterPlayMode();
+}
+
+void ReplayManager::writeLog(const std::string &path, uint32_t stateHash) const
+{
+    BitWriter writer;
+
+    // Header
+    writer.writeInt(REPLAY_MAGIC);
+    writer.writeShort((uint16_t)REPLAY_VERSION);
+    writer.writeInt(seed_);
+    writer.writeInt(floatBits(tickRate_));
+    writer.writeShort((uint16_t)maxTicksPerFrame_);
+    writer.writeShort((uint16_t)scenePath_.size());
+    for (char c : scenePath_)
+    {
+        writer.writeByte((uint8_t)c);
+    }
+    writer.writeInt((uint32_t)sceneSnapshot_.size());
+    for (char c : sceneSnapshot_)
+    {
+        writer.writeByte((uint8_t)c);
+    }
+    writer.writeInt((uint32_t)frames_.size());
+
+    // Frames
+    for (const ReplayFrame &frame : frames_)
+    {
+        writer.writeInt(floatBits(frame.realDeltaTime));
+        writer.writeBits(frame.hasInput ? 1 : 0, 1);
+        if (frame.hasInput)
+        {
+            writeInputValue(writer, frame.input.forwardsMovement);
+            writeInputValue(writer, frame.input.sidewaysMovement);
+            writeInputValue(writer, frame.input.verticalMovement);
+            writeInputValue(writer, frame.input.horizontalRotation);
+            writeInputValue(writer, frame.input.verticalRotation);
+        }
+    }
+
+    // The final state, used to check replays for determinism breaks
+    writer.writeInt(stateHash);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char*)writer.getBuffer(), writer.sizeBytes());
+}
+
+bool ReplayManager::readLog(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+
+    // Read the whole file into a word buffer for the bit reader.
+    // Pad by a word, as the reader may fetch one word ahead.
+    const size_t sizeBytes = (size_t)file.tellg();
+    std::vector<uint32_t> buffer(sizeBytes / 4 + 2, 0);
+    file.seekg(0);
+    file.read((char*)buffer.data(), sizeBytes);
+
+    BitReader reader(buffer.data());
+    if (reader.readInt() != REPLAY_MAGIC || reader.readShort() != REPLAY_VERSION)
+    {
+        return false;
+    }
+
+    seed_ = reader.readInt();
+    tickRate_ = bitsFloat(reader.readInt());
+    maxTicksPerFrame_ = reader.readShort();
+    scenePath_.resize(reader.readShort());
+    for (char &c : scenePath_)
+    {
+        c = (char)reader.readByte();
+    }
+    sceneSnapshot_.resize(reader.readInt());
+    for (char &c : sceneSnapshot_)
+    {
+        c = (char)reader.readByte();
+    }
+
+    frames_.resize(reader.readInt());
+    for (ReplayFrame &frame : frames_)
+    {
+        frame.realDeltaTime = bitsFloat(reader.readInt());
+        frame.hasInput = reader.readBits(1) != 0;
+        frame.input = InputCmd();
+        if (frame.hasInput)
+        {
+            frame.input.forwardsMovement = readInputValue(reader);
+            frame.input.sidewaysMovement = readInputValue(reader);
+            frame.input.verticalMovement = readInputValue(reader);
+            frame.input.horizontalRotation = readInputValue(reader);
+            frame.input.verticalRotation = readInputValue(reader);
+        }
+    }
+
+    expectedStateHash_ = reader.readInt();
+    return true;
+}
+
+void ReplayManager::finishReplay()
+{
+    state_ = ReplayState::Idle;
+    InputManager::instance()->enableInput();
+
+    // Check the final state matches the recording
+    const uint32_t stateHash = computeStateHash();
+    const bool deterministic = (stateHash == expectedStateHash_);
+
+    // Write the per-frame timings as a csv, so they can be diffed between builds
+    float totalUpdate = 0.0f;
+    float totalFrame = 0.0f;
+    std::ofstream csv(replayPath_ + ".timings.csv");
+    csv << "frame,delta_time,update_ms,frame_ms\n";
+    for (unsigned int i = 0; i < timings_.size(); ++i)
+    {
+        const ReplayFrameTiming &timing = timings_[i];
+        csv << i << "," << timing.deltaTime << "," << timing.updateMilliseconds << "," << timing.frameMilliseconds << "\n";
+        totalUpdate += timing.updateMilliseconds;
+        totalFrame += timing.frameMilliseconds;
+    }
+    csv << "state_hash," << stateHash << ",expected," << expectedStateHash_ << "\n";
+
+    const float frameCount = (float)std::max((size_t)1, timings_.size());
+    printf("Replay finished: %d frames, %.3f ms update, %.3f ms frame (mean), state hash %08x %s\n",
+        (int)timings_.size(), totalUpdate / frameCount, totalFrame / frameCount, stateHash,
+        deterministic ? "(matches recording)" : "(DIVERGED from recording)");
+
+    Application::instance()->enterEditMode();
+    if (quitWhenFinished_)
+    {
+        Application::instance()->quit();
+    }
+}
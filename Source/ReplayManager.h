@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "InputManager.h"
+#include "Utils/Singleton.h"
+
+enum class ReplayState
+{
+    Idle,
+    Recording,
+    Replaying,
+};
+
+// A single recorded frame
+struct ReplayFrame
+{
+    float realDeltaTime;
+    bool hasInput;
+    InputCmd input;
+};
+
+// Timings gathered for a single replayed frame
+struct ReplayFrameTiming
+{
+    float deltaTime;
+    float updateMilliseconds;
+    float frameMilliseconds;
+};
+
+// Records play sessions to a compact binary log, and replays them deterministically.
+//
+// A recording stores a snapshot of the scene as it was in the editor, the random seed, the clock's
+// tick settings, and for every frame the real delta time and the first input command dispatched to
+// the scene (if any). The snapshot is kept in the log, so recording never saves the scene or its assets.
+// Replaying the frame times with the same tick settings runs the same ticks as the recording.
+// When replaying, the clock and the input commands are driven by the log, and live
+// input polling is disabled. Per-frame cpu timings are written to a csv file next to the
+// log, and the final state hash is compared against the one stored in the recording.
+class ReplayManager : public Singleton<ReplayManager>
+{
+public:
+    ReplayManager();
+
+    ReplayState state() const { return state_; }
+    bool isRecording() const { return state_ == ReplayState::Recording; }
+    bool isReplaying() const { return state_ == ReplayState::Replaying; }
+
+    // Snapshots the current scene, restarts it from the snapshot, enters play mode and begins recording.
+    void startRecording();
+
+    // Stops the recording, writes the log to the specified path and puts the scene back as it was.
+    void stopRecording(const std::string &logPath);
+
+    // Loads a recorded log, restores its scene snapshot, enters play mode and begins replaying it.
+    // If quitWhenFinished is set, the application exits when the replay ends.
+    bool startReplay(const std::string &logPath, bool quitWhenFinished);
+
+    // Called at the start of every frame, directly after the clock has been updated.
+    // When replaying, this replaces the clock's delta time with the recorded one.
+    void frameStart();
+
+    // Called when the frame's simulation update has finished, and when the frame has been drawn.
+    void frameUpdated();
+    void frameEnd();
+
+    // Stores the first input command dispatched by the input manager in the frame.
+    // The other ticks of the frame get the same command without the mouse movement.
+    void recordInput(const InputCmd &inputs);
+
+    // Sends the recorded input command for the current frame to the scene, for one tick.
+    void dispatchRecordedInput(bool firstTick) const;
+
+    // Computes a hash of the simulation state of the current scene, from every transform except
+    // those steered by live mouse input. Two runs of the same recording should always produce the same hash.
+    uint32_t computeStateHash() const;
+
+private:
+    ReplayState state_;
+
+    // The contents of the log being recorded or replayed
+    uint32_t seed_;
+    float tickRate_;
+    int maxTicksPerFrame_;
+    std::string scenePath_;
+    std::string sceneSnapshot_;
+    std::vector<ReplayFrame> frames_;
+
+    // The frame currently being recorded or replayed
+    ReplayFrame currentFrame_;
+    int replayFrameIndex_;
+
+    // Replay settings
+    std::string replayPath_;
+    bool quitWhenFinished_;
+    uint32_t expectedStateHash_;
+
+    // Timing information for each replayed frame
+    std::chrono::high_resolution_clock::time_point frameStartTime_;
+    std::vector<ReplayFrameTiming> timings_;
+
+    // Restores the scene snapshot, seeds the random number generator, and enters play mode.
+    // Both recording and replaying start in this way, so they begin from the same state.
+    void resetSimulation() const;
+
+    // Encodes and decodes the log format
+    void writeLog(const std::string &path, uint32_t stateHash) const;
+    bool readLog(const std::string &path);
+
+    // Ends a replay, checks the state hash and writes the timing results.
+    void finishReplay();
+};
@@ -88,7 +88,8 @@ void Camera::setFov(float fov)
 Matrix4x4 Camera::getWorldToCameraMatrix(float aspectRatio, EyeType eye) const
 {
     const Transform* transform = gameObject()->findComponent<Transform>();
-    const Matrix4x4 worldToLocal = transform->worldToLocal();
+    // Look from where the camera is drawn, between the last two simulation ticks
+    const Matrix4x4 worldToLocal = transform->renderLocalToWorld().invert();
     
     Matrix4x4 projection;
     if (type_ == CameraType::Perspective)
@@ -21,6 +21,9 @@ enum class EyeType
 class Camera : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Camera;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit Camera(GameObject* gameObject);
     ~Camera() override { }
 
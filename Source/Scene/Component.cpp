@@ -2,9 +2,14 @@
 
 #include <imgui.h>
 
+#include "SceneManager.h"
+#include "Utils/BlockPool.h"
+
 Component::Component(GameObject* gameObject)
     : gameObject_(gameObject),
-    updateEnabled_(true)
+    updateEnabled_(true),
+    poolType_(ComponentType::None),
+    poolIndex_(0)
 {
 
 }
@@ -14,14 +19,25 @@ Component::~Component()
 	gameObject()->removeComponent(this);
 }
 
-const std::string Component::name() const
+void* Component::operator new(size_t size, ComponentType type)
+{
+    return SceneManager::instance()->allocateComponent(type, size);
+}
+
+void Component::operator delete(void* block, ComponentType)
 {
-    // Get the component name from typeid
-    const char* componentName = typeid(*this).name();
+    // Only called if a constructor throws
+    BlockPool::free(block);
+}
 
-    // The name begins with "Class " on msvc
-    // Skip the first 6 chars (5 in Class plus the space)
-    return std::string(componentName + 6);
+void Component::operator delete(void* block)
+{
+    BlockPool::free(block);
+}
+
+const std::string Component::name() const
+{
+    return componentTypeInfo(componentType()).name;
 }
 
 void Component::update(float)
@@ -39,6 +55,11 @@ void Component::handleCollision(Collider*)
 	// Do nothing
 }
 
+void Component::resetForReuse()
+{
+    // Do nothing
+}
+
 void Component::drawProperties()
 {
 	ImGui::Text("%s", "This component has no properties.");
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Scene/ComponentType.h"
 #include "Scene/GameObject.h"
 #include "Serialization/SerializedObject.h"
 #include "Serialization/PropertyTable.h"
@@ -15,6 +16,15 @@ public:
     explicit Component(GameObject* gameObject);
     virtual ~Component();
 
+    // Components are allocated from the scene manager's pool for their concrete type, by GameObject::createComponent
+    static void* operator new(size_t size, ComponentType type);
+    static void operator delete(void* block, ComponentType type);
+    static void operator delete(void* block);
+
+    // The type of the component.
+    // Each component class also has a static TYPE, so lookups by type don't need RTTI.
+    virtual ComponentType componentType() const = 0;
+
     // The name of the component type.
     const std::string name() const;
 
@@ -25,7 +35,7 @@ public:
     bool updateEnabled() const { return updateEnabled_; }
     void setUpdateEnabled(bool enabled) { updateEnabled_ = enabled; }
 
-    // Called each frame.
+    // Called each frame, for types given an update phase in the component type registry.
 	virtual void update(float deltaTime);
 
     // Handle input
@@ -34,6 +44,10 @@ public:
 	// Called when a rigidbody on this gameobject detects an intersection with a collider
 	virtual void handleCollision(Collider* collider);
 
+    // Called when the gameobject is released to a prefab pool.
+    // Puts back any state that the next user of the instance expects to find as the prefab set it.
+    virtual void resetForReuse();
+
     // Used to draw the imgui properties section
 	virtual void drawProperties();
 
@@ -44,4 +58,11 @@ public:
 private:
     GameObject* gameObject_;
     bool updateEnabled_;
+
+    // Where the component is in the scene manager's pools.
+    // The pool type is None when the component is in no pool.
+    ComponentType poolType_;
+    uint32_t poolIndex_;
+
+    friend class SceneManager;
 };
\ No newline at end of file
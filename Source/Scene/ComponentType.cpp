@@ -0,0 +1,129 @@
+#include "ComponentType.h"
+
+#include <unordered_map>
+
+#include "Scene/GameObject.h"
+#include "Scene/Camera.h"
+#include "Scene/Freecam.h"
+#include "Scene/Helicopter.h"
+#include "Scene/HelicopterView.h"
+#include "Scene/Rocket.h"
+#include "Scene/Shield.h"
+#include "Scene/StaticMesh.h"
+#include "Scene/StaticTurret.h"
+#include "Scene/Terrain.h"
+#include "Scene/Transform.h"
+#include "Scene/TurretGun.h"
+#include "Scene/Windmill.h"
+#include "Physics/BoxCollider.h"
+#include "Physics/Rigidbody.h"
+#include "Physics/SphereCollider.h"
+#include "Physics/TerrainCollider.h"
+
+namespace
+{
+    template<class T>
+    Component* createComponentOfType(GameObject* gameObject)
+    {
+        return gameObject->createComponent<T>();
+    }
+
+    // Indexed by ComponentType
+    const ComponentTypeInfo componentTypes[COMPONENT_TYPE_COUNT] =
+    {
+        { "Transform", ComponentType::None, &createComponentOfType<Transform>, UpdatePhase::None, 0 },
+        { "Camera", ComponentType::None, &createComponentOfType<Camera>, UpdatePhase::None, 0 },
+        { "StaticMesh", ComponentType::None, &createComponentOfType<StaticMesh>, UpdatePhase::None, 0 },
+        { "Freecam", ComponentType::None, &createComponentOfType<Freecam>, UpdatePhase::Late,
+            UpdateAccess::ReadsTransforms | UpdateAccess::WritesTransforms },
+        { "Helicopter", ComponentType::None, &createComponentOfType<Helicopter>, UpdatePhase::None, 0 },
+        { "HelicopterView", ComponentType::None, &createComponentOfType<HelicopterView>, UpdatePhase::Late,
+            UpdateAccess::WritesTransforms },
+        { "StaticTurret", ComponentType::None, &createComponentOfType<StaticTurret>, UpdatePhase::Gameplay,
+            UpdateAccess::ReadsTransforms | UpdateAccess::WritesOwnTransform | UpdateAccess::ReadsComponents },
+        { "Terrain", ComponentType::None, &createComponentOfType<Terrain>, UpdatePhase::None, 0 },
+        { "Shield", ComponentType::None, &createComponentOfType<Shield>, UpdatePhase::None, 0 },
+        { "Windmill", ComponentType::None, &createComponentOfType<Windmill>, UpdatePhase::Gameplay,
+            UpdateAccess::WritesOwnTransform },
+        { "Collider", ComponentType::None, nullptr, UpdatePhase::None, 0 },
+        { "SphereCollider", ComponentType::Collider, &createComponentOfType<SphereCollider>, UpdatePhase::None, 0 },
+        { "BoxCollider", ComponentType::Collider, &createComponentOfType<BoxCollider>, UpdatePhase::None, 0 },
+        { "TerrainCollider", ComponentType::Collider, &createComponentOfType<TerrainCollider>, UpdatePhase::None, 0 },
+
+        // Collisions call handleCollision on the other components of the gameobject, which can do anything
+        { "Rigidbody", ComponentType::None, &createComponentOfType<Rigidbody>, UpdatePhase::Physics,
+            UpdateAccess::ReadsTransforms | UpdateAccess::WritesTransforms | UpdateAccess::ReadsComponents
+            | UpdateAccess::WritesComponents | UpdateAccess::MainThread },
+
+        { "Rocket", ComponentType::None, &createComponentOfType<Rocket>, UpdatePhase::None, 0 },
+        { "TurretGun", ComponentType::None, &createComponentOfType<TurretGun>, UpdatePhase::None, 0 },
+    };
+
+    // Only concrete types can be found by name, matching the names that components are serialized under
+    std::unordered_map<std::string, ComponentType> buildTypesByName()
+    {
+        std::unordered_map<std::string, ComponentType> typesByName;
+        for (int i = 0; i < COMPONENT_TYPE_COUNT; ++i)
+        {
+            if (componentTypes[i].create != nullptr)
+            {
+                typesByName[componentTypes[i].name] = (ComponentType)i;
+            }
+        }
+
+        return typesByName;
+    }
+}
+
+const ComponentTypeInfo& componentTypeInfo(ComponentType type)
+{
+    return componentTypes[(int)type];
+}
+
+ComponentType findComponentType(const std::string &name)
+{
+    static const std::unordered_map<std::string, ComponentType> typesByName = buildTypesByName();
+
+    auto it = typesByName.find(name);
+    return (it == typesByName.end()) ? ComponentType::None : it->second;
+}
+
+bool isComponentType(ComponentType type, ComponentType baseType)
+{
+    for (ComponentType t = type; t != ComponentType::None; t = componentTypes[(int)t].parent)
+    {
+        if (t == baseType)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool updatesConflict(ComponentType a, ComponentType b)
+{
+    const uint32_t accessA = componentTypes[(int)a].updateAccess;
+    const uint32_t accessB = componentTypes[(int)b].updateAccess;
+
+    // Something written by one update can't be read or written by the other.
+    // A type that only moves its own transforms doesn't conflict with itself.
+    const uint32_t transformAccess = UpdateAccess::ReadsTransforms | UpdateAccess::WritesTransforms | UpdateAccess::WritesOwnTransform;
+    const uint32_t transformWrites = (a == b) ? UpdateAccess::WritesTransforms : (UpdateAccess::WritesTransforms | UpdateAccess::WritesOwnTransform);
+    const bool transformsConflict = ((accessA | accessB) & transformWrites) != 0
+        && ((accessA & transformAccess) != 0)
+        && ((accessB & transformAccess) != 0);
+    const bool componentsConflict = ((accessA | accessB) & UpdateAccess::WritesComponents) != 0
+        && ((accessA & (UpdateAccess::ReadsComponents | UpdateAccess::WritesComponents)) != 0)
+        && ((accessB & (UpdateAccess::ReadsComponents | UpdateAccess::WritesComponents)) != 0);
+
+    return transformsConflict || componentsConflict;
+}
+
+bool updatesInParallel(ComponentType type)
+{
+    // Components of the same type may be on the same gameobject hierarchy, so any shared write rules it out,
+    // apart from moving their own transforms, as those types promise not to be nested
+    const uint32_t access = componentTypes[(int)type].updateAccess;
+    return (access & (UpdateAccess::WritesTransforms | UpdateAccess::WritesComponents | UpdateAccess::MainThread)) == 0;
+}
\ No newline at end of file
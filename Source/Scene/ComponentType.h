@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class Component;
+class GameObject;
+
+// A dense ID for every type of component, used to index the components on a GameObject.
+// Abstract base types have IDs too, so components can be looked up by their base type.
+enum class ComponentType : uint8_t
+{
+    Transform,
+    Camera,
+    StaticMesh,
+    Freecam,
+    Helicopter,
+    HelicopterView,
+    StaticTurret,
+    Terrain,
+    Shield,
+    Windmill,
+    Collider,
+    SphereCollider,
+    BoxCollider,
+    TerrainCollider,
+    Rigidbody,
+    Rocket,
+    TurretGun,
+
+    Count,
+    None = Count
+};
+
+// The number of component types
+const int COMPONENT_TYPE_COUNT = (int)ComponentType::Count;
+
+// The stages that components are updated in, in order.
+// Gameobjects created or deleted during a phase are only created or deleted once the phase has finished.
+enum class UpdatePhase : uint8_t
+{
+    // Run for every fixed simulation tick, with the fixed delta time
+    Input,
+    Gameplay,
+    Physics,
+
+    // Run once per frame after the ticks, with the frame's delta time.
+    // For cameras and other things that only change what is drawn.
+    Late,
+
+    Count,
+    None = Count
+};
+
+// The number of update phases
+const int UPDATE_PHASE_COUNT = (int)UpdatePhase::Count;
+
+// The shared state touched by a component's update, other than the component itself.
+// Updates of types whose access doesn't conflict run at the same time on the job system, and the
+// components of a type that writes nothing shared are split across several jobs.
+namespace UpdateAccess
+{
+    // The world values of any transform. World values are brought up to date before the updates
+    // run, but worldToLocal is still computed on demand, so it must not be read.
+    const uint32_t ReadsTransforms = 1 << 0;
+
+    // Moves transforms
+    const uint32_t WritesTransforms = 1 << 1;
+
+    // Only moves the transforms of the component's own gameobject and its children, and doesn't read the
+    // transforms of other components of the same type, so the type's components can be split across jobs.
+    // None of the type's components may be on a child of another one. Other types can't run at the same
+    // time if they touch transforms, as their components may be on the same gameobjects.
+    const uint32_t WritesOwnTransform = 1 << 2;
+
+    // The state of components on other gameobjects
+    const uint32_t ReadsComponents = 1 << 3;
+    const uint32_t WritesComponents = 1 << 4;
+
+    // Loads resources, or does anything else that has to happen on the main thread
+    const uint32_t MainThread = 1 << 5;
+}
+
+// Describes a type of component
+struct ComponentTypeInfo
+{
+    // The name the type is serialized under
+    const char* name;
+
+    // The type it derives from, or None if it derives straight from Component
+    ComponentType parent;
+
+    // Adds a component of the type to a GameObject, if none exists already.
+    // Null for abstract types.
+    Component* (*create)(GameObject* gameObject);
+
+    // The phase the type is updated in. Types that don't override update use None, and aren't visited each frame.
+    UpdatePhase updatePhase;
+
+    // UpdateAccess flags describing what the type's update touches
+    uint32_t updateAccess;
+};
+
+// Gets the description of a component type
+const ComponentTypeInfo& componentTypeInfo(ComponentType type);
+
+// Finds the component type with the given name.
+// Returns ComponentType::None if no type has the name.
+ComponentType findComponentType(const std::string &name);
+
+// Checks if a component type is the same as, or derives from, another type
+bool isComponentType(ComponentType type, ComponentType baseType);
+
+// Checks if the updates of two component types can't run at the same time
+bool updatesConflict(ComponentType a, ComponentType b);
+
+// Checks if the components of a type can be updated at the same time as each other
+bool updatesInParallel(ComponentType type);
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+
+class Component;
+
+// Every component of one concrete type in the scene, packed together for iteration.
+// Components are swap-removed, so the order changes as components are deleted.
+typedef std::vector<Component*> ComponentPool;
+
+// A live view of every component in the scene of type T, or of a type derived from it.
+// It walks the pools of each matching type in turn, without copying them, so it always
+// reflects the scene as it is. Components of a matching type must not be added or removed while iterating.
+template<class T>
+class ComponentView
+{
+public:
+    class Iterator
+    {
+    public:
+        Iterator(const ComponentPool* const* pool, const ComponentPool* const* poolsEnd)
+            : pool_(pool),
+            poolsEnd_(poolsEnd),
+            index_(0)
+        {
+            skipEmptyPools();
+        }
+
+        T* operator*() const { return static_cast<T*>((**pool_)[index_]); }
+
+        Iterator& operator++()
+        {
+            ++index_;
+            skipEmptyPools();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return pool_ == other.pool_ && index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        const ComponentPool* const* pool_;
+        const ComponentPool* const* poolsEnd_;
+        size_t index_;
+
+        // Moves on to the start of the next pool once the current one has been walked
+        void skipEmptyPools()
+        {
+            while (pool_ != poolsEnd_ && index_ >= (*pool_)->size())
+            {
+                ++pool_;
+                index_ = 0;
+            }
+        }
+    };
+
+    // The pools of every type that is T or derives from it
+    explicit ComponentView(const std::vector<const ComponentPool*> &pools)
+        : pools_(pools)
+    {
+
+    }
+
+    Iterator begin() const { return Iterator(pools_.data(), pools_.data() + pools_.size()); }
+    Iterator end() const { return Iterator(pools_.data() + pools_.size(), pools_.data() + pools_.size()); }
+
+    bool empty() const { return begin() == end(); }
+
+    size_t size() const
+    {
+        size_t count = 0;
+        for (const ComponentPool* pool : pools_)
+        {
+            count += pool->size();
+        }
+
+        return count;
+    }
+
+private:
+    const std::vector<const ComponentPool*> &pools_;
+};
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "DetailBatchTree.h"
+
+#include <algorithm>
+
+DetailBatchTree::DetailBatchTree()
+{
+
+}
+
+void DetailBatchTree::build(const std::vector<DetailBatch>& batches)
+{
+    nodes_.clear();
+    batchIndices_.clear();
+
+    // Empty batches are never drawn, so leave them out of the tree
+    for (int i = 0; i < (int)batches.size(); ++i)
+    {
+        if (batches[i].count > 0)
+        {
+            batchIndices_.push_back(i);
+        }
+    }
+
+    if (batchIndices_.empty())
+    {
+        batchBounds_.clear();
+        batchDrawDistances_.clear();
+        batchCounts_.clear();
+        return;
+    }
+
+    // Sort the batches into the tree, then copy out what queries need in the same order
+    batchBounds_.resize(batches.size());
+    for (int index : batchIndices_)
+    {
+        batchBounds_[index] = batches[index].bounds;
+    }
+
+    nodes_.push_back(Node());
+    buildNode(0, 0, (int)batchIndices_.size());
+
+    batchBounds_.resize(batchIndices_.size());
+    batchDrawDistances_.resize(batchIndices_.size());
+    batchCounts_.resize(batchIndices_.size());
+    for (size_t i = 0; i < batchIndices_.size(); ++i)
+    {
+        const DetailBatch& batch = batches[batchIndices_[i]];
+        batchBounds_[i] = batch.bounds;
+        batchDrawDistances_[i] = batch.drawDistance;
+        batchCounts_[i] = batch.count;
+    }
+
+    // Find the furthest draw distance under each node
+    for (Node& node : nodes_)
+    {
+        node.maxDrawDistance = 0.0f;
+        for (int i = node.firstBatch; i < node.firstBatch + node.batchCount; ++i)
+        {
+            node.maxDrawDistance = std::max(node.maxDrawDistance, batchDrawDistances_[i]);
+        }
+    }
+}
+
+void DetailBatchTree::findVisible(const Frustum& frustum, const Point3& viewPosition, float distanceScale,
+    std::vector<int>& visible, DetailCullingStats& stats) const
+{
+    visible.clear();
+    stats = DetailCullingStats();
+
+    if (!nodes_.empty())
+    {
+        visitNode(0, false, frustum, viewPosition, distanceScale, visible, stats);
+    }
+}
+
+void DetailBatchTree::buildNode(int nodeIndex, int firstBatch, int batchCount)
+{
+    // While building, batchBounds_ is indexed by the batch index
+    Node node;
+    node.bounds = batchBounds_[batchIndices_[firstBatch]];
+    for (int i = firstBatch + 1; i < firstBatch + batchCount; ++i)
+    {
+        node.bounds.expandToCover(batchBounds_[batchIndices_[i]].min());
+        node.bounds.expandToCover(batchBounds_[batchIndices_[i]].max());
+    }
+    node.maxDrawDistance = 0.0f;
+    node.firstChild = 0;
+    node.childCount = 0;
+    node.firstBatch = firstBatch;
+    node.batchCount = batchCount;
+
+    if (batchCount <= MAX_BATCHES_PER_LEAF)
+    {
+        nodes_[nodeIndex] = node;
+        return;
+    }
+
+    // Split the batches into quadrants around the centre of the node, by the centre of each batch
+    const Point3 centre = node.bounds.centre();
+    const std::vector<int>::iterator begin = batchIndices_.begin() + firstBatch;
+    const std::vector<int>::iterator end = begin + batchCount;
+    const std::vector<int>::iterator splitZ = std::partition(begin, end, [&](int index) { return batchBounds_[index].centre().z < centre.z; });
+    const std::vector<int>::iterator splitX0 = std::partition(begin, splitZ, [&](int index) { return batchBounds_[index].centre().x < centre.x; });
+    const std::vector<int>::iterator splitX1 = std::partition(splitZ, end, [&](int index) { return batchBounds_[index].centre().x < centre.x; });
+    const std::vector<int>::iterator quadrants[5] = { begin, splitX0, splitZ, splitX1, end };
+
+    // Batches that all share a centre, such as the tiers of one tile, can't be split
+    std::vector<int> starts;
+    std::vector<int> counts;
+    for (int i = 0; i < 4; ++i)
+    {
+        const int count = (int)(quadrants[i + 1] - quadrants[i]);
+        if (count > 0)
+        {
+            starts.push_back((int)(quadrants[i] - batchIndices_.begin()));
+            counts.push_back(count);
+        }
+    }
+
+    if (starts.size() == 1)
+    {
+        nodes_[nodeIndex] = node;
+        return;
+    }
+
+    node.firstChild = (int)nodes_.size();
+    node.childCount = (int)starts.size();
+    nodes_[nodeIndex] = node;
+    nodes_.resize(nodes_.size() + starts.size());
+
+    for (size_t i = 0; i < starts.size(); ++i)
+    {
+        buildNode(node.firstChild + (int)i, starts[i], counts[i]);
+    }
+}
+
+void DetailBatchTree::visitNode(int nodeIndex, bool insideFrustum, const Frustum& frustum, const Point3& viewPosition,
+    float distanceScale, std::vector<int>& visible, DetailCullingStats& stats) const
+{
+    const Node& node = nodes_[nodeIndex];
+
+    // Nothing under the node is drawn from further away than its furthest draw distance
+    const float maxDistance = node.maxDrawDistance * distanceScale;
+    if (node.bounds.sqrDistance(viewPosition) > maxDistance * maxDistance)
+    {
+        stats.distanceCulledBatches += node.batchCount;
+        return;
+    }
+
+    // Once a node is entirely in view, so is everything under it
+    if (!insideFrustum)
+    {
+        if (!frustum.intersects(node.bounds))
+        {
+            stats.frustumCulledBatches += node.batchCount;
+            return;
+        }
+
+        insideFrustum = frustum.contains(node.bounds);
+    }
+
+    if (node.childCount > 0)
+    {
+        for (int i = 0; i < node.childCount; ++i)
+        {
+            visitNode(node.firstChild + i, insideFrustum, frustum, viewPosition, distanceScale, visible, stats);
+        }
+        return;
+    }
+
+    // Test each batch in the leaf on its own
+    for (int i = node.firstBatch; i < node.firstBatch + node.batchCount; ++i)
+    {
+        const float drawDistance = batchDrawDistances_[i] * distanceScale;
+        if (batchBounds_[i].sqrDistance(viewPosition) > drawDistance * drawDistance)
+        {
+            stats.distanceCulledBatches++;
+            continue;
+        }
+
+        if (!insideFrustum && !frustum.intersects(batchBounds_[i]))
+        {
+            stats.frustumCulledBatches++;
+            continue;
+        }
+
+        visible.push_back(batchIndices_[i]);
+        stats.visibleBatches++;
+        stats.visibleInstances += batchCounts_[i];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Bounds.h"
+#include "Math/Frustum.h"
+#include "Math/Point3.h"
+
+// A group of detail meshes drawn in a single batch
+struct DetailBatch
+{
+    const static int MaxInstancesPerBatch = 1024;
+
+    // The batch's range of the terrain's detail positions
+    uint32_t firstInstance;
+    int count;
+
+    Bounds bounds;
+    float drawDistance;
+};
+
+// The number of detail batches found by a query, and the number culled at each stage
+struct DetailCullingStats
+{
+    int visibleBatches = 0;
+    int visibleInstances = 0;
+    int frustumCulledBatches = 0;
+    int distanceCulledBatches = 0;
+};
+
+// A quadtree over the bounds of detail batches.
+//
+// Each node knows the bounds and the largest draw distance of the batches under it,
+// so whole areas of the terrain are culled by distance and by the view frustum at once.
+// Nodes entirely inside the frustum skip the frustum tests for everything under them.
+class DetailBatchTree
+{
+public:
+    const static int MAX_BATCHES_PER_LEAF = 4;
+
+    DetailBatchTree();
+
+    // Builds the tree over the non-empty batches. Must be built again when the batches change.
+    void build(const std::vector<DetailBatch> &batches);
+
+    // Finds the batches that intersect a frustum and are within their draw distance of a point.
+    // Draw distances are measured to the closest point of each batch, after multiplying them by distanceScale.
+    void findVisible(const Frustum &frustum, const Point3 &viewPosition, float distanceScale,
+        std::vector<int> &visible, DetailCullingStats &stats) const;
+
+    int nodeCount() const { return (int)nodes_.size(); }
+
+private:
+    // Every node has a contiguous range of batchIndices_, covering all of the batches under it.
+    // Leaves have no children.
+    struct Node
+    {
+        Bounds bounds;
+        float maxDrawDistance;
+        int firstChild;
+        int childCount;
+        int firstBatch;
+        int batchCount;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<int> batchIndices_;
+
+    // The bounds, draw distance and instance count of every batch, in the order of batchIndices_
+    std::vector<Bounds> batchBounds_;
+    std::vector<float> batchDrawDistances_;
+    std::vector<int> batchCounts_;
+
+    // Fills in a node covering a range of batchIndices_, and builds its children
+    void buildNode(int nodeIndex, int firstBatch, int batchCount);
+
+    // Adds the visible batches under a node to the list
+    void visitNode(int nodeIndex, bool insideFrustum, const Frustum &frustum, const Point3 &viewPosition,
+        float distanceScale, std::vector<int> &visible, DetailCullingStats &stats) const;
+};
\ No newline at end of file
@@ -8,6 +8,9 @@ class Transform;
 class Freecam : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Freecam;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit Freecam(GameObject* gameObject);
     ~Freecam() override { }
 
@@ -40,9 +40,13 @@ GameObject::GameObject(const std::string &name)
 }
 
 GameObject::GameObject(const std::string &name, Prefab* prefab)
-    : name_(name),
+    : id_(INVALID_ID),
+    name_(name),
     flags_(0),
-    prefab_(prefab)
+    prefab_(prefab),
+    prefabPool_(nullptr),
+    componentsByType_(),
+    transform_(nullptr)
 {
     // Give every GameObject instance a transform component
     // This ensures that gameobject can be parented inside each other.
@@ -71,6 +75,12 @@ GameObject::~GameObject()
     // Ensure the scene manager knows the object has been deleted.
     SceneManager::instance()->gameObjectDeleted(this);
 
+    // Let the pool know it has one fewer instance to top up from
+    if (prefabPool_ != nullptr)
+    {
+        prefabPool_->instanceDeleted();
+    }
+
     // Ensure the properties panel isnt still showing the object
     if (PropertiesPanel::instance()->current() == this)
     {
@@ -78,6 +88,16 @@ GameObject::~GameObject()
     }
 }
 
+void* GameObject::operator new(size_t size)
+{
+    return SceneManager::instance()->allocateGameObject(size);
+}
+
+void GameObject::operator delete(void* block)
+{
+    BlockPool::free(block);
+}
+
 bool GameObject::hasFlag(GameObjectFlag flag) const
 {
     return ((int)flags_ & (int)flag) != 0;
@@ -93,11 +113,14 @@ void GameObject::setFlag(GameObjectFlag flag, bool state)
     {
         flags_ &= ~(uint32_t)flag;
     }
+
+    SceneManager::instance()->gameObjectFlagsChanged(this);
 }
 
 void GameObject::setFlags(GameObjectFlagList flags)
 {
     flags_ = flags;
+    SceneManager::instance()->gameObjectFlagsChanged(this);
 }
 
 void GameObject::drawEditor()
@@ -153,7 +176,7 @@ void GameObject::drawComponentsSection()
 		{
 			// Display a remove component button
 			// This must not be shown for transform components, they cannot be removed.
-			if (static_cast<Transform*>(component) != nullptr && ImGui::BigButton("Remove Component"))
+			if (component->componentType() != ComponentType::Transform && ImGui::BigButton("Remove Component"))
 			{
 				delete component;
 			}
@@ -308,8 +331,7 @@ void GameObject::serialize(PropertyTable &table)
             if (std::find(propertyNames.begin(), propertyNames.end(), components_[i]->name()) == propertyNames.end())
             {
                 // Delete the component.
-                std::swap(components_[i], components_.back());
-                components_.pop_back();
+                removeComponent(components_[i]);
                 i--;
             }
         }
@@ -355,19 +377,6 @@ void GameObject::serialize(PropertyTable &table)
     }
 }
 
-void GameObject::update(float deltaTime)
-{
-    for (unsigned int i = 0; i < components_.size(); ++i)
-    {
-        if(components_[i]->updateEnabled() == false)
-        {
-            continue;
-        }
-
-        components_[i]->update(deltaTime);
-    }
-}
-
 void GameObject::handleInput(const InputCmd& inputs)
 {
     for (Component* component : components_)
@@ -386,73 +395,26 @@ void GameObject::handleCollision(Collider* collider)
 
 Component* GameObject::findComponent(const std::string &typeName)
 {
-    for (Component* component : components_)
+    // Only concrete types have names, and nothing derives from them,
+    // so the component in their slot is always of exactly that type
+    const ComponentType type = findComponentType(typeName);
+    if (type == ComponentType::None)
     {
-        if (component->name() == typeName)
-        {
-            return component;
-        }
+        return nullptr;
     }
 
-    return nullptr;
+    return componentsByType_[(int)type];
 }
 
 Component* GameObject::createComponent(const std::string &typeName)
 {
-    if (typeName == "Transform")
-        return createComponent<Transform>();
-
-    if (typeName == "Camera")
-        return createComponent<Camera>();
-
-    if (typeName == "StaticMesh")
-        return createComponent<StaticMesh>();
-
-    if (typeName == "Freecam")
-        return createComponent<Freecam>();
-
-    if (typeName == "Helicopter")
-        return createComponent<Helicopter>();
-
-    if (typeName == "HelicopterView")
-        return createComponent<HelicopterView>();
-
-    if (typeName == "StaticTurret")
-        return createComponent<StaticTurret>();
-
-    if (typeName == "Terrain")
-        return createComponent<Terrain>();
-
-    if (typeName == "Shield")
-        return createComponent<Shield>();
-
-    if (typeName == "Windmill")
-        return createComponent<Windmill>();
-
-    if (typeName == "SphereCollider")
-        return createComponent<SphereCollider>();
-
-    if (typeName == "BoxCollider")
-        return createComponent<BoxCollider>();
-
-    if (typeName == "Rigidbody")
-        return createComponent<Rigidbody>();
-
-	if (typeName == "TerrainCollider")
-		return createComponent<TerrainCollider>();
-
-    if (typeName == "Rocket")
-        return createComponent<Rocket>();
-
-    if (typeName == "TurretGun")
-        return createComponent<TurretGun>();
-	
-    return nullptr;
-}
+    const ComponentType type = findComponentType(typeName);
+    if (type == ComponentType::None)
+    {
+        return nullptr;
+    }
 
-Transform* GameObject::transform() const
-{
-    return findComponent<Transform>();
+    return componentTypeInfo(type).create(this);
 }
 
 Camera* GameObject::camera() const
@@ -478,4 +440,45 @@ void GameObject::removeComponent(Component* discard)
 	{
 		components_.erase(it);
 	}
+
+	SceneManager::instance()->componentDeleted(discard);
+
+	// This is called from the component's destructor, when its type is no longer known,
+	// so check every slot and fill the ones it held with the next matching component
+	for (int i = 0; i < COMPONENT_TYPE_COUNT; ++i)
+	{
+		if (componentsByType_[i] != discard)
+		{
+			continue;
+		}
+
+		componentsByType_[i] = nullptr;
+		for (Component* component : components_)
+		{
+			if (isComponentType(component->componentType(), (ComponentType)i))
+			{
+				componentsByType_[i] = component;
+				break;
+			}
+		}
+	}
+
+	transform_ = findComponent<Transform>();
+}
+
+void GameObject::addComponent(Component* component)
+{
+    components_.push_back(component);
+    SceneManager::instance()->componentCreated(component);
+
+    // Fill the slots of the component's type and its base types, unless an earlier component already holds them
+    for (ComponentType type = component->componentType(); type != ComponentType::None; type = componentTypeInfo(type).parent)
+    {
+        if (componentsByType_[(int)type] == nullptr)
+        {
+            componentsByType_[(int)type] = component;
+        }
+    }
+
+    transform_ = findComponent<Transform>();
 }
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "Editor/EditableObject.h"
+#include "Scene/ComponentType.h"
 #include "Serialization/SerializedObject.h"
 
 class Collider;
@@ -13,10 +14,12 @@ class BitReader;
 
 class Transform;
 class Camera;
+class PrefabPool;
 class StaticMesh;
 class Terrain;
 
-// Identify gameobjects with a unique 32 bit ID
+// Identify gameobjects with a unique 32 bit ID.
+// IDs aren't reused straight away, so an ID kept after its gameobject is deleted finds nothing.
 typedef uint32_t GameObjectID;
 
 struct InputCmd;
@@ -37,15 +40,23 @@ class GameObject : public IEditableObject, ISerializedObject
 {
     friend class SceneManager;
     friend class Prefab;
+    friend class PrefabPool;
     friend class PropertyTable;
 
 public:
+    // An ID that never refers to a gameobject
+    const static GameObjectID INVALID_ID = 0;
+
     GameObject();
     explicit GameObject(const std::string &name);
     explicit GameObject(const std::string &name, Prefab* prefab);
 
     ~GameObject();
 
+    // GameObjects are allocated from a pool in the scene manager
+    static void* operator new(size_t size);
+    static void operator delete(void* block);
+
     // Prevent a GameObject from being copied or moved
     GameObject(const GameObject&) = delete;
     GameObject(GameObject&&) = delete;
@@ -53,9 +64,13 @@ public:
     GameObject& operator=(GameObject&&) = delete;
 
     // Getters for basic gameobject properties
+    GameObjectID id() const { return id_; }
     const std::string& name() const { return name_; }
     Prefab* prefab() const { return prefab_; }
 
+    // The pool the gameobject is reused by, or null if it is deleted when destroyed
+    PrefabPool* prefabPool() const { return prefabPool_; }
+
     // Methods for getting and setting gameobject flags
     GameObjectFlagList flags() const { return flags_; }
     bool hasFlag(GameObjectFlag flag) const;
@@ -73,36 +88,18 @@ public:
     // Used for networking and saving objects to disk.
     void serialize(PropertyTable &table) override;
 
-    // Called once per frame
-    void update(float deltaTime);
-
 	// Dispatches an input command to all components on the gameobject
     void handleInput(const InputCmd& inputs);
 
 	// Dispatches a collision event to all components on the gameobject
 	void handleCollision(Collider* collider);
 
-    // Looks for a component of the given type on the GameObject.
+    // Looks for a component of the given type, or of a type derived from it, on the GameObject.
     // Returns nullptr if none is found.
-    // Note: This method can be slow. Caching the result may be worthwile.
     template<class T>
     T* findComponent() const
     {
-        // Check each existing component to see if any are an instance of T
-        for (unsigned int i = 0; i < components_.size(); ++i)
-        {
-            // Try to cast to a T
-            T* existing = dynamic_cast<T*>(components_[i]);
-
-            // dynamic_cast gives us nullptr if it failed
-            if (existing != nullptr)
-            {
-                return existing;
-            }
-        }
-
-        // No component exists.
-        return nullptr;
+        return static_cast<T*>(componentsByType_[(int)T::TYPE]);
     }
 
     // Looks for a component with the given name on the GameObject.
@@ -111,7 +108,6 @@ public:
 
     // Adds a component of the given type to the GameObject, if none exists already.
     // Returns the new, or existing, component.
-    // Note: This method can be slow. Caching the result may be worthwile.
     template<class T>
     T* createComponent()
     {
@@ -122,9 +118,9 @@ public:
             return existing;
         }
 
-        // Not found. Create a new component and add it to the gameobject.
-        T* newObject = new T(this);
-        components_.push_back(newObject);
+        // Not found. Create a new component, in the memory pool for its type, and add it to the gameobject.
+        T* newObject = new (T::TYPE) T(this);
+        addComponent(newObject);
         return newObject;
     }
 
@@ -132,7 +128,7 @@ public:
     Component* createComponent(const std::string &typeName);
 
     // Shortcut methods for finding components
-    Transform* transform() const;
+    Transform* transform() const { return transform_; }
     Camera* camera() const;
     StaticMesh* staticMesh() const;
     Terrain* terrain() const;
@@ -144,14 +140,28 @@ protected:
 	void removeComponent(Component* component);
 
 private:
+    // Assigned by the scene manager when the gameobject is registered
+    GameObjectID id_;
+
     std::string name_;
     GameObjectFlagList flags_;
 
     // The prefab that the GameObject was instantiated from
     Prefab* prefab_;
+    PrefabPool* prefabPool_;
 
     // The components that currently exist on the GameObject
     std::vector<Component*> components_;
 
+    // The first component of each type, including base types, in the order they were added.
+    // Lets components be found without searching the whole list.
+    Component* componentsByType_[COMPONENT_TYPE_COUNT];
+
+    // Every GameObject has a transform, and it is needed far more than anything else
+    Transform* transform_;
+
+    // Adds a new component to the list, and to the index of components by type
+    void addComponent(Component* component);
+
 	friend class Component;
 };
@@ -0,0 +1,255 @@
+#include "Heightfield.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace
+{
+    // Computes the normal for a texel from the height differences across it.
+    // This is the cross product of the (unnormalized) tangent and bitangent directions.
+    void computeNormal(float dydx, float dydz, float &normalX, float &normalY, float &normalZ)
+    {
+        const float inverseLength = 1.0f / sqrtf((1.0f + dydx * dydx) * (1.0f + dydz * dydz));
+        normalX = -dydx * inverseLength;
+        normalY = inverseLength;
+        normalZ = -dydz * inverseLength;
+    }
+}
+
+Heightfield::Heightfield()
+    : resolution_(0),
+    sizeX_(1.0f),
+    sizeZ_(1.0f),
+    heightOffset_(0.0f)
+{
+
+}
+
+void Heightfield::setDimensions(int resolution, float sizeX, float sizeZ, float heightOffset)
+{
+    const bool areaChanged = resolution != resolution_ || sizeX != sizeX_ || sizeZ != sizeZ_;
+
+    resolution_ = resolution;
+    sizeX_ = sizeX;
+    sizeZ_ = sizeZ;
+    heightOffset_ = heightOffset;
+
+    // The normals depend on the distance between texels
+    if (areaChanged && heights_.size() == (size_t)resolution * resolution)
+    {
+        rebuildNormals();
+    }
+}
+
+void Heightfield::assign(int resolution, float sizeX, float sizeZ, float heightOffset, const float* heights, const float* normals)
+{
+    resolution_ = resolution;
+    sizeX_ = sizeX;
+    sizeZ_ = sizeZ;
+    heightOffset_ = heightOffset;
+
+    const size_t texels = (size_t)resolution * resolution;
+    heights_.assign(heights, heights + texels);
+    normals_.assign(normals, normals + texels * 4);
+}
+
+void Heightfield::rebuildNormals()
+{
+    const int resolution = resolution_;
+    normals_.resize((size_t)resolution * resolution * 4);
+
+    // The normals use central differences of the neighbouring texels.
+    // The gradient is scaled by 2 * resolution / size, which the terrain's slope limits were tuned against.
+    const float scaleX = 2.0f * resolution / sizeX_;
+    const float scaleZ = 2.0f * resolution / sizeZ_;
+
+    const __m128 scaleX4 = _mm_set1_ps(scaleX);
+    const __m128 scaleZ4 = _mm_set1_ps(scaleZ);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    for (int z = 0; z < resolution; ++z)
+    {
+        const float* row = heights_.data() + (size_t)z * resolution;
+        const float* rowBelow = heights_.data() + (size_t)std::max(z - 1, 0) * resolution;
+        const float* rowAbove = heights_.data() + (size_t)std::min(z + 1, resolution - 1) * resolution;
+        float* normals = normals_.data() + (size_t)z * resolution * 4;
+
+        // The first and last texels in the row clamp their neighbours, so handle them separately.
+        for (int x : { 0, resolution - 1 })
+        {
+            const float dydx = (row[std::min(x + 1, resolution - 1)] - row[std::max(x - 1, 0)]) * scaleX;
+            const float dydz = (rowAbove[x] - rowBelow[x]) * scaleZ;
+            computeNormal(dydx, dydz, normals[x * 4], normals[x * 4 + 1], normals[x * 4 + 2]);
+            normals[x * 4 + 3] = 0.0f;
+        }
+
+        int x = 1;
+        for (; x + 4 <= resolution - 1; x += 4)
+        {
+            const __m128 dydx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(row + x + 1), _mm_loadu_ps(row + x - 1)), scaleX4);
+            const __m128 dydz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(rowAbove + x), _mm_loadu_ps(rowBelow + x)), scaleZ4);
+            const __m128 lengthSquared = _mm_mul_ps(_mm_add_ps(one, _mm_mul_ps(dydx, dydx)), _mm_add_ps(one, _mm_mul_ps(dydz, dydz)));
+            const __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+
+            // Interleave the components of four normals
+            __m128 normalX = _mm_xor_ps(_mm_mul_ps(dydx, inverseLength), signMask);
+            __m128 normalY = inverseLength;
+            __m128 normalZ = _mm_xor_ps(_mm_mul_ps(dydz, inverseLength), signMask);
+            __m128 padding = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(normalX, normalY, normalZ, padding);
+            _mm_storeu_ps(normals + x * 4, normalX);
+            _mm_storeu_ps(normals + x * 4 + 4, normalY);
+            _mm_storeu_ps(normals + x * 4 + 8, normalZ);
+            _mm_storeu_ps(normals + x * 4 + 12, padding);
+        }
+        for (; x < resolution - 1; ++x)
+        {
+            const float dydx = (row[x + 1] - row[x - 1]) * scaleX;
+            const float dydz = (rowAbove[x] - rowBelow[x]) * scaleZ;
+            computeNormal(dydx, dydz, normals[x * 4], normals[x * 4 + 1], normals[x * 4 + 2]);
+            normals[x * 4 + 3] = 0.0f;
+        }
+    }
+}
+
+float Heightfield::sampleHeight(float x, float z) const
+{
+    float height;
+    sampleHeights(&x, &z, &height, 1);
+    return height;
+}
+
+Vector3 Heightfield::sampleNormal(float x, float z) const
+{
+    Vector3 normal;
+    sampleNormals(&x, &z, &normal.x, &normal.y, &normal.z, 1);
+    return normal;
+}
+
+void Heightfield::sampleHeights(const float* x, const float* z, float* heights, int count) const
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        sampleFourHeights(x + i, z + i, heights + i);
+    }
+
+    // Pad the last group of points by repeating the final one
+    if (i < count)
+    {
+        float paddedX[4], paddedZ[4], sampled[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            paddedX[j] = x[std::min(i + j, count - 1)];
+            paddedZ[j] = z[std::min(i + j, count - 1)];
+        }
+
+        sampleFourHeights(paddedX, paddedZ, sampled);
+        std::copy(sampled, sampled + (count - i), heights + i);
+    }
+}
+
+void Heightfield::sampleNormals(const float* x, const float* z, float* normalsX, float* normalsY, float* normalsZ, int count) const
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        sampleFourNormals(x + i, z + i, normalsX + i, normalsY + i, normalsZ + i);
+    }
+
+    // Pad the last group of points by repeating the final one
+    if (i < count)
+    {
+        float paddedX[4], paddedZ[4], sampledX[4], sampledY[4], sampledZ[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            paddedX[j] = x[std::min(i + j, count - 1)];
+            paddedZ[j] = z[std::min(i + j, count - 1)];
+        }
+
+        sampleFourNormals(paddedX, paddedZ, sampledX, sampledY, sampledZ);
+        std::copy(sampledX, sampledX + (count - i), normalsX + i);
+        std::copy(sampledY, sampledY + (count - i), normalsY + i);
+        std::copy(sampledZ, sampledZ + (count - i), normalsZ + i);
+    }
+}
+
+void Heightfield::findCells(const float* x, const float* z, size_t* indices, __m128 &fractionX, __m128 &fractionZ) const
+{
+    // Convert the world positions to texel coordinates, clamped to the grid
+    const __m128 maxCoordinate = _mm_set1_ps((float)(resolution_ - 1));
+    const __m128 maxCell = _mm_set1_ps((float)(resolution_ - 2));
+    const __m128 u = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(x), _mm_set1_ps((resolution_ - 1) / sizeX_)), _mm_setzero_ps()), maxCoordinate);
+    const __m128 v = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(z), _mm_set1_ps((resolution_ - 1) / sizeZ_)), _mm_setzero_ps()), maxCoordinate);
+
+    // Find the cell containing each point, and the position within the cell.
+    // The coordinates are positive, so truncation rounds down.
+    const __m128 cellX = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(u)), maxCell);
+    const __m128 cellZ = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(v)), maxCell);
+    fractionX = _mm_sub_ps(u, cellX);
+    fractionZ = _mm_sub_ps(v, cellZ);
+
+    int cellXs[4], cellZs[4];
+    _mm_storeu_si128((__m128i*)cellXs, _mm_cvttps_epi32(cellX));
+    _mm_storeu_si128((__m128i*)cellZs, _mm_cvttps_epi32(cellZ));
+    for (int i = 0; i < 4; ++i)
+    {
+        indices[i] = (size_t)cellXs[i] + (size_t)cellZs[i] * resolution_;
+    }
+}
+
+void Heightfield::sampleFourHeights(const float* x, const float* z, float* heights) const
+{
+    size_t indices[4];
+    __m128 fractionX, fractionZ;
+    findCells(x, z, indices, fractionX, fractionZ);
+
+    // Gather the four corners of each cell
+    const float* values = heights_.data();
+    const size_t rowOffset = resolution_;
+    const __m128 v00 = _mm_setr_ps(values[indices[0]], values[indices[1]], values[indices[2]], values[indices[3]]);
+    const __m128 v10 = _mm_setr_ps(values[indices[0] + 1], values[indices[1] + 1], values[indices[2] + 1], values[indices[3] + 1]);
+    const __m128 v01 = _mm_setr_ps(values[indices[0] + rowOffset], values[indices[1] + rowOffset], values[indices[2] + rowOffset], values[indices[3] + rowOffset]);
+    const __m128 v11 = _mm_setr_ps(values[indices[0] + rowOffset + 1], values[indices[1] + rowOffset + 1], values[indices[2] + rowOffset + 1], values[indices[3] + rowOffset + 1]);
+
+    // Bilinear interpolation
+    const __m128 lowerZ = _mm_add_ps(v00, _mm_mul_ps(_mm_sub_ps(v10, v00), fractionX));
+    const __m128 upperZ = _mm_add_ps(v01, _mm_mul_ps(_mm_sub_ps(v11, v01), fractionX));
+    const __m128 height = _mm_add_ps(lowerZ, _mm_mul_ps(_mm_sub_ps(upperZ, lowerZ), fractionZ));
+    _mm_storeu_ps(heights, _mm_add_ps(height, _mm_set1_ps(heightOffset_)));
+}
+
+void Heightfield::sampleFourNormals(const float* x, const float* z, float* normalsX, float* normalsY, float* normalsZ) const
+{
+    size_t indices[4];
+    __m128 fractionX, fractionZ;
+    findCells(x, z, indices, fractionX, fractionZ);
+
+    float fractionsX[4], fractionsZ[4];
+    _mm_storeu_ps(fractionsX, fractionX);
+    _mm_storeu_ps(fractionsZ, fractionZ);
+
+    // Interpolate each normal with all of its components at once
+    __m128 sampled[4];
+    const size_t rowOffset = resolution_ * 4;
+    for (int i = 0; i < 4; ++i)
+    {
+        const float* corner = normals_.data() + indices[i] * 4;
+        const __m128 v00 = _mm_loadu_ps(corner);
+        const __m128 v10 = _mm_loadu_ps(corner + 4);
+        const __m128 v01 = _mm_loadu_ps(corner + rowOffset);
+        const __m128 v11 = _mm_loadu_ps(corner + rowOffset + 4);
+
+        const __m128 pointFractionX = _mm_set1_ps(fractionsX[i]);
+        const __m128 lowerZ = _mm_add_ps(v00, _mm_mul_ps(_mm_sub_ps(v10, v00), pointFractionX));
+        const __m128 upperZ = _mm_add_ps(v01, _mm_mul_ps(_mm_sub_ps(v11, v01), pointFractionX));
+        sampled[i] = _mm_add_ps(lowerZ, _mm_mul_ps(_mm_sub_ps(upperZ, lowerZ), _mm_set1_ps(fractionsZ[i])));
+    }
+
+    // Split the components into separate arrays
+    _MM_TRANSPOSE4_PS(sampled[0], sampled[1], sampled[2], sampled[3]);
+    _mm_storeu_ps(normalsX, sampled[0]);
+    _mm_storeu_ps(normalsY, sampled[1]);
+    _mm_storeu_ps(normalsZ, sampled[2]);
+}
\ No newline at end of file
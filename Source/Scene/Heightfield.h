@@ -0,0 +1,71 @@
+#pragma once
+
+#include <emmintrin.h>
+#include <vector>
+
+#include "Math/Vector3.h"
+
+// A grid of heights covering a rectangle in the XZ plane, with a precomputed normal field.
+//
+// Heights and normals are sampled with bilinear filtering. As well as single
+// point queries there are batch queries, which take arrays of coordinates and
+// sample four points at a time using SSE2. Batch queries should be preferred
+// whenever many points are needed, such as when placing objects.
+class Heightfield
+{
+public:
+    Heightfield();
+
+    // The raw height values. There are resolution * resolution values, in rows of increasing z.
+    // rebuildNormals must be called after the heights are modified.
+    std::vector<float>& heights() { return heights_; }
+    const std::vector<float>& heights() const { return heights_; }
+
+    // Sets the resolution of the grid, the area it covers in world space, and
+    // an offset added to all sampled heights. Rebuilds the normals if the area changed.
+    void setDimensions(int resolution, float sizeX, float sizeZ, float heightOffset);
+
+    int resolution() const { return resolution_; }
+    float sizeX() const { return sizeX_; }
+    float sizeZ() const { return sizeZ_; }
+    float heightOffset() const { return heightOffset_; }
+
+    // Recomputes the normal field from the heights.
+    void rebuildNormals();
+
+    // The normal field, as (x, y, z, 0) for each texel. It is rebuilt by rebuildNormals.
+    const std::vector<float>& normals() const { return normals_; }
+
+    // Replaces the whole heightfield, along with a normal field saved from an earlier rebuildNormals.
+    // This is faster than setting the heights and rebuilding the normals.
+    void assign(int resolution, float sizeX, float sizeZ, float heightOffset, const float* heights, const float* normals);
+
+    // Samples a single height or normal at a point.
+    // The x and z coordinates are in world space, and are clamped to the heightfield.
+    float sampleHeight(float x, float z) const;
+    Vector3 sampleNormal(float x, float z) const;
+
+    // Samples the heights and normals at count points.
+    // The normals are written to separate arrays for each component.
+    void sampleHeights(const float* x, const float* z, float* heights, int count) const;
+    void sampleNormals(const float* x, const float* z, float* normalsX, float* normalsY, float* normalsZ, int count) const;
+
+private:
+    int resolution_;
+    float sizeX_;
+    float sizeZ_;
+    float heightOffset_;
+
+    std::vector<float> heights_;
+
+    // The normal field, stored as (x, y, z, 0) for each texel.
+    // Keeping the components together means each cell corner is a single load.
+    std::vector<float> normals_;
+
+    // Finds the grid cells containing four points, and the position of each point within its cell
+    void findCells(const float* x, const float* z, size_t* indices, __m128 &fractionX, __m128 &fractionZ) const;
+
+    // Samples the heights or normals at four points
+    void sampleFourHeights(const float* x, const float* z, float* heights) const;
+    void sampleFourNormals(const float* x, const float* z, float* normalsX, float* normalsY, float* normalsZ) const;
+};
\ No newline at end of file
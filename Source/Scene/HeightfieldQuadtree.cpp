@@ -0,0 +1,343 @@
+#include "HeightfieldQuadtree.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <emmintrin.h>
+#include <math.h>
+
+#include "Heightfield.h"
+
+namespace
+{
+    // A node waiting to be visited, with the range of distances over which the ray is inside its bounds
+    struct PendingNode
+    {
+        int level;
+        int x;
+        int z;
+        float entry;
+        float exit;
+    };
+
+    // Clips the distances [entry, exit] to where a ray is inside a box.
+    // Axes the ray runs parallel to only need the origin to be within the box.
+    bool clipToBox(const float* origin, const float* inverseDirection, const float* boxMin, const float* boxMax, float &entry, float &exit)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (inverseDirection[axis] == 0.0f)
+            {
+                if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis])
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            float axisEntry = (boxMin[axis] - origin[axis]) * inverseDirection[axis];
+            float axisExit = (boxMax[axis] - origin[axis]) * inverseDirection[axis];
+            if (axisEntry > axisExit)
+            {
+                std::swap(axisEntry, axisExit);
+            }
+
+            entry = std::max(entry, axisEntry);
+            exit = std::min(exit, axisExit);
+        }
+
+        return entry <= exit;
+    }
+}
+
+HeightfieldQuadtree::HeightfieldQuadtree()
+    : heightfield_(nullptr),
+    cellCount_(0)
+{
+
+}
+
+void HeightfieldQuadtree::build(const Heightfield& heightfield)
+{
+    heightfield_ = &heightfield;
+    levels_.clear();
+
+    const int resolution = heightfield.resolution();
+    const std::vector<float>& heights = heightfield.heights();
+    if (resolution < 2 || heights.size() != (size_t)resolution * resolution)
+    {
+        cellCount_ = 0;
+        return;
+    }
+
+    // The bottom level holds the bounds of the four corners of each cell
+    cellCount_ = resolution - 1;
+    Level cells;
+    cells.width = cellCount_;
+    cells.height = cellCount_;
+    cells.bounds.resize((size_t)cellCount_ * cellCount_ * 2);
+
+    for (int z = 0; z < cellCount_; ++z)
+    {
+        const float* row = heights.data() + (size_t)z * resolution;
+        const float* nextRow = row + resolution;
+        float* bounds = cells.bounds.data() + (size_t)z * cellCount_ * 2;
+
+        int x = 0;
+        for (; x + 4 <= cellCount_; x += 4)
+        {
+            const __m128 left = _mm_loadu_ps(row + x);
+            const __m128 right = _mm_loadu_ps(row + x + 1);
+            const __m128 nextLeft = _mm_loadu_ps(nextRow + x);
+            const __m128 nextRight = _mm_loadu_ps(nextRow + x + 1);
+            const __m128 lowest = _mm_min_ps(_mm_min_ps(left, right), _mm_min_ps(nextLeft, nextRight));
+            const __m128 highest = _mm_max_ps(_mm_max_ps(left, right), _mm_max_ps(nextLeft, nextRight));
+
+            // Interleave into (min, max) pairs
+            _mm_storeu_ps(bounds + x * 2, _mm_unpacklo_ps(lowest, highest));
+            _mm_storeu_ps(bounds + x * 2 + 4, _mm_unpackhi_ps(lowest, highest));
+        }
+        for (; x < cellCount_; ++x)
+        {
+            bounds[x * 2] = std::min(std::min(row[x], row[x + 1]), std::min(nextRow[x], nextRow[x + 1]));
+            bounds[x * 2 + 1] = std::max(std::max(row[x], row[x + 1]), std::max(nextRow[x], nextRow[x + 1]));
+        }
+    }
+    levels_.push_back(std::move(cells));
+
+    // Each level above merges 2x2 nodes of the one below, until a single node covers the heightfield
+    while (levels_.back().width > 1 || levels_.back().height > 1)
+    {
+        const Level& below = levels_.back();
+        Level level;
+        level.width = (below.width + 1) / 2;
+        level.height = (below.height + 1) / 2;
+        level.bounds.resize((size_t)level.width * level.height * 2);
+
+        for (int z = 0; z < level.height; ++z)
+        {
+            for (int x = 0; x < level.width; ++x)
+            {
+                float lowest = INFINITY;
+                float highest = -INFINITY;
+                for (int childZ = z * 2; childZ < std::min(z * 2 + 2, below.height); ++childZ)
+                {
+                    for (int childX = x * 2; childX < std::min(x * 2 + 2, below.width); ++childX)
+                    {
+                        const float* child = below.bounds.data() + ((size_t)childX + (size_t)childZ * below.width) * 2;
+                        lowest = std::min(lowest, child[0]);
+                        highest = std::max(highest, child[1]);
+                    }
+                }
+
+                level.bounds[((size_t)x + (size_t)z * level.width) * 2] = lowest;
+                level.bounds[((size_t)x + (size_t)z * level.width) * 2 + 1] = highest;
+            }
+        }
+        levels_.push_back(std::move(level));
+    }
+}
+
+bool HeightfieldQuadtree::raycast(const Point3& origin, const Vector3& direction, float maxDistance, HeightfieldHit& hit) const
+{
+    return traverse(origin, direction, maxDistance, 0.0f, hit);
+}
+
+bool HeightfieldQuadtree::sweepSegment(const Point3& start, const Point3& end, HeightfieldHit& hit) const
+{
+    return traverse(start, end - start, 1.0f, 0.0f, hit);
+}
+
+bool HeightfieldQuadtree::sweepSphere(const Point3& start, const Point3& end, float radius, HeightfieldHit& hit) const
+{
+    return traverse(start, end - start, 1.0f, radius, hit);
+}
+
+void HeightfieldQuadtree::raycastBatch(const HeightfieldRay* rays, HeightfieldHit* hits, int count) const
+{
+    for (int i = 0; i < count; ++i)
+    {
+        traverse(rays[i].origin, rays[i].direction, rays[i].maxDistance, 0.0f, hits[i]);
+    }
+}
+
+bool HeightfieldQuadtree::traverse(const Point3& origin, const Vector3& direction, float maxDistance, float lift, HeightfieldHit& hit) const
+{
+    hit.hit = false;
+    hit.distance = maxDistance;
+    if (levels_.empty())
+    {
+        return false;
+    }
+
+    // Work in grid space, where cells are one unit across and heights are raw values.
+    // The mapping is linear, so distances along the ray are the same as in world space.
+    const float scaleX = cellCount_ / heightfield_->sizeX();
+    const float scaleZ = cellCount_ / heightfield_->sizeZ();
+    const float gridOrigin[3] = { origin.x * scaleX, origin.y - heightfield_->heightOffset(), origin.z * scaleZ };
+    const float gridDirection[3] = { direction.x * scaleX, direction.y, direction.z * scaleZ };
+    float inverseDirection[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        inverseDirection[axis] = gridDirection[axis] != 0.0f ? 1.0f / gridDirection[axis] : 0.0f;
+    }
+
+    // Each pass through the loop pops one node and pushes at most four, so the stack stays shallow
+    PendingNode stack[4 * 32];
+    int stackSize = 0;
+
+    // Clips a ray to the column under the highest point of a node, since everything below the surface is solid
+    auto tryNode = [&](int level, int x, int z, float limit, PendingNode &node)
+    {
+        const int shift = level;
+        const float* bounds = levels_[level].bounds.data() + ((size_t)x + (size_t)z * levels_[level].width) * 2;
+        const float boxMin[3] = { (float)(x << shift), -FLT_MAX, (float)(z << shift) };
+        const float boxMax[3] = { (float)std::min((x + 1) << shift, cellCount_), bounds[1] + lift, (float)std::min((z + 1) << shift, cellCount_) };
+
+        node.level = level;
+        node.x = x;
+        node.z = z;
+        node.entry = 0.0f;
+        node.exit = limit;
+        return clipToBox(gridOrigin, inverseDirection, boxMin, boxMax, node.entry, node.exit);
+    };
+
+    float closest = maxDistance;
+    if (tryNode((int)levels_.size() - 1, 0, 0, closest, stack[0]))
+    {
+        stackSize = 1;
+    }
+
+    while (stackSize > 0)
+    {
+        const PendingNode node = stack[--stackSize];
+        if (node.entry > closest)
+        {
+            continue;
+        }
+
+        // When the ray enters a node below its lowest point, it has hit the side of the terrain
+        const float* bounds = levels_[node.level].bounds.data() + ((size_t)node.x + (size_t)node.z * levels_[node.level].width) * 2;
+        if (gridOrigin[1] + gridDirection[1] * node.entry <= bounds[0] + lift)
+        {
+            closest = node.entry;
+            hit.hit = true;
+            continue;
+        }
+
+        if (node.level == 0)
+        {
+            const float distance = intersectCell(node.x, node.z, gridOrigin, gridDirection, node.entry, std::min(node.exit, closest), lift);
+            if (distance >= 0.0f && (!hit.hit || distance < closest))
+            {
+                closest = distance;
+                hit.hit = true;
+            }
+            continue;
+        }
+
+        // Visit the children the ray passes through, nearest first
+        const int childLevel = node.level - 1;
+        PendingNode children[4];
+        int childCount = 0;
+        for (int childZ = node.z * 2; childZ < std::min(node.z * 2 + 2, levels_[childLevel].height); ++childZ)
+        {
+            for (int childX = node.x * 2; childX < std::min(node.x * 2 + 2, levels_[childLevel].width); ++childX)
+            {
+                if (tryNode(childLevel, childX, childZ, closest, children[childCount]))
+                {
+                    ++childCount;
+                }
+            }
+        }
+
+        std::sort(children, children + childCount, [](const PendingNode &a, const PendingNode &b) { return a.entry > b.entry; });
+        for (int i = 0; i < childCount; ++i)
+        {
+            stack[stackSize++] = children[i];
+        }
+    }
+
+    if (hit.hit)
+    {
+        hit.distance = closest;
+        hit.point = origin + direction * closest;
+        hit.normal = heightfield_->sampleNormal(hit.point.x, hit.point.z);
+    }
+    return hit.hit;
+}
+
+float HeightfieldQuadtree::intersectCell(int cellX, int cellZ, const float* origin, const float* direction, float start, float end, float lift) const
+{
+    // The surface over the cell is h(u, v) = a + b*u + c*v + d*u*v, for u and v within the cell.
+    const int resolution = heightfield_->resolution();
+    const float* corner = heightfield_->heights().data() + (size_t)cellX + (size_t)cellZ * resolution;
+    const double h00 = corner[0] + lift;
+    const double h10 = corner[1] + lift;
+    const double h01 = corner[resolution] + lift;
+    const double h11 = corner[resolution + 1] + lift;
+    const double a = h00;
+    const double b = h10 - h00;
+    const double c = h01 - h00;
+    const double d = h00 - h10 - h01 + h11;
+
+    // Measure from where the ray enters the cell, to keep the values small
+    const double u = origin[0] + (double)direction[0] * start - cellX;
+    const double v = origin[2] + (double)direction[2] * start - cellZ;
+    const double y = origin[1] + (double)direction[1] * start;
+    const double du = direction[0];
+    const double dv = direction[2];
+    const double dy = direction[1];
+
+    // The height of the ray above the surface is a quadratic in the distance s from the entry point
+    const double c0 = y - a - b * u - c * v - d * u * v;
+    const double c1 = dy - b * du - c * dv - d * (u * dv + v * du);
+    const double c2 = -d * du * dv;
+    const double length = (double)end - start;
+
+    // Already on or below the surface
+    if (c0 <= 0.0)
+    {
+        return start;
+    }
+
+    double first = -1.0;
+    if (fabs(c2) < 1e-12)
+    {
+        if (c1 < 0.0)
+        {
+            first = -c0 / c1;
+        }
+    }
+    else
+    {
+        const double discriminant = c1 * c1 - 4.0 * c2 * c0;
+        if (discriminant >= 0.0)
+        {
+            // Use the numerically stable form of the quadratic formula
+            const double q = -0.5 * (c1 + (c1 >= 0.0 ? sqrt(discriminant) : -sqrt(discriminant)));
+            const double root0 = q / c2;
+            const double root1 = q != 0.0 ? c0 / q : -1.0;
+            for (double root : { root0, root1 })
+            {
+                if (root >= 0.0 && (first < 0.0 || root < first))
+                {
+                    first = root;
+                }
+            }
+        }
+    }
+
+    if (first >= 0.0 && first <= length)
+    {
+        return (float)(start + first);
+    }
+
+    // Catch a crossing lost to rounding right at the far side of the cell
+    const double endU = u + du * length;
+    const double endV = v + dv * length;
+    if (y + dy * length <= a + b * endU + c * endV + d * endU * endV)
+    {
+        return end;
+    }
+    return -1.0f;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "Math/Point3.h"
+#include "Math/Vector3.h"
+
+class Heightfield;
+
+// A ray cast against a heightfield quadtree.
+// The direction does not need to be normalized; distances are measured in multiples of it.
+struct HeightfieldRay
+{
+    Point3 origin;
+    Vector3 direction;
+    float maxDistance;
+};
+
+// The result of a heightfield quadtree query
+struct HeightfieldHit
+{
+    bool hit;
+    float distance;
+    Point3 point;
+    Vector3 normal;
+};
+
+// A min / max pyramid over the cells of a heightfield, for finding where rays meet the surface.
+//
+// Each level stores the lowest and highest height within 2x2 nodes of the level below,
+// with the bottom level holding the bounds of single cells. A query descends only into the
+// nodes whose bounding boxes the ray passes through, nearest first, so the cost grows with
+// the log of the resolution rather than with the number of cells along the ray.
+// At the cells themselves the ray is intersected exactly with the bilinear surface, so hits
+// agree with Heightfield::sampleHeight. Everything below the surface counts as solid, so rays
+// that start underground hit immediately. Only the area covered by the heightfield can be hit.
+class HeightfieldQuadtree
+{
+public:
+    HeightfieldQuadtree();
+
+    // Rebuilds the pyramid from the heights. Must be called whenever the heights change.
+    // The heightfield must outlive the quadtree; changes to its height offset are picked up without a rebuild.
+    void build(const Heightfield& heightfield);
+
+    // Finds the first point where a ray meets the surface, within maxDistance along the direction.
+    bool raycast(const Point3& origin, const Vector3& direction, float maxDistance, HeightfieldHit& hit) const;
+
+    // Finds the first point on the segment from start to end that meets the surface.
+    // The hit distance is the fraction of the way along the segment.
+    bool sweepSegment(const Point3& start, const Point3& end, HeightfieldHit& hit) const;
+
+    // Finds where a sphere moving from start to end first touches the surface.
+    // The sphere is approximated by sweeping its centre against the surface raised by the radius,
+    // which is exact on flat ground and close on gentle slopes.
+    // The hit point is the centre of the sphere at contact, and the distance is a fraction of the segment.
+    bool sweepSphere(const Point3& start, const Point3& end, float radius, HeightfieldHit& hit) const;
+
+    // Casts count rays, writing a result for each.
+    void raycastBatch(const HeightfieldRay* rays, HeightfieldHit* hits, int count) const;
+
+    // The number of levels in the pyramid, including the level of single cells
+    int levelCount() const { return (int)levels_.size(); }
+
+private:
+    struct Level
+    {
+        int width;
+        int height;
+
+        // The lowest and highest raw height of each node, as interleaved pairs
+        std::vector<float> bounds;
+    };
+
+    const Heightfield* heightfield_;
+    int cellCount_;
+    std::vector<Level> levels_;
+
+    // Descends the pyramid, finding the first hit against the surface raised by lift.
+    bool traverse(const Point3& origin, const Vector3& direction, float maxDistance, float lift, HeightfieldHit& hit) const;
+
+    // Intersects a ray in grid space with the bilinear surface of a single cell, between two distances.
+    // Returns the distance of the first point on or below the surface, or a negative value for no hit.
+    float intersectCell(int cellX, int cellZ, const float* origin, const float* direction, float start, float end, float lift) const;
+};
\ No newline at end of file
@@ -11,6 +11,9 @@ struct InputCmd;
 class Helicopter : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Helicopter;
+    ComponentType componentType() const override { return TYPE; }
+
     Helicopter(GameObject* gameObject);
 
     void drawProperties() override;
@@ -8,6 +8,9 @@ class Transform;
 class HelicopterView : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::HelicopterView;
+    ComponentType componentType() const override { return TYPE; }
+
     HelicopterView(GameObject* gameObject);
 
     // Draws the freecam properties fold out
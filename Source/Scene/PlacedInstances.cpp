@@ -0,0 +1,212 @@
+#include "PlacedInstances.h"
+
+#include <algorithm>
+#include <cmath>
+
+const float PlacedInstances::IMPOSTOR_FADE_FRACTION = 0.1f;
+
+PlacedInstances::PlacedInstances()
+    : sizeX_(1.0f),
+    sizeZ_(1.0f),
+    cellsPerSide_(1),
+    version_(0)
+{
+
+}
+
+void PlacedInstances::reset(float sizeX, float sizeZ, int cellsPerSide)
+{
+    sizeX_ = sizeX;
+    sizeZ_ = sizeZ;
+    cellsPerSide_ = cellsPerSide;
+    groups_.clear();
+    pending_.clear();
+    transforms_.clear();
+}
+
+void PlacedInstances::add(const Mesh* mesh, const Material* material, const Bounds &localBounds, const Matrix4x4 &localToWorld,
+    const Impostor* impostor, float impostorDistance)
+{
+    addInstance(findGroup(mesh, material, impostor, impostorDistance), localBounds, localToWorld);
+}
+
+void PlacedInstances::addImpostor(const Impostor* impostor, float impostorDistance, const Bounds &localBounds, const Matrix4x4 &rootToWorld)
+{
+    addInstance(findGroup(nullptr, nullptr, impostor, impostorDistance), localBounds, rootToWorld);
+}
+
+void PlacedInstances::addInstance(int groupIndex, const Bounds &localBounds, const Matrix4x4 &localToWorld)
+{
+    // Find the world space bounds from the corners of the local bounds
+    const Point3 min = localBounds.min();
+    const Point3 max = localBounds.max();
+    Bounds bounds;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const Point3 local((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+        const Point3 world = localToWorld * local;
+        if (corner == 0)
+        {
+            bounds = Bounds(world, world);
+        }
+        else
+        {
+            bounds.expandToCover(world);
+        }
+    }
+
+    PendingGroup& group = pending_[groupIndex];
+    group.transforms.push_back(localToWorld);
+    group.bounds.push_back(bounds);
+    group.cells.push_back(findCell(bounds.centre().x, bounds.centre().z));
+}
+
+void PlacedInstances::build()
+{
+    const size_t cellCount = (size_t)cellsPerSide_ * cellsPerSide_;
+
+    transforms_.clear();
+    for (size_t groupIndex = 0; groupIndex < groups_.size(); ++groupIndex)
+    {
+        Group& group = groups_[groupIndex];
+        const PendingGroup& pending = pending_[groupIndex];
+        group.firstInstance = (uint32_t)transforms_.size();
+
+        // Count the instances in each cell to find where each cell starts
+        group.cellStarts.assign(cellCount + 1, 0);
+        for (uint32_t cell : pending.cells)
+        {
+            group.cellStarts[cell + 1]++;
+        }
+        for (size_t cell = 0; cell < cellCount; ++cell)
+        {
+            group.cellStarts[cell + 1] += group.cellStarts[cell];
+        }
+
+        // Place each instance in its cell, and grow the bounds of the cell to cover it
+        std::vector<uint32_t> cellEnds(group.cellStarts.begin(), group.cellStarts.end() - 1);
+        group.cellBounds.assign(cellCount, Bounds());
+        transforms_.resize(group.firstInstance + pending.transforms.size());
+        for (size_t i = 0; i < pending.transforms.size(); ++i)
+        {
+            const uint32_t cell = pending.cells[i];
+            if (cellEnds[cell] == group.cellStarts[cell])
+            {
+                group.cellBounds[cell] = pending.bounds[i];
+            }
+            else
+            {
+                group.cellBounds[cell].expandToCover(pending.bounds[i].min());
+                group.cellBounds[cell].expandToCover(pending.bounds[i].max());
+            }
+
+            transforms_[group.firstInstance + cellEnds[cell]] = pending.transforms[i];
+            cellEnds[cell]++;
+        }
+    }
+
+    version_++;
+}
+
+void PlacedInstances::findVisible(const Frustum &frustum, const Point3 &viewPosition, float distanceScale, std::vector<DrawRange> &ranges) const
+{
+    ranges.clear();
+
+    for (size_t groupIndex = 0; groupIndex < groups_.size(); ++groupIndex)
+    {
+        const Group& group = groups_[groupIndex];
+        if (group.cellStarts.empty())
+        {
+            continue;
+        }
+
+        // Meshes are drawn out to the end of the fade, and impostors from its start
+        float fadeStart, fadeLength;
+        impostorFade(group, distanceScale, fadeStart, fadeLength);
+        const bool isImpostor = (group.mesh == nullptr);
+        const bool fades = (group.impostor != nullptr);
+        const float sqrFadeStart = fadeStart * fadeStart;
+        const float sqrFadeEnd = (fadeStart + fadeLength) * (fadeStart + fadeLength);
+
+        // Visible cells that follow on from each other are merged into a single range
+        bool open = false;
+        for (size_t cell = 0; cell + 1 < group.cellStarts.size(); ++cell)
+        {
+            const uint32_t start = group.cellStarts[cell];
+            const uint32_t end = group.cellStarts[cell + 1];
+            if (start == end)
+            {
+                continue;
+            }
+
+            const Bounds& bounds = group.cellBounds[cell];
+            bool visible = frustum.intersects(bounds);
+            if (visible && fades && isImpostor)
+            {
+                visible = bounds.sqrFarthestDistance(viewPosition) >= sqrFadeStart;
+            }
+            else if (visible && fades)
+            {
+                visible = bounds.sqrDistance(viewPosition) <= sqrFadeEnd;
+            }
+
+            if (!visible)
+            {
+                open = false;
+                continue;
+            }
+
+            if (open)
+            {
+                ranges.back().count = group.firstInstance + end - ranges.back().firstInstance;
+            }
+            else
+            {
+                ranges.push_back({ (int)groupIndex, group.firstInstance + start, end - start });
+                open = true;
+            }
+        }
+    }
+}
+
+void PlacedInstances::impostorFade(const Group &group, float distanceScale, float &fadeStart, float &fadeLength)
+{
+    if (group.impostor == nullptr)
+    {
+        fadeStart = 0.0f;
+        fadeLength = 0.0f;
+        return;
+    }
+
+    fadeStart = group.impostorDistance * distanceScale;
+    fadeLength = fadeStart * IMPOSTOR_FADE_FRACTION;
+}
+
+int PlacedInstances::findGroup(const Mesh* mesh, const Material* material, const Impostor* impostor, float impostorDistance)
+{
+    for (size_t i = 0; i < groups_.size(); ++i)
+    {
+        if (groups_[i].mesh == mesh && groups_[i].material == material
+            && groups_[i].impostor == impostor && groups_[i].impostorDistance == impostorDistance)
+        {
+            return (int)i;
+        }
+    }
+
+    Group group;
+    group.mesh = mesh;
+    group.material = material;
+    group.impostor = impostor;
+    group.impostorDistance = impostorDistance;
+    group.firstInstance = 0;
+    groups_.push_back(group);
+    pending_.push_back(PendingGroup());
+    return (int)groups_.size() - 1;
+}
+
+uint32_t PlacedInstances::findCell(float x, float z) const
+{
+    const int cellX = std::min(std::max((int)(x / sizeX_ * cellsPerSide_), 0), cellsPerSide_ - 1);
+    const int cellZ = std::min(std::max((int)(z / sizeZ_ * cellsPerSide_), 0), cellsPerSide_ - 1);
+    return (uint32_t)(cellX + cellZ * cellsPerSide_);
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Bounds.h"
+#include "Math/Frustum.h"
+#include "Math/Matrix4x4.h"
+
+class Mesh;
+class Material;
+class Impostor;
+
+// Many copies of static meshes placed across the terrain, drawn with instancing instead of
+// as separate GameObjects.
+//
+// Instances are grouped by mesh and material. Within a group they are sorted by the square
+// cell of the terrain they are in, so the instances of each cell are contiguous. Cells are
+// culled as a whole, and runs of visible cells are drawn with a single instanced draw call.
+//
+// Far from the viewer, meshes can be replaced by impostors, which have groups of their own.
+// Cells whose instances are all beyond the fade are only drawn as impostors, and cells whose
+// instances are all before it are only drawn as meshes.
+class PlacedInstances
+{
+public:
+    // The fraction of its impostor distance that a mesh cross-fades to its impostor over
+    static const float IMPOSTOR_FADE_FRACTION;
+
+    // The instances of a single mesh and material, or of an impostor
+    struct Group
+    {
+        // Null for impostor groups
+        const Mesh* mesh;
+        const Material* material;
+
+        // For mesh groups, the impostor that replaces the meshes far from the viewer, if any.
+        // For impostor groups, the impostor drawn for each instance.
+        const Impostor* impostor;
+
+        // The distance from the viewer that meshes start fading out to the impostor at
+        float impostorDistance;
+
+        // The first instance of the group in transforms()
+        uint32_t firstInstance;
+
+        // The first instance of each cell, relative to firstInstance,
+        // with an extra entry at the end for the end of the last cell
+        std::vector<uint32_t> cellStarts;
+
+        // The world space bounds of the instances in each cell
+        std::vector<Bounds> cellBounds;
+    };
+
+    // A run of instances of a group to draw, as a range of transforms()
+    struct DrawRange
+    {
+        int group;
+        uint32_t firstInstance;
+        uint32_t count;
+    };
+
+    PlacedInstances();
+
+    // Removes every instance, and sets up the cells covering the area from the origin to (sizeX, sizeZ)
+    void reset(float sizeX, float sizeZ, int cellsPerSide);
+
+    // Adds an instance of a mesh. The local bounds of the mesh are used for culling.
+    // When an impostor is given, the mesh fades out to it from impostorDistance onwards.
+    void add(const Mesh* mesh, const Material* material, const Bounds &localBounds, const Matrix4x4 &localToWorld,
+        const Impostor* impostor = nullptr, float impostorDistance = 0.0f);
+
+    // Adds an instance of an impostor, which fades in from impostorDistance onwards.
+    // The local bounds cover the impostor relative to its root.
+    void addImpostor(const Impostor* impostor, float impostorDistance, const Bounds &localBounds, const Matrix4x4 &rootToWorld);
+
+    // Sorts the instances into cells. Must be called after adding instances, before they are drawn.
+    void build();
+
+    // Finds the runs of instances in cells that intersect a frustum. Mesh cells are skipped when all of
+    // their instances have faded out to impostors, and impostor cells when none of them have started
+    // to fade in. Impostor distances are measured from the view position and multiplied by distanceScale.
+    void findVisible(const Frustum &frustum, const Point3 &viewPosition, float distanceScale, std::vector<DrawRange> &ranges) const;
+
+    // The distance from the viewer a group starts fading to its impostor at, and the length of the fade.
+    // Zero when the group has no impostor.
+    static void impostorFade(const Group &group, float distanceScale, float &fadeStart, float &fadeLength);
+
+    const std::vector<Group>& groups() const { return groups_; }
+
+    // The transform of every instance, in the order of the groups and their cells
+    const std::vector<Matrix4x4>& transforms() const { return transforms_; }
+
+    int cellsPerSide() const { return cellsPerSide_; }
+    int instanceCount() const { return (int)transforms_.size(); }
+
+    // Incremented by every build, so the transforms are only uploaded when they change
+    uint64_t version() const { return version_; }
+
+private:
+    float sizeX_;
+    float sizeZ_;
+    int cellsPerSide_;
+    uint64_t version_;
+
+    std::vector<Group> groups_;
+    std::vector<Matrix4x4> transforms_;
+
+    // The instances added to each group, in the order they were added.
+    // The arrays are in parallel, with one entry per instance.
+    struct PendingGroup
+    {
+        std::vector<Matrix4x4> transforms;
+        std::vector<Bounds> bounds;
+        std::vector<uint32_t> cells;
+    };
+    std::vector<PendingGroup> pending_;
+
+    // Finds the group for a mesh and material, or an impostor, adding one if needed
+    int findGroup(const Mesh* mesh, const Material* material, const Impostor* impostor, float impostorDistance);
+
+    // Adds an instance to a group, finding its world space bounds from its local bounds
+    void addInstance(int group, const Bounds &localBounds, const Matrix4x4 &localToWorld);
+
+    // The cell containing a point
+    uint32_t findCell(float x, float z) const;
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "PlacementMask.h"
+
+#include <algorithm>
+
+#include "Heightfield.h"
+
+PlacementMask::PlacementMask()
+    : resolution_(0),
+    texelsPerMetreX_(0.0f),
+    texelsPerMetreZ_(0.0f),
+    allowedCount_(0)
+{
+
+}
+
+void PlacementMask::build(const Heightfield& heightfield, float minHeight, float maxHeight, float minNormalY)
+{
+    resolution_ = heightfield.resolution();
+    texelsPerMetreX_ = (resolution_ - 1) / heightfield.sizeX();
+    texelsPerMetreZ_ = (resolution_ - 1) / heightfield.sizeZ();
+    allowedCount_ = 0;
+
+    // Compare the raw heights, rather than adding the offset to every texel
+    const float minRawHeight = minHeight - heightfield.heightOffset();
+    const float maxRawHeight = maxHeight - heightfield.heightOffset();
+
+    const std::vector<float>& heights = heightfield.heights();
+    const std::vector<float>& normals = heightfield.normals();
+    const size_t texelCount = (size_t)resolution_ * resolution_;
+    flags_.resize(texelCount);
+    for (size_t i = 0; i < texelCount; ++i)
+    {
+        const bool allowed = heights[i] >= minRawHeight && heights[i] <= maxRawHeight && normals[i * 4 + 1] >= minNormalY;
+        flags_[i] = allowed ? 1 : 0;
+        allowedCount_ += allowed ? 1 : 0;
+    }
+}
+
+bool PlacementMask::allowed(float x, float z) const
+{
+    if (resolution_ == 0)
+    {
+        return false;
+    }
+
+    const int texelX = std::min(std::max((int)(x * texelsPerMetreX_ + 0.5f), 0), resolution_ - 1);
+    const int texelZ = std::min(std::max((int)(z * texelsPerMetreZ_ + 0.5f), 0), resolution_ - 1);
+    return flags_[texelX + (size_t)texelZ * resolution_] != 0;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Heightfield;
+
+// A grid of flags marking where on a heightfield things may be placed.
+//
+// The mask is built once from altitude and slope limits, so placement can test
+// each candidate point with a single lookup instead of sampling heights and normals.
+class PlacementMask
+{
+public:
+    PlacementMask();
+
+    // Marks the texels with a height between minHeight and maxHeight, and a normal with a y component of at least minNormalY.
+    // Heights include the heightfield's height offset.
+    void build(const Heightfield &heightfield, float minHeight, float maxHeight, float minNormalY);
+
+    // Whether the texel nearest to a point is marked. Points outside the mask are clamped to its edge.
+    // Nothing is marked before the mask is built.
+    bool allowed(float x, float z) const;
+
+    int resolution() const { return resolution_; }
+
+    // The number of marked texels
+    int allowedCount() const { return allowedCount_; }
+
+private:
+    int resolution_;
+    float texelsPerMetreX_;
+    float texelsPerMetreZ_;
+    int allowedCount_;
+
+    // A flag for each texel, in rows of increasing z
+    std::vector<uint8_t> flags_;
+};
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "PoissonDiskSampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PlacementMask.h"
+
+PoissonDiskSampler::PoissonDiskSampler()
+    : cellSize_(1.0f),
+    gridWidth_(0),
+    gridHeight_(0)
+{
+
+}
+
+void PoissonDiskSampler::generate(const Vector2& min, const Vector2& max, float radius, const PlacementMask* mask, int maxPoints,
+    RandomStream& random, std::vector<Vector2>& points)
+{
+    points.clear();
+    active_.clear();
+
+    const float width = max.x - min.x;
+    const float height = max.y - min.y;
+    if (!(radius > 0.0f) || !(width > 0.0f) || !(height > 0.0f) || maxPoints <= 0)
+    {
+        return;
+    }
+
+    // A cell's diagonal is the radius, so each cell can hold at most one point
+    const float minRadius = sqrtf(2.0f * width * height / MAX_GRID_CELLS);
+    radius = std::max(radius, minRadius);
+    min_ = min;
+    cellSize_ = radius / sqrtf(2.0f);
+    gridWidth_ = std::max((int)ceilf(width / cellSize_), 1);
+    gridHeight_ = std::max((int)ceilf(height / cellSize_), 1);
+    grid_.assign((size_t)gridWidth_ * gridHeight_, -1);
+
+    const float sqrRadius = radius * radius;
+    int seedAttempts = 0;
+    while (true)
+    {
+        // Start a new area from a random point. This also finds parts of the mask that
+        // aren't connected to the areas already filled.
+        if (active_.empty())
+        {
+            if (seedAttempts >= MAX_SEED_ATTEMPTS)
+            {
+                break;
+            }
+
+            seedAttempts++;
+            const Vector2 seed(random.nextFloat(min.x, max.x), random.nextFloat(min.y, max.y));
+            if ((mask == nullptr || mask->allowed(seed.x, seed.y)) && farFromOthers(seed, radius, points))
+            {
+                add(seed, points);
+            }
+            continue;
+        }
+
+        // Try candidates between one and two radii from a random active point
+        const int activeIndex = (int)(random.nextUint() % active_.size());
+        const Vector2 centre = points[active_[activeIndex]];
+        bool found = false;
+        for (int i = 0; i < CANDIDATES_PER_POINT && !found; ++i)
+        {
+            // Pick offsets in a square until one lands in the ring, which avoids trigonometry
+            Vector2 offset;
+            float sqrDistance;
+            do
+            {
+                offset = Vector2(random.nextFloat(-2.0f * radius, 2.0f * radius), random.nextFloat(-2.0f * radius, 2.0f * radius));
+                sqrDistance = offset.sqrMagnitude();
+            } while (sqrDistance < sqrRadius || sqrDistance > 4.0f * sqrRadius);
+
+            const Vector2 candidate = centre + offset;
+            if (candidate.x < min.x || candidate.x >= max.x || candidate.y < min.y || candidate.y >= max.y)
+            {
+                continue;
+            }
+
+            // The mask is a single lookup, so test it before the neighbours
+            if ((mask == nullptr || mask->allowed(candidate.x, candidate.y)) && farFromOthers(candidate, radius, points))
+            {
+                add(candidate, points);
+                found = true;
+            }
+        }
+
+        // Retire the point once there is no room left around it
+        if (!found)
+        {
+            active_[activeIndex] = active_.back();
+            active_.pop_back();
+        }
+    }
+
+    // Keep a random subset, picked with a partial shuffle
+    if ((int)points.size() > maxPoints)
+    {
+        for (int i = 0; i < maxPoints; ++i)
+        {
+            const int j = i + (int)(random.nextUint() % (uint32_t)(points.size() - i));
+            std::swap(points[i], points[j]);
+        }
+        points.resize(maxPoints);
+    }
+}
+
+bool PoissonDiskSampler::farFromOthers(const Vector2& point, float radius, const std::vector<Vector2>& points) const
+{
+    // Any point within the radius is at most two cells away
+    const int x = cellX(point.x);
+    const int y = cellY(point.y);
+    const int minX = std::max(x - 2, 0);
+    const int maxX = std::min(x + 2, gridWidth_ - 1);
+    const int minY = std::max(y - 2, 0);
+    const int maxY = std::min(y + 2, gridHeight_ - 1);
+
+    const float sqrRadius = radius * radius;
+    for (int cy = minY; cy <= maxY; ++cy)
+    {
+        for (int cx = minX; cx <= maxX; ++cx)
+        {
+            const int index = grid_[cx + (size_t)cy * gridWidth_];
+            if (index >= 0 && (points[index] - point).sqrMagnitude() < sqrRadius)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void PoissonDiskSampler::add(const Vector2& point, std::vector<Vector2>& points)
+{
+    const int index = (int)points.size();
+    points.push_back(point);
+    grid_[cellX(point.x) + (size_t)cellY(point.y) * gridWidth_] = index;
+    active_.push_back(index);
+}
+
+int PoissonDiskSampler::cellX(float x) const
+{
+    return std::min(std::max((int)((x - min_.x) / cellSize_), 0), gridWidth_ - 1);
+}
+
+int PoissonDiskSampler::cellY(float y) const
+{
+    return std::min(std::max((int)((y - min_.y) / cellSize_), 0), gridHeight_ - 1);
+}
\ No newline at end of file
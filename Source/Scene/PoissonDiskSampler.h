@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include "Math/Random.h"
+#include "Math/Vector2.h"
+
+class PlacementMask;
+
+// Picks random points in a rectangle with no two points closer than a minimum distance,
+// using Bridson's algorithm.
+//
+// Each new point is tried around an existing one, and a grid with at most one point
+// per cell finds the neighbours it must be checked against. The work done is proportional
+// to the number of points found rather than to the number of candidates rejected.
+// Points come from a random stream, so the same seed always gives the same points.
+class PoissonDiskSampler
+{
+public:
+    // The number of candidates tried around a point before it is retired
+    const static int CANDIDATES_PER_POINT = 30;
+
+    // The number of random points tried to start a new area when every area so far is full
+    const static int MAX_SEED_ATTEMPTS = 30;
+
+    // The largest grid used. Larger radii are used when the rectangle would need more cells.
+    const static int MAX_GRID_CELLS = 1 << 22;
+
+    PoissonDiskSampler();
+
+    // Replaces the points with new points between min and max, at least radius apart.
+    // Only points the mask allows are kept, or any point if the mask is null. When more than maxPoints
+    // are found, a random subset of them is kept, so the points still cover the whole rectangle.
+    void generate(const Vector2 &min, const Vector2 &max, float radius, const PlacementMask* mask, int maxPoints,
+        RandomStream &random, std::vector<Vector2> &points);
+
+private:
+    Vector2 min_;
+    float cellSize_;
+    int gridWidth_;
+    int gridHeight_;
+
+    // The index of the point in each cell of the grid, or -1 for empty cells
+    std::vector<int> grid_;
+
+    // The points that new points are still being tried around
+    std::vector<int> active_;
+
+    // Whether a point is at least radius from every point in the grid
+    bool farFromOthers(const Vector2 &point, float radius, const std::vector<Vector2> &points) const;
+
+    // Adds a point to the list and the grid, and starts trying points around it
+    void add(const Vector2 &point, std::vector<Vector2> &points);
+
+    // The cell of the grid containing a point
+    int cellX(float x) const;
+    int cellY(float y) const;
+};
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "PrefabPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Editor/PropertiesPanel.h"
+#include "Scene/GameObject.h"
+#include "Scene/Transform.h"
+#include "Serialization/Prefab.h"
+#include "SceneManager.h"
+
+PrefabPool::PrefabPool(Prefab* prefab)
+    : prefab_(prefab),
+    instanceCount_(0),
+    createdCount_(0)
+{
+
+}
+
+PrefabPool::~PrefabPool()
+{
+    clear();
+}
+
+void PrefabPool::prewarm(int count)
+{
+    // Instances in the scene count too, as they come back when they are destroyed
+    while ((int)instanceCount_ < count)
+    {
+        GameObject* gameObject = create();
+        SceneManager::instance()->deactivateGameObject(gameObject);
+        released_.push_back(gameObject);
+    }
+}
+
+GameObject* PrefabPool::acquire()
+{
+    if (released_.empty())
+    {
+        return create();
+    }
+
+    GameObject* gameObject = released_.back();
+    released_.pop_back();
+    SceneManager::instance()->activateGameObject(gameObject);
+    return gameObject;
+}
+
+void PrefabPool::release(GameObject* gameObject)
+{
+    assert(gameObject->prefabPool_ == this);
+    assert(std::find(released_.begin(), released_.end(), gameObject) == released_.end());
+
+    // Keep the instance as a root, so it isn't deleted along with anything else
+    gameObject->transform()->setParentTransform(nullptr);
+
+    // Ensure the properties panel isnt still showing the object
+    if (PropertiesPanel::instance()->current() == gameObject)
+    {
+        PropertiesPanel::instance()->inspect(nullptr);
+    }
+
+    SceneManager::instance()->deactivateGameObject(gameObject);
+    released_.push_back(gameObject);
+}
+
+void PrefabPool::clear()
+{
+    for (GameObject* gameObject : released_)
+    {
+        delete gameObject;
+    }
+    released_.clear();
+}
+
+GameObject* PrefabPool::create()
+{
+    GameObject* gameObject = new GameObject(prefab_->resourceName(), prefab_);
+    gameObject->prefabPool_ = this;
+    instanceCount_++;
+    createdCount_++;
+    return gameObject;
+}
+
+void PrefabPool::instanceDeleted()
+{
+    assert(instanceCount_ > 0);
+    instanceCount_--;
+}
\ No newline at end of file
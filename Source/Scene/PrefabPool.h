@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+class GameObject;
+class Prefab;
+
+// Keeps instances of a prefab for reuse, for things that are created and destroyed all the time, such as projectiles.
+//
+// Creating a gameobject from a prefab allocates every component and reads the prefab's properties.
+// A released instance skips all of that: it is taken out of the scene, with its components removed from
+// the scene's lists and reset by their resetForReuse hooks, and put back into the scene when it is acquired.
+// Pooled instances are roots, so deleting another gameobject never deletes them.
+class PrefabPool
+{
+    friend class GameObject;
+
+public:
+    explicit PrefabPool(Prefab* prefab);
+
+    // Deletes the released instances. Acquired instances are left in the scene.
+    ~PrefabPool();
+
+    // Prevent the pool from being copied, as its instances point back at it
+    PrefabPool(const PrefabPool&) = delete;
+    PrefabPool& operator=(const PrefabPool&) = delete;
+
+    Prefab* prefab() const { return prefab_; }
+
+    // Creates released instances ahead of time, until the pool has made at least count instances that
+    // are still around, so that many acquires won't have to. Calling it again with the same count does nothing.
+    void prewarm(int count);
+
+    // Gets an instance of the prefab in the scene, reusing a released one when there is one.
+    // Must not be called during the updates. Use SceneManager::spawnPooledGameObject from components.
+    GameObject* acquire();
+
+    // Takes an instance out of the scene and keeps it for the next acquire.
+    // Must not be called during the updates. SceneManager::destroyGameObject releases pooled instances.
+    void release(GameObject* gameObject);
+
+    // Deletes the released instances
+    void clear();
+
+    // The number of released instances waiting to be reused, the number of instances that haven't
+    // been deleted, released or in the scene, and the number created in total
+    size_t releasedCount() const { return released_.size(); }
+    size_t instanceCount() const { return instanceCount_; }
+    size_t createdCount() const { return createdCount_; }
+
+private:
+    Prefab* prefab_;
+    std::vector<GameObject*> released_;
+    size_t instanceCount_;
+    size_t createdCount_;
+
+    GameObject* create();
+
+    // Called by the destructor of each instance
+    void instanceDeleted();
+};
\ No newline at end of file
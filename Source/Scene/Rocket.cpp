@@ -31,8 +31,9 @@ void Rocket::handleCollision(Collider* collider)
         chopper->takeDamage(damage_);
     }
 	
-    // Delete gameObject on collision
-    delete gameObject();
+    // Delete gameObject on collision, once the rigidbody that found the collision has finished with it.
+    // Rockets fired by turrets go back to the prefab's pool instead.
+    SceneManager::instance()->destroyGameObject(gameObject());
 }
 
 void Rocket::setRocketSpeed(float speed)
@@ -9,6 +9,9 @@ class Quaternion;
 class Rocket : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Rocket;
+    ComponentType componentType() const override { return TYPE; }
+
     Rocket(GameObject* gameObject);
 
     void drawProperties() override;
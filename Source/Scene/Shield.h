@@ -5,6 +5,9 @@
 class Shield : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Shield;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit Shield(GameObject* gameObject);
 
     // Basic property getters
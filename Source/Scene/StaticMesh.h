@@ -8,6 +8,9 @@
 class StaticMesh : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::StaticMesh;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit StaticMesh(GameObject* gameObject);
     ~StaticMesh() override { }
 
@@ -2,6 +2,7 @@
 #include "SceneManager.h"
 
 #include "Physics/Rigidbody.h"
+#include "Scene/Terrain.h"
 
 #include "imgui.h"
 
@@ -16,17 +17,39 @@ StaticTurret::StaticTurret(GameObject* gameObject)
 
 void StaticTurret::update(float)
 {
+    const ComponentView<Helicopter> helicopters = SceneManager::instance()->findAllComponentsInScene<Helicopter>();
+    if (helicopters.empty())
+    {
+        // The turrets remain still when no helicopters are in the scene
+        return;
+    }
+
+    // The turret needs a rotating base with a barrel, which is also where it looks from.
+    // Turrets made from the create menu have neither until they are added.
+    const std::vector<Transform*> children = transform_->children();
+    if (children.empty())
+    {
+        return;
+    }
+    const std::vector<Transform*> grandchildren = children[0]->children();
+    if (grandchildren.empty())
+    {
+        return;
+    }
+    const Point3 lineOfSightOrigin = grandchildren[0]->positionWorld();
+    const ComponentView<Terrain> terrains = SceneManager::instance()->findAllComponentsInScene<Terrain>();
+
     // Pointer to chopper and vector storing 
     Helicopter* chopper = nullptr;
     float closestHeliDistanceSqr = 9999999.0f;
 
     // Find closest chopper
-    for (Helicopter* helicopter : SceneManager::instance()->findAllComponentsInScene<Helicopter>())
+    for (Helicopter* helicopter : helicopters)
     {
         Vector3 vectorToHeli = transform_->positionWorld() - helicopter->transform()->positionWorld();
 
         const float heliDistanceSqr = (vectorToHeli.sqrMagnitude());
-        if (heliDistanceSqr < closestHeliDistanceSqr)
+        if (heliDistanceSqr < closestHeliDistanceSqr && hasLineOfSight(terrains, lineOfSightOrigin, helicopter->transform()->positionWorld()))
         {
             closestHeliDistanceSqr = heliDistanceSqr;
             chopper = helicopter;
@@ -35,13 +58,10 @@ void StaticTurret::update(float)
 
     if(chopper == nullptr)
     {
-        // The turrets remain still when no helicopters are in the scene
+        // The turrets remain still when all the helicopters are hidden by the terrain
         return;
     }
 
-    const std::vector<Transform*> children = transform_->children();
-    const std::vector<Transform*> grandchildren = children[0]->children();
-
     // Vector from turret to chopper
     Vector3 chopperVector = getChopperPredictedPosition(chopper);
     
@@ -74,4 +94,19 @@ Vector3 StaticTurret::getChopperPredictedPosition(Helicopter* chopper)
     predictedChopperPos.y += (0.5 * 9.7 * t * t);
 
     return predictedChopperPos;
+}
+
+bool StaticTurret::hasLineOfSight(const ComponentView<Terrain>& terrains, const Point3& from, const Point3& to) const
+{
+    // Sweep the sight line through the terrains
+    HeightfieldHit hit;
+    for (const Terrain* terrain : terrains)
+    {
+        if (terrain->sweepSegment(from, to, hit))
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
\ No newline at end of file
@@ -1,12 +1,18 @@
 #pragma once
 
 #include "Scene/Component.h"
+#include "Scene/ComponentView.h"
 #include "Scene/Transform.h"
 #include "Scene/Helicopter.h"
 
+class Terrain;
+
 class StaticTurret : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::StaticTurret;
+    ComponentType componentType() const override { return TYPE; }
+
     StaticTurret(GameObject* gameObject);
 
     void update(float deltaTime) override;
@@ -18,4 +24,7 @@ private:
     float rotationSpeed_ = 90.0f;
 
     Vector3 getChopperPredictedPosition(Helicopter* chopper);
+
+    // Checks that none of the terrains block the line between two points
+    bool hasLineOfSight(const ComponentView<Terrain>& terrains, const Point3& from, const Point3& to) const;
 };
\ No newline at end of file
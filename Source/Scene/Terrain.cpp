@@ -1,11 +1,16 @@
 #include "Terrain.h"
 
+#include <math.h>
 #include <imgui.h>
 #include "Utils/ImGuiExtensions.h"
 #include "Renderer/Material.h"
 
 #include "Math/Random.h"
 
+#include "Physics/Collider.h"
+#include "Scene/PlacementMask.h"
+#include "Scene/PoissonDiskSampler.h"
+#include "Scene/StaticMesh.h"
 #include "Scene/Transform.h"
 #include "Serialization/Prefab.h"
 #include "Utils/Clock.h"
@@ -27,26 +32,76 @@ void TerrainObject::serialize(PropertyTable& table)
     table.serialize("min_altitude", minAltitude, 0.0f);
     table.serialize("max_altitude", maxAltitude, 1000.0f);
     table.serialize("max_slope", maxSlope, 1.0f);
+    table.serialize("min_spacing", minSpacing, 20.0f);
     table.serialize("min_instances", minInstances, 1);
     table.serialize("max_instances", maxInstances, 100);
     table.serialize("seed", seed, 0);
+    table.serialize("impostor_distance", impostorDistance, 0.0f);
 }
 
+bool TerrainObject::samePlacement(const TerrainObject& other) const
+{
+    return prefab == other.prefab
+        && minAltitude == other.minAltitude
+        && maxAltitude == other.maxAltitude
+        && maxSlope == other.maxSlope
+        && minSpacing == other.minSpacing
+        && minInstances == other.minInstances
+        && maxInstances == other.maxInstances
+        && seed == other.seed;
+}
+
+namespace
+{
+    // The point along a segment where a coordinate, measured in tiles, next crosses a tile edge after t.
+    // The coordinate is from + delta * t. Returns a point past the end if it never crosses one.
+    float nextCrossing(float from, float delta, float t)
+    {
+        const float position = from + delta * t;
+        if (delta > 0.0f)
+        {
+            return (floorf(position) + 1.0f - from) / delta;
+        }
+        if (delta < 0.0f)
+        {
+            return (ceilf(position) - 1.0f - from) / delta;
+        }
+        return 2.0f;
+    }
+}
+
+const uint32_t Terrain::PLACEMENT_VERSION;
+const char* const Terrain::TILE_CACHE_DIRECTORY = "TerrainTiles";
+const char* const Terrain::BAKE_DIRECTORY = "TerrainBakes";
+
 Terrain::Terrain(GameObject* gameObject)
     : Component(gameObject),
     heightMap_(TextureFormat::R16, HEIGHTMAP_RESOLUTION, HEIGHTMAP_RESOLUTION),
+    detailMesh_(nullptr),
+    detailMaterial_(nullptr),
+    detailScale_(Vector2::one()),
     detailAltitudeLimits_(Vector2(0.0f, 500.0f)),
     detailSlopeLimit_(0.0f),
+    detailSpacing_(2.0f),
     dimensions_(Vector3(1024.0f, 80.0f, 1024.0f)),
     seed_(0),
     fractalSmoothness_(2.0f),
     mountainScale_(4.0f),
     islandFactor_(2.0f),
     waterColor_(Color(0.05f, 0.066f, 0.093f)),
-    waterDepth_(30.0f)
+    waterDepth_(30.0f),
+    maxHeight_(1.0f),
+    bakedKey_(0),
+    streamedResolution_(0),
+    streamingBudget_(64),
+    tileStreamer_(nullptr),
+    activeStreamedResolution_(0),
+    activeStreamingBudget_(0),
+    detailVersion_(0),
+    detailPlacement_(),
+    placementVersion_(0),
+    placementWaterDepth_(0.0f)
 {
-    mesh_ = ResourceManager::instance()->load<Mesh>("Resources/Meshes/terrain.obj");
-
     // Ensure bilinear filtering is used on the heightmap
     heightMap_.setFilterMode(TextureFilterMode::Bilinear);
 
@@ -55,18 +110,19 @@ Terrain::Terrain(GameObject* gameObject)
     layer.material = ResourceManager::instance()->load<Material>("Resources/Materials/ground_rock_01.material");
     terrainLayers_.push_back(layer);
 
-    generateTerrain();
+    loadOrGenerateTerrain();
 }
 
 Terrain::~Terrain()
 {
     // Delete all the sub-objects when the terrain is deleted.
-    for (GameObject* go : placedObjectInstances_)
+    for (PlacedObjectLayer& layer : placedObjectLayers_)
     {
-        delete go;
+        destroyLayerInstances(layer);
     }
-    placedObjectInstances_.clear();
+    placedObjectLayers_.clear();
 
+    delete tileStreamer_;
 }
 
 void Terrain::drawProperties()
@@ -117,22 +173,32 @@ void Terrain::serialize(PropertyTable &table)
     table.serialize("factal_smoothness", fractalSmoothness_, 2.0f);
     table.serialize("mountain_scale", mountainScale_, 4.0f);
     table.serialize("island_factor", islandFactor_, 2.0f);
+    table.serialize("streamed_resolution", streamedResolution_, 0);
+    table.serialize("streaming_budget", streamingBudget_, 64);
     table.serialize("detail_mesh", detailMesh_);
     table.serialize("detail_material", detailMaterial_);
     table.serialize("detail_scale", detailScale_, Vector2::one());
     table.serialize("detail_altitude_limits", detailAltitudeLimits_, Vector2(0.0f, 500.0f));
     table.serialize("detail_slope_limit", detailSlopeLimit_, 0.0f);
+    table.serialize("detail_spacing", detailSpacing_, 2.0f);
 
     // If we read in some new properties, the terrain needs regenerating.
+    // When saving, bake the terrain so it can be loaded without generating it next time.
     if (table.mode() == PropertyTableMode::Reading)
     {
-        generateTerrain();
+        loadOrGenerateTerrain();
+    }
+    else if (bakeKey() != bakedKey_)
+    {
+        saveBake(bakeKey());
     }
 }
 
 void Terrain::drawGenerationProperties()
 {
-    bool terrainGenerationNeeded = ImGui::DragFloat3("Size", &dimensions_.x, 1.0f, 1.0f, 4096.0f);
+    // Streamed heightmaps keep the same detail over larger terrains
+    const float maxSize = 4096.0f * std::max(1, streamedResolution_ / HEIGHTMAP_RESOLUTION);
+    bool terrainGenerationNeeded = ImGui::DragFloat3("Size", &dimensions_.x, 1.0f, 1.0f, maxSize);
     terrainGenerationNeeded |= ImGui::DragFloat("Water Depth", &waterDepth_, 0.1f, 0.0f, 100.0f);
     ImGui::Spacing();
 
@@ -140,14 +206,28 @@ void Terrain::drawGenerationProperties()
     ImGui::SameLine();
     if (ImGui::Button("Randomise"))
     {
-        srand((int)Clock::instance()->frameCount());
-        seed_ = rand();
+        seed_ = (int)(RandomStream(Clock::instance()->frameCount()).nextUint() & 0x7FFFFFFF);
         terrainGenerationNeeded = true;
     }
 
     terrainGenerationNeeded |= ImGui::DragFloat("Fractal Smoothness", &fractalSmoothness_, 0.01f, 1.5f, 2.5f);
     terrainGenerationNeeded |= ImGui::DragFloat("Mountain Scale", &mountainScale_, 0.05f, 1.0f, 10.0f);
     terrainGenerationNeeded |= ImGui::DragFloat("Island Factor", &islandFactor_, 0.05f, 0.1f, 20.0f);
+    ImGui::Spacing();
+
+    // Streaming uses a heightmap larger than the heightmap texture, loaded in tiles around the camera
+    const char* streamingOptions[] = { "Off", "2048", "4096", "8192", "16384" };
+    int streamingOption = (streamedResolution_ == 0) ? 0 : (int)log2f((float)streamedResolution_) - 10;
+    if (ImGui::Combo("Streamed Resolution", &streamingOption, streamingOptions, 5))
+    {
+        streamedResolution_ = (streamingOption == 0) ? 0 : 1 << (streamingOption + 10);
+        terrainGenerationNeeded = true;
+    }
+    terrainGenerationNeeded |= ImGui::DragInt("Streaming Budget (MB)", &streamingBudget_, 1.0f, 8, 1024);
+    if (tileStreamer_ != nullptr)
+    {
+        ImGui::Text("Resident tiles: %d / %d", tileStreamer_->residentCount(), tileStreamer_->slotCount());
+    }
 
     // If any generation property was modified, regenerate the terrain.
     if (terrainGenerationNeeded)
@@ -163,11 +243,12 @@ void Terrain::drawDetailsProperties()
     detailsNeedPlacing |= ImGui::DragFloatRange2("Detail Scale", &detailScale_.x, &detailScale_.y, 0.05f, 0.01f, 100.0f);
     detailsNeedPlacing |= ImGui::DragFloatRange2("Altitude Limits", &detailAltitudeLimits_.x, &detailAltitudeLimits_.y, 0.5f, -100.0f, 500.0f);
     detailsNeedPlacing |= ImGui::DragFloat("Slope Limit", &detailSlopeLimit_, 0.05f, 0.0f, 1.0f);
+    detailsNeedPlacing |= ImGui::DragFloat("Spacing", &detailSpacing_, 0.05f, 0.25f, 20.0f);
 
     // Regenerate terrain layers when a change is detected
     if (detailsNeedPlacing)
     {
-        placeDetailMeshes();
+        generateTerrain();
     }
 }
 
@@ -183,13 +264,14 @@ void Terrain::drawObjectsProperties()
         objectsNeedPlacing |= ImGui::ResourceSelect<Prefab>("Prefab", "Select Prefab", object.prefab);
         objectsNeedPlacing |= ImGui::DragFloatRange2("Altitude Range", &object.minAltitude, &object.maxAltitude, 1.0f, -100.0f, 1000.0f);
         objectsNeedPlacing |= ImGui::DragFloat("Max Slope", &object.maxSlope, 0.005f, 0.0f, 1.0f);
+        objectsNeedPlacing |= ImGui::DragFloat("Min Spacing", &object.minSpacing, 0.5f, 1.0f, 500.0f);
         objectsNeedPlacing |= ImGui::DragIntRange2("Instances", &object.minInstances, &object.maxInstances, 1, 0, 1000);
+        objectsNeedPlacing |= ImGui::DragFloat("Impostor Distance", &object.impostorDistance, 5.0f, 0.0f, 10000.0f);
         objectsNeedPlacing |= ImGui::InputInt("Seed", &object.seed);
         ImGui::SameLine();
         if (ImGui::Button("Randomise"))
         {
-            srand((int)Clock::instance()->frameCount());
-            object.seed = rand();
+            object.seed = (int)(RandomStream(Clock::instance()->frameCount()).nextUint() & 0x7FFFFFFF);
             objectsNeedPlacing = true;
         }
 
@@ -201,13 +283,13 @@ void Terrain::drawObjectsProperties()
     if (ImGui::BigButton("Add Layer"))
     {
         placedObjects_.resize(placedObjects_.size() + 1);
-        placedObjects_.back().seed = rand();
+        placedObjects_.back().seed = (int)(random_uint() & 0x7FFFFFFF);
         objectsNeedPlacing = true;
     }
 
     if (objectsNeedPlacing)
     {
-        placeObjects();
+        generateTerrain();
     }
 }
 
@@ -245,6 +327,19 @@ void Terrain::drawAppearenceProperties()
     }
 }
 
+void Terrain::loadOrGenerateTerrain()
+{
+    // The terrain is deterministic, so a bake with the same key is identical to generating it again
+    const uint64_t key = bakeKey();
+    if (key == bakedKey_ || loadBake(key))
+    {
+        return;
+    }
+
+    generateTerrain();
+    saveBake(key);
+}
+
 void Terrain::generateTerrain()
 {
     /*
@@ -270,168 +365,498 @@ void Terrain::generateTerrain()
      *
      * Finally, the maximum height in the heightmap is found. This is used to
      * normalize the heightmap prior to storing it in a gpu-memory texture.
+     *
+     * The stages are run by a TerrainGenerator, which splits each one across
+     * multiple threads.
      */
 
-    srand(seed_);
+    // The terrain no longer matches its bake
+    bakedKey_ = 0;
+
+    const TerrainGenerationSettings settings = generationSettings();
+    heightfield_.setDimensions(HEIGHTMAP_RESOLUTION, dimensions_.x, dimensions_.z, -waterDepth_);
+    const bool heightsChanged = generator_.generate(settings, heightfield_.heights(), textureHeights_);
+
+    // Upload the changed parts of the heightmap to the gpu,
+    // and update the normals and quadtree used when querying the heightmap on the cpu
+    if (heightsChanged)
+    {
+        maxHeight_ = generator_.maxHeight();
+        uploadHeightmapChanges();
+        heightfield_.rebuildNormals();
+        heightfieldQuadtree_.build(heightfield_);
+    }
+
+    // Objects and details are placed by sampling the heightmap, and the colliders of streamed tiles are sampled the same way.
+    // The samples depend on the heights, the terrain size and the water depth.
+    const bool samplingChanged = dimensions_.x != placementDimensions_.x
+        || dimensions_.z != placementDimensions_.z
+        || waterDepth_ != placementWaterDepth_;
+
+    // Streamed tiles are generated from the same settings at a higher resolution
+    updateTileStreaming(settings, heightsChanged || samplingChanged);
+    rebuildLodTrees();
+
+    if (heightsChanged || samplingChanged)
+    {
+        placementVersion_++;
+        placementDimensions_ = dimensions_;
+        placementWaterDepth_ = waterDepth_;
+    }
+
+    // The heightmap is now build.
+    // Place objects on it.
+    placeObjects();
+    placeDetailMeshes(heightsChanged && !samplingChanged);
+}
+
+TerrainGenerationSettings Terrain::generationSettings() const
+{
+    TerrainGenerationSettings settings;
+    settings.resolution = HEIGHTMAP_RESOLUTION;
+    settings.height = dimensions_.y;
+    settings.seed = seed_;
+    settings.fractalSmoothness = fractalSmoothness_;
+    settings.mountainScale = mountainScale_;
+    settings.islandFactor = islandFactor_;
+    return settings;
+}
+
+uint64_t Terrain::bakeKey() const
+{
+    // Everything that affects the heightmap, the placed objects or the detail batches
+    const int resolution = HEIGHTMAP_RESOLUTION;
+    TerrainBakeKey key;
+    key.add(TerrainGenerator::OUTPUT_VERSION);
+    key.add(PLACEMENT_VERSION);
+    key.add(resolution);
+    key.add(dimensions_);
+    key.add(waterDepth_);
+    key.add(seed_);
+    key.add(fractalSmoothness_);
+    key.add(mountainScale_);
+    key.add(islandFactor_);
+
+    key.add(placedObjects_.size());
+    for (const TerrainObject& object : placedObjects_)
+    {
+        key.add(object.prefab != nullptr ? object.prefab->resourceID() : (ResourceID)0);
+        key.add(object.minAltitude);
+        key.add(object.maxAltitude);
+        key.add(object.maxSlope);
+        key.add(object.minSpacing);
+        key.add(object.minInstances);
+        key.add(object.maxInstances);
+        key.add(object.seed);
+    }
+
+    key.add(detailMesh_ != nullptr ? detailMesh_->resourceID() : (ResourceID)0);
+    key.add(detailMaterial_ != nullptr ? detailMaterial_->resourceID() : (ResourceID)0);
+    key.add(detailScale_);
+    key.add(detailAltitudeLimits_);
+    key.add(detailSlopeLimit_);
+    key.add(detailSpacing_);
+
+    return key.value();
+}
+
+bool Terrain::loadBake(uint64_t key)
+{
+    TerrainBakeCache bake;
+    if (!bake.open(TerrainBakeCache::bakePath(BAKE_DIRECTORY, key), key, HEIGHTMAP_RESOLUTION)
+        || bake.objectLayerCount() != (int)placedObjects_.size())
+    {
+        return false;
+    }
+
+    // Copy the heightmap out of the bake, and upload all of it
+    const size_t texelCount = (size_t)HEIGHTMAP_RESOLUTION * HEIGHTMAP_RESOLUTION;
+    heightfield_.assign(HEIGHTMAP_RESOLUTION, dimensions_.x, dimensions_.z, -waterDepth_, bake.heights(), bake.normals());
+    heightfieldQuadtree_.build(heightfield_);
+    textureHeights_.assign(bake.textureHeights(), bake.textureHeights() + texelCount);
+    heightMap_.setData(textureHeights_.data(), (int)(texelCount * sizeof(uint16_t)), 0);
+    maxHeight_ = bake.maxHeight();
 
-    // Reset the heightmap to a single value.
-    int resolution = 1;
-    heights_.resize(1);
-    heights_[0] = dimensions_.y / 2.0f;
+    // The generator's cached stages don't match the baked heights, so the next generation must run every stage
+    generator_.reset();
 
-    // Run fractal passes, doubling the heightmap size each time, until
-    // we are up to the required resolution.
-    float moveSize = dimensions_.y / 2.0f;
-    while (resolution < HEIGHTMAP_RESOLUTION)
+    updateTileStreaming(generationSettings(), true);
+    rebuildLodTrees();
+
+    // Everything placed before was placed on a different heightmap
+    placementVersion_++;
+    placementDimensions_ = dimensions_;
+    placementWaterDepth_ = waterDepth_;
+
+    // Create the baked object instances
+    for (PlacedObjectLayer& layer : placedObjectLayers_)
+    {
+        destroyLayerInstances(layer);
+    }
+    placedObjectLayers_.resize(placedObjects_.size());
+
+    for (unsigned int i = 0; i < placedObjects_.size(); ++i)
     {
-        int newResolution = resolution * 2;
-        std::vector<float> newHeights(newResolution * newResolution);
-        for (int y = 0; y < newResolution; ++y)
+        PlacedObjectLayer& layer = placedObjectLayers_[i];
+        layer.objectType = placedObjects_[i];
+        layer.placementVersion = placementVersion_;
+        layer.positions.clear();
+        layer.rotations.clear();
+
+        int count = 0;
+        const TerrainBakeObject* objects = bake.objects(i, count);
+        for (int j = 0; j < count; ++j)
         {
-            for (int x = 0; x < newResolution; ++x)
-            {
-                float v1 = heights_[x / 2 + y / 2 * resolution];
-                float v2 = heights_[std::min(x / 2 + 1, resolution - 1) + y / 2 * resolution];
-                float interp0 = (x % 2) == 0 ? v1 : (v1 + v2) / 2.0f;
+            const TerrainBakeObject& object = objects[j];
+            layer.positions.push_back(Point3(object.position[0], object.position[1], object.position[2]));
+            layer.rotations.push_back(Quaternion(object.rotation[0], object.rotation[1], object.rotation[2], object.rotation[3]));
+        }
 
-                float v3 = heights_[x / 2 + std::min(y / 2 + 1, resolution - 1) * resolution];
-                float v4 = heights_[std::min(x / 2 + 1, resolution - 1) + std::min(y / 2 + 1, resolution - 1) * resolution];
-                float interp1 = (x % 2) == 0 ? v3 : (v3 + v4) / 2.0f;
+        createLayerInstances(layer);
+    }
+    rebuildPlacedInstances();
+
+    // Copy the baked detail batches
+    detailPlacement_.mesh = detailMesh_;
+    detailPlacement_.material = detailMaterial_;
+    detailPlacement_.scale = detailScale_;
+    detailPlacement_.altitudeLimits = detailAltitudeLimits_;
+    detailPlacement_.slopeLimit = detailSlopeLimit_;
+    detailPlacement_.spacing = detailSpacing_;
+    detailPlacement_.placementVersion = placementVersion_;
+
+    detailMeshBatches_.resize(bake.detailBatchCount());
+    for (int i = 0; i < bake.detailBatchCount(); ++i)
+    {
+        const TerrainBakeDetailBatch& bakedBatch = bake.detailBatches()[i];
+        DetailBatch& batch = detailMeshBatches_[i];
+        batch.firstInstance = bakedBatch.firstPosition;
+        batch.count = bakedBatch.count;
+        batch.bounds = Bounds(Point3(bakedBatch.boundsMin[0], bakedBatch.boundsMin[1], bakedBatch.boundsMin[2]),
+            Point3(bakedBatch.boundsMax[0], bakedBatch.boundsMax[1], bakedBatch.boundsMax[2]));
+        batch.drawDistance = bakedBatch.drawDistance;
+    }
 
-                float interp = (y % 2) == 0 ? interp0 : (interp0 + interp1) / 2.0f;
+    // The baked positions are packed the same way as the terrain's
+    const Vector4* positions = (const Vector4*)bake.detailPositions();
+    detailPositions_.assign(positions, positions + bake.detailPositionCount());
+    detailBatchTree_.build(detailMeshBatches_);
+    detailVersion_++;
 
-                newHeights[x + y * newResolution] = interp + random_float(-moveSize, moveSize);
-            }
+    bakedKey_ = key;
+    return true;
+}
+
+void Terrain::saveBake(uint64_t key)
+{
+    TerrainBakeContents contents;
+    contents.resolution = HEIGHTMAP_RESOLUTION;
+    contents.maxHeight = maxHeight_;
+    contents.heights = heightfield_.heights().data();
+    contents.normals = heightfield_.normals().data();
+    contents.textureHeights = textureHeights_.data();
+
+    for (const PlacedObjectLayer& layer : placedObjectLayers_)
+    {
+        contents.objectLayerCounts.push_back((uint32_t)layer.positions.size());
+        for (size_t i = 0; i < layer.positions.size(); ++i)
+        {
+            const Point3& position = layer.positions[i];
+            const Quaternion& rotation = layer.rotations[i];
+            contents.objects.push_back({ { position.x, position.y, position.z }, { rotation.x, rotation.y, rotation.z, rotation.w } });
         }
+    }
 
-        heights_ = newHeights;
-        resolution = newResolution;
-        moveSize /= fractalSmoothness_;
+    for (const DetailBatch& batch : detailMeshBatches_)
+    {
+        TerrainBakeDetailBatch bakedBatch;
+        bakedBatch.count = batch.count;
+        bakedBatch.firstPosition = batch.firstInstance;
+        bakedBatch.boundsMin[0] = batch.bounds.min().x;
+        bakedBatch.boundsMin[1] = batch.bounds.min().y;
+        bakedBatch.boundsMin[2] = batch.bounds.min().z;
+        bakedBatch.boundsMax[0] = batch.bounds.max().x;
+        bakedBatch.boundsMax[1] = batch.bounds.max().y;
+        bakedBatch.boundsMax[2] = batch.bounds.max().z;
+        bakedBatch.drawDistance = batch.drawDistance;
+        contents.detailBatches.push_back(bakedBatch);
     }
 
-    // Raise each height value to a power, allowing a controllable "mountain factor"
-    // that pulls high bits up and squashes lower bits down.
-    for (unsigned int i = 0; i < heights_.size(); ++i)
+    const float* positions = (const float*)detailPositions_.data();
+    contents.detailPositions.assign(positions, positions + detailPositions_.size() * 4);
+
+    // A bake that can't be written only means the terrain is generated again next time
+    create_directories(fs::path(BAKE_DIRECTORY));
+    if (TerrainBakeCache::save(TerrainBakeCache::bakePath(BAKE_DIRECTORY, key), key, contents))
     {
-        heights_[i] = powf(heights_[i], mountainScale_);
+        bakedKey_ = key;
     }
+}
 
-    // Use an "island factor" to flatten parts near the edge of the heightmap
-    // Just compute the distance from the island centre and flatten, with a controlable power factor.
-    for (int y = 0; y < HEIGHTMAP_RESOLUTION; ++y)
+void Terrain::uploadHeightmapChanges()
+{
+    // Upload each horizontal run of changed tiles as a single rectangle
+    const int tileSize = TerrainGenerator::DIRTY_TILE_SIZE;
+    const int tilesPerRow = generator_.dirtyTilesPerRow();
+    for (int tileY = 0; tileY < tilesPerRow; ++tileY)
     {
-        for (int x = 0; x < HEIGHTMAP_RESOLUTION; ++x)
+        int tileX = 0;
+        while (tileX < tilesPerRow)
         {
-            float distanceX = (x / (float)HEIGHTMAP_RESOLUTION) - 0.5f;
-            float distanceY = (y / (float)HEIGHTMAP_RESOLUTION) - 0.5f;
-            float distanceFromCentre = sqrtf(distanceX * distanceX + distanceY * distanceY) * 2.0f;
-            if (distanceFromCentre > 1.0f)
+            if (!generator_.tileChanged(tileX, tileY))
             {
-                distanceFromCentre = 1.0f;
+                tileX++;
+                continue;
             }
 
-            heights_[x + y * HEIGHTMAP_RESOLUTION] *= 1.0f - powf(distanceFromCentre, islandFactor_);
-
-            // Force values at the very edge of the terrain to 0.
-            // This prevents weird artifacts in the water depth calculations
-            if (x == 0 || x == HEIGHTMAP_RESOLUTION - 1 || y == 0 || y == HEIGHTMAP_RESOLUTION - 1)
+            const int firstTile = tileX;
+            while (tileX < tilesPerRow && generator_.tileChanged(tileX, tileY))
             {
-                heights_[x + y * HEIGHTMAP_RESOLUTION] = 0.0f;
+                tileX++;
             }
+
+            const int x = firstTile * tileSize;
+            const int y = tileY * tileSize;
+            const int width = std::min(tileX * tileSize, HEIGHTMAP_RESOLUTION) - x;
+            const int height = std::min(y + tileSize, HEIGHTMAP_RESOLUTION) - y;
+            heightMap_.setSubData(&textureHeights_[x + y * HEIGHTMAP_RESOLUTION], x, y, width, height, HEIGHTMAP_RESOLUTION, 0);
         }
     }
+}
 
-    // Determine the maximum heightmap height
-    float maxHeight = 0.0f;
-    for (unsigned int i = 0; i < heights_.size(); ++i)
+void Terrain::updateTileStreaming(const TerrainGenerationSettings &settings, bool heightsChanged)
+{
+    if (!heightsChanged && streamedResolution_ == activeStreamedResolution_ && streamingBudget_ == activeStreamingBudget_)
     {
-        maxHeight = std::max(maxHeight, heights_[i]);
+        return;
     }
 
-    // Generate a uint16 version of the data (normalized) for passing to the gpu.
-    std::vector<uint16_t> textureHeights(HEIGHTMAP_RESOLUTION * HEIGHTMAP_RESOLUTION);
-    for (int i = 0; i < textureHeights.size(); ++i)
-    {
-        textureHeights[i] = (uint16_t)(heights_[i] / maxHeight * 65535.0f);
+    delete tileStreamer_;
+    tileStreamer_ = nullptr;
+    tileCache_.close();
+    activeStreamedResolution_ = streamedResolution_;
+    activeStreamingBudget_ = streamingBudget_;
 
-        // Also correct the on-cpu heightfield to match
-        heights_[i] /= (maxHeight / dimensions_.y);
+    if (streamedResolution_ <= HEIGHTMAP_RESOLUTION)
+    {
+        return;
     }
 
-    // Upload the heightmap data to the gpu
-    heightMap_.setData(textureHeights.data(), 2 * HEIGHTMAP_RESOLUTION * HEIGHTMAP_RESOLUTION, 0);
+    // The tiles are normalized with the maximum height of the heightmap texture, so the two line up.
+    // The fractal passes are the same at every resolution, so the heightmap texture is a close
+    // approximation of the streamed heightmap.
+    TerrainGenerationSettings streamedSettings = settings;
+    streamedSettings.resolution = streamedResolution_;
+    create_directories(fs::path(TILE_CACHE_DIRECTORY));
+    if (tileCache_.open(TerrainTileCache::cachePath(TILE_CACHE_DIRECTORY, streamedSettings, maxHeight_), streamedSettings, maxHeight_))
+    {
+        tileStreamer_ = new TerrainTileStreamer(&tileCache_, (size_t)streamingBudget_ * 1024 * 1024, dimensions_, -waterDepth_);
+    }
+}
 
-    // The heightmap is now build.
-    // Place objects on it.
-    placeObjects();
-    placeDetailMeshes();
+void Terrain::rebuildLodTrees()
+{
+    // The finest patches have a vertex for every texel of the heightmap, or of the streamed heightmap.
+    // Streamed heights only approximate the heightmap the bounds come from, so leave some room.
+    const int resolution = (tileStreamer_ != nullptr) ? std::max(HEIGHTMAP_RESOLUTION, activeStreamedResolution_) : HEIGHTMAP_RESOLUTION;
+    const int levelCount = (int)log2f((float)(resolution / TerrainLodTree::GRID_RESOLUTION)) + 1;
+    const float heightMargin = (tileStreamer_ != nullptr) ? dimensions_.y * 0.05f : 0.0f;
+    lodTree_.build(heightfield_, levelCount, heightMargin, true);
+
+    // The water extends 8 terrain sizes out on each side. Its waves scale with the depth of the water,
+    // and it rises towards the horizon, which the bounds of its patches must cover.
+    const Vector2 terrainSize(dimensions_.x, dimensions_.z);
+    const float horizonRise = std::max((terrainSize * 8.0f).magnitude() - 5000.0f, 0.0f) * 0.015f;
+    waterLodTree_.buildFlat(terrainSize * -8.0f, terrainSize * 16.0f, -waterDepth_, waterDepth_ + horizonRise, WATER_LOD_LEVELS);
 }
 
 void Terrain::placeObjects()
 {
-    // Delete any existing objects
-    for (GameObject* go : placedObjectInstances_)
+    // Delete the layers for object types that no longer exist
+    bool changed = false;
+    while (placedObjectLayers_.size() > placedObjects_.size())
     {
-        delete go;
+        destroyLayerInstances(placedObjectLayers_.back());
+        placedObjectLayers_.pop_back();
+        changed = true;
     }
-    placedObjectInstances_.clear();
 
     // Consider each type of object we are supposed to place
-    for (const TerrainObject& objectType : placedObjects_)
+    for (unsigned int i = 0; i < placedObjects_.size(); ++i)
     {
-        generateObjectInstances(objectType);
+        const TerrainObject& objectType = placedObjects_[i];
+
+        if (i >= placedObjectLayers_.size())
+        {
+            placedObjectLayers_.push_back(PlacedObjectLayer());
+        }
+        else if (placedObjectLayers_[i].placementVersion == placementVersion_ && placedObjectLayers_[i].objectType.samePlacement(objectType))
+        {
+            // This type is already placed with the current settings, but may be drawn differently
+            if (placedObjectLayers_[i].objectType.impostorDistance != objectType.impostorDistance)
+            {
+                placedObjectLayers_[i].objectType.impostorDistance = objectType.impostorDistance;
+                changed = true;
+            }
+            continue;
+        }
+
+        // Delete any existing objects of this type and place them again
+        PlacedObjectLayer& layer = placedObjectLayers_[i];
+        destroyLayerInstances(layer);
+        layer.positions.clear();
+        layer.rotations.clear();
+
+        layer.objectType = objectType;
+        layer.placementVersion = placementVersion_;
+        generateObjectPlacements(objectType, layer.positions, layer.rotations);
+        createLayerInstances(layer);
+        changed = true;
+    }
+
+    if (changed)
+    {
+        rebuildPlacedInstances();
     }
 }
 
-void Terrain::placeDetailMeshes()
+void Terrain::placeDetailMeshes(bool onlyHeightsChanged)
 {
-    // Delete any existing detail batches
-    detailMeshBatches_.clear();
+    const bool settingsChanged = detailPlacement_.mesh != detailMesh_
+        || detailPlacement_.material != detailMaterial_
+        || detailPlacement_.scale.x != detailScale_.x
+        || detailPlacement_.scale.y != detailScale_.y
+        || detailPlacement_.altitudeLimits.x != detailAltitudeLimits_.x
+        || detailPlacement_.altitudeLimits.y != detailAltitudeLimits_.y
+        || detailPlacement_.slopeLimit != detailSlopeLimit_
+        || detailPlacement_.spacing != detailSpacing_;
+
+    // Nothing to do if neither the settings nor the heightmap changed
+    if (!settingsChanged && detailPlacement_.placementVersion == placementVersion_)
+    {
+        return;
+    }
+
+    // When only the heights changed, only the batches over changed parts of the heightmap need placing again.
+    const bool placeAll = settingsChanged || !onlyHeightsChanged || detailPlacement_.placementVersion + 1 != placementVersion_;
+
+    detailPlacement_.mesh = detailMesh_;
+    detailPlacement_.material = detailMaterial_;
+    detailPlacement_.scale = detailScale_;
+    detailPlacement_.altitudeLimits = detailAltitudeLimits_;
+    detailPlacement_.slopeLimit = detailSlopeLimit_;
+    detailPlacement_.spacing = detailSpacing_;
+    detailPlacement_.placementVersion = placementVersion_;
+
+    if (detailMesh_ == nullptr || detailMaterial_ == nullptr)
+    {
+        detailMeshBatches_.clear();
+        detailPositions_.clear();
+        detailBatchTree_.build(detailMeshBatches_);
+        detailVersion_++;
+        return;
+    }
 
-    if (detailMesh_ != nullptr && detailMaterial_ != nullptr)
+    // Split the terrain into a 12x12 grid of detail batches
+    // For each tile, there are multiple batches
+    // Each batch has a different draw distance, preventing a single grass/no grass transition
+    const int batchResolution = 12;
+    const int batchesPerTile = 3;
+    const bool resized = detailMeshBatches_.size() != batchResolution * batchResolution * batchesPerTile;
+    detailMeshBatches_.resize(batchResolution * batchResolution * batchesPerTile);
+
+    // Find the batches that need placing again
+    std::vector<int> placedBatches;
+    for (int z = 0; z < batchResolution; ++z)
     {
-        // Split the terrain into a 12x12 grid of detail batches
-        const int batchResolution = 12;
+        // Determine the bounds in the z plane
+        float minZ = z * dimensions_.z / (float)batchResolution;
+        float maxZ = (z + 1) * dimensions_.z / (float)batchResolution;
+
         for (int x = 0; x < batchResolution; ++x)
         {
             // Determine the bounds in the x plane
             float minX = x * dimensions_.x / (float)batchResolution;
             float maxX = (x + 1) * dimensions_.x / (float)batchResolution;
 
-            for (int z = 0; z < batchResolution; ++z)
+            // Skip tiles where the heightmap underneath hasn't changed.
+            // Sampling the normal reads neighbouring texels, so include a border of one texel.
+            bool place = placeAll || resized;
+            if (!place)
+            {
+                const float texelsPerMetreX = (HEIGHTMAP_RESOLUTION - 1) / dimensions_.x;
+                const float texelsPerMetreZ = (HEIGHTMAP_RESOLUTION - 1) / dimensions_.z;
+                place = generator_.regionChanged((int)(minX * texelsPerMetreX) - 1, (int)(minZ * texelsPerMetreZ) - 1,
+                    (int)(maxX * texelsPerMetreX) + 2, (int)(maxZ * texelsPerMetreZ) + 2);
+            }
+
+            if (!place)
             {
-                // Determine the bounds in the z plane
-                float minZ = z * dimensions_.z / (float)batchResolution;
-                float maxZ = (z + 1) * dimensions_.z / (float)batchResolution;
-
-                // For each tile, attempt to make multiple batches
-                // Each batch has a different draw distance, preventing a single grass/no grass transition
-                for (int iter = 0; iter < 3; ++iter)
-                {
-                    DetailBatch batch;
-                    batch.bounds = Bounds(Point3(minX, 0.0f, minZ), Point3(maxX, dimensions_.y, maxZ));
-                    batch.drawDistance = batch.bounds.size().magnitude() * 0.25f * (float)(iter + 1);
-
-                    // Look for instance positions within the bounds
-                    const uint32_t seed = iter | (x << 12) | (z << 24);
-                    generateDetailPositions(batch, seed);
-
-                    // If the batch is not empty, save it
-                    if (batch.count > 0)
-                    {
-                        detailMeshBatches_.push_back(batch);
-                    }
-                }
+                continue;
+            }
+
+            for (int iter = 0; iter < batchesPerTile; ++iter)
+            {
+                const int batchIndex = (x + z * batchResolution) * batchesPerTile + iter;
+                DetailBatch& batch = detailMeshBatches_[batchIndex];
+                batch.bounds = Bounds(Point3(minX, 0.0f, minZ), Point3(maxX, dimensions_.y, maxZ));
+                batch.drawDistance = batch.bounds.size().magnitude() * 0.25f * (float)(iter + 1);
+                placedBatches.push_back(batchIndex);
             }
         }
     }
+
+    // The altitude and slope limits are tested against a mask built once, rather than sampled for every candidate.
+    // Each batch has its own seed, so batches are placed in parallel and the result doesn't depend on the thread count.
+    PlacementMask mask;
+    std::vector<std::vector<Vector4>> placedPositions(placedBatches.size());
+    if (!placedBatches.empty())
+    {
+        mask.build(heightfield_, detailAltitudeLimits_.x, detailAltitudeLimits_.y, detailSlopeLimit_);
+        generator_.parallelFor("PlaceTerrainDetails", (int)placedBatches.size(), [&](int, int taskIndex)
+        {
+            const int batchIndex = placedBatches[taskIndex];
+            const int iter = batchIndex % batchesPerTile;
+            const int x = (batchIndex / batchesPerTile) % batchResolution;
+            const int z = (batchIndex / batchesPerTile) / batchResolution;
+            const uint32_t seed = iter | (x << 12) | (z << 24);
+            generateDetailPositions(detailMeshBatches_[batchIndex], seed, mask, placedPositions[taskIndex]);
+        });
+    }
+
+    // The positions of every batch are packed together in the order of the batches.
+    // Batches that aren't placed again copy their positions from the previous placement.
+    std::vector<Vector4> positions;
+    positions.reserve(detailPositions_.size());
+
+    size_t nextPlaced = 0;
+    for (int i = 0; i < (int)detailMeshBatches_.size(); ++i)
+    {
+        DetailBatch& batch = detailMeshBatches_[i];
+        const uint32_t firstInstance = (uint32_t)positions.size();
+        if (nextPlaced < placedBatches.size() && placedBatches[nextPlaced] == i)
+        {
+            positions.insert(positions.end(), placedPositions[nextPlaced].begin(), placedPositions[nextPlaced].end());
+            nextPlaced++;
+        }
+        else
+        {
+            positions.insert(positions.end(), detailPositions_.begin() + batch.firstInstance,
+                detailPositions_.begin() + batch.firstInstance + batch.count);
+        }
+        batch.firstInstance = firstInstance;
+    }
+
+    detailPositions_.swap(positions);
+    detailBatchTree_.build(detailMeshBatches_);
+    detailVersion_++;
 }
 
-void Terrain::generateObjectInstances(const TerrainObject& objectType)
+void Terrain::generateObjectPlacements(const TerrainObject& objectType, std::vector<Point3>& positions, std::vector<Quaternion>& rotations) const
 {
     // Use the object type seed
     // This ensures that multiple runs are deterministic.
-    srand(objectType.seed);
+    RandomStream random(objectType.seed);
 
     // Check the object type is ok
     if (objectType.prefab == nullptr)
@@ -439,122 +864,354 @@ void Terrain::generateObjectInstances(const TerrainObject& objectType)
         return;
     }
 
-    // Pick random points on the heightmap and check if they are suitable for a windmill.
-    int placed = 0;
-    int attempts = 0;
-    while (placed < objectType.minInstances || (attempts < objectType.maxInstances * 10 && placed < objectType.maxInstances))
+    // Rotations come from a separate stream, so they don't affect the positions
+    RandomStream rotationRandom = random.split(1);
+
+    // Spread the instances over the parts of the terrain that meet the altitude and slope constraints,
+    // keeping them at least the minimum spacing apart
+    PlacementMask mask;
+    mask.build(heightfield_, objectType.minAltitude, objectType.maxAltitude, 1.0f - objectType.maxSlope);
+
+    PoissonDiskSampler sampler;
+    std::vector<Vector2> points;
+    sampler.generate(Vector2::zero(), Vector2(dimensions_.x, dimensions_.z), objectType.minSpacing, &mask,
+        objectType.maxInstances, random, points);
+
+    // The spacing can leave too little room for the minimum number of instances.
+    // Make up the rest with random points the mask allows, even if they are closer together.
+    if ((int)points.size() < objectType.minInstances && mask.allowedCount() > 0)
+    {
+        RandomStream extraRandom = random.split(2);
+        int attempts = 0;
+        while ((int)points.size() < objectType.minInstances && attempts < 100000)
+        {
+            attempts++;
+            const Vector2 point(extraRandom.nextFloat(0.0f, dimensions_.x), extraRandom.nextFloat(0.0f, dimensions_.z));
+            if (mask.allowed(point.x, point.y))
+            {
+                points.push_back(point);
+            }
+        }
+    }
+
+    if ((int)points.size() < objectType.minInstances)
+    {
+        printf("Failed to place object type %s on terrain - only %d of the minimum %d instances fit the constraints\n",
+            objectType.prefab->resourceName().c_str(), (int)points.size(), objectType.minInstances);
+    }
+
+    std::vector<float> heights;
+    samplePointHeights(points, heights);
+
+    positions.reserve(positions.size() + points.size());
+    rotations.reserve(rotations.size() + points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        positions.push_back(Point3(points[i].x, heights[i], points[i].y));
+        rotations.push_back(Quaternion::euler(0.0f, rotationRandom.nextFloat(0.0f, 360.0f), 0.0f));
+    }
+}
+
+void Terrain::createLayerInstances(PlacedObjectLayer& layer) const
+{
+    layer.instancedParts.clear();
+    layer.rootScale = Vector3::one();
+
+    if (layer.objectType.prefab == nullptr)
+    {
+        return;
+    }
+
+    // Every instance is made from the same prefab, so the first one shows which parts are static
+    for (size_t i = 0; i < layer.positions.size(); ++i)
     {
-        attempts++;
+        GameObject* instance = createObjectInstance(layer.objectType, layer.positions[i], layer.rotations[i]);
+        Transform* root = instance->transform();
 
-        // Pick a random point
-        float x = random_float(0.0f, dimensions_.x);
-        float z = random_float(0.0f, dimensions_.z);
-        float y = sampleHeightmap(x, z);
+        std::vector<InstancedPart>* parts = nullptr;
+        if (i == 0)
+        {
+            layer.rootScale = root->scaleLocal();
+            parts = &layer.instancedParts;
+        }
 
-        // Check the altitude constraints are met
-        if (y < objectType.minAltitude || y > objectType.maxAltitude)
+        // The static meshes are drawn with instancing instead
+        if (!removeInstancedParts(root, root->worldToLocal(), true, parts))
         {
-            continue;
+            // Nothing else is left, so none of the instances need GameObjects
+            delete instance;
+            return;
         }
 
-        // Check the slope constraints are met
-        if (sampleHeightmapNormal(x, z).y < (1.0f - objectType.maxSlope))
+        layer.instances.push_back(instance);
+    }
+}
+
+void Terrain::destroyLayerInstances(PlacedObjectLayer& layer) const
+{
+    for (GameObject* go : layer.instances)
+    {
+        delete go;
+    }
+    layer.instances.clear();
+    layer.instancedParts.clear();
+}
+
+GameObject* Terrain::createObjectInstance(const TerrainObject& objectType, const Point3& position, const Quaternion& rotation) const
+{
+    GameObject* newGO = new GameObject(objectType.prefab->resourceName(), objectType.prefab);
+    newGO->setFlag(GameObjectFlag::NotShownOrSaved, true);
+    newGO->setFlag(GameObjectFlag::SurviveSceneChanges, true); // The terrain handles deleting its sub-objects manually
+    newGO->transform()->setPositionLocal(position);
+    newGO->transform()->setRotationLocal(rotation);
+    return newGO;
+}
+
+bool Terrain::removeInstancedParts(Transform* transform, const Matrix4x4& worldToRoot, bool parentsStatic, std::vector<InstancedPart>* parts)
+{
+    GameObject* gameObject = transform->gameObject();
+
+    // Find out whether the object has any components that need it to stay a GameObject
+    bool isStatic = parentsStatic;
+    bool hasOtherComponents = false;
+    for (Component* component : gameObject->componentList())
+    {
+        if (component == transform || component->componentType() == ComponentType::StaticMesh)
         {
             continue;
         }
 
-        // Place the object at that point
-        GameObject* newGO = new GameObject(objectType.prefab->resourceName(), objectType.prefab);
-        newGO->setFlag(GameObjectFlag::NotShownOrSaved, true);
-        newGO->setFlag(GameObjectFlag::SurviveSceneChanges, true); // The terrain handles deleting its sub-objects manually
-        newGO->transform()->setPositionLocal(Point3(x, y, z));
-        newGO->transform()->setRotationLocal(Quaternion::euler(0.0f, random_float(0.0f, 360.0f), 0.0f));
-        placedObjectInstances_.push_back(newGO);
-        placed++;
-
-        // Safety - if we have done a huge number of attempts, exit
-        if (attempts > 100000)
+        hasOtherComponents = true;
+        if (!isComponentType(component->componentType(), ComponentType::Collider))
         {
-            printf("Failed to place object type %s on terrain - too many attempts", objectType.prefab->resourceName().c_str());
-            return;
+            isStatic = false;
+        }
+    }
+
+    // Move the static mesh to the instanced parts
+    StaticMesh* staticMesh = gameObject->staticMesh();
+    if (staticMesh != nullptr && isStatic)
+    {
+        if (parts != nullptr && staticMesh->mesh() != nullptr && staticMesh->material() != nullptr)
+        {
+            parts->push_back({ staticMesh->mesh(), staticMesh->material(), worldToRoot * transform->localToWorld() });
         }
+
+        delete staticMesh;
+        staticMesh = nullptr;
     }
+
+    bool hasComponentsLeft = hasOtherComponents || staticMesh != nullptr;
+    for (Transform* child : transform->children())
+    {
+        if (removeInstancedParts(child, worldToRoot, isStatic, parts))
+        {
+            hasComponentsLeft = true;
+        }
+    }
+
+    return hasComponentsLeft;
 }
 
-void Terrain::generateDetailPositions(DetailBatch& batch, uint32_t seed) const
+void Terrain::rebuildPlacedInstances()
+{
+    placedInstances_.reset(dimensions_.x, dimensions_.z, PLACED_INSTANCE_CELLS);
+
+    for (PlacedObjectLayer& layer : placedObjectLayers_)
+    {
+        // Bake the static meshes into an impostor once for each prefab
+        const bool useImpostor = layer.objectType.impostorDistance > 0.0f && !layer.instancedParts.empty();
+        if (useImpostor && (layer.impostor == nullptr || layer.impostorPrefab != layer.objectType.prefab))
+        {
+            std::vector<Impostor::Part> parts;
+            for (const InstancedPart& part : layer.instancedParts)
+            {
+                parts.push_back({ part.mesh, part.material, part.localToRoot });
+            }
+
+            layer.impostor.reset(new Impostor());
+            layer.impostor->bake(parts);
+            layer.impostorPrefab = layer.objectType.prefab;
+        }
+
+        const Impostor* impostor = useImpostor ? layer.impostor.get() : nullptr;
+        const float impostorDistance = useImpostor ? layer.objectType.impostorDistance : 0.0f;
+        for (size_t i = 0; i < layer.positions.size(); ++i)
+        {
+            const Matrix4x4 rootToWorld = Matrix4x4::trs(layer.positions[i], layer.rotations[i], layer.rootScale);
+            for (const InstancedPart& part : layer.instancedParts)
+            {
+                placedInstances_.add(part.mesh, part.material, part.mesh->bounds(), rootToWorld * part.localToRoot, impostor, impostorDistance);
+            }
+
+            if (impostor != nullptr)
+            {
+                const Vector3 extent(impostor->radius(), impostor->radius(), impostor->radius());
+                placedInstances_.addImpostor(impostor, impostorDistance, Bounds(impostor->centre() - extent, impostor->centre() + extent), rootToWorld);
+            }
+        }
+    }
+
+    placedInstances_.build();
+}
+
+void Terrain::generateDetailPositions(DetailBatch& batch, uint32_t seed, const PlacementMask& mask, std::vector<Vector4>& positions) const
 {
     // Use the batch centre as the seed
     // This ensures that multiple runs are deterministic.
-    srand(seed);
+    RandomStream random(seed);
+    RandomStream scaleRandom = random.split(1);
+
+    // Spread up to 1024 points over the batch, at least the detail spacing apart.
+    // Each batch is sampled on its own, so points either side of a batch edge can be slightly closer.
+    PoissonDiskSampler sampler;
+    std::vector<Vector2> points;
+    sampler.generate(Vector2(batch.bounds.min().x, batch.bounds.min().z), Vector2(batch.bounds.max().x, batch.bounds.max().z),
+        detailSpacing_, &mask, DetailBatch::MaxInstancesPerBatch, random, points);
 
-    // Reset the number of positions in the batch
-    batch.count = 0;
+    std::vector<float> heights;
+    samplePointHeights(points, heights);
 
-    // Otherwise, pick 1024 random points on the terrain
-    int attempts = 0;
-    while (attempts < 4000 && batch.count < DetailBatch::MaxInstancesPerBatch)
+    positions.reserve(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
     {
-        attempts++;
+        float scale = scaleRandom.nextFloat(detailScale_.x, detailScale_.y);
+        positions.push_back(Vector4(points[i].x, heights[i], points[i].y, scale));
+    }
 
-        // Pick a random point
-        float x = random_float(batch.bounds.min().x, batch.bounds.max().x);
-        float z = random_float(batch.bounds.min().z, batch.bounds.max().z);
-        float y = sampleHeightmap(x, z);
+    batch.count = (int)points.size();
+}
 
-        // Respect the detail altitude limits
-        if (y > detailAltitudeLimits_.y || y < detailAltitudeLimits_.x)
+void Terrain::samplePointHeights(const std::vector<Vector2>& points, std::vector<float>& heights) const
+{
+    // Only the chosen points need their heights, which are sampled in blocks
+    const int blockSize = 64;
+    float xs[blockSize], zs[blockSize];
+    heights.resize(points.size());
+    for (size_t start = 0; start < points.size(); start += blockSize)
+    {
+        const int count = (int)std::min(points.size() - start, (size_t)blockSize);
+        for (int i = 0; i < count; ++i)
         {
-            continue;
+            xs[i] = points[start + i].x;
+            zs[i] = points[start + i].y;
         }
+        heightfield_.sampleHeights(xs, zs, heights.data() + start, count);
+    }
+}
 
-        // Respect the layer's slope settings
-        if (sampleHeightmapNormal(x, z).y < detailSlopeLimit_)
+const TerrainTileCollider* Terrain::findTileCollider(float x, float z) const
+{
+    if (tileStreamer_ == nullptr || x < 0.0f || z < 0.0f || x >= dimensions_.x || z >= dimensions_.z)
+    {
+        return nullptr;
+    }
+
+    const int tilesPerSide = tileStreamer_->tilesPerSide();
+    const int tileX = std::min((int)(x / dimensions_.x * tilesPerSide), tilesPerSide - 1);
+    const int tileY = std::min((int)(z / dimensions_.z * tilesPerSide), tilesPerSide - 1);
+    return tileStreamer_->collider(tileX, tileY);
+}
+
+bool Terrain::sweepSegment(const Point3& start, const Point3& end, HeightfieldHit& hit) const
+{
+    if (tileStreamer_ == nullptr)
+    {
+        return heightfieldQuadtree_.sweepSegment(start, end, hit);
+    }
+
+    // Only the part of the segment over the terrain can hit it
+    const Vector3 delta = end - start;
+    float t = 0.0f, tEnd = 1.0f;
+    const float starts[2] = { start.x, start.z };
+    const float deltas[2] = { delta.x, delta.z };
+    const float sizes[2] = { dimensions_.x, dimensions_.z };
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (deltas[axis] == 0.0f)
         {
+            if (starts[axis] < 0.0f || starts[axis] > sizes[axis])
+            {
+                hit.hit = false;
+                return false;
+            }
             continue;
         }
 
-        float scale = random_float(detailScale_.x, detailScale_.y);
-        batch.instancePositions[batch.count] = Vector4(x, y, z, scale);
-        batch.count++;
+        const float t0 = -starts[axis] / deltas[axis];
+        const float t1 = (sizes[axis] - starts[axis]) / deltas[axis];
+        t = std::max(t, std::min(t0, t1));
+        tEnd = std::min(tEnd, std::max(t0, t1));
+    }
+
+    // Split the segment at the tile edges, and sweep each piece against the collider of its tile,
+    // or against the heightmap where the tile has none
+    const float tilesPerSide = (float)tileStreamer_->tilesPerSide();
+    const float tileStartX = start.x / dimensions_.x * tilesPerSide;
+    const float tileStartZ = start.z / dimensions_.z * tilesPerSide;
+    const float tileDeltaX = delta.x / dimensions_.x * tilesPerSide;
+    const float tileDeltaZ = delta.z / dimensions_.z * tilesPerSide;
+    while (t < tEnd)
+    {
+        const float crossing = std::min(nextCrossing(tileStartX, tileDeltaX, t), nextCrossing(tileStartZ, tileDeltaZ, t));
+        const float next = std::min(std::max(crossing, t + 1e-5f), tEnd);
+        const Point3 pieceStart = start + delta * t;
+        const Point3 pieceEnd = start + delta * next;
+        const Point3 middle = start + delta * ((t + next) * 0.5f);
+
+        bool pieceHit;
+        const TerrainTileCollider* collider = findTileCollider(middle.x, middle.z);
+        if (collider != nullptr)
+        {
+            pieceHit = collider->quadtree.sweepSegment(pieceStart - collider->offset, pieceEnd - collider->offset, hit);
+            hit.point += collider->offset;
+        }
+        else
+        {
+            pieceHit = heightfieldQuadtree_.sweepSegment(pieceStart, pieceEnd, hit);
+        }
+
+        if (pieceHit)
+        {
+            hit.distance = t + hit.distance * (next - t);
+            return true;
+        }
+        t = next;
+    }
+
+    hit.hit = false;
+    return false;
+}
+
+bool Terrain::raycast(const Point3& origin, const Vector3& direction, float maxDistance, HeightfieldHit& hit) const
+{
+    if (!sweepSegment(origin, origin + direction * maxDistance, hit))
+    {
+        return false;
     }
+
+    hit.distance *= maxDistance;
+    return true;
 }
 
 float Terrain::sampleHeightmap(float x, float z) const
 {
-	// Clamp the x and z to the terrain dimensions
-	if (x < 0.0f) x = 0.0f;
-	if (x > dimensions_.x) x = dimensions_.x;
-	if (z < 0.0f) z = 0.0f;
-	if (z > dimensions_.z) z = dimensions_.z;
+    const TerrainTileCollider* collider = findTileCollider(x, z);
+    if (collider != nullptr)
+    {
+        return collider->heightfield.sampleHeight(x - collider->offset.x, z - collider->offset.z);
+    }
 
-	// Now sample the correct heightmap texel
-    int xTexel = (int)((x / dimensions_.x) * (HEIGHTMAP_RESOLUTION - 1) + 0.5f);
-    int zTexel = (int)((z / dimensions_.z) * (HEIGHTMAP_RESOLUTION - 1) + 0.5f);
-    return heights_[xTexel + zTexel * HEIGHTMAP_RESOLUTION] - waterDepth_;
+    return heightfield_.sampleHeight(x, z);
 }
 
 Vector3 Terrain::sampleHeightmapNormal(float x, float z) const
 {
-	// Clamp the x and z to the terrain dimensions
-	if (x < 1.0f) x = 0.0f;
-	if (x > dimensions_.x) x = dimensions_.x;
-	if (z < 1.0f) z = 0.0f;
-	if (z > dimensions_.z) z = dimensions_.z;
-
-	// Now sample the correct heightmap texels and perform finite difference
-    int xTexel = (int)((x / dimensions_.x) * (HEIGHTMAP_RESOLUTION - 1) + 0.5f);
-    int zTexel = (int)((z / dimensions_.z) * (HEIGHTMAP_RESOLUTION - 1) + 0.5f);
-    int x1Texel = std::max(xTexel - 1, 0);
-    int x2Texel = std::min(xTexel + 1, HEIGHTMAP_RESOLUTION - 1);
-    int z1Texel = std::max(zTexel - 1, 0);
-    int z2Texel = std::min(zTexel + 1, HEIGHTMAP_RESOLUTION - 1);
-    float x1 = heights_[x1Texel + zTexel * HEIGHTMAP_RESOLUTION];
-    float x2 = heights_[x2Texel + zTexel * HEIGHTMAP_RESOLUTION];
-    float z1 = heights_[xTexel + z1Texel * HEIGHTMAP_RESOLUTION];
-    float z2 = heights_[xTexel + z2Texel * HEIGHTMAP_RESOLUTION];
-    float dydx = (x2 - x1) * (2.0f * HEIGHTMAP_RESOLUTION / dimensions_.x);
-    float dydz = (z2 - z1) * (2.0f * HEIGHTMAP_RESOLUTION / dimensions_.z);
-    Vector3 worldTangent = Vector3(1.0f, dydx, 0.0f).normalized();
-    Vector3 worldBitangent = Vector3(0.0f, dydz, 1.0f).normalized();
-    return Vector3::cross(worldBitangent, worldTangent);
+    const TerrainTileCollider* collider = findTileCollider(x, z);
+    if (collider != nullptr)
+    {
+        return collider->heightfield.sampleNormal(x - collider->offset.x, z - collider->offset.z);
+    }
+
+    return heightfield_.sampleNormal(x, z);
 }
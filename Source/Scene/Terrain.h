@@ -1,15 +1,30 @@
 #pragma once
 
+#include <memory>
+
 #include "Scene/Component.h"
+#include "Scene/DetailBatchTree.h"
+#include "Scene/Heightfield.h"
+#include "Scene/HeightfieldQuadtree.h"
+#include "Scene/PlacedInstances.h"
+#include "Scene/TerrainBakeCache.h"
+#include "Scene/TerrainGenerator.h"
+#include "Scene/TerrainLodTree.h"
+#include "Scene/TerrainTileCache.h"
+#include "Scene/TerrainTileStreamer.h"
+#include "Renderer/Impostor.h"
 #include "Renderer/Mesh.h"
 #include "Renderer/Texture.h"
 #include "Math/Bounds.h"
 #include "Math/Color.h"
+#include "Math/Matrix4x4.h"
+#include "Math/Quaternion.h"
 #include "Math/Vector2.h"
 #include "Math/Vector3.h"
 #include "Math/Vector4.h"
 
 class Material;
+class PlacementMask;
 
 struct TerrainLayer : ISerializedObject
 {
@@ -31,30 +46,48 @@ struct TerrainObject : ISerializedObject
     float minAltitude = 0.0f;
     float maxAltitude = 1000.0f;
     float maxSlope = 1.0f;
+
+    // The closest any two instances may be, in m
+    float minSpacing = 20.0f;
+
     int minInstances = 0;
     int maxInstances = 100;
     int seed = 0;
 
-    void serialize(PropertyTable& table) override;
-};
+    // The distance from the viewer that instances are replaced by impostors at, in m. 0 for never.
+    float impostorDistance = 0.0f;
 
-// A group of detail meshes drawn in a single batch
-struct DetailBatch
-{
-    const static int MaxInstancesPerBatch = 1024;
+    void serialize(PropertyTable& table) override;
 
-    int count;
-    Vector4 instancePositions[MaxInstancesPerBatch];
-    Bounds bounds;
-    float drawDistance;
+    // Whether two object types would place the same instances
+    bool samePlacement(const TerrainObject &other) const;
 };
 
 class Terrain : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Terrain;
+    ComponentType componentType() const override { return TYPE; }
+
     const static int HEIGHTMAP_RESOLUTION = 1024;
     const static int MAX_LAYERS = 32;
 
+    // Part of the key of baked terrains. Bump it whenever a change to the object or detail
+    // placement changes where instances are placed, so terrains baked before are placed again.
+    const static uint32_t PLACEMENT_VERSION = 2;
+
+    // The number of cells along each side of the terrain that placed instances are culled in
+    const static int PLACED_INSTANCE_CELLS = 16;
+
+    // The number of levels in the water's level of detail tree. The water covers 16 times the terrain along each side.
+    const static int WATER_LOD_LEVELS = 7;
+
+    // Where the tiles of streamed heightmaps are stored between runs
+    static const char* const TILE_CACHE_DIRECTORY;
+
+    // Where baked terrains are stored between runs
+    static const char* const BAKE_DIRECTORY;
+
     explicit Terrain(GameObject* gameObject);
     ~Terrain() override;
 
@@ -64,7 +97,6 @@ public:
     // Serialisation function
     void serialize(PropertyTable &table) override;
 
-    const Mesh* mesh() const { return mesh_; }
     const Texture* heightmap() const { return &heightMap_; }
     const Mesh* detailMesh() const { return detailMesh_; }
     const Material* detailMaterial() const { return detailMaterial_; }
@@ -85,14 +117,48 @@ public:
     // The detail mesh batches on the terrain
     const std::vector<DetailBatch>& detailBatches() const { return detailMeshBatches_; }
 
+    // The quadtree used to cull the detail mesh batches
+    const DetailBatchTree& detailBatchTree() const { return detailBatchTree_; }
+
+    // The position and scale of every detail mesh instance, packed in the order of the batches
+    const std::vector<Vector4>& detailPositions() const { return detailPositions_; }
+
+    // Incremented whenever the detail positions change, so they are only uploaded when needed
+    uint64_t detailVersion() const { return detailVersion_; }
+
+    // The heightmap, for sampling many points at once
+    const Heightfield& heightfield() const { return heightfield_; }
+
+    // The min / max quadtree over the heightmap, covering the whole terrain at the heightmap's resolution
+    const HeightfieldQuadtree& heightfieldQuadtree() const { return heightfieldQuadtree_; }
+
+    // Finds the first point on the segment from start to end that meets the terrain.
+    // The hit distance is the fraction of the way along the segment. Where streamed tiles
+    // with colliders are drawn, the segment is swept against them instead of the heightmap.
+    bool sweepSegment(const Point3& start, const Point3& end, HeightfieldHit& hit) const;
+
+    // Finds the first point where a ray meets the terrain, within maxDistance along the direction, as for sweepSegment
+    bool raycast(const Point3& origin, const Vector3& direction, float maxDistance, HeightfieldHit& hit) const;
+
+    // Streams a higher resolution heightmap in tiles around the camera, or null when streaming is off.
+    // The renderer updates it each frame. Where no tile is resident, the heightmap texture is used instead.
+    TerrainTileStreamer* tileStreamer() const { return tileStreamer_; }
+
+    // The static meshes of the objects placed on the terrain, which are drawn with instancing
+    const PlacedInstances& placedInstances() const { return placedInstances_; }
+
+    // The level of detail trees the terrain and its water are drawn from
+    const TerrainLodTree& lodTree() const { return lodTree_; }
+    const TerrainLodTree& waterLodTree() const { return waterLodTree_; }
+
 private:
-    Mesh* mesh_;
     Texture heightMap_;
     Mesh* detailMesh_;
     Material* detailMaterial_;
     Vector2 detailScale_;
     Vector2 detailAltitudeLimits_;
     float detailSlopeLimit_;
+    float detailSpacing_;
     Vector3 dimensions_;
     Color waterColor_;
     float waterDepth_;
@@ -105,14 +171,98 @@ private:
     float mountainScale_;
     float islandFactor_;
 
-    // The current heightmap
-    std::vector<float> heights_;
+    // The current heightmap with its quadtree, and its normalized copy used for the heightmap texture
+    Heightfield heightfield_;
+    HeightfieldQuadtree heightfieldQuadtree_;
+    std::vector<uint16_t> textureHeights_;
+
+    // The patches the terrain and water are drawn in
+    TerrainLodTree lodTree_;
+    TerrainLodTree waterLodTree_;
+
+    // The largest height before normalization, which the heightmap texture is normalized by
+    float maxHeight_;
+
+    // The key of the baked terrain matching the current one, or 0 if it hasn't been baked
+    uint64_t bakedKey_;
 
-    // A list of objects placed on the terrain
-    std::vector<GameObject*> placedObjectInstances_;
+    // Generates the heightmap. Kept between runs to reuse its buffers.
+    TerrainGenerator generator_;
 
-    // A list of detail mesh layers on the terrain
+    // The resolution of the streamed heightmap, or 0 to only use the heightmap texture,
+    // and the gpu memory in MB to use for streamed tiles.
+    int streamedResolution_;
+    int streamingBudget_;
+
+    // The tiles of the streamed heightmap on disk, and the tiles on the gpu
+    TerrainTileCache tileCache_;
+    TerrainTileStreamer* tileStreamer_;
+    int activeStreamedResolution_;
+    int activeStreamingBudget_;
+
+    // A static mesh of a placed object, drawn with instancing
+    struct InstancedPart
+    {
+        Mesh* mesh;
+        Material* material;
+        Matrix4x4 localToRoot;
+    };
+
+    // The objects placed on the terrain for each object type, along with
+    // the settings used to place them. Only types whose settings or placement
+    // inputs have changed get placed again.
+    struct PlacedObjectLayer
+    {
+        TerrainObject objectType;
+        uint64_t placementVersion;
+
+        // Where each instance is placed
+        std::vector<Point3> positions;
+        std::vector<Quaternion> rotations;
+
+        // The static meshes of the prefab, and the scale of its root
+        std::vector<InstancedPart> instancedParts;
+        Vector3 rootScale;
+
+        // The static meshes baked into an impostor, when the type has an impostor distance,
+        // and the prefab it was baked from
+        std::unique_ptr<Impostor> impostor;
+        const Prefab* impostorPrefab = nullptr;
+
+        // GameObjects for the parts of each instance that gameplay needs, such as colliders.
+        // Empty when the prefab is only static meshes.
+        std::vector<GameObject*> instances;
+    };
+    std::vector<PlacedObjectLayer> placedObjectLayers_;
+
+    // The instanced static meshes of every placed object layer
+    PlacedInstances placedInstances_;
+
+    // A list of detail mesh layers on the terrain.
+    // Every grid cell has a batch, even if it is empty, so batches can be regenerated individually.
     std::vector<DetailBatch> detailMeshBatches_;
+    DetailBatchTree detailBatchTree_;
+    std::vector<Vector4> detailPositions_;
+    uint64_t detailVersion_;
+
+    // The detail settings used to place the detail batches
+    struct DetailPlacementSettings
+    {
+        const Mesh* mesh;
+        const Material* material;
+        Vector2 scale;
+        Vector2 altitudeLimits;
+        float slopeLimit;
+        float spacing;
+        uint64_t placementVersion;
+    };
+    DetailPlacementSettings detailPlacement_;
+
+    // Incremented whenever the result of sampling the heightmap changes,
+    // which means that objects and details need placing again.
+    uint64_t placementVersion_;
+    Vector3 placementDimensions_;
+    float placementWaterDepth_;
 
     // Draws sections of the terrain editor
     void drawGenerationProperties();
@@ -120,23 +270,70 @@ private:
     void drawObjectsProperties();
     void drawAppearenceProperties();
 
-    // Regenerates the terrain
+    // Loads the terrain from a bake of the current settings, or generates and bakes it if there isn't one
+    void loadOrGenerateTerrain();
+
+    // Regenerates the parts of the terrain affected by changed settings.
+    // The heightmap, placed objects and detail batches are each only rebuilt when their inputs change.
     void generateTerrain();
+
+    // The settings for generating the heightmap
+    TerrainGenerationSettings generationSettings() const;
+
+    // Computes the key identifying a bake of the current generation settings
+    uint64_t bakeKey() const;
+
+    // Loads the heightmap, placed objects and detail batches from a bake. Returns false if there is no matching bake.
+    bool loadBake(uint64_t key);
+
+    // Writes the current heightmap, placed objects and detail batches to a bake
+    void saveBake(uint64_t key);
     void placeObjects();
-    void placeDetailMeshes();
+    void placeDetailMeshes(bool onlyHeightsChanged);
+
+    // Uploads the parts of the heightmap texture that changed in the last generation
+    void uploadHeightmapChanges();
+
+    // Restarts tile streaming when the heights or streaming settings change
+    void updateTileStreaming(const TerrainGenerationSettings &settings, bool heightsChanged);
+
+    // Rebuilds the level of detail trees for the current heights, size and streamed resolution
+    void rebuildLodTrees();
+
+    // Picks where to place the instances of the given object type
+    void generateObjectPlacements(const TerrainObject &objectType, std::vector<Point3> &positions, std::vector<Quaternion> &rotations) const;
+
+    // Creates the GameObjects for a placed layer, moving its static meshes to instanced parts
+    void createLayerInstances(PlacedObjectLayer &layer) const;
+    void destroyLayerInstances(PlacedObjectLayer &layer) const;
+
+    // Creates a single instance of an object type
+    GameObject* createObjectInstance(const TerrainObject &objectType, const Point3 &position, const Quaternion &rotation) const;
+
+    // Removes the static meshes under a transform, adding them to the list of parts if one is given.
+    // A mesh is static when neither its object nor any of its parents have components other than
+    // transforms, static meshes and colliders. Returns whether any of the objects have other components left.
+    static bool removeInstancedParts(Transform* transform, const Matrix4x4 &worldToRoot, bool parentsStatic, std::vector<InstancedPart>* parts);
+
+    // Rebuilds the instanced static meshes from every placed object layer
+    void rebuildPlacedInstances();
+
+    // Generates the detail positions for the given detail batch where the mask allows, and sets the batch's count
+    void generateDetailPositions(DetailBatch &batch, uint32_t seed, const PlacementMask &mask, std::vector<Vector4> &positions) const;
 
-    // Generates object instances for the given object type
-    void generateObjectInstances(const TerrainObject &objectType);
+    // Samples the heights at a list of placed points, where each point's y is a world z coordinate
+    void samplePointHeights(const std::vector<Vector2> &points, std::vector<float> &heights) const;
 
-    // Generates detail positions for the given detail batch
-    void generateDetailPositions(DetailBatch &batch, uint32_t seed) const;
+    // The collider of the streamed tile under a point in world space, or null if it has none
+    const TerrainTileCollider* findTileCollider(float x, float z) const;
 
 public:
-    // Gets the heightmap height at a specified point
+    // Gets the heightmap height at a specified point, using bilinear filtering.
+    // Streamed tiles with colliders are sampled in place of the heightmap.
     // The x and z coordinates are in world space.
     float sampleHeightmap(float x, float z) const;
 
-    // Gets the heightmap normal at a specified point
+    // Gets the heightmap normal at a specified point, using bilinear filtering.
     // The x and z coordinates are in world space.
     Vector3 sampleHeightmapNormal(float x, float z) const;
 };
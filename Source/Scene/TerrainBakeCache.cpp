@@ -0,0 +1,212 @@
+#include "TerrainBakeCache.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const char BAKE_MAGIC[4] = { 'T', 'B', 'A', 'K' };
+    // The version of the file format. Changes to what is generated are covered by the key instead,
+    // through TerrainGenerator::OUTPUT_VERSION and Terrain::PLACEMENT_VERSION.
+    const uint32_t BAKE_VERSION = 1;
+
+    // Sections of the file start on 64 byte boundaries
+    size_t alignSection(size_t size)
+    {
+        return (size + 63) & ~(size_t)63;
+    }
+}
+
+TerrainBakeKey::TerrainBakeKey()
+    : hash_(14695981039346656037ull)
+{
+
+}
+
+void TerrainBakeKey::add(const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash_ ^= bytes[i];
+        hash_ *= 1099511628211ull;
+    }
+}
+
+std::string TerrainBakeCache::bakePath(const std::string &directory, uint64_t key)
+{
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "TerrainBake_%016llx.cache", (unsigned long long)key);
+    return directory + "/" + fileName;
+}
+
+bool TerrainBakeCache::save(const std::string &path, uint64_t key, const TerrainBakeContents &contents)
+{
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BAKE_MAGIC, sizeof(header.magic));
+    header.version = BAKE_VERSION;
+    header.key = key;
+    header.resolution = contents.resolution;
+    header.maxHeight = contents.maxHeight;
+    header.objectLayerCount = (uint32_t)contents.objectLayerCounts.size();
+    header.objectCount = (uint32_t)contents.objects.size();
+    header.detailBatchCount = (uint32_t)contents.detailBatches.size();
+    header.detailPositionCount = (uint32_t)(contents.detailPositions.size() / 4);
+
+    const Layout layout = computeLayout(header);
+    MappedFile file;
+    if (!file.open(path, layout.size))
+    {
+        return false;
+    }
+
+    // Write the header last, so a file that is only partly written is never accepted
+    const size_t texels = (size_t)contents.resolution * contents.resolution;
+    uint8_t* data = file.data();
+    std::memset(data, 0, sizeof(Header));
+    std::memcpy(data + layout.heights, contents.heights, texels * sizeof(float));
+    std::memcpy(data + layout.normals, contents.normals, texels * 4 * sizeof(float));
+    std::memcpy(data + layout.textureHeights, contents.textureHeights, texels * sizeof(uint16_t));
+    std::memcpy(data + layout.objectLayerCounts, contents.objectLayerCounts.data(), contents.objectLayerCounts.size() * sizeof(uint32_t));
+    std::memcpy(data + layout.objects, contents.objects.data(), contents.objects.size() * sizeof(TerrainBakeObject));
+    std::memcpy(data + layout.detailBatches, contents.detailBatches.data(), contents.detailBatches.size() * sizeof(TerrainBakeDetailBatch));
+    std::memcpy(data + layout.detailPositions, contents.detailPositions.data(), contents.detailPositions.size() * sizeof(float));
+    file.flush();
+    std::memcpy(data, &header, sizeof(header));
+
+    file.close();
+    return true;
+}
+
+bool TerrainBakeCache::open(const std::string &path, uint64_t key, int resolution)
+{
+    close();
+
+    if (!file_.openReadOnly(path) || file_.size() < sizeof(Header))
+    {
+        close();
+        return false;
+    }
+
+    const Header& bakedHeader = header();
+    if (std::memcmp(bakedHeader.magic, BAKE_MAGIC, sizeof(bakedHeader.magic)) != 0
+        || bakedHeader.version != BAKE_VERSION
+        || bakedHeader.key != key
+        || bakedHeader.resolution != resolution)
+    {
+        close();
+        return false;
+    }
+
+    // The file may have been left larger by an earlier bake, but never smaller
+    layout_ = computeLayout(bakedHeader);
+    if (file_.size() < layout_.size)
+    {
+        close();
+        return false;
+    }
+
+    // Find where each object layer starts, checking the layers add up to the object count
+    const uint32_t* layerCounts = (const uint32_t*)(file_.data() + layout_.objectLayerCounts);
+    objectLayerStarts_.resize(bakedHeader.objectLayerCount);
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < bakedHeader.objectLayerCount; ++i)
+    {
+        objectLayerStarts_[i] = start;
+        start += layerCounts[i];
+    }
+
+    if (start != bakedHeader.objectCount)
+    {
+        close();
+        return false;
+    }
+
+    // Check each detail batch's positions are in the file
+    const TerrainBakeDetailBatch* batches = detailBatches();
+    for (uint32_t i = 0; i < bakedHeader.detailBatchCount; ++i)
+    {
+        if (batches[i].count < 0 || (uint64_t)batches[i].firstPosition + batches[i].count > bakedHeader.detailPositionCount)
+        {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TerrainBakeCache::close()
+{
+    file_.close();
+    objectLayerStarts_.clear();
+}
+
+float TerrainBakeCache::maxHeight() const
+{
+    return header().maxHeight;
+}
+
+const float* TerrainBakeCache::heights() const
+{
+    return (const float*)(file_.data() + layout_.heights);
+}
+
+const float* TerrainBakeCache::normals() const
+{
+    return (const float*)(file_.data() + layout_.normals);
+}
+
+const uint16_t* TerrainBakeCache::textureHeights() const
+{
+    return (const uint16_t*)(file_.data() + layout_.textureHeights);
+}
+
+int TerrainBakeCache::objectLayerCount() const
+{
+    return (int)header().objectLayerCount;
+}
+
+const TerrainBakeObject* TerrainBakeCache::objects(int layer, int &count) const
+{
+    const uint32_t* layerCounts = (const uint32_t*)(file_.data() + layout_.objectLayerCounts);
+    count = (int)layerCounts[layer];
+    return (const TerrainBakeObject*)(file_.data() + layout_.objects) + objectLayerStarts_[layer];
+}
+
+int TerrainBakeCache::detailBatchCount() const
+{
+    return (int)header().detailBatchCount;
+}
+
+const TerrainBakeDetailBatch* TerrainBakeCache::detailBatches() const
+{
+    return (const TerrainBakeDetailBatch*)(file_.data() + layout_.detailBatches);
+}
+
+int TerrainBakeCache::detailPositionCount() const
+{
+    return (int)header().detailPositionCount;
+}
+
+const float* TerrainBakeCache::detailPositions() const
+{
+    return (const float*)(file_.data() + layout_.detailPositions);
+}
+
+TerrainBakeCache::Layout TerrainBakeCache::computeLayout(const Header &header)
+{
+    const size_t texels = (size_t)header.resolution * header.resolution;
+
+    Layout layout;
+    layout.heights = alignSection(sizeof(Header));
+    layout.normals = layout.heights + alignSection(texels * sizeof(float));
+    layout.textureHeights = layout.normals + alignSection(texels * 4 * sizeof(float));
+    layout.objectLayerCounts = layout.textureHeights + alignSection(texels * sizeof(uint16_t));
+    layout.objects = layout.objectLayerCounts + alignSection(header.objectLayerCount * sizeof(uint32_t));
+    layout.detailBatches = layout.objects + alignSection(header.objectCount * sizeof(TerrainBakeObject));
+    layout.detailPositions = layout.detailBatches + alignSection(header.detailBatchCount * sizeof(TerrainBakeDetailBatch));
+    layout.size = layout.detailPositions + (size_t)header.detailPositionCount * 4 * sizeof(float);
+    return layout;
+}
\ No newline at end of file
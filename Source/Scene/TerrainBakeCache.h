@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Utils/MappedFile.h"
+
+// Builds the key that identifies a baked terrain, from every setting that affects its generation
+// and the versions of the code that generates it.
+// The key is a 64 bit FNV-1a hash of the bytes added to it.
+class TerrainBakeKey
+{
+public:
+    TerrainBakeKey();
+
+    void add(const void* data, size_t size);
+
+    template<typename T>
+    void add(const T &value)
+    {
+        add(&value, sizeof(value));
+    }
+
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_;
+};
+
+// A placed object instance in a baked terrain
+struct TerrainBakeObject
+{
+    float position[3];
+    float rotation[4];
+};
+
+// A detail batch in a baked terrain.
+// The positions of every batch are stored together, and each batch refers to a range of them.
+struct TerrainBakeDetailBatch
+{
+    int32_t count;
+    uint32_t firstPosition;
+    float boundsMin[3];
+    float boundsMax[3];
+    float drawDistance;
+};
+
+// The outputs of terrain generation, gathered together to be baked
+struct TerrainBakeContents
+{
+    int resolution = 0;
+    float maxHeight = 1.0f;
+
+    // resolution * resolution heights, normals (x, y, z, 0) and texture heights
+    const float* heights = nullptr;
+    const float* normals = nullptr;
+    const uint16_t* textureHeights = nullptr;
+
+    // The number of objects in each placed object layer, and the objects of every layer in order
+    std::vector<uint32_t> objectLayerCounts;
+    std::vector<TerrainBakeObject> objects;
+
+    // The detail batches, and their positions as (x, y, z, scale)
+    std::vector<TerrainBakeDetailBatch> detailBatches;
+    std::vector<float> detailPositions;
+};
+
+// The generated heightmap, placed objects and detail batches of a terrain, stored in a file.
+//
+// Generation is deterministic, so a terrain whose settings match a baked one
+// can be loaded straight from the file instead of being generated again.
+// The file is memory mapped, and its sections are read in place.
+class TerrainBakeCache
+{
+public:
+    // The path of the baked file for a key. Each key has its own file.
+    static std::string bakePath(const std::string &directory, uint64_t key);
+
+    // Writes a baked terrain to a file. Returns false if the file can't be written.
+    static bool save(const std::string &path, uint64_t key, const TerrainBakeContents &contents);
+
+    // Opens a baked terrain. Returns false if there is no file, or it was baked
+    // with a different key, resolution or version of the format.
+    bool open(const std::string &path, uint64_t key, int resolution);
+
+    // Closes the file. The pointers returned by the accessors are no longer valid.
+    void close();
+
+    bool isOpen() const { return file_.isOpen(); }
+
+    float maxHeight() const;
+
+    // The sections of the baked terrain, laid out as in TerrainBakeContents
+    const float* heights() const;
+    const float* normals() const;
+    const uint16_t* textureHeights() const;
+
+    // The objects placed for an object layer
+    int objectLayerCount() const;
+    const TerrainBakeObject* objects(int layer, int &count) const;
+
+    int detailBatchCount() const;
+    const TerrainBakeDetailBatch* detailBatches() const;
+
+    // The positions of every detail batch, four floats each
+    int detailPositionCount() const;
+    const float* detailPositions() const;
+
+private:
+    // The start of the file, followed by each section in the order of TerrainBakeContents
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        int32_t resolution;
+        float maxHeight;
+        uint32_t objectLayerCount;
+        uint32_t objectCount;
+        uint32_t detailBatchCount;
+        uint32_t detailPositionCount;
+    };
+
+    // The offsets of each section from the start of the file
+    struct Layout
+    {
+        size_t heights;
+        size_t normals;
+        size_t textureHeights;
+        size_t objectLayerCounts;
+        size_t objects;
+        size_t detailBatches;
+        size_t detailPositions;
+        size_t size;
+    };
+
+    MappedFile file_;
+    Layout layout_;
+
+    // The first object of each layer
+    std::vector<uint32_t> objectLayerStarts_;
+
+    const Header& header() const { return *(const Header*)file_.data(); }
+
+    static Layout computeLayout(const Header &header);
+};
\ No newline at end of file
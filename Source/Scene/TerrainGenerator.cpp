@@ -0,0 +1,612 @@
+#include "TerrainGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <emmintrin.h>
+#include <math.h>
+
+#include "Math/Random.h"
+#include "Utils/JobSystem.h"
+
+// Defined here as well, as the bake and tile cache keys take it by reference
+const uint32_t TerrainGenerator::OUTPUT_VERSION;
+
+namespace
+{
+    // The number of rows processed by a single task
+    const int ROWS_PER_TASK = 16;
+
+    int taskCountForRows(int rows)
+    {
+        return (rows + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    }
+
+    // Computes log2(x) for four positive values.
+    // The mantissa is mapped to [sqrt(0.5), sqrt(2)) and log2 is found with the series
+    // ln(m) = 2 * atanh((m - 1) / (m + 1)), which is accurate to float precision here.
+    __m128 log2x4(__m128 x)
+    {
+        const __m128i bits = _mm_castps_si128(x);
+        __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+        __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+        // Halve mantissas above sqrt(2) so the series converges quickly
+        const __m128 large = _mm_cmpgt_ps(mantissa, _mm_set1_ps(1.41421356f));
+        mantissa = _mm_or_ps(_mm_and_ps(large, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))), _mm_andnot_ps(large, mantissa));
+        exponent = _mm_sub_epi32(exponent, _mm_castps_si128(large));
+
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+        const __m128 t2 = _mm_mul_ps(t, t);
+        __m128 series = _mm_set1_ps(1.0f / 9.0f);
+        series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(1.0f / 7.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(1.0f / 5.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(1.0f / 3.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, t2), one);
+
+        // 2 / ln(2) converts 2 * atanh(t) from natural log to log2
+        const __m128 log2Mantissa = _mm_mul_ps(_mm_mul_ps(series, t), _mm_set1_ps(2.88539008f));
+        return _mm_add_ps(_mm_cvtepi32_ps(exponent), log2Mantissa);
+    }
+
+    // Computes 2^x for four values, using a Taylor series for the fractional part.
+    __m128 exp2x4(__m128 x)
+    {
+        x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(127.0f)), _mm_set1_ps(-126.0f));
+
+        const __m128i whole = _mm_cvtps_epi32(x);
+        const __m128 f = _mm_mul_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(whole)), _mm_set1_ps(0.693147181f));
+
+        __m128 series = _mm_set1_ps(1.0f / 720.0f);
+        series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f / 120.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f / 24.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f / 6.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(0.5f));
+        series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, f), _mm_set1_ps(1.0f));
+
+        const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, _mm_set1_epi32(127)), 23));
+        return _mm_mul_ps(series, scale);
+    }
+
+    // Computes x^power for four values. Values of x at or below zero return zero.
+    // Only basic SSE arithmetic is used, so unlike powf the results are the same on every platform.
+    __m128 powx4(__m128 x, __m128 power)
+    {
+        const __m128 positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+        const __m128 result = exp2x4(_mm_mul_ps(log2x4(x), power));
+        return _mm_and_ps(positive, result);
+    }
+
+    // Computes the island mask for four adjacent texels of a row, starting at column x.
+    // Use an "island factor" to flatten parts near the edge of the heightmap
+    // Just compute the distance from the island centre and flatten, with a controlable power factor.
+    __m128 islandMaskx4(int x, __m128 distanceYSquared, __m128 inverseResolution, __m128 islandFactor)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+
+        const __m128 column = _mm_add_ps(_mm_set1_ps((float)x), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+        const __m128 distanceX = _mm_sub_ps(_mm_mul_ps(column, inverseResolution), half);
+        __m128 distanceFromCentre = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(distanceX, distanceX), distanceYSquared)), two);
+        distanceFromCentre = _mm_min_ps(distanceFromCentre, one);
+        return _mm_sub_ps(one, powx4(distanceFromCentre, islandFactor));
+    }
+
+    // The squared distance of a row from the island centre, for islandMaskx4
+    __m128 islandRowDistanceSquared(int y, int resolution)
+    {
+        const __m128 distanceY = _mm_sub_ps(_mm_set1_ps(y / (float)resolution), _mm_set1_ps(0.5f));
+        return _mm_mul_ps(distanceY, distanceY);
+    }
+}
+
+TerrainGenerator::TerrainGenerator(JobSystem* jobSystem)
+    : jobSystem_(jobSystem),
+    lastGenerationMilliseconds_(0.0f),
+    maxHeight_(1.0f),
+    generated_(false),
+    dirtyTilesPerRow_(0)
+{
+}
+
+bool TerrainGenerator::generate(const TerrainGenerationSettings &settings, std::vector<float> &heights, std::vector<uint16_t> &textureHeights)
+{
+    /*
+     * See Terrain::generateTerrain for a description of the algorithm.
+     * The passes are the same, but the work in each pass is split into bands
+     * of rows, and the intermediate results are kept so that only the stages
+     * downstream of a changed setting need to run.
+     */
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Work out which stages have changed inputs
+    const bool resolutionChanged = !generated_ || settings.resolution != settings_.resolution;
+    const bool fractalChanged = resolutionChanged
+        || settings.height != settings_.height
+        || settings.seed != settings_.seed
+        || settings.fractalSmoothness != settings_.fractalSmoothness;
+    const bool mountainChanged = fractalChanged || settings.mountainScale != settings_.mountainScale;
+    const bool islandChanged = resolutionChanged || settings.islandFactor != settings_.islandFactor;
+
+    const size_t elementCount = (size_t)settings.resolution * settings.resolution;
+    const bool outputResized = heights.size() != elementCount || textureHeights.size() != elementCount;
+
+    settings_ = settings;
+    generated_ = true;
+
+    if (resolutionChanged)
+    {
+        fractalHeights_.resize(elementCount);
+        fractalScratch_.resize(elementCount);
+        mountainHeights_.resize(elementCount);
+        islandMask_.resize(elementCount);
+
+        dirtyTilesPerRow_ = (settings.resolution + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+        dirtyTiles_.resize(dirtyTilesPerRow_ * dirtyTilesPerRow_);
+    }
+
+    // Each thread of the job system needs its own scratch row
+    const int threadCount = (jobSystem() == nullptr) ? 1 : jobSystem()->threadCount();
+    scratchRows_.resize(threadCount);
+    threadMaxHeights_.resize(threadCount);
+    for (std::vector<float> &scratch : scratchRows_)
+    {
+        scratch.resize(settings.resolution + 4);
+    }
+
+    if (outputResized)
+    {
+        heights.resize(elementCount);
+        textureHeights.resize(elementCount);
+    }
+
+    // Nothing to do if the output would be the same
+    if (!mountainChanged && !islandChanged && !outputResized)
+    {
+        std::fill(dirtyTiles_.begin(), dirtyTiles_.end(), 0);
+        lastGenerationMilliseconds_ = 0.0f;
+        return false;
+    }
+
+    if (fractalChanged)
+    {
+        runFractalStage();
+    }
+
+    if (mountainChanged)
+    {
+        runMountainStage();
+    }
+
+    if (islandChanged)
+    {
+        runIslandStage();
+    }
+
+    runOutputStage(heights, textureHeights, outputResized);
+
+    lastGenerationMilliseconds_ = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    return true;
+}
+
+bool TerrainGenerator::regionChanged(int minX, int minY, int maxX, int maxY) const
+{
+    // Clamp the region to the heightmap
+    const int lastTexel = settings_.resolution - 1;
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    maxX = std::min(maxX, lastTexel);
+    maxY = std::min(maxY, lastTexel);
+
+    for (int tileY = minY / DIRTY_TILE_SIZE; tileY <= maxY / DIRTY_TILE_SIZE; ++tileY)
+    {
+        for (int tileX = minX / DIRTY_TILE_SIZE; tileX <= maxX / DIRTY_TILE_SIZE; ++tileX)
+        {
+            if (tileChanged(tileX, tileY))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void TerrainGenerator::generateRegion(const TerrainGenerationSettings &settings, int x, int y, int width, int height, float* heights)
+{
+    const int resolution = settings.resolution;
+
+    // The part of the region inside the heightmap. Texels outside it are copied from the edge afterwards.
+    const int minX = std::min(std::max(x, 0), resolution - 1);
+    const int minY = std::min(std::max(y, 0), resolution - 1);
+    const int maxX = std::min(std::max(x + width - 1, 0), resolution - 1);
+    const int maxY = std::min(std::max(y + height - 1, 0), resolution - 1);
+
+    // Work out the window of each fractal level that the region depends on, finest first.
+    // Each texel depends on the two nearest texels of the level below in each direction.
+    struct Window
+    {
+        int resolution;
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    std::vector<Window> windows;
+    Window window = { resolution, minX, minY, maxX, maxY };
+    windows.push_back(window);
+    while (window.resolution > 1)
+    {
+        const int belowResolution = window.resolution / 2;
+        window = { belowResolution, window.minX / 2, window.minY / 2,
+            std::min(window.maxX / 2 + 1, belowResolution - 1), std::min(window.maxY / 2 + 1, belowResolution - 1) };
+        windows.push_back(window);
+    }
+
+    // Run the fractal passes over just the windows, starting from the single root value.
+    // The arithmetic and random offsets are the same as runFractalPass, so the values match exactly.
+    std::vector<float> source(1, settings.height / 2.0f);
+    std::vector<float> dest;
+    std::vector<float> interpolated;
+    float moveSize = settings.height / 2.0f;
+    for (int level = (int)windows.size() - 2; level >= 0; --level)
+    {
+        const Window &from = windows[level + 1];
+        const Window &to = windows[level];
+        const int fromWidth = from.maxX - from.minX + 1;
+        const int toWidth = to.maxX - to.minX + 1;
+        dest.resize((size_t)toWidth * (to.maxY - to.minY + 1));
+        interpolated.resize(fromWidth + 1);
+
+        RandomStream random = RandomStream((uint64_t)settings.seed).split(to.resolution);
+        for (int row = to.minY; row <= to.maxY; ++row)
+        {
+            // Interpolate vertically between the two nearest source rows
+            const float* row0 = source.data() + (size_t)(row / 2 - from.minY) * fromWidth;
+            const float* row1 = source.data() + (size_t)(std::min(row / 2 + 1, from.resolution - 1) - from.minY) * fromWidth;
+            for (int i = 0; i < fromWidth; ++i)
+            {
+                interpolated[i] = (row % 2) == 0 ? row0[i] : (row0[i] + row1[i]) * 0.5f;
+            }
+
+            // Only used when the window reaches the edge of the level, where interpolation is clamped
+            interpolated[fromWidth] = interpolated[fromWidth - 1];
+
+            float* destRow = dest.data() + (size_t)(row - to.minY) * toWidth;
+            random.seek((uint64_t)row * to.resolution + to.minX);
+            random.fillFloat(destRow, toWidth, -moveSize, moveSize);
+
+            for (int column = to.minX; column <= to.maxX; ++column)
+            {
+                const int sourceColumn = column / 2 - from.minX;
+                const float value = (column % 2) == 0
+                    ? interpolated[sourceColumn]
+                    : (interpolated[sourceColumn] + interpolated[sourceColumn + 1]) * 0.5f;
+                destRow[column - to.minX] += value;
+            }
+        }
+
+        source.swap(dest);
+        moveSize /= settings.fractalSmoothness;
+    }
+
+    // Apply the mountain and island stages, four texels at a time
+    const int windowWidth = maxX - minX + 1;
+    const __m128 mountainScale = _mm_set1_ps(settings.mountainScale);
+    const __m128 islandFactor = _mm_set1_ps(settings.islandFactor);
+    const __m128 inverseResolution = _mm_set1_ps(1.0f / (float)resolution);
+    for (int row = minY; row <= maxY; ++row)
+    {
+        float* values = source.data() + (size_t)(row - minY) * windowWidth;
+        const bool edgeRow = row == 0 || row == resolution - 1;
+        const __m128 distanceYSquared = islandRowDistanceSquared(row, resolution);
+
+        for (int i = 0; i < windowWidth; i += 4)
+        {
+            float padded[4];
+            const int count = std::min(4, windowWidth - i);
+            std::copy(values + i, values + i + count, padded);
+            std::fill(padded + count, padded + 4, 0.0f);
+
+            const __m128 mountain = powx4(_mm_loadu_ps(padded), mountainScale);
+            const __m128 mask = edgeRow ? _mm_setzero_ps() : islandMaskx4(minX + i, distanceYSquared, inverseResolution, islandFactor);
+            _mm_storeu_ps(padded, _mm_mul_ps(mountain, mask));
+            std::copy(padded, padded + count, values + i);
+        }
+
+        // The island mask forces the edge columns to 0
+        if (minX == 0)
+        {
+            values[0] = 0.0f;
+        }
+        if (maxX == resolution - 1)
+        {
+            values[windowWidth - 1] = 0.0f;
+        }
+    }
+
+    // Copy out the region, clamping texels outside the heightmap to its edge
+    for (int row = 0; row < height; ++row)
+    {
+        const int sourceRow = std::min(std::max(y + row, minY), maxY) - minY;
+        for (int column = 0; column < width; ++column)
+        {
+            const int sourceColumn = std::min(std::max(x + column, minX), maxX) - minX;
+            heights[(size_t)row * width + column] = source[(size_t)sourceRow * windowWidth + sourceColumn];
+        }
+    }
+}
+
+void TerrainGenerator::runFractalStage()
+{
+    // Reset the heightmap to a single value.
+    int resolution = 1;
+    fractalHeights_[0] = settings_.height / 2.0f;
+
+    // Run fractal passes, doubling the heightmap size each time, until
+    // we are up to the required resolution.
+    float moveSize = settings_.height / 2.0f;
+    while (resolution < settings_.resolution)
+    {
+        runFractalPass(fractalHeights_.data(), fractalScratch_.data(), resolution, moveSize);
+        fractalHeights_.swap(fractalScratch_);
+
+        resolution *= 2;
+        moveSize /= settings_.fractalSmoothness;
+    }
+}
+
+void TerrainGenerator::runFractalPass(const float* source, float* dest, int resolution, float moveSize)
+{
+    const int newResolution = resolution * 2;
+
+    // Each pass and row has its own position in the random stream,
+    // so the rows can be generated in any order on any thread.
+    const RandomStream passRandom = RandomStream((uint64_t)settings_.seed).split(newResolution);
+    parallelFor("TerrainFractalPass", taskCountForRows(newResolution), [&](int threadIndex, int taskIndex)
+    {
+        RandomStream random = passRandom;
+        float* interpolated = scratchRows_[threadIndex].data();
+
+        const int firstRow = taskIndex * ROWS_PER_TASK;
+        const int lastRow = std::min(firstRow + ROWS_PER_TASK, newResolution);
+        for (int y = firstRow; y < lastRow; ++y)
+        {
+            // Interpolate vertically between the two nearest source rows
+            const float* row0 = source + (y / 2) * resolution;
+            const float* row1 = source + std::min(y / 2 + 1, resolution - 1) * resolution;
+            if ((y % 2) == 0)
+            {
+                std::copy(row0, row0 + resolution, interpolated);
+            }
+            else
+            {
+                const __m128 half = _mm_set1_ps(0.5f);
+                int x = 0;
+                for (; x + 4 <= resolution; x += 4)
+                {
+                    const __m128 sum = _mm_add_ps(_mm_loadu_ps(row0 + x), _mm_loadu_ps(row1 + x));
+                    _mm_storeu_ps(interpolated + x, _mm_mul_ps(sum, half));
+                }
+                for (; x < resolution; ++x)
+                {
+                    interpolated[x] = (row0[x] + row1[x]) * 0.5f;
+                }
+            }
+
+            // Repeat the last value, so the horizontal interpolation is clamped at the edge.
+            interpolated[resolution] = interpolated[resolution - 1];
+
+            // Start the output row with the random offsets
+            float* destRow = dest + y * newResolution;
+            random.seek(y * newResolution);
+            random.fillFloat(destRow, newResolution, -moveSize, moveSize);
+
+            // Interpolate horizontally, writing even (copied) and odd (averaged) values
+            const __m128 half = _mm_set1_ps(0.5f);
+            int x = 0;
+            for (; x + 4 <= resolution; x += 4)
+            {
+                const __m128 even = _mm_loadu_ps(interpolated + x);
+                const __m128 next = _mm_loadu_ps(interpolated + x + 1);
+                const __m128 odd = _mm_mul_ps(_mm_add_ps(even, next), half);
+
+                float* out = destRow + x * 2;
+                _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_unpacklo_ps(even, odd)));
+                _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(even, odd)));
+            }
+            for (; x < resolution; ++x)
+            {
+                destRow[x * 2] += interpolated[x];
+                destRow[x * 2 + 1] += (interpolated[x] + interpolated[x + 1]) * 0.5f;
+            }
+        }
+    });
+}
+
+void TerrainGenerator::runMountainStage()
+{
+    const int resolution = settings_.resolution;
+    const float* source = fractalHeights_.data();
+    float* dest = mountainHeights_.data();
+
+    parallelFor("TerrainMountainStage", taskCountForRows(resolution), [&](int, int taskIndex)
+    {
+        // Raise each height value to a power, allowing a controllable "mountain factor"
+        // that pulls high bits up and squashes lower bits down.
+        const __m128 mountainScale = _mm_set1_ps(settings_.mountainScale);
+
+        // The resolution is a power of two of at least 4, so the range is always a multiple of four.
+        const size_t first = (size_t)taskIndex * ROWS_PER_TASK * resolution;
+        const size_t last = std::min(first + (size_t)ROWS_PER_TASK * resolution, (size_t)resolution * resolution);
+        for (size_t i = first; i < last; i += 4)
+        {
+            _mm_storeu_ps(dest + i, powx4(_mm_loadu_ps(source + i), mountainScale));
+        }
+    });
+}
+
+void TerrainGenerator::runIslandStage()
+{
+    const int resolution = settings_.resolution;
+    float* mask = islandMask_.data();
+
+    parallelFor("TerrainIslandStage", taskCountForRows(resolution), [&](int, int taskIndex)
+    {
+        const __m128 islandFactor = _mm_set1_ps(settings_.islandFactor);
+        const __m128 inverseResolution = _mm_set1_ps(1.0f / (float)resolution);
+
+        const int firstRow = taskIndex * ROWS_PER_TASK;
+        const int lastRow = std::min(firstRow + ROWS_PER_TASK, resolution);
+        for (int y = firstRow; y < lastRow; ++y)
+        {
+            float* row = mask + y * resolution;
+
+            // Force values at the very edge of the terrain to 0.
+            // This prevents weird artifacts in the water depth calculations
+            if (y == 0 || y == resolution - 1)
+            {
+                std::fill(row, row + resolution, 0.0f);
+                continue;
+            }
+
+            const __m128 distanceYSquared = islandRowDistanceSquared(y, resolution);
+            for (int x = 0; x < resolution; x += 4)
+            {
+                _mm_storeu_ps(row + x, islandMaskx4(x, distanceYSquared, inverseResolution, islandFactor));
+            }
+
+            row[0] = 0.0f;
+            row[resolution - 1] = 0.0f;
+        }
+    });
+}
+
+void TerrainGenerator::runOutputStage(std::vector<float> &heights, std::vector<uint16_t> &textureHeights, bool allTilesChanged)
+{
+    const int resolution = settings_.resolution;
+    const size_t elementCount = (size_t)resolution * resolution;
+    const float* mountain = mountainHeights_.data();
+    const float* mask = islandMask_.data();
+    float* output = heights.data();
+
+    // Combine the mountain heights with the island mask and find the maximum height
+    std::fill(threadMaxHeights_.begin(), threadMaxHeights_.end(), 0.0f);
+    parallelFor("TerrainMaxHeight", taskCountForRows(resolution), [&](int threadIndex, int taskIndex)
+    {
+        __m128 maxHeight = _mm_setzero_ps();
+
+        const size_t first = (size_t)taskIndex * ROWS_PER_TASK * resolution;
+        const size_t last = std::min(first + (size_t)ROWS_PER_TASK * resolution, elementCount);
+        for (size_t i = first; i < last; i += 4)
+        {
+            const __m128 height = _mm_mul_ps(_mm_loadu_ps(mountain + i), _mm_loadu_ps(mask + i));
+            _mm_storeu_ps(output + i, height);
+            maxHeight = _mm_max_ps(maxHeight, height);
+        }
+
+        float maxHeights[4];
+        _mm_storeu_ps(maxHeights, maxHeight);
+        const float taskMax = std::max(std::max(maxHeights[0], maxHeights[1]), std::max(maxHeights[2], maxHeights[3]));
+        threadMaxHeights_[threadIndex] = std::max(threadMaxHeights_[threadIndex], taskMax);
+    });
+
+    float maxHeight = *std::max_element(threadMaxHeights_.begin(), threadMaxHeights_.end());
+    if (maxHeight <= 0.0f)
+    {
+        maxHeight = 1.0f;
+    }
+    maxHeight_ = maxHeight;
+
+    // Normalize the heights and build the texture data.
+    // Each task handles one row of dirty tiles, comparing the new texels against the old ones.
+    uint16_t* texels = textureHeights.data();
+    const float heightScale = settings_.height / maxHeight;
+    const float texelScale = 65535.0f / maxHeight;
+
+    parallelFor("TerrainOutputStage", dirtyTilesPerRow_, [&](int, int tileY)
+    {
+        const __m128 heightScale4 = _mm_set1_ps(heightScale);
+        const __m128 texelScale4 = _mm_set1_ps(texelScale);
+        const __m128i signBias = _mm_set1_epi32(32768);
+        const __m128i signFlip = _mm_set1_epi16((short)0x8000);
+
+        uint8_t* dirtyRow = dirtyTiles_.data() + tileY * dirtyTilesPerRow_;
+        std::fill(dirtyRow, dirtyRow + dirtyTilesPerRow_, allTilesChanged ? 1 : 0);
+
+        const int firstRow = tileY * DIRTY_TILE_SIZE;
+        const int lastRow = std::min(firstRow + DIRTY_TILE_SIZE, resolution);
+        for (int y = firstRow; y < lastRow; ++y)
+        {
+            float* heightRow = output + (size_t)y * resolution;
+            uint16_t* texelRow = texels + (size_t)y * resolution;
+
+            int x = 0;
+            for (; x + 8 <= resolution; x += 8)
+            {
+                const __m128 h0 = _mm_loadu_ps(heightRow + x);
+                const __m128 h1 = _mm_loadu_ps(heightRow + x + 4);
+
+                // Generate a uint16 version of the data (normalized) for passing to the gpu.
+                // SSE2 can only pack to signed 16 bit values, so bias into signed range and flip back.
+                const __m128i t0 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(h0, texelScale4)), signBias);
+                const __m128i t1 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(h1, texelScale4)), signBias);
+                const __m128i newTexels = _mm_xor_si128(_mm_packs_epi32(t0, t1), signFlip);
+
+                // Mark the tile as changed if any texel differs
+                const __m128i oldTexels = _mm_loadu_si128((const __m128i*)(texelRow + x));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(oldTexels, newTexels)) != 0xFFFF)
+                {
+                    dirtyRow[x / DIRTY_TILE_SIZE] = 1;
+                }
+                _mm_storeu_si128((__m128i*)(texelRow + x), newTexels);
+
+                // Also correct the on-cpu heightfield to match
+                _mm_storeu_ps(heightRow + x, _mm_mul_ps(h0, heightScale4));
+                _mm_storeu_ps(heightRow + x + 4, _mm_mul_ps(h1, heightScale4));
+            }
+            for (; x < resolution; ++x)
+            {
+                const uint16_t texel = (uint16_t)(heightRow[x] * texelScale);
+                if (texelRow[x] != texel)
+                {
+                    dirtyRow[x / DIRTY_TILE_SIZE] = 1;
+                }
+                texelRow[x] = texel;
+                heightRow[x] *= heightScale;
+            }
+        }
+    });
+}
+
+void TerrainGenerator::parallelFor(const char* name, int taskCount, const std::function<void(int, int)> &task) const
+{
+    JobSystem* jobs = jobSystem();
+    if (jobs == nullptr)
+    {
+        for (int taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+        {
+            task(0, taskIndex);
+        }
+        return;
+    }
+
+    // Tasks are already coarse, so each one is a job of its own
+    jobs->parallelFor(name, taskCount, 1, [&](int begin, int end)
+    {
+        const int threadIndex = jobs->currentThreadIndex();
+        for (int taskIndex = begin; taskIndex < end; ++taskIndex)
+        {
+            task(threadIndex, taskIndex);
+        }
+    });
+}
+
+JobSystem* TerrainGenerator::jobSystem() const
+{
+    return (jobSystem_ != nullptr) ? jobSystem_ : JobSystem::instance();
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class JobSystem;
+
+// The properties that control the shape of a generated heightmap
+struct TerrainGenerationSettings
+{
+    int resolution = 1024;
+    float height = 80.0f;
+    int seed = 0;
+    float fractalSmoothness = 2.0f;
+    float mountainScale = 4.0f;
+    float islandFactor = 2.0f;
+};
+
+// Generates fractal island heightmaps.
+//
+// Generation is split into stages - the fractal base heights, the mountain
+// power curve, the island mask, and the final normalized heightmap. The output
+// of each stage is cached, and a stage only runs again when its inputs change,
+// so tweaking the island factor doesn't rerun the fractal passes.
+//
+// Within a stage the heightmap is split into bands of rows which are processed
+// in parallel, and the inner loops use SSE2. Random offsets come from counter
+// based streams indexed by position, so the output is identical regardless of
+// the number of threads used. The bands are run as jobs on the engine's job system.
+class TerrainGenerator
+{
+public:
+    // The size of the tiles used to track which parts of the heightmap changed
+    const static int DIRTY_TILE_SIZE = 64;
+
+    // Part of the key of baked terrains. Bump it whenever a change to the generator
+    // changes the heights it outputs, so terrains baked by older versions are regenerated.
+    const static uint32_t OUTPUT_VERSION = 1;
+
+    // Runs its work on the given job system, or on JobSystem::instance() if none is given.
+    // Without either, everything runs on the calling thread.
+    explicit TerrainGenerator(JobSystem* jobSystem = nullptr);
+
+    // Updates a heightmap with values between 0 and settings.height, along with
+    // a normalized 16 bit copy suitable for uploading to a texture.
+    // Only the stages affected by settings changed since the last call are run.
+    // Returns true if the heights changed. Resolution must be a power of two, and at least 4.
+    bool generate(const TerrainGenerationSettings &settings, std::vector<float> &heights, std::vector<uint16_t> &textureHeights);
+
+    // Forgets the cached stages, so the next call to generate runs all of them.
+    // Needed when the heights passed to generate were loaded from somewhere else.
+    void reset() { generated_ = false; }
+
+    // Whether any texel in the given range (inclusive) changed in the last call to generate.
+    bool regionChanged(int minX, int minY, int maxX, int maxY) const;
+
+    // The tiles of texture data that changed in the last call to generate.
+    // Each tile is DIRTY_TILE_SIZE texels square, clipped to the heightmap size.
+    int dirtyTilesPerRow() const { return dirtyTilesPerRow_; }
+    bool tileChanged(int tileX, int tileY) const { return dirtyTiles_[tileX + tileY * dirtyTilesPerRow_] != 0; }
+
+    // The time taken by the last call to generate
+    float lastGenerationMilliseconds() const { return lastGenerationMilliseconds_; }
+
+    // The largest height before normalization in the last call to generate.
+    // Heights from generateRegion are normalized by multiplying by settings.height / maxHeight().
+    float maxHeight() const { return maxHeight_; }
+
+    // Generates the heights of a rectangle of the heightmap, before normalization.
+    // Only the fractal values the rectangle depends on are computed, so a heightmap too large to
+    // keep in memory can be generated a piece at a time. The heights match those that generate
+    // would produce. Texels outside the heightmap are clamped to its edge.
+    static void generateRegion(const TerrainGenerationSettings &settings, int x, int y, int width, int height, float* heights);
+
+    // Calls task(threadIndex, taskIndex) for every task in [0, taskCount) as jobs, and waits for them.
+    // The thread index is the job system's index of the thread running the task, for per-thread scratch data.
+    // Also used by the terrain to place details in parallel.
+    void parallelFor(const char* name, int taskCount, const std::function<void(int, int)> &task) const;
+
+private:
+    JobSystem* jobSystem_;
+    float lastGenerationMilliseconds_;
+    float maxHeight_;
+
+    // The settings used by the last run, and whether there has been one
+    TerrainGenerationSettings settings_;
+    bool generated_;
+
+    // The cached output of each stage
+    std::vector<float> fractalHeights_;
+    std::vector<float> mountainHeights_;
+    std::vector<float> islandMask_;
+
+    // Working buffers, kept between runs to avoid allocating
+    std::vector<float> fractalScratch_;
+    std::vector<std::vector<float>> scratchRows_;
+    std::vector<float> threadMaxHeights_;
+
+    // A flag for each tile of the output that changed in the last run
+    int dirtyTilesPerRow_;
+    std::vector<uint8_t> dirtyTiles_;
+
+    // The job system to run on, which may be null
+    JobSystem* jobSystem() const;
+
+    // Builds the fractal base heights, doubling the resolution with each pass.
+    void runFractalStage();
+
+    // Runs a fractal pass, upscaling the heightmap from resolution to resolution * 2
+    // and offsetting each value by a random amount.
+    void runFractalPass(const float* source, float* dest, int resolution, float moveSize);
+
+    // Raises the fractal heights to the mountain scale power.
+    void runMountainStage();
+
+    // Builds the island falloff mask.
+    void runIslandStage();
+
+    // Combines the mountain heights and island mask, normalizes the result, and
+    // builds the texture data, recording which tiles of the texture changed.
+    void runOutputStage(std::vector<float> &heights, std::vector<uint16_t> &textureHeights, bool allTilesChanged);
+};
\ No newline at end of file
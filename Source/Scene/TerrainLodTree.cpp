@@ -0,0 +1,183 @@
+#include "TerrainLodTree.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Heightfield.h"
+
+const float TerrainLodTree::MORPH_FRACTION = 0.3f;
+
+// Defined here as well, as std::min takes it by reference
+const int TerrainLodTree::MAX_LEVELS;
+
+TerrainLodTree::TerrainLodTree()
+    : origin_(Vector2::zero()),
+    size_(Vector2::one()),
+    levelCount_(0),
+    finestRange_(0.0f),
+    extendEdges_(false)
+{
+
+}
+
+void TerrainLodTree::build(const Heightfield& heightfield, int levelCount, float heightMargin, bool extendEdges)
+{
+    origin_ = Vector2::zero();
+    size_ = Vector2(heightfield.sizeX(), heightfield.sizeZ());
+    levelCount_ = std::min(std::max(levelCount, 1), MAX_LEVELS);
+    extendEdges_ = extendEdges;
+    heightRanges_.assign(levelCount_, std::vector<float>());
+
+    // Find the heights under each node of the finest level, including the texels on its edges
+    const int resolution = heightfield.resolution();
+    const std::vector<float>& heights = heightfield.heights();
+    const int leaves = nodesPerSide(0);
+    const float texelsPerLeaf = (resolution - 1) / (float)leaves;
+    std::vector<float>& leafRanges = heightRanges_[0];
+    leafRanges.resize((size_t)leaves * leaves * 2);
+    for (int z = 0; z < leaves; ++z)
+    {
+        const int minTexelZ = std::max((int)floorf(z * texelsPerLeaf), 0);
+        const int maxTexelZ = std::min((int)ceilf((z + 1) * texelsPerLeaf), resolution - 1);
+        for (int x = 0; x < leaves; ++x)
+        {
+            const int minTexelX = std::max((int)floorf(x * texelsPerLeaf), 0);
+            const int maxTexelX = std::min((int)ceilf((x + 1) * texelsPerLeaf), resolution - 1);
+
+            float minHeight = heights[minTexelX + (size_t)minTexelZ * resolution];
+            float maxHeight = minHeight;
+            for (int texelZ = minTexelZ; texelZ <= maxTexelZ; ++texelZ)
+            {
+                const float* row = &heights[(size_t)texelZ * resolution];
+                for (int texelX = minTexelX; texelX <= maxTexelX; ++texelX)
+                {
+                    minHeight = std::min(minHeight, row[texelX]);
+                    maxHeight = std::max(maxHeight, row[texelX]);
+                }
+            }
+
+            const size_t index = ((size_t)x + (size_t)z * leaves) * 2;
+            leafRanges[index] = minHeight + heightfield.heightOffset() - heightMargin;
+            leafRanges[index + 1] = maxHeight + heightfield.heightOffset() + heightMargin;
+        }
+    }
+
+    buildUpperLevels();
+}
+
+void TerrainLodTree::buildFlat(const Vector2& origin, const Vector2& size, float minHeight, float maxHeight, int levelCount)
+{
+    origin_ = origin;
+    size_ = size;
+    levelCount_ = std::min(std::max(levelCount, 1), MAX_LEVELS);
+    extendEdges_ = false;
+    heightRanges_.assign(levelCount_, std::vector<float>());
+
+    const int leaves = nodesPerSide(0);
+    std::vector<float>& leafRanges = heightRanges_[0];
+    leafRanges.resize((size_t)leaves * leaves * 2);
+    for (size_t i = 0; i < leafRanges.size(); i += 2)
+    {
+        leafRanges[i] = minHeight;
+        leafRanges[i + 1] = maxHeight;
+    }
+
+    buildUpperLevels();
+}
+
+void TerrainLodTree::buildUpperLevels()
+{
+    for (int level = 1; level < levelCount_; ++level)
+    {
+        const int nodes = nodesPerSide(level);
+        const std::vector<float>& below = heightRanges_[level - 1];
+        std::vector<float>& ranges = heightRanges_[level];
+        ranges.resize((size_t)nodes * nodes * 2);
+        for (int z = 0; z < nodes; ++z)
+        {
+            for (int x = 0; x < nodes; ++x)
+            {
+                float minHeight = below[((size_t)x * 2 + (size_t)z * 2 * nodes * 2) * 2];
+                float maxHeight = minHeight;
+                for (int child = 0; child < 4; ++child)
+                {
+                    const size_t childIndex = ((size_t)(x * 2 + (child & 1)) + (size_t)(z * 2 + (child >> 1)) * nodes * 2) * 2;
+                    minHeight = std::min(minHeight, below[childIndex]);
+                    maxHeight = std::max(maxHeight, below[childIndex + 1]);
+                }
+
+                ranges[((size_t)x + (size_t)z * nodes) * 2] = minHeight;
+                ranges[((size_t)x + (size_t)z * nodes) * 2 + 1] = maxHeight;
+            }
+        }
+    }
+
+    // The finest level is drawn out to a fixed multiple of its node size
+    const float leafSize = std::max(size_.x, size_.y) / nodesPerSide(0);
+    finestRange_ = leafSize * LOD_RANGE_FACTOR;
+}
+
+void TerrainLodTree::select(const Frustum& frustum, const Point3& viewPosition, float rangeScale,
+    std::vector<TerrainPatch>& patches, TerrainLodStats& stats) const
+{
+    patches.clear();
+    stats = TerrainLodStats();
+
+    if (levelCount_ == 0)
+    {
+        return;
+    }
+
+    float ranges[MAX_LEVELS];
+    for (int level = 0; level < levelCount_; ++level)
+    {
+        ranges[level] = finestRange_ * rangeScale * (float)(1 << level);
+    }
+
+    selectNode(levelCount_ - 1, 0, 0, frustum, viewPosition, ranges, patches, stats);
+}
+
+Bounds TerrainLodTree::nodeBounds(int level, int x, int z) const
+{
+    const int nodes = nodesPerSide(level);
+    const float* heights = &heightRanges_[level][((size_t)x + (size_t)z * nodes) * 2];
+    const Vector2 nodeSize = size_ / (float)nodes;
+    Point3 min(origin_.x + x * nodeSize.x, heights[0], origin_.y + z * nodeSize.y);
+    Point3 max(min.x + nodeSize.x, heights[1], min.z + nodeSize.y);
+
+    // The vertices on the edges of the terrain are pushed out by half its size
+    if (extendEdges_)
+    {
+        if (x == 0) min.x -= size_.x * 0.5f;
+        if (z == 0) min.z -= size_.y * 0.5f;
+        if (x == nodes - 1) max.x += size_.x * 0.5f;
+        if (z == nodes - 1) max.z += size_.y * 0.5f;
+    }
+
+    return Bounds(min, max);
+}
+
+void TerrainLodTree::selectNode(int level, int x, int z, const Frustum& frustum, const Point3& viewPosition, const float* ranges,
+    std::vector<TerrainPatch>& patches, TerrainLodStats& stats) const
+{
+    const Bounds bounds = nodeBounds(level, x, z);
+    if (!frustum.intersects(bounds))
+    {
+        stats.frustumCulledNodes++;
+        return;
+    }
+
+    // Draw the node as it is when none of it is close enough for the level below
+    if (level == 0 || bounds.sqrDistance(viewPosition) > ranges[level - 1] * ranges[level - 1])
+    {
+        const float size = 1.0f / nodesPerSide(level);
+        patches.push_back({ x * size, z * size, size, (float)level });
+        stats.selectedPatches++;
+        return;
+    }
+
+    for (int child = 0; child < 4; ++child)
+    {
+        selectNode(level - 1, x * 2 + (child & 1), z * 2 + (child >> 1), frustum, viewPosition, ranges, patches, stats);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+#include "Math/Bounds.h"
+#include "Math/Frustum.h"
+#include "Math/Point3.h"
+#include "Math/Vector2.h"
+
+class Heightfield;
+
+// A square of the area covered by a TerrainLodTree, drawn with one instance of the patch grid.
+// The position and size are fractions of the area, so a patch matches a vec4 in the shader.
+struct TerrainPatch
+{
+    float x;
+    float z;
+    float size;
+
+    // The level of the node the patch was selected from, where 0 is the finest
+    float level;
+};
+
+// The number of patches found by a query, and the number of nodes culled on the way
+struct TerrainLodStats
+{
+    int selectedPatches = 0;
+    int frustumCulledNodes = 0;
+};
+
+// A continuous distance-dependent level of detail (CDLOD) quadtree over a rectangle of terrain.
+//
+// Every node is drawn with the same grid of GRID_RESOLUTION quads, so the nodes of each
+// level have half the vertex spacing of the level above. Each level is drawn out to twice
+// the distance of the level below it, and in the last part of its range a vertex morphs
+// to the position it would have in the level above, so the levels meet without seams or
+// popping. Nodes outside the frustum are skipped along with everything under them, so the
+// vertex work grows with the visible area rather than the size of the terrain.
+class TerrainLodTree
+{
+public:
+    // The number of quads along each side of a patch
+    const static int GRID_RESOLUTION = 32;
+
+    // The most levels a tree can have
+    const static int MAX_LEVELS = 12;
+
+    // The distance the finest level is drawn to, in multiples of the size of its nodes.
+    // It is large enough that neighbouring patches are never more than one level apart.
+    const static int LOD_RANGE_FACTOR = 6;
+
+    // The fraction of the distance between the end of the level below and the end of a level that vertices morph over
+    static const float MORPH_FRACTION;
+
+    TerrainLodTree();
+
+    // Builds the tree over a heightfield, with the given number of levels. Each node's bounds cover the
+    // heights under it plus the margin. When extendEdges is set, the patches at the edges of the terrain
+    // are stretched out by half its size, and their bounds cover the extra area.
+    void build(const Heightfield &heightfield, int levelCount, float heightMargin, bool extendEdges);
+
+    // Builds the tree over a flat rectangle, with every node covering the same range of heights
+    void buildFlat(const Vector2 &origin, const Vector2 &size, float minHeight, float maxHeight, int levelCount);
+
+    // Finds the patches to draw for a frustum. Levels are picked by distance from the view position, with
+    // every range multiplied by rangeScale. Passes can share a view position, so they pick the same levels.
+    void select(const Frustum &frustum, const Point3 &viewPosition, float rangeScale,
+        std::vector<TerrainPatch> &patches, TerrainLodStats &stats) const;
+
+    int levelCount() const { return levelCount_; }
+
+    // The distance the finest level is drawn to, before scaling.
+    // Each level above is drawn to twice the distance of the one below.
+    float finestRange() const { return finestRange_; }
+
+    // The world space bounds of a node
+    Bounds nodeBounds(int level, int x, int z) const;
+
+private:
+    Vector2 origin_;
+    Vector2 size_;
+    int levelCount_;
+    float finestRange_;
+    bool extendEdges_;
+
+    // The lowest and highest world space height under each node, as interleaved pairs.
+    // Level 0 has the most nodes, and the top level has a single node.
+    std::vector<std::vector<float>> heightRanges_;
+
+    // Adds the patches under a node
+    void selectNode(int level, int x, int z, const Frustum &frustum, const Point3 &viewPosition, const float* ranges,
+        std::vector<TerrainPatch> &patches, TerrainLodStats &stats) const;
+
+    // Fills in the levels above level 0 from the nodes below them
+    void buildUpperLevels();
+
+    // The number of nodes along each side of a level
+    int nodesPerSide(int level) const { return 1 << (levelCount_ - 1 - level); }
+};
\ No newline at end of file
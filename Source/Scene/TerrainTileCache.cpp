@@ -0,0 +1,136 @@
+#include "TerrainTileCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "Scene/TerrainBakeCache.h"
+
+namespace
+{
+    const char TILE_CACHE_MAGIC[4] = { 'T', 'T', 'L', 'C' };
+    const uint32_t TILE_CACHE_VERSION = 2;
+
+    // Sections of the file start on 64 byte boundaries
+    size_t alignSection(size_t size)
+    {
+        return (size + 63) & ~(size_t)63;
+    }
+}
+
+TerrainTileCache::TerrainTileCache()
+    : maxHeight_(1.0f),
+    tilesPerSide_(0)
+{
+
+}
+
+std::string TerrainTileCache::cachePath(const std::string &directory, const TerrainGenerationSettings &settings, float maxHeight)
+{
+    // The same things as the header, which still catches the rare hash collision
+    TerrainBakeKey key;
+    key.add(TerrainGenerator::OUTPUT_VERSION);
+    key.add(settings.resolution);
+    key.add(settings.seed);
+    key.add(settings.height);
+    key.add(settings.fractalSmoothness);
+    key.add(settings.mountainScale);
+    key.add(settings.islandFactor);
+    key.add(maxHeight);
+
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "TerrainTiles_%016llx.cache", (unsigned long long)key.value());
+    return directory + "/" + fileName;
+}
+
+bool TerrainTileCache::open(const std::string &path, const TerrainGenerationSettings &settings, float maxHeight)
+{
+    close();
+
+    settings_ = settings;
+    maxHeight_ = maxHeight;
+    tilesPerSide_ = settings.resolution / TILE_SIZE;
+
+    const size_t tileCount = (size_t)tilesPerSide_ * tilesPerSide_;
+    const size_t tileBytes = (size_t)TILE_TEXELS * TILE_TEXELS * sizeof(uint16_t);
+    const size_t fileSize = alignSection(sizeof(Header)) + alignSection(tileCount) + tileCount * tileBytes;
+    if (!file_.open(path, fileSize))
+    {
+        return false;
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TILE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TILE_CACHE_VERSION;
+    header.generatorVersion = TerrainGenerator::OUTPUT_VERSION;
+    header.tileSize = TILE_SIZE;
+    header.resolution = settings.resolution;
+    header.seed = settings.seed;
+    header.height = settings.height;
+    header.fractalSmoothness = settings.fractalSmoothness;
+    header.mountainScale = settings.mountainScale;
+    header.islandFactor = settings.islandFactor;
+    header.maxHeight = maxHeight;
+
+    // Tiles from a file made with other settings can't be used, so forget them
+    if (std::memcmp(file_.data(), &header, sizeof(header)) != 0)
+    {
+        std::memcpy(file_.data(), &header, sizeof(header));
+        std::fill(tileFlags(), tileFlags() + tileCount, 0);
+    }
+
+    return true;
+}
+
+void TerrainTileCache::close()
+{
+    file_.close();
+    tilesPerSide_ = 0;
+}
+
+bool TerrainTileCache::hasTile(int tileX, int tileY) const
+{
+    return tileFlags()[tileX + tileY * tilesPerSide_] != 0;
+}
+
+const uint16_t* TerrainTileCache::tile(int tileX, int tileY)
+{
+    if (!hasTile(tileX, tileY))
+    {
+        generateTile(tileX, tileY);
+    }
+
+    return tileTexels(tileX, tileY);
+}
+
+uint8_t* TerrainTileCache::tileFlags() const
+{
+    return file_.data() + alignSection(sizeof(Header));
+}
+
+uint16_t* TerrainTileCache::tileTexels(int tileX, int tileY) const
+{
+    const size_t tileCount = (size_t)tilesPerSide_ * tilesPerSide_;
+    const size_t tileIndex = (size_t)tileX + (size_t)tileY * tilesPerSide_;
+    uint8_t* tiles = file_.data() + alignSection(sizeof(Header)) + alignSection(tileCount);
+    return (uint16_t*)tiles + tileIndex * TILE_TEXELS * TILE_TEXELS;
+}
+
+void TerrainTileCache::generateTile(int tileX, int tileY)
+{
+    // Generate the tile along with its border
+    std::vector<float> heights((size_t)TILE_TEXELS * TILE_TEXELS);
+    TerrainGenerator::generateRegion(settings_, tileX * TILE_SIZE - 1, tileY * TILE_SIZE - 1, TILE_TEXELS, TILE_TEXELS, heights.data());
+
+    // Normalize to 16 bits the same way as TerrainGenerator::generate does.
+    // The maximum comes from a smaller heightmap, so a few texels can be slightly above it.
+    const float texelScale = 65535.0f / maxHeight_;
+    uint16_t* texels = tileTexels(tileX, tileY);
+    for (size_t i = 0; i < heights.size(); ++i)
+    {
+        texels[i] = (uint16_t)std::min(heights[i] * texelScale, 65535.0f);
+    }
+
+    tileFlags()[tileX + tileY * tilesPerSide_] = 1;
+}
\ No newline at end of file
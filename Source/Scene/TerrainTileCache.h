@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Scene/TerrainGenerator.h"
+#include "Utils/MappedFile.h"
+
+// Square tiles of a large generated heightmap, stored in a memory mapped file.
+//
+// Tiles are generated the first time they are asked for and written to the file,
+// so later runs with the same settings reuse them. Only the tiles that are read
+// are paged into memory, so the heightmap can be far larger than the memory
+// available for it.
+//
+// Each tile has a one texel border copied from its neighbours, so it can be
+// filtered and have normals computed without reading any other tile.
+class TerrainTileCache
+{
+public:
+    // The number of texels along each side of a tile, not counting the border
+    const static int TILE_SIZE = 256;
+
+    // The number of texels along each side of a tile, including the border
+    const static int TILE_TEXELS = TILE_SIZE + 2;
+
+    TerrainTileCache();
+
+    // The path of the cache file for a heightmap with the given settings, so heightmaps with
+    // different settings each keep their own tiles rather than clearing each other's.
+    static std::string cachePath(const std::string &directory, const TerrainGenerationSettings &settings, float maxHeight);
+
+    // Opens the cache file for a heightmap with the given settings.
+    // The resolution must be a multiple of TILE_SIZE. The tiles are normalized to 16 bits
+    // using maxHeight, so they line up with a smaller heightmap generated from the same settings.
+    // An existing file made with different settings, or by a different version of the generator, is cleared. Returns false if the file can't be mapped.
+    bool open(const std::string &path, const TerrainGenerationSettings &settings, float maxHeight);
+
+    // Closes the cache file
+    void close();
+
+    bool isOpen() const { return file_.isOpen(); }
+
+    // The number of tiles along each side of the heightmap
+    int tilesPerSide() const { return tilesPerSide_; }
+
+    // Whether a tile has already been generated
+    bool hasTile(int tileX, int tileY) const;
+
+    // Gets the texels of a tile, in rows of TILE_TEXELS, generating it first if needed
+    const uint16_t* tile(int tileX, int tileY);
+
+    // Generates a tile and writes it into the file.
+    // Different tiles can be generated on different threads at the same time.
+    void generateTile(int tileX, int tileY);
+
+private:
+    // The start of the file. It is followed by a flag for each tile, marking the
+    // tiles that have been generated, and then the texels of every tile.
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t generatorVersion;
+        int32_t tileSize;
+        int32_t resolution;
+        int32_t seed;
+        float height;
+        float fractalSmoothness;
+        float mountainScale;
+        float islandFactor;
+        float maxHeight;
+    };
+
+    MappedFile file_;
+    TerrainGenerationSettings settings_;
+    float maxHeight_;
+    int tilesPerSide_;
+
+    // The generated flags and texels within the mapped file
+    uint8_t* tileFlags() const;
+    uint16_t* tileTexels(int tileX, int tileY) const;
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "TerrainTileResidency.h"
+
+#include <algorithm>
+#include <math.h>
+
+TerrainTileResidency::TerrainTileResidency(int tilesPerSide, int slotCount)
+    : tilesPerSide_(tilesPerSide),
+    residentCount_(0),
+    tileSlots_((size_t)tilesPerSide * tilesPerSide, -1),
+    slotTiles_(slotCount, -1),
+    slotLastUsed_(slotCount, 0),
+    updateCount_(0)
+{
+
+}
+
+void TerrainTileResidency::update(float x, float y, float radius, int maxLoads, std::vector<TileLoad> &loads)
+{
+    ++updateCount_;
+
+    // Find the tiles that overlap the circle, and their distances from the point
+    requested_.clear();
+    const int minTileX = std::max((int)floorf(x - radius), 0);
+    const int minTileY = std::max((int)floorf(y - radius), 0);
+    const int maxTileX = std::min((int)floorf(x + radius), tilesPerSide_ - 1);
+    const int maxTileY = std::min((int)floorf(y + radius), tilesPerSide_ - 1);
+    for (int tileY = minTileY; tileY <= maxTileY; ++tileY)
+    {
+        for (int tileX = minTileX; tileX <= maxTileX; ++tileX)
+        {
+            // Measure to the nearest point of the tile
+            const float distanceX = x - std::min(std::max(x, (float)tileX), (float)(tileX + 1));
+            const float distanceY = y - std::min(std::max(y, (float)tileY), (float)(tileY + 1));
+            const float distanceSquared = distanceX * distanceX + distanceY * distanceY;
+            if (distanceSquared <= radius * radius)
+            {
+                requested_.push_back(std::make_pair(distanceSquared, tileX + tileY * tilesPerSide_));
+            }
+        }
+    }
+    std::sort(requested_.begin(), requested_.end());
+
+    // Resident tiles that are still wanted keep their slots
+    for (const std::pair<float, int> &request : requested_)
+    {
+        const int tileSlot = tileSlots_[request.second];
+        if (tileSlot >= 0)
+        {
+            slotLastUsed_[tileSlot] = updateCount_;
+        }
+    }
+
+    // Load the missing tiles, nearest first
+    for (const std::pair<float, int> &request : requested_)
+    {
+        if ((int)loads.size() >= maxLoads)
+        {
+            break;
+        }
+
+        const int tile = request.second;
+        if (tileSlots_[tile] >= 0)
+        {
+            continue;
+        }
+
+        // Use the least recently wanted slot. Free slots were never used, so they come first.
+        int bestSlot = -1;
+        for (int slot = 0; slot < (int)slotTiles_.size(); ++slot)
+        {
+            if (slotLastUsed_[slot] != updateCount_ && (bestSlot < 0 || slotLastUsed_[slot] < slotLastUsed_[bestSlot]))
+            {
+                bestSlot = slot;
+            }
+        }
+
+        // Every slot holds a tile that is wanted now
+        if (bestSlot < 0)
+        {
+            break;
+        }
+
+        const int evictedTile = slotTiles_[bestSlot];
+        if (evictedTile >= 0)
+        {
+            tileSlots_[evictedTile] = -1;
+        }
+        else
+        {
+            ++residentCount_;
+        }
+
+        tileSlots_[tile] = bestSlot;
+        slotTiles_[bestSlot] = tile;
+        slotLastUsed_[bestSlot] = updateCount_;
+        loads.push_back({ tile % tilesPerSide_, tile / tilesPerSide_, bestSlot, evictedTile });
+    }
+}
\ No newline at end of file
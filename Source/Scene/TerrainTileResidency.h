@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Decides which tiles of a tiled heightmap to keep in a fixed number of slots.
+//
+// Each update asks for the tiles around a point, nearest first. Tiles that are
+// already resident keep their slots. Missing tiles are given free slots, or the
+// slots of the tiles that have gone longest without being asked for. Only a
+// limited number of tiles are loaded per update, so a large move fills in over
+// several updates rather than all at once.
+class TerrainTileResidency
+{
+public:
+    // A tile to load into a slot
+    struct TileLoad
+    {
+        int tileX;
+        int tileY;
+        int slot;
+
+        // The index of the tile that was in the slot before, or -1 if the slot was free
+        int evictedTile;
+    };
+
+    TerrainTileResidency(int tilesPerSide, int slotCount);
+
+    // Requests the tiles within radius of a point, both measured in tiles.
+    // The tiles that need loading are added to loads, nearest first, up to maxLoads.
+    void update(float x, float y, float radius, int maxLoads, std::vector<TileLoad> &loads);
+
+    // The slot holding a tile, or -1 if it isn't resident
+    int slot(int tileX, int tileY) const { return tileSlots_[tileX + tileY * tilesPerSide_]; }
+
+    int tilesPerSide() const { return tilesPerSide_; }
+    int slotCount() const { return (int)slotTiles_.size(); }
+    int residentCount() const { return residentCount_; }
+
+private:
+    int tilesPerSide_;
+    int residentCount_;
+
+    // The slot of each tile, or -1
+    std::vector<int> tileSlots_;
+
+    // The tile in each slot, or -1, and the last update that asked for it
+    std::vector<int> slotTiles_;
+    std::vector<uint64_t> slotLastUsed_;
+
+    uint64_t updateCount_;
+
+    // Scratch list of the requested tiles and their distances
+    std::vector<std::pair<float, int>> requested_;
+};
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "TerrainTileStreamer.h"
+
+#include <algorithm>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+TerrainTileStreamer::TerrainTileStreamer(TerrainTileCache* cache, size_t budgetBytes, const Vector3 &terrainSize, float heightOffset)
+    : cache_(cache),
+    residency_(cache->tilesPerSide(), slotsForBudget(cache, budgetBytes)),
+    colliderResidency_(cache->tilesPerSide(), std::min(MAX_COLLIDERS, cache->tilesPerSide() * cache->tilesPerSide())),
+    terrainSize_(terrainSize),
+    heightOffset_(heightOffset),
+    tileTexture_(TextureFormat::R16, TerrainTileCache::TILE_TEXELS, TerrainTileCache::TILE_TEXELS, slotsForBudget(cache, budgetBytes)),
+    pageTable_(TextureFormat::RFloat, cache->tilesPerSide(), cache->tilesPerSide()),
+    pages_((size_t)cache->tilesPerSide() * cache->tilesPerSide(), -1.0f),
+    colliders_(colliderResidency_.slotCount()),
+    colliderTiles_(colliderResidency_.slotCount(), -1)
+{
+    const int tilesPerSide = cache->tilesPerSide();
+    radius_ = radiusForSlots(residency_.slotCount(), tilesPerSide);
+    colliderRadius_ = radiusForSlots(colliderResidency_.slotCount(), tilesPerSide);
+
+    pageTable_.setSubData(pages_.data(), 0, 0, tilesPerSide, tilesPerSide, tilesPerSide, 0);
+}
+
+TerrainTileStreamer::~TerrainTileStreamer()
+{
+    if (!generating_.finished() || !building_.finished())
+    {
+        JobSystem::instance()->wait(generating_);
+        JobSystem::instance()->wait(building_);
+    }
+}
+
+void TerrainTileStreamer::update(float x, float y)
+{
+    // Only one batch is loaded at a time, so the residencies can't give away a slot that is still waiting for its tile
+    if (!loads_.empty() || !colliderLoads_.empty())
+    {
+        if (!generating_.finished() || !building_.finished())
+        {
+            return;
+        }
+        finishLoads();
+    }
+
+    const int tilesPerSide = residency_.tilesPerSide();
+    residency_.update(x * tilesPerSide, y * tilesPerSide, radius_, MAX_LOADS_PER_UPDATE, loads_);
+    colliderResidency_.update(x * tilesPerSide, y * tilesPerSide, colliderRadius_, MAX_LOADS_PER_UPDATE, colliderLoads_);
+    if (loads_.empty() && colliderLoads_.empty())
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < colliderLoads_.size(); ++i)
+    {
+        pendingColliders_.push_back(std::make_unique<TerrainTileCollider>());
+    }
+
+    // Generating a tile takes far longer than a frame, so it is done on the workers, followed by building the colliders.
+    // Without any workers, nothing would run the jobs until the main thread waits for something.
+    JobSystem* jobSystem = JobSystem::instance();
+    if (jobSystem != nullptr && jobSystem->threadCount() > 1)
+    {
+        TerrainTileCache* cache = cache_;
+        for (int i = 0; i < (int)(loads_.size() + colliderLoads_.size()); ++i)
+        {
+            const TerrainTileResidency::TileLoad &load = (i < (int)loads_.size()) ? loads_[i] : colliderLoads_[i - loads_.size()];
+            const int tileX = load.tileX;
+            const int tileY = load.tileY;
+
+            // A tile is often loaded for drawing and for collision at the same time, but only needs generating once
+            bool alreadyQueued = false;
+            for (int j = 0; j < i && !alreadyQueued; ++j)
+            {
+                const TerrainTileResidency::TileLoad &other = (j < (int)loads_.size()) ? loads_[j] : colliderLoads_[j - loads_.size()];
+                alreadyQueued = (other.tileX == tileX && other.tileY == tileY);
+            }
+
+            if (!alreadyQueued && !cache->hasTile(tileX, tileY))
+            {
+                jobSystem->run("Generate terrain tile", [cache, tileX, tileY] { cache->generateTile(tileX, tileY); }, &generating_);
+            }
+        }
+
+        for (size_t i = 0; i < colliderLoads_.size(); ++i)
+        {
+            const int tileX = colliderLoads_[i].tileX;
+            const int tileY = colliderLoads_[i].tileY;
+            TerrainTileCollider* collider = pendingColliders_[i].get();
+            jobSystem->run("Build terrain tile collider", [this, tileX, tileY, collider] { buildCollider(tileX, tileY, *collider); }, &building_, &generating_);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < colliderLoads_.size(); ++i)
+        {
+            buildCollider(colliderLoads_[i].tileX, colliderLoads_[i].tileY, *pendingColliders_[i]);
+        }
+    }
+
+    // When nothing needs generating on the workers, upload straight away, generating anything missing here
+    if (generating_.finished() && building_.finished())
+    {
+        finishLoads();
+    }
+}
+
+void TerrainTileStreamer::finishLoads()
+{
+    const int tilesPerSide = residency_.tilesPerSide();
+    for (const TerrainTileResidency::TileLoad &load : loads_)
+    {
+        // The evicted tile has to fall back to the low resolution heightmap
+        if (load.evictedTile >= 0)
+        {
+            pages_[load.evictedTile] = -1.0f;
+        }
+
+        tileTexture_.setLayerData(cache_->tile(load.tileX, load.tileY), load.slot);
+        pages_[load.tileX + load.tileY * tilesPerSide] = (float)load.slot;
+    }
+
+    // The page table is small, so upload all of it
+    if (!loads_.empty())
+    {
+        pageTable_.setSubData(pages_.data(), 0, 0, tilesPerSide, tilesPerSide, tilesPerSide, 0);
+    }
+
+    for (size_t i = 0; i < colliderLoads_.size(); ++i)
+    {
+        const TerrainTileResidency::TileLoad &load = colliderLoads_[i];
+        colliders_[load.slot] = std::move(pendingColliders_[i]);
+        colliderTiles_[load.slot] = load.tileX + load.tileY * tilesPerSide;
+    }
+
+    loads_.clear();
+    colliderLoads_.clear();
+    pendingColliders_.clear();
+}
+
+void TerrainTileStreamer::buildCollider(int tileX, int tileY, TerrainTileCollider &collider) const
+{
+    // Place the texels the same way the gpu does, where texel i of the streamed heightmap is (i + 0.5) / resolution
+    // of the way across the terrain. The first texel of a tile is its border, from the tile before it.
+    const int texels = TerrainTileCache::TILE_TEXELS;
+    const float resolution = (float)(cache_->tilesPerSide() * TerrainTileCache::TILE_SIZE);
+    const float texelSizeX = terrainSize_.x / resolution;
+    const float texelSizeZ = terrainSize_.z / resolution;
+    collider.offset = Vector3((tileX * TerrainTileCache::TILE_SIZE - 0.5f) * texelSizeX, 0.0f, (tileY * TerrainTileCache::TILE_SIZE - 0.5f) * texelSizeZ);
+
+    // The texels are normalized to the height of the terrain
+    const uint16_t* tile = cache_->tile(tileX, tileY);
+    const float heightScale = terrainSize_.y / 65535.0f;
+    std::vector<float>& heights = collider.heightfield.heights();
+    heights.resize((size_t)texels * texels);
+    for (size_t i = 0; i < heights.size(); ++i)
+    {
+        heights[i] = tile[i] * heightScale;
+    }
+
+    collider.heightfield.setDimensions(texels, (texels - 1) * texelSizeX, (texels - 1) * texelSizeZ, heightOffset_);
+    collider.heightfield.rebuildNormals();
+    collider.quadtree.build(collider.heightfield);
+}
+
+bool TerrainTileStreamer::isResident(float x, float y) const
+{
+    const int tilesPerSide = residency_.tilesPerSide();
+    const int tileX = std::min(std::max((int)(x * tilesPerSide), 0), tilesPerSide - 1);
+    const int tileY = std::min(std::max((int)(y * tilesPerSide), 0), tilesPerSide - 1);
+    return pages_[tileX + tileY * tilesPerSide] >= 0.0f;
+}
+
+const TerrainTileCollider* TerrainTileStreamer::collider(int tileX, int tileY) const
+{
+    // Colliders are only used where the tile is drawn too, so collisions match what is seen
+    const int tilesPerSide = residency_.tilesPerSide();
+    const int tile = tileX + tileY * tilesPerSide;
+    const int slot = colliderResidency_.slot(tileX, tileY);
+    if (slot < 0 || colliderTiles_[slot] != tile || pages_[tile] < 0.0f)
+    {
+        return nullptr;
+    }
+
+    return colliders_[slot].get();
+}
+
+int TerrainTileStreamer::slotsForBudget(const TerrainTileCache* cache, size_t budgetBytes)
+{
+    const size_t tileBytes = (size_t)TerrainTileCache::TILE_TEXELS * TerrainTileCache::TILE_TEXELS * sizeof(uint16_t);
+    const size_t tileCount = (size_t)cache->tilesPerSide() * cache->tilesPerSide();
+    return (int)std::max(std::min(budgetBytes / tileBytes, tileCount), (size_t)1);
+}
+
+float TerrainTileStreamer::radiusForSlots(int slotCount, int tilesPerSide)
+{
+    // Keep a circle of tiles that fits within the slots, leaving some spare
+    // for the tiles at the edge of the circle and for the point moving between updates.
+    // When every tile fits, keep them all.
+    return (slotCount >= tilesPerSide * tilesPerSide)
+        ? (float)tilesPerSide * 2.0f
+        : std::max(sqrtf(slotCount / (float)M_PI) * 0.8f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Math/Vector3.h"
+#include "Renderer/Texture.h"
+#include "Scene/Heightfield.h"
+#include "Scene/HeightfieldQuadtree.h"
+#include "Scene/TerrainTileCache.h"
+#include "Scene/TerrainTileResidency.h"
+#include "Utils/JobSystem.h"
+
+// The streamed heights of a single tile, for collision queries.
+// The heightfield starts at offset rather than at the origin, so queries must be moved by it.
+struct TerrainTileCollider
+{
+    Vector3 offset;
+    Heightfield heightfield;
+    HeightfieldQuadtree quadtree;
+};
+
+// Streams the tiles of a TerrainTileCache onto the gpu around a moving point.
+//
+// Resident tiles are stored in the layers of an array texture, and a page table
+// texture gives the layer of each tile, or -1 for tiles that aren't resident.
+// Shaders look up the page table first, and fall back to a low resolution
+// heightmap of the whole terrain where a tile is missing.
+//
+// The resident tiles nearest the point also get colliders, so that collisions
+// there match what is drawn. Colliders take far more memory than the textures,
+// so only a few tiles have them.
+//
+// Tiles that haven't been generated yet are generated on the job system, and the
+// batch is uploaded by the first update after all of them are done. Until then the
+// page table still points at whatever the slots held before.
+class TerrainTileStreamer
+{
+public:
+    // The most tiles uploaded in a single update
+    const static int MAX_LOADS_PER_UPDATE = 4;
+
+    // The most tiles with colliders at once. Each takes about 2MB.
+    const static int MAX_COLLIDERS = 16;
+
+    // Creates the textures for streaming from a cache, using at most budgetBytes of gpu memory for the tiles.
+    // The size and height offset of the terrain place the colliders in the world.
+    TerrainTileStreamer(TerrainTileCache* cache, size_t budgetBytes, const Vector3 &terrainSize, float heightOffset);
+
+    // Waits for any tiles still being generated
+    ~TerrainTileStreamer();
+
+    // Prevent the streamer from being copied, as jobs keep a pointer to its counters
+    TerrainTileStreamer(const TerrainTileStreamer&) = delete;
+    TerrainTileStreamer& operator=(const TerrainTileStreamer&) = delete;
+
+    // Streams in the tiles around a point, given as a fraction of the way across the heightmap in x and y.
+    // Tiles are generated into the cache as they are first needed, on the job system's workers, and
+    // uploaded by a later update. Without any workers they are generated and uploaded straight away.
+    void update(float x, float y);
+
+    // Whether the tile under a point has been uploaded, with the point given as for update
+    bool isResident(float x, float y) const;
+
+    // The collider of a tile, or null if the tile isn't drawn from the streamed heights or has no collider
+    const TerrainTileCollider* collider(int tileX, int tileY) const;
+
+    // The tile textures, for binding when drawing
+    const ArrayTexture* tileTexture() const { return &tileTexture_; }
+    const Texture* pageTable() const { return &pageTable_; }
+
+    int tilesPerSide() const { return residency_.tilesPerSide(); }
+    int residentCount() const { return residency_.residentCount(); }
+    int slotCount() const { return residency_.slotCount(); }
+
+private:
+    TerrainTileCache* cache_;
+    TerrainTileResidency residency_;
+    TerrainTileResidency colliderResidency_;
+    Vector3 terrainSize_;
+    float heightOffset_;
+
+    // The distances in tiles around the point to keep resident, and to keep colliders for
+    float radius_;
+    float colliderRadius_;
+
+    ArrayTexture tileTexture_;
+    Texture pageTable_;
+
+    // The cpu copy of the page table
+    std::vector<float> pages_;
+
+    // The collider in each collider slot, and the tile it was built for
+    std::vector<std::unique_ptr<TerrainTileCollider>> colliders_;
+    std::vector<int> colliderTiles_;
+
+    // The tiles being loaded, and the colliders being built, which are swapped in once the jobs for them are done
+    std::vector<TerrainTileResidency::TileLoad> loads_;
+    std::vector<TerrainTileResidency::TileLoad> colliderLoads_;
+    std::vector<std::unique_ptr<TerrainTileCollider>> pendingColliders_;
+    JobCounter generating_;
+    JobCounter building_;
+
+    // Uploads the tiles being loaded, points the page table at them and swaps in the new colliders
+    void finishLoads();
+
+    // Builds the collider of a tile, generating the tile first if needed
+    void buildCollider(int tileX, int tileY, TerrainTileCollider &collider) const;
+
+    // The number of slots that fit in a budget, limited to the number of tiles
+    static int slotsForBudget(const TerrainTileCache* cache, size_t budgetBytes);
+
+    // The radius of the circle of tiles to keep in a number of slots
+    static float radiusForSlots(int slotCount, int tilesPerSide);
+};
\ No newline at end of file
@@ -2,13 +2,11 @@
 
 #include <imgui.h>
 
+#include "SceneManager.h"
+
 Transform::Transform(GameObject* gameObject)
     : Component(gameObject),
-    position_(Point3::origin()),
-    rotation_(Quaternion::identity()),
-    scale_(Vector3::one()),
-    localToWorld_(Matrix4x4::identity()),
-    worldToLocal_(Matrix4x4::identity()),
+    id_(hierarchy().create()),
     parent_(nullptr)
 {
 
@@ -25,73 +23,86 @@ Transform::~Transform()
 
     // If we have a parent, unparent from it
     setParentTransform(nullptr);
+
+    hierarchy().destroy(id_);
 }
 
 void Transform::drawProperties()
 {
-    ImGui::DragFloat3("Position", &position_.x, 0.1f);
-    ImGui::DragFloat4("Rotation", (float*)&rotation_, 0.01f, -1.0f, 1.0f);
-    ImGui::DragFloat3("Scale", &scale_.x, 0.1f);
+    Point3 position = positionLocal();
+    Quaternion rotation = rotationLocal();
+    Vector3 scale = scaleLocal();
+    ImGui::DragFloat3("Position", &position.x, 0.1f);
+    ImGui::DragFloat4("Rotation", (float*)&rotation, 0.01f, -1.0f, 1.0f);
+    ImGui::DragFloat3("Scale", &scale.x, 0.1f);
 
     // The rotation quat needs to be re-normalized.
-    rotation_.normalize();
+    rotation.normalize();
 
-    // The matrices may be changes by the above editing
-    // Recompute them every time the properties editor is shown.
-    recomputeMatrices();
+    hierarchy().setLocal(id_, position, rotation, scale);
 }
 
 void Transform::serialize(PropertyTable &table)
 {
-    table.serialize<Point3>("Position", position_, Point3::origin());
-    table.serialize<Quaternion>("Rotation", rotation_, Quaternion::identity());
-    table.serialize<Vector3>("Scale", scale_, Vector3::one());
+    Point3 position = positionLocal();
+    Quaternion rotation = rotationLocal();
+    Vector3 scale = scaleLocal();
+    table.serialize<Point3>("Position", position, Point3::origin());
+    table.serialize<Quaternion>("Rotation", rotation, Quaternion::identity());
+    table.serialize<Vector3>("Scale", scale, Vector3::one());
 
-    // The matrices may be changed by the above editing
-    // Recompute them every time the properties editor is shown.
-    recomputeMatrices();
+    hierarchy().setLocal(id_, position, rotation, scale);
+}
+
+Point3 Transform::positionLocal() const
+{
+    return hierarchy().positionLocal(id_);
+}
+
+Quaternion Transform::rotationLocal() const
+{
+    return hierarchy().rotationLocal(id_);
+}
+
+Vector3 Transform::scaleLocal() const
+{
+    return hierarchy().scaleLocal(id_);
 }
 
 Point3 Transform::positionWorld() const
 {
-    // Return local position multiplied by parent localToWorld matrix.
-    // World space = local space for objects with no parent
-    if (parentTransform() != nullptr)
-    {
-        return parent_->localToWorld() * position_;
-    }
-    else
-    {
-        return position_;
-    }
+    return hierarchy().positionWorld(id_);
 }
 
 Quaternion Transform::rotationWorld() const
 {
-    // Return local rotation * parent object world rotation.
-    // World space = local space for objects with no parent
-    if (parentTransform() != nullptr)
-    {
-        return parent_->rotationWorld() * rotation_;
-    }
-    else
-    {
-        return rotation_;
-    }
+    return hierarchy().rotationWorld(id_);
 }
 
 Vector3 Transform::scaleWorld() const
 {
-    // Return local scale * parent object world scale.
-    // World space = local space for objects with no parent
-    if (parentTransform() != nullptr)
-    {
-        return parent_->scaleWorld() * scale_;
-    }
-    else
-    {
-        return scale_;
-    }
+    return hierarchy().scaleWorld(id_);
+}
+
+Matrix4x4 Transform::worldToLocal() const
+{
+    return hierarchy().worldToLocal(id_);
+}
+
+Matrix4x4 Transform::localToWorld() const
+{
+    return hierarchy().localToWorld(id_);
+}
+
+Matrix4x4 Transform::renderLocalToWorld() const
+{
+    return hierarchy().renderLocalToWorld(id_);
+}
+
+Point3 Transform::renderPositionWorld() const
+{
+    const Matrix4x4& matrix = hierarchy().renderLocalToWorld(id_);
+    return Point3(matrix.elements[12], matrix.elements[13], matrix.elements[14]);
 }
 
 Vector3 Transform::left() const
@@ -133,7 +144,7 @@ void Transform::setParentTransform(Transform* parent)
     }
 
     parent_ = parent;
-    recomputeMatrices();
+    hierarchy().setParent(id_, (parent_ != nullptr) ? parent_->id_ : TransformHierarchy::INVALID_ID);
 
     if (parent_ != nullptr)
     {
@@ -143,50 +154,49 @@ void Transform::setParentTransform(Transform* parent)
 
 void Transform::onTransformChanged()
 {
-    recomputeMatrices();
+    hierarchy().markDirty(id_);
+}
+
+void Transform::skipInterpolation()
+{
+    hierarchy().skipInterpolation(id_);
 }
 
 void Transform::setPositionLocal(const Point3& pos)
 {
-    position_ = pos;
-    recomputeMatrices();
+    hierarchy().setPositionLocal(id_, pos);
 }
 
 void Transform::setRotationLocal(const Quaternion& rot)
 {
-    rotation_ = rot;
-    recomputeMatrices();
+    hierarchy().setRotationLocal(id_, rot);
 }
 
 void Transform::setRotationWorld(const Quaternion& rot)
 {
     if (parentTransform() != nullptr)
     {
-        rotation_ = parent_->rotationWorld().inverse() * rot;
+        setRotationLocal(parent_->rotationWorld().inverse() * rot);
     }
     else
     {
-        rotation_ = rot;
+        setRotationLocal(rot);
     }
-    recomputeMatrices();
 }
 
 void Transform::setScaleLocal(const Vector3& scale)
 {
-    scale_ = scale;
-    recomputeMatrices();
+    hierarchy().setScaleLocal(id_, scale);
 }
 
 void Transform::translateLocal(const Vector3& translation)
 {
-    position_ += rotation_ * translation;
-    recomputeMatrices();
+    setPositionLocal(positionLocal() + rotationLocal() * translation);
 }
 
 void Transform::translateWorld(const Vector3& translation)
 {
-    position_ += translation;
-    recomputeMatrices();
+    setPositionLocal(positionLocal() + translation);
 }
 
 void Transform::rotateLocal(float angle, const Vector3& axis)
@@ -195,29 +205,12 @@ void Transform::rotateLocal(float angle, const Vector3& axis)
     const Quaternion newRotation = Quaternion::rotation(angle, axis);
 
     // Apply new rotation to existing local space rotation
-    rotation_ = newRotation * rotation_;
-
-    recomputeMatrices();
+    setRotationLocal(newRotation * rotationLocal());
 }
 
-void Transform::recomputeMatrices()
+TransformHierarchy& Transform::hierarchy()
 {
-    // Compute new localToWorld/worldToLocal matrices
-    localToWorld_ = Matrix4x4::trs(position_, rotation_, scale_);
-    worldToLocal_ = Matrix4x4::trsInverse(position_, rotation_, scale_);
-
-    // If object has a parent, apply trs from parent
-    if (parent_ != nullptr)
-    {
-        localToWorld_ = parent_->localToWorld() * localToWorld();
-        worldToLocal_ = worldToLocal() * parent_->worldToLocal();
-    }
-
-    // Recompute matrices for all children
-    for (Transform* child : children_)
-    {
-        child->recomputeMatrices();
-    }
+    return SceneManager::instance()->transformHierarchy();
 }
 
 void Transform::addChild(Transform* child)
@@ -7,10 +7,14 @@
 #include "Math/Vector3.h"
 #include "Math/Quaternion.h"
 #include "Math/Matrix4x4.h"
+#include "Scene/TransformHierarchy.h"
 
 class Transform : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Transform;
+    ComponentType componentType() const override { return TYPE; }
+
     explicit Transform(GameObject* gameObject);
     virtual ~Transform();
 
@@ -28,9 +32,9 @@ public:
     const std::vector<Transform*>& children() const { return children_; }
 
     // Transform position / rotation / scale in local space
-    Point3 positionLocal() const { return position_; }
-    Quaternion rotationLocal() const { return rotation_; }
-    Vector3 scaleLocal() const { return scale_; }
+    Point3 positionLocal() const;
+    Quaternion rotationLocal() const;
+    Vector3 scaleLocal() const;
 
     // Transform position / rotation / scale in world space
     // world space = local space for objects with no parent
@@ -39,8 +43,13 @@ public:
     Vector3 scaleWorld() const;
 
     // Transformation matrices
-    Matrix4x4 worldToLocal() const { return worldToLocal_; }
-    Matrix4x4 localToWorld() const { return localToWorld_; }
+    // These are recomputed on demand after the transform or its parents change.
+    Matrix4x4 worldToLocal() const;
+    Matrix4x4 localToWorld() const;
+
+    // The matrix and position to draw with, interpolated between the last two simulation ticks
+    Matrix4x4 renderLocalToWorld() const;
+    Point3 renderPositionWorld() const;
 
     // Object axis in world space
     Vector3 left() const;
@@ -53,9 +62,13 @@ public:
     // Changes parent transform for manipulating transform hierarchy
     void setParentTransform(Transform* parent);
 
-    // Callback when transform is changed for child notification and matrix recomputation
+    // Marks the matrices of the transform and its children as needing to be recomputed
     void onTransformChanged();
 
+    // Draws the transform where it is put for the rest of the tick, as if it had just been created,
+    // instead of moving there over the next frames
+    void skipInterpolation();
+
     // Directly sets the transformation TRS values
     void setPositionLocal(const Point3 &pos);
     void setRotationLocal(const Quaternion &rot);
@@ -70,10 +83,8 @@ public:
     void rotateLocal(float angle, const Vector3& axis);
 
 private:
-    // Local space transformation values
-    Point3 position_;
-    Quaternion rotation_;
-    Vector3 scale_;
+    // Where the transform's values are stored in the scene's transform hierarchy
+    TransformID id_;
 
     // Parent transform
     Transform* parent_;
@@ -81,10 +92,8 @@ private:
     // Child transforms
     std::vector<Transform*> children_;
 
-    // Cached transformation matrices
-    Matrix4x4 worldToLocal_;
-    Matrix4x4 localToWorld_;
-    void recomputeMatrices();
+    // The hierarchy that every transform is stored in
+    static TransformHierarchy& hierarchy();
 
     // For adding and removal of child transforms
     // Called when parent transforms are set by children
@@ -0,0 +1,594 @@
+#include "TransformHierarchy.h"
+
+#include <assert.h>
+#include <xmmintrin.h>
+
+namespace
+{
+    // Reused list of slots, to avoid allocating when marking and updating.
+    // One per thread, as different subtrees may be changed at the same time.
+    thread_local std::vector<int32_t> slotStack;
+
+    // Builds the matrix for a scale, then a rotation, then a translation.
+    // Matches Matrix4x4::trs, without multiplying the three matrices together.
+    void buildTrs(const Point3& t, const Quaternion& q, const Vector3& s, Matrix4x4& result)
+    {
+        float* e = result.elements;
+        e[0] = (1.0f - 2.0f * (q.y * q.y + q.z * q.z)) * s.x;
+        e[1] = 2.0f * (q.x * q.y + q.w * q.z) * s.x;
+        e[2] = 2.0f * (q.x * q.z - q.w * q.y) * s.x;
+        e[3] = 0.0f;
+        e[4] = 2.0f * (q.x * q.y - q.w * q.z) * s.y;
+        e[5] = (1.0f - 2.0f * (q.x * q.x + q.z * q.z)) * s.y;
+        e[6] = 2.0f * (q.y * q.z + q.w * q.x) * s.y;
+        e[7] = 0.0f;
+        e[8] = 2.0f * (q.x * q.z + q.w * q.y) * s.z;
+        e[9] = 2.0f * (q.y * q.z - q.w * q.x) * s.z;
+        e[10] = (1.0f - 2.0f * (q.x * q.x + q.y * q.y)) * s.z;
+        e[11] = 0.0f;
+        e[12] = t.x;
+        e[13] = t.y;
+        e[14] = t.z;
+        e[15] = 1.0f;
+    }
+
+    // Multiplies a by b, where b is affine, so its bottom row is (0, 0, 0, 1).
+    // Each column of the result is a sum of the columns of a, weighted by a column of b.
+    void multiplyAffine(const Matrix4x4& a, const Matrix4x4& b, Matrix4x4& result)
+    {
+        const __m128 a0 = _mm_loadu_ps(a.elements);
+        const __m128 a1 = _mm_loadu_ps(a.elements + 4);
+        const __m128 a2 = _mm_loadu_ps(a.elements + 8);
+        const __m128 a3 = _mm_loadu_ps(a.elements + 12);
+
+        for (int column = 0; column < 4; ++column)
+        {
+            const float* b0 = b.elements + column * 4;
+            __m128 sum = _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b0[0])), _mm_mul_ps(a1, _mm_set1_ps(b0[1])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(b0[2])));
+            if (column == 3)
+            {
+                sum = _mm_add_ps(sum, a3);
+            }
+            _mm_storeu_ps(result.elements + column * 4, sum);
+        }
+    }
+
+    // Inverts an affine matrix, by inverting the upper 3x3 and then the translation
+    void invertAffine(const Matrix4x4& m, Matrix4x4& result)
+    {
+        const Vector3 a(m.elements[0], m.elements[1], m.elements[2]);
+        const Vector3 b(m.elements[4], m.elements[5], m.elements[6]);
+        const Vector3 c(m.elements[8], m.elements[9], m.elements[10]);
+        const Vector3 t(m.elements[12], m.elements[13], m.elements[14]);
+
+        // The rows of the inverse are the cross products of the columns, over the determinant
+        const Vector3 bc = Vector3::cross(b, c);
+        const Vector3 ca = Vector3::cross(c, a);
+        const Vector3 ab = Vector3::cross(a, b);
+        const float inverseDeterminant = 1.0f / Vector3::dot(a, bc);
+
+        const Vector3 rows[3] = { bc * inverseDeterminant, ca * inverseDeterminant, ab * inverseDeterminant };
+        for (int row = 0; row < 3; ++row)
+        {
+            result.set(row, 0, rows[row].x);
+            result.set(row, 1, rows[row].y);
+            result.set(row, 2, rows[row].z);
+            result.set(row, 3, -Vector3::dot(rows[row], t));
+        }
+        result.setRow(3, 0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    // Rearranges the values into the given order of their current indices
+    template<class T>
+    void gather(std::vector<T>& values, const std::vector<int32_t>& order)
+    {
+        std::vector<T> result;
+        result.reserve(order.size());
+        for (int32_t index : order)
+        {
+            result.push_back(values[index]);
+        }
+        values.swap(result);
+    }
+}
+
+const TransformID TransformHierarchy::INVALID_ID;
+
+TransformHierarchy::TransformHierarchy()
+    : deadCount_(0),
+    ticking_(false)
+{
+
+}
+
+TransformID TransformHierarchy::create()
+{
+    TransformID id;
+    if (freeIDs_.empty())
+    {
+        id = (TransformID)slots_.size();
+        slots_.push_back(0);
+    }
+    else
+    {
+        id = freeIDs_.back();
+        freeIDs_.pop_back();
+    }
+
+    slots_[id] = appendSlot(id);
+    return id;
+}
+
+void TransformHierarchy::destroy(TransformID id)
+{
+    const int32_t slot = slots_[id];
+
+    // Turn the children into roots. They stay after this slot, as roots can go anywhere.
+    int32_t child = firstChildren_[slot];
+    while (child >= 0)
+    {
+        const int32_t next = nextSiblings_[child];
+        parents_[child] = -1;
+        nextSiblings_[child] = -1;
+        markSlotDirty(child);
+        child = next;
+    }
+    firstChildren_[slot] = -1;
+
+    unlinkFromParent(slot);
+    ids_[slot] = INVALID_ID;
+    flags_[slot] = 0;
+    freeIDs_.push_back(id);
+    ++deadCount_;
+
+    // Squeeze out the dead slots once they make up half of the arrays
+    if (deadCount_ > 64 && deadCount_ * 2 >= slotCount())
+    {
+        std::vector<int32_t> order;
+        order.reserve(slotCount() - deadCount_);
+        for (int32_t i = 0; i < (int32_t)slotCount(); ++i)
+        {
+            if (ids_[i] != INVALID_ID)
+            {
+                order.push_back(i);
+            }
+        }
+        reorderSlots(order);
+    }
+}
+
+TransformID TransformHierarchy::parent(TransformID id) const
+{
+    const int32_t parentSlot = parents_[slots_[id]];
+    return (parentSlot < 0) ? INVALID_ID : ids_[parentSlot];
+}
+
+void TransformHierarchy::setParent(TransformID id, TransformID parent)
+{
+    const int32_t slot = slots_[id];
+    const int32_t parentSlot = (parent == INVALID_ID) ? -1 : (int32_t)slots_[parent];
+    if (parents_[slot] == parentSlot)
+    {
+        return;
+    }
+
+    // A transform can't be parented to itself or its own descendants
+    for (int32_t ancestor = parentSlot; ancestor >= 0; ancestor = parents_[ancestor])
+    {
+        assert(ancestor != slot);
+    }
+
+    unlinkFromParent(slot);
+    linkToParent(slot, parentSlot);
+
+    // Keep the parent in front of its children
+    if (parentSlot > slot)
+    {
+        moveSubtreeToEnd(slot);
+    }
+
+    // The previous local values were relative to the old parent, so don't interpolate from them
+    const int32_t newSlot = slots_[id];
+    previousPositions_[newSlot] = positions_[newSlot];
+    previousRotations_[newSlot] = rotations_[newSlot];
+    previousScales_[newSlot] = scales_[newSlot];
+    flags_[newSlot] &= (uint8_t)~MOVED;
+
+    markSlotDirty(newSlot);
+}
+
+void TransformHierarchy::setLocal(TransformID id, const Point3& position, const Quaternion& rotation, const Vector3& scale)
+{
+    const int32_t slot = slots_[id];
+    positions_[slot] = position;
+    rotations_[slot] = rotation;
+    scales_[slot] = scale;
+    localChanged(slot);
+}
+
+void TransformHierarchy::setPositionLocal(TransformID id, const Point3& position)
+{
+    const int32_t slot = slots_[id];
+    positions_[slot] = position;
+    localChanged(slot);
+}
+
+void TransformHierarchy::setRotationLocal(TransformID id, const Quaternion& rotation)
+{
+    const int32_t slot = slots_[id];
+    rotations_[slot] = rotation;
+    localChanged(slot);
+}
+
+void TransformHierarchy::setScaleLocal(TransformID id, const Vector3& scale)
+{
+    const int32_t slot = slots_[id];
+    scales_[slot] = scale;
+    localChanged(slot);
+}
+
+void TransformHierarchy::markDirty(TransformID id)
+{
+    markSlotDirty(slots_[id]);
+}
+
+const Matrix4x4& TransformHierarchy::localToWorld(TransformID id)
+{
+    const int32_t slot = slots_[id];
+    updateSlot(slot);
+    return localToWorld_[slot];
+}
+
+const Matrix4x4& TransformHierarchy::worldToLocal(TransformID id)
+{
+    const int32_t slot = slots_[id];
+    updateSlot(slot);
+    if ((flags_[slot] & INVERSE_DIRTY) != 0)
+    {
+        invertAffine(localToWorld_[slot], worldToLocal_[slot]);
+        flags_[slot] &= (uint8_t)~INVERSE_DIRTY;
+    }
+
+    return worldToLocal_[slot];
+}
+
+Point3 TransformHierarchy::positionWorld(TransformID id)
+{
+    const Matrix4x4& matrix = localToWorld(id);
+    return Point3(matrix.elements[12], matrix.elements[13], matrix.elements[14]);
+}
+
+const Quaternion& TransformHierarchy::rotationWorld(TransformID id)
+{
+    const int32_t slot = slots_[id];
+    updateSlot(slot);
+    return worldRotations_[slot];
+}
+
+const Vector3& TransformHierarchy::scaleWorld(TransformID id)
+{
+    const int32_t slot = slots_[id];
+    updateSlot(slot);
+    return worldScales_[slot];
+}
+
+void TransformHierarchy::updateWorldMatrices()
+{
+    // Parents come first, so they are always up to date by the time their children are reached
+    const int32_t count = (int32_t)slotCount();
+    for (int32_t slot = 0; slot < count; ++slot)
+    {
+        if ((flags_[slot] & WORLD_DIRTY) != 0)
+        {
+            computeSlot(slot);
+        }
+    }
+}
+
+const Matrix4x4& TransformHierarchy::renderLocalToWorld(TransformID id)
+{
+    const int32_t slot = slots_[id];
+    if ((flags_[slot] & INTERPOLATED) == 0)
+    {
+        return localToWorld(id);
+    }
+
+    return renderLocalToWorld_[slot];
+}
+
+void TransformHierarchy::beginTick()
+{
+    // Only transforms moved by the last tick differ from their previous state.
+    // Transforms placed since the last tick are interpolated from now on.
+    const int32_t count = (int32_t)slotCount();
+    for (int32_t slot = 0; slot < count; ++slot)
+    {
+        if ((flags_[slot] & MOVED) != 0)
+        {
+            previousPositions_[slot] = positions_[slot];
+            previousRotations_[slot] = rotations_[slot];
+            previousScales_[slot] = scales_[slot];
+        }
+        flags_[slot] &= (uint8_t)~(MOVED | PLACING);
+    }
+
+    ticking_ = true;
+}
+
+void TransformHierarchy::endTick()
+{
+    ticking_ = false;
+}
+
+void TransformHierarchy::updateRenderMatrices(float interpolationFactor)
+{
+    updateWorldMatrices();
+
+    // Most transforms didn't move in the last tick, and are drawn where they are
+    const int32_t count = (int32_t)slotCount();
+    for (int32_t slot = 0; slot < count; ++slot)
+    {
+        const int32_t parentSlot = parents_[slot];
+        const bool parentInterpolated = parentSlot >= 0 && (flags_[parentSlot] & INTERPOLATED) != 0;
+        if ((flags_[slot] & MOVED) == 0 && !parentInterpolated)
+        {
+            flags_[slot] &= (uint8_t)~INTERPOLATED;
+            continue;
+        }
+
+        // Take the shorter way around between the two rotations
+        Quaternion previousRotation = previousRotations_[slot];
+        const Quaternion& rotation = rotations_[slot];
+        if (previousRotation.x * rotation.x + previousRotation.y * rotation.y + previousRotation.z * rotation.z + previousRotation.w * rotation.w < 0.0f)
+        {
+            previousRotation = Quaternion(-previousRotation.x, -previousRotation.y, -previousRotation.z, -previousRotation.w);
+        }
+
+        Matrix4x4 local;
+        buildTrs(Point3::lerpUnclamped(previousPositions_[slot], positions_[slot], interpolationFactor),
+            Quaternion::lerpUnclamped(previousRotation, rotation, interpolationFactor),
+            Vector3::lerpUnclamped(previousScales_[slot], scales_[slot], interpolationFactor), local);
+
+        if (parentSlot < 0)
+        {
+            renderLocalToWorld_[slot] = local;
+        }
+        else
+        {
+            multiplyAffine(renderLocalToWorld_[parentSlot], local, renderLocalToWorld_[slot]);
+        }
+        flags_[slot] |= INTERPOLATED;
+    }
+}
+
+int32_t TransformHierarchy::appendSlot(TransformID id)
+{
+    ids_.push_back(id);
+    parents_.push_back(-1);
+    firstChildren_.push_back(-1);
+    nextSiblings_.push_back(-1);
+    flags_.push_back(WORLD_DIRTY | INVERSE_DIRTY | PLACING);
+
+    positions_.push_back(Point3::origin());
+    rotations_.push_back(Quaternion::identity());
+    scales_.push_back(Vector3::one());
+
+    previousPositions_.push_back(Point3::origin());
+    previousRotations_.push_back(Quaternion::identity());
+    previousScales_.push_back(Vector3::one());
+
+    localToWorld_.push_back(Matrix4x4::identity());
+    worldToLocal_.push_back(Matrix4x4::identity());
+    worldRotations_.push_back(Quaternion::identity());
+    worldScales_.push_back(Vector3::one());
+    renderLocalToWorld_.push_back(Matrix4x4::identity());
+
+    return (int32_t)slotCount() - 1;
+}
+
+void TransformHierarchy::linkToParent(int32_t slot, int32_t parentSlot)
+{
+    parents_[slot] = parentSlot;
+    if (parentSlot >= 0)
+    {
+        nextSiblings_[slot] = firstChildren_[parentSlot];
+        firstChildren_[parentSlot] = slot;
+    }
+}
+
+void TransformHierarchy::unlinkFromParent(int32_t slot)
+{
+    const int32_t parentSlot = parents_[slot];
+    if (parentSlot >= 0)
+    {
+        if (firstChildren_[parentSlot] == slot)
+        {
+            firstChildren_[parentSlot] = nextSiblings_[slot];
+        }
+        else
+        {
+            int32_t previous = firstChildren_[parentSlot];
+            while (nextSiblings_[previous] != slot)
+            {
+                previous = nextSiblings_[previous];
+            }
+            nextSiblings_[previous] = nextSiblings_[slot];
+        }
+    }
+
+    parents_[slot] = -1;
+    nextSiblings_[slot] = -1;
+}
+
+void TransformHierarchy::skipInterpolation(TransformID id)
+{
+    const int32_t slot = slots_[id];
+    previousPositions_[slot] = positions_[slot];
+    previousRotations_[slot] = rotations_[slot];
+    previousScales_[slot] = scales_[slot];
+    flags_[slot] = (uint8_t)((flags_[slot] & ~MOVED) | PLACING);
+}
+
+void TransformHierarchy::localChanged(int32_t slot)
+{
+    if (ticking_ && (flags_[slot] & PLACING) == 0)
+    {
+        flags_[slot] |= MOVED;
+    }
+    else
+    {
+        previousPositions_[slot] = positions_[slot];
+        previousRotations_[slot] = rotations_[slot];
+        previousScales_[slot] = scales_[slot];
+    }
+
+    markSlotDirty(slot);
+}
+
+void TransformHierarchy::markSlotDirty(int32_t slot)
+{
+    // The descendants of a dirty slot are always dirty too, so there is nothing more to do.
+    // This keeps repeated changes to the same transform cheap.
+    if ((flags_[slot] & WORLD_DIRTY) != 0)
+    {
+        return;
+    }
+
+    slotStack.clear();
+    slotStack.push_back(slot);
+    while (!slotStack.empty())
+    {
+        const int32_t current = slotStack.back();
+        slotStack.pop_back();
+        flags_[current] |= WORLD_DIRTY | INVERSE_DIRTY;
+
+        for (int32_t child = firstChildren_[current]; child >= 0; child = nextSiblings_[child])
+        {
+            if ((flags_[child] & WORLD_DIRTY) == 0)
+            {
+                slotStack.push_back(child);
+            }
+        }
+    }
+}
+
+void TransformHierarchy::updateSlot(int32_t slot)
+{
+    if ((flags_[slot] & WORLD_DIRTY) == 0)
+    {
+        return;
+    }
+
+    // Find the dirty ancestors, then compute them from the top down
+    slotStack.clear();
+    for (int32_t current = slot; current >= 0 && (flags_[current] & WORLD_DIRTY) != 0; current = parents_[current])
+    {
+        slotStack.push_back(current);
+    }
+
+    for (size_t i = slotStack.size(); i > 0; --i)
+    {
+        computeSlot(slotStack[i - 1]);
+    }
+}
+
+void TransformHierarchy::computeSlot(int32_t slot)
+{
+    const int32_t parentSlot = parents_[slot];
+    if (parentSlot < 0)
+    {
+        buildTrs(positions_[slot], rotations_[slot], scales_[slot], localToWorld_[slot]);
+        worldRotations_[slot] = rotations_[slot];
+        worldScales_[slot] = scales_[slot];
+    }
+    else
+    {
+        Matrix4x4 local;
+        buildTrs(positions_[slot], rotations_[slot], scales_[slot], local);
+        multiplyAffine(localToWorld_[parentSlot], local, localToWorld_[slot]);
+        worldRotations_[slot] = worldRotations_[parentSlot] * rotations_[slot];
+        worldScales_[slot] = worldScales_[parentSlot] * scales_[slot];
+    }
+
+    // The inverse is left until it is asked for
+    flags_[slot] = (flags_[slot] & (uint8_t)~WORLD_DIRTY) | INVERSE_DIRTY;
+}
+
+void TransformHierarchy::moveSubtreeToEnd(int32_t slot)
+{
+    // Only slots after this one can be its descendants.
+    // A slot is in the subtree if its parent is, and parents are found before their children.
+    const int32_t count = (int32_t)slotCount();
+    std::vector<uint8_t> inSubtree(count - slot, 0);
+    inSubtree[0] = 1;
+    for (int32_t i = slot + 1; i < count; ++i)
+    {
+        const int32_t parentSlot = parents_[i];
+        inSubtree[i - slot] = (parentSlot >= slot && inSubtree[parentSlot - slot] != 0) ? 1 : 0;
+    }
+
+    // Keep everything else in order, and drop dead slots while everything is being moved anyway
+    std::vector<int32_t> order;
+    order.reserve(count);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        if (ids_[i] != INVALID_ID && (i < slot || inSubtree[i - slot] == 0))
+        {
+            order.push_back(i);
+        }
+    }
+    for (int32_t i = slot; i < count; ++i)
+    {
+        if (inSubtree[i - slot] != 0)
+        {
+            order.push_back(i);
+        }
+    }
+
+    reorderSlots(order);
+}
+
+void TransformHierarchy::reorderSlots(const std::vector<int32_t>& order)
+{
+    std::vector<int32_t> newSlots(slotCount(), -1);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        newSlots[order[i]] = (int32_t)i;
+    }
+
+    gather(ids_, order);
+    gather(parents_, order);
+    gather(firstChildren_, order);
+    gather(nextSiblings_, order);
+    gather(flags_, order);
+    gather(positions_, order);
+    gather(rotations_, order);
+    gather(scales_, order);
+    gather(previousPositions_, order);
+    gather(previousRotations_, order);
+    gather(previousScales_, order);
+    gather(localToWorld_, order);
+    gather(worldToLocal_, order);
+    gather(worldRotations_, order);
+    gather(worldScales_, order);
+    gather(renderLocalToWorld_, order);
+
+    // Point the links at the new slots
+    deadCount_ = 0;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        parents_[i] = (parents_[i] < 0) ? -1 : newSlots[parents_[i]];
+        firstChildren_[i] = (firstChildren_[i] < 0) ? -1 : newSlots[firstChildren_[i]];
+        nextSiblings_[i] = (nextSiblings_[i] < 0) ? -1 : newSlots[nextSiblings_[i]];
+
+        if (ids_[i] == INVALID_ID)
+        {
+            ++deadCount_;
+        }
+        else
+        {
+            slots_[ids_[i]] = (uint32_t)i;
+        }
+    }
+}
\ No newline at end of file
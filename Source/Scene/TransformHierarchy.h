@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/Matrix4x4.h"
+#include "Math/Point3.h"
+#include "Math/Quaternion.h"
+#include "Math/Vector3.h"
+
+// Identifies a transform in a TransformHierarchy.
+// IDs stay the same while the transforms are moved around inside the hierarchy.
+typedef uint32_t TransformID;
+
+// The local and world state of every transform in the scene, stored as arrays rather than per object.
+//
+// Transforms are kept in hierarchy order, so a parent always comes before its children, and the
+// world matrices of everything can be brought up to date in a single pass from front to back.
+// Changing a transform only marks it and its descendants as dirty. Their world matrices are
+// recomputed by the next pass, or earlier if one of them is asked for. The inverse matrices are
+// only computed when they are asked for.
+//
+// The local values from before the latest simulation tick are kept too, so what is drawn can be
+// interpolated between the last two ticks. Changes made outside of a tick apply to both states,
+// so moving things in the editor or between ticks isn't smoothed out. Neither are changes to
+// transforms created during the tick, so new objects appear where they are first put.
+//
+// Once the world matrices are up to date, separate subtrees can be moved and read from different
+// threads at the same time. Anything that adds, removes or reparents transforms can't.
+class TransformHierarchy
+{
+public:
+    // An ID that refers to no transform. Used as the parent of root transforms.
+    const static TransformID INVALID_ID = 0xFFFFFFFF;
+
+    TransformHierarchy();
+
+    // Adds a root transform at the origin, with no rotation and a scale of one
+    TransformID create();
+
+    // Removes a transform. Its children become root transforms.
+    void destroy(TransformID id);
+
+    // Gets and sets the parent of a transform, which is INVALID_ID for root transforms.
+    // The local values are kept, so the transform moves with its new parent.
+    TransformID parent(TransformID id) const;
+    void setParent(TransformID id, TransformID parent);
+
+    // Transform position / rotation / scale relative to the parent
+    const Point3& positionLocal(TransformID id) const { return positions_[slots_[id]]; }
+    const Quaternion& rotationLocal(TransformID id) const { return rotations_[slots_[id]]; }
+    const Vector3& scaleLocal(TransformID id) const { return scales_[slots_[id]]; }
+
+    void setLocal(TransformID id, const Point3& position, const Quaternion& rotation, const Vector3& scale);
+    void setPositionLocal(TransformID id, const Point3& position);
+    void setRotationLocal(TransformID id, const Quaternion& rotation);
+    void setScaleLocal(TransformID id, const Vector3& scale);
+
+    // Marks a transform and its descendants as needing their world values recomputed
+    void markDirty(TransformID id);
+
+    // Treats a transform as if it had just been created, so it is drawn where it is put for the rest
+    // of the tick rather than moving there from where it was before. Used when objects are reused.
+    void skipInterpolation(TransformID id);
+
+    // World space values, recomputed first if the transform is dirty.
+    // The world scale is the product of the local scales, ignoring any rotations between them.
+    const Matrix4x4& localToWorld(TransformID id);
+    const Matrix4x4& worldToLocal(TransformID id);
+    Point3 positionWorld(TransformID id);
+    const Quaternion& rotationWorld(TransformID id);
+    const Vector3& scaleWorld(TransformID id);
+
+    // Recomputes the world values of every dirty transform
+    void updateWorldMatrices();
+
+    // Called around each simulation tick. Starting a tick saves the current local values as the previous state.
+    void beginTick();
+    void endTick();
+
+    // Brings the world values up to date, then computes the matrices to draw the transforms moved
+    // by the latest tick with, a fraction of the way from the state before the tick to the current state.
+    void updateRenderMatrices(float interpolationFactor);
+
+    // The matrix to draw a transform with. Transforms that weren't interpolated by the last call
+    // to updateRenderMatrices are drawn with their current world matrix.
+    const Matrix4x4& renderLocalToWorld(TransformID id);
+
+    // The number of transforms in the hierarchy
+    size_t size() const { return slotCount() - deadCount_; }
+
+private:
+    // Flags stored for each slot
+    const static uint8_t WORLD_DIRTY = 1;
+    const static uint8_t INVERSE_DIRTY = 2;
+
+    // Set when the local values change during a tick, until the next tick saves them
+    const static uint8_t MOVED = 4;
+
+    // Set when the render matrix was interpolated, so the children are interpolated too
+    const static uint8_t INTERPOLATED = 8;
+
+    // Set on transforms created or reused since the last tick started, whose changes aren't interpolated
+    const static uint8_t PLACING = 16;
+
+    // Where each transform ID is stored. Unused IDs are on the free list.
+    std::vector<uint32_t> slots_;
+    std::vector<TransformID> freeIDs_;
+
+    // The arrays below all have an element per slot, in hierarchy order.
+    // Slots of destroyed transforms have an ID of INVALID_ID, and are removed when there are enough of them.
+    std::vector<TransformID> ids_;
+    std::vector<int32_t> parents_;
+    std::vector<int32_t> firstChildren_;
+    std::vector<int32_t> nextSiblings_;
+    std::vector<uint8_t> flags_;
+
+    std::vector<Point3> positions_;
+    std::vector<Quaternion> rotations_;
+    std::vector<Vector3> scales_;
+
+    std::vector<Point3> previousPositions_;
+    std::vector<Quaternion> previousRotations_;
+    std::vector<Vector3> previousScales_;
+
+    std::vector<Matrix4x4> localToWorld_;
+    std::vector<Matrix4x4> worldToLocal_;
+    std::vector<Quaternion> worldRotations_;
+    std::vector<Vector3> worldScales_;
+    std::vector<Matrix4x4> renderLocalToWorld_;
+
+    size_t deadCount_;
+
+    // Whether a tick is running, so changes can be interpolated
+    bool ticking_;
+
+    size_t slotCount() const { return ids_.size(); }
+
+    // Adds a slot to the end of the arrays
+    int32_t appendSlot(TransformID id);
+
+    // Links and unlinks a slot from its parent's list of children
+    void linkToParent(int32_t slot, int32_t parentSlot);
+    void unlinkFromParent(int32_t slot);
+
+    // Marks a slot and its descendants as dirty after its local values changed.
+    // Outside of a tick, the previous state is made to match.
+    void localChanged(int32_t slot);
+
+    // Marks a slot and its descendants as dirty
+    void markSlotDirty(int32_t slot);
+
+    // Brings a slot's world values up to date, along with any dirty ancestors
+    void updateSlot(int32_t slot);
+
+    // Recomputes the world values of a slot whose parent is already up to date
+    void computeSlot(int32_t slot);
+
+    // Moves a slot and its descendants to the end of the arrays, keeping their order
+    void moveSubtreeToEnd(int32_t slot);
+
+    // Rebuilds the arrays with the slots in the given order. Slots that are left out are dropped.
+    void reorderSlots(const std::vector<int32_t>& order);
+};
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "TurretGun.h"
 
+#include <algorithm>
+
 #include "Scene/Transform.h"
 #include "Scene/Rocket.h"
 #include "Math/Quaternion.h"
 #include "Serialization/Prefab.h"
+#include "SceneManager.h"
+#include "Utils/Clock.h"
 
 #include "imgui.h"
 #include "Utils/ImGuiExtensions.h"
@@ -11,43 +15,64 @@
 TurretGun::TurretGun(GameObject* gameObject)
     : Component(gameObject),
     transform_(gameObject->createComponent<Transform>()),
-    timeSinceShot_(0.0f),
-    refireTime_(2.5f)
+    refireTime_(2.5f),
+    refireTimer_(TimerWheel::INVALID_ID),
+    pooledProjectiles_(2)
 {
     transform_->setRotationLocal(Quaternion::identity());
+    scheduleRefire();
+}
+
+TurretGun::~TurretGun()
+{
+    SceneManager::instance()->cancelTimer(refireTimer_);
 }
 
 void TurretGun::serialize(PropertyTable &table)
 {
     table.serialize("prefab", prefab_);
     table.serialize("refire_time", refireTime_, 2.5f);
+    table.serialize("pooled_projectiles", pooledProjectiles_, 2);
+
+    if (table.mode() == PropertyTableMode::Reading)
+    {
+        scheduleRefire();
+        if (prefab_ != nullptr)
+        {
+            SceneManager::instance()->prefabPool(prefab_).prewarm(pooledProjectiles_);
+        }
+    }
 }
 
 void TurretGun::drawProperties()
 {
     ImGui::ResourceSelect<Prefab>("Prefab", "Select Prefab", prefab_);
-    ImGui::DragFloat("Refire time", &refireTime_, 0.1f);
-}
-
-void TurretGun::update(float deltaTime)
-{
-    // Add delta time to elapsed time since shot
-    timeSinceShot_ += deltaTime;
-    
-    // If elapsed time exceeds refire time, fire projectile
-    if (timeSinceShot_ >= refireTime_)
+    if (ImGui::DragFloat("Refire time", &refireTime_, 0.1f, Clock::instance()->fixedDeltaTime(), 3600.0f))
     {
-        spawnPrefab();
-        timeSinceShot_ = 0.0f;
+        scheduleRefire();
     }
+    ImGui::DragInt("Pooled projectiles", &pooledProjectiles_, 0.1f, 0, 64);
 }
 
 void TurretGun::spawnPrefab()
 {
     if (prefab_ != nullptr)
     {
-        // Create new gameObject using prefab and set parent transform
-        GameObject* projectile = new GameObject("Projectile", prefab_);
-        projectile->findComponent<Rocket>()->initRocket(transform_->positionWorld(), transform_->rotationWorld());
+        // Reuse a projectile from the prefab's pool, starting where the gun is now.
+        // Turrets update in parallel, so the scene manager spawns it once they have all finished.
+        const Point3 position = transform_->positionWorld();
+        const Quaternion rotation = transform_->rotationWorld();
+        SceneManager::instance()->spawnPooledGameObject(prefab_, [position, rotation](GameObject* projectile)
+        {
+            projectile->findComponent<Rocket>()->initRocket(position, rotation);
+        });
     }
+}
+
+void TurretGun::scheduleRefire()
+{
+    // The gun fires at most once a tick. A period of 0 would make the timer fire only once.
+    refireTime_ = std::max(refireTime_, Clock::instance()->fixedDeltaTime());
+    SceneManager::instance()->cancelTimer(refireTimer_);
+    refireTimer_ = SceneManager::instance()->scheduleTimer(refireTime_, [this] { spawnPrefab(); }, refireTime_);
 }
\ No newline at end of file
@@ -1,17 +1,21 @@
 #pragma once
 
 #include "Scene/Component.h"
+#include "Utils/TimerWheel.h"
 
 class Prefab;
 
 class TurretGun : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::TurretGun;
+    ComponentType componentType() const override { return TYPE; }
+
     TurretGun(GameObject* gameObject);
+    ~TurretGun();
 
     void serialize(PropertyTable &table);
     void drawProperties() override;
-    void update(float deltaTime) override;
 
     void spawnPrefab();
 
@@ -19,6 +23,14 @@ private:
     Transform* transform_;
     Prefab* prefab_ = nullptr;
 
-    float timeSinceShot_;
     float refireTime_;
+
+    // Fires the gun every refireTime_ seconds, so the gun doesn't need updating every tick
+    TimerID refireTimer_;
+
+    // The number of projectiles created ahead of time when the gun is loaded, so firing doesn't have to
+    int pooledProjectiles_;
+
+    // Restarts the refire timer, after the refire time changes
+    void scheduleRefire();
 };
\ No newline at end of file
@@ -8,6 +8,9 @@ class Transform;
 class Windmill : public Component
 {
 public:
+    const static ComponentType TYPE = ComponentType::Windmill;
+    ComponentType componentType() const override { return TYPE; }
+
     Windmill(GameObject* gameObject);
 
     void drawProperties() override;
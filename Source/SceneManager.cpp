@@ -1,5 +1,10 @@
 #include "SceneManager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
 #include "Application.h"
 
 #include "Editor/MainWindowMenu.h"
@@ -16,10 +21,48 @@
 #include "InputManager.h"
 
 #include "Utils/Clock.h"
+#include "Utils/JobSystem.h"
 #include "EditorManager.h"
 
+namespace
+{
+    // The number of components of a type that are updated by each job, when they can be split across jobs
+    const int UPDATE_GRAIN_SIZE = 64;
+
+    void updateComponents(const ComponentPool& pool, size_t begin, size_t end, float deltaTime)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (pool[i]->updateEnabled())
+            {
+                pool[i]->update(deltaTime);
+            }
+        }
+    }
+}
+
 SceneManager::SceneManager()
+    : gameObjectMemory_(sizeof(GameObject)),
+    lastSceneCloseMilliseconds_(0.0f),
+    lastSceneOpenMilliseconds_(0.0f),
+    mainCamera_(nullptr),
+    mainCameraDirty_(true),
+    updating_(false)
 {
+    // Find the pools each type of component is stored in, including the pools of derived types
+    for (int baseType = 0; baseType < COMPONENT_TYPE_COUNT; ++baseType)
+    {
+        for (int type = 0; type < COMPONENT_TYPE_COUNT; ++type)
+        {
+            if (isComponentType((ComponentType)type, (ComponentType)baseType))
+            {
+                poolsOfType_[baseType].push_back(&pools_[type]);
+            }
+        }
+    }
+
+    buildUpdateGroups();
+
     // We require a scene loaded at all times.
     // Load the startup scene when the game starts
     openScene("Resources/Scenes/startup.scene");
@@ -42,37 +85,173 @@ SceneManager::SceneManager()
     });
 }
 
+void SceneManager::startTick()
+{
+    transformHierarchy_.beginTick();
+}
+
+void SceneManager::tick(float fixedDeltaTime)
+{
+    updatePhase(UpdatePhase::Input, fixedDeltaTime);
+    runTimers();
+    updatePhase(UpdatePhase::Gameplay, fixedDeltaTime);
+    updatePhase(UpdatePhase::Physics, fixedDeltaTime);
+
+    transformHierarchy_.endTick();
+}
+
 void SceneManager::frameStart()
 {
-    const float deltaTime = Clock::instance()->deltaTime();
+    updatePhase(UpdatePhase::Late, Clock::instance()->deltaTime());
+
+    // Close up the gaps left in the gameobject list by the gameobjects deleted since the last frame
+    gameObjects_.compact();
 
-    // Trigger updates for all gameobjects
-    for (GameObject* gameObject : gameObjects_)
+    // Bring every transform moved by the updates up to date in one pass, ready for rendering
+    transformHierarchy_.updateRenderMatrices(Clock::instance()->interpolationFactor());
+}
+
+void SceneManager::spawnGameObject(const std::string &name, Prefab* prefab, std::function<void(GameObject*)> spawned)
+{
+    if (updating_)
     {
-        gameObject->update(deltaTime);
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pendingSpawns_.push_back({ name, prefab, false, std::move(spawned) });
+        return;
+    }
+
+    GameObject* gameObject = new GameObject(name, prefab);
+    if (spawned)
+    {
+        spawned(gameObject);
+    }
+}
+
+void SceneManager::spawnPooledGameObject(Prefab* prefab, std::function<void(GameObject*)> spawned)
+{
+    if (updating_)
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pendingSpawns_.push_back({ std::string(), prefab, true, std::move(spawned) });
+        return;
+    }
+
+    GameObject* gameObject = prefabPool(prefab).acquire();
+    if (spawned)
+    {
+        spawned(gameObject);
     }
 }
 
+void SceneManager::destroyGameObject(GameObject* gameObject)
+{
+    if (updating_)
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pendingDestroys_.push_back(gameObject->id());
+        return;
+    }
+
+    // An instance that has already been released to its pool has no ID, so this ignores releasing it again
+    if (gameObjects_.find(gameObject->id()) != gameObject)
+    {
+        return;
+    }
+
+    if (gameObject->prefabPool_ != nullptr)
+    {
+        gameObject->prefabPool_->release(gameObject);
+    }
+    else
+    {
+        delete gameObject;
+    }
+}
+
+TimerID SceneManager::scheduleTimer(float delaySeconds, std::function<void()> callback, float periodSeconds)
+{
+    // Round to whole ticks, but never to 0, as a period of 0 ticks means the timer doesn't repeat
+    const float fixedDeltaTime = Clock::instance()->fixedDeltaTime();
+    const uint64_t delayTicks = (uint64_t)fmaxf(roundf(delaySeconds / fixedDeltaTime), 1.0f);
+    const uint64_t periodTicks = (periodSeconds > 0.0f) ? (uint64_t)fmaxf(roundf(periodSeconds / fixedDeltaTime), 1.0f) : 0;
+    return timers_.schedule(delayTicks, std::move(callback), periodTicks);
+}
+
+void SceneManager::cancelTimer(TimerID id)
+{
+    timers_.cancel(id);
+}
+
+PrefabPool& SceneManager::prefabPool(Prefab* prefab)
+{
+    std::unique_ptr<PrefabPool>& pool = prefabPools_[prefab];
+    if (pool == nullptr)
+    {
+        pool.reset(new PrefabPool(prefab));
+    }
+    return *pool;
+}
+
 void SceneManager::openScene(const std::string& scenePath)
 {
+    const auto openStart = std::chrono::high_resolution_clock::now();
+
     // If we are reloading the current scene, the scene values (lighting settings etc) 
     // may need to be reset.
     ResourceManager::instance()->importResource(ResourceManager::instance()->pathToResourceID(scenePath));
 
     // Change the current scene
     currentScene_ = ResourceManager::instance()->load<Scene>(scenePath);
+    recreateGameObjects(openStart);
+}
+
+void SceneManager::snapshotScene(PropertyTable& sceneProperties)
+{
+    sceneProperties.setMode(PropertyTableMode::Writing);
+    currentScene_->serialize(sceneProperties);
+}
 
-    // Delete all scene gameobjects (except ones with the SurviveSceneChanges flag)
-    for(size_t i = gameObjects_.size() - 1; i < gameObjects_.size(); --i)
+void SceneManager::restoreScene(PropertyTable& sceneProperties)
+{
+    const auto openStart = std::chrono::high_resolution_clock::now();
+    sceneProperties.setMode(PropertyTableMode::Reading);
+    currentScene_->serialize(sceneProperties);
+    recreateGameObjects(openStart);
+}
+
+void SceneManager::recreateGameObjects(std::chrono::high_resolution_clock::time_point openStart)
+{
+    // Delete all scene gameobjects (except ones with the SurviveSceneChanges flag).
+    // Deleting a gameobject deletes its children too, which leaves gaps in the list.
+    const auto closeStart = std::chrono::high_resolution_clock::now();
+    for(size_t i = gameObjects_.orderedCount() - 1; i < gameObjects_.orderedCount(); --i)
     {
-        if(gameObjects_[i]->hasFlag(GameObjectFlag::SurviveSceneChanges) == false)
+        GameObject* gameObject = gameObjects_.orderedAt(i);
+        if(gameObject != nullptr && gameObject->hasFlag(GameObjectFlag::SurviveSceneChanges) == false)
         {
-            delete gameObjects_[i];
+            delete gameObject;
         }
     }
+    gameObjects_.compact();
+
+    // Instances released to the pools aren't in the scene, so they are deleted separately
+    for (auto& pool : prefabPools_)
+    {
+        pool.second->clear();
+    }
+
+    // Give back the memory of the old scene all at once
+    releaseUnusedMemory();
+    const auto closeEnd = std::chrono::high_resolution_clock::now();
 
     // Create the new objects from the scene
     currentScene_->createGameObjects();
+    const auto openEnd = std::chrono::high_resolution_clock::now();
+
+    lastSceneCloseMilliseconds_ = std::chrono::duration<float, std::milli>(closeEnd - closeStart).count();
+    lastSceneOpenMilliseconds_ = std::chrono::duration<float, std::milli>((closeStart - openStart) + (openEnd - closeEnd)).count();
+    printf("Opened scene %s: %d gameobjects, %.2f ms to close the previous scene, %.2f ms to open\n",
+        scenePath().c_str(), (int)gameObjects_.size(), lastSceneCloseMilliseconds_, lastSceneOpenMilliseconds_);
 }
 
 void SceneManager::createScene(const std::string& scenePath)
@@ -94,23 +273,41 @@ void SceneManager::saveScene()
 
 Camera* SceneManager::mainCamera() const
 {
-    for (GameObject* gameObject : gameObjects_)
+    if (!mainCameraDirty_)
     {
-        Camera* camera = gameObject->findComponent<Camera>();
+        return mainCamera_;
+    }
+
+    mainCamera_ = nullptr;
+    mainCameraDirty_ = false;
+    for (size_t i = 0; i < gameObjects_.orderedCount(); ++i)
+    {
+        GameObject* gameObject = gameObjects_.orderedAt(i);
+        Camera* camera = (gameObject != nullptr) ? gameObject->findComponent<Camera>() : nullptr;
         if (camera != nullptr && gameObject->hasFlag(GameObjectFlag::NotShownInScenePanel) == false)
         {
-            return camera;
+            mainCamera_ = camera;
+            break;
         }
     }
 
-    return nullptr;
+    return mainCamera_;
+}
+
+void SceneManager::gameObjectFlagsChanged(GameObject*)
+{
+    mainCameraDirty_ = true;
 }
 
 void SceneManager::handleInput(const InputCmd& inputs)
 {
-    for (GameObject* gameObject : gameObjects_)
+    for (size_t i = 0; i < gameObjects_.orderedCount(); ++i)
     {
-        gameObject->handleInput(inputs);
+        GameObject* gameObject = gameObjects_.orderedAt(i);
+        if (gameObject != nullptr)
+        {
+            gameObject->handleInput(inputs);
+        }
     }
 }
 
@@ -141,21 +338,262 @@ void SceneManager::addCreateGameObjectMenuItem(const std::string &gameObjectName
     );
 }
 
+void* SceneManager::allocateGameObject(size_t size)
+{
+    assert(size <= gameObjectMemory_.blockSize());
+    return gameObjectMemory_.allocate();
+}
+
+void* SceneManager::allocateComponent(ComponentType type, size_t size)
+{
+    // Each pool is created by the first component of its type
+    std::unique_ptr<BlockPool>& memory = componentMemory_[(int)type];
+    if (memory == nullptr)
+    {
+        memory.reset(new BlockPool(size));
+    }
+
+    assert(size <= memory->blockSize());
+    return memory->allocate();
+}
+
+void SceneManager::releaseUnusedMemory()
+{
+    gameObjectMemory_.releaseEmptyChunks();
+    for (std::unique_ptr<BlockPool>& memory : componentMemory_)
+    {
+        if (memory != nullptr)
+        {
+            memory->releaseEmptyChunks();
+        }
+    }
+}
+
 void SceneManager::gameObjectCreated(GameObject* go)
 {
-    // Ensure the object does not already exist in the gameobject list
-    assert(std::find(gameObjects_.begin(), gameObjects_.end(), go) == gameObjects_.end());
+    // Ensure the object has not already been registered
+    assert(go->id_ == GameObject::INVALID_ID);
 
-    // Add to the gameobjects list
-    gameObjects_.push_back(go);
+    // Add to the gameobjects list, giving it an ID
+    go->id_ = gameObjects_.add(go);
+    if (go->id_ == GameObject::INVALID_ID)
+    {
+        printf("Unable to add gameobject %s to the scene - there are already %u gameobjects\n", go->name().c_str(), SlotMap<GameObject>::MAX_SLOTS);
+    }
+
+    // A camera created before the gameobject was registered may now be the main camera
+    mainCameraDirty_ = true;
 }
 
 void SceneManager::gameObjectDeleted(GameObject* go)
 {
     // If the go is in the scene list, remove it
-    auto found = std::find(gameObjects_.begin(), gameObjects_.end(), go);
-    if (found != gameObjects_.end())
+    gameObjects_.remove(go->id_);
+    go->id_ = GameObject::INVALID_ID;
+
+    mainCameraDirty_ = true;
+}
+
+void SceneManager::buildUpdateGroups()
+{
+    for (int type = 0; type < COMPONENT_TYPE_COUNT; ++type)
+    {
+        const ComponentTypeInfo& info = componentTypeInfo((ComponentType)type);
+        if (info.updatePhase == UpdatePhase::None)
+        {
+            continue;
+        }
+
+        // A type joins the last group of its phase unless it conflicts with a type already in it,
+        // so types that conflict still update in the order they are listed
+        std::vector<UpdateGroup>& groups = updateGroups_[(int)info.updatePhase];
+        bool conflicts = groups.empty();
+        for (size_t i = 0; !conflicts && i < groups.back().types.size(); ++i)
+        {
+            conflicts = updatesConflict(groups.back().types[i], (ComponentType)type);
+        }
+
+        if (conflicts)
+        {
+            groups.push_back({ {}, false });
+        }
+
+        groups.back().types.push_back((ComponentType)type);
+        // Moving a transform in world space reads its parent's world values
+        groups.back().readsTransforms |= (info.updateAccess & (UpdateAccess::ReadsTransforms | UpdateAccess::WritesOwnTransform)) != 0;
+    }
+}
+
+void SceneManager::updatePhase(UpdatePhase phase, float deltaTime)
+{
+    // Only components of types that override update are visited
+    updating_ = true;
+    for (const UpdateGroup& group : updateGroups_[(int)phase])
+    {
+        updateGroup(group, deltaTime);
+    }
+    updating_ = false;
+
+    applyPendingChanges();
+}
+
+void SceneManager::runTimers()
+{
+    updating_ = true;
+    timers_.tick();
+    updating_ = false;
+
+    applyPendingChanges();
+}
+
+void SceneManager::updateGroup(const UpdateGroup& group, float deltaTime)
+{
+    // Reading a dirty transform updates it, so make sure nothing is dirty before several updates can read them
+    if (group.readsTransforms)
+    {
+        transformHierarchy_.updateWorldMatrices();
+    }
+
+    // A type that can't be split up, with nothing to run beside it, is updated straight away
+    JobSystem* jobSystem = JobSystem::instance();
+    if (jobSystem == nullptr || (group.types.size() == 1 && !updatesInParallel(group.types[0])))
+    {
+        for (ComponentType type : group.types)
+        {
+            const ComponentPool& pool = pools_[(int)type];
+            updateComponents(pool, 0, pool.size(), deltaTime);
+        }
+        return;
+    }
+
+    JobCounter counter;
+    for (ComponentType type : group.types)
+    {
+        const ComponentTypeInfo& info = componentTypeInfo(type);
+        const ComponentPool& pool = pools_[(int)type];
+        if (pool.empty())
+        {
+            continue;
+        }
+
+        if ((info.updateAccess & UpdateAccess::MainThread) != 0)
+        {
+            jobSystem->runOnMainThread(info.name, [&pool, deltaTime] { updateComponents(pool, 0, pool.size(), deltaTime); }, &counter);
+        }
+        else if (updatesInParallel(type))
+        {
+            for (size_t begin = 0; begin < pool.size(); begin += UPDATE_GRAIN_SIZE)
+            {
+                const size_t end = std::min(begin + UPDATE_GRAIN_SIZE, pool.size());
+                jobSystem->run(info.name, [&pool, begin, end, deltaTime] { updateComponents(pool, begin, end, deltaTime); }, &counter);
+            }
+        }
+        else
+        {
+            jobSystem->run(info.name, [&pool, deltaTime] { updateComponents(pool, 0, pool.size(), deltaTime); }, &counter);
+        }
+    }
+
+    jobSystem->wait(counter);
+}
+
+void SceneManager::applyPendingChanges()
+{
+    // Deleting a gameobject deletes its children, which may also be waiting to be deleted,
+    // so only delete the ones that still exist
+    for (GameObjectID id : pendingDestroys_)
+    {
+        GameObject* gameObject = gameObjects_.find(id);
+        if (gameObject != nullptr)
+        {
+            destroyGameObject(gameObject);
+        }
+    }
+    pendingDestroys_.clear();
+
+    // A spawned callback may spawn more gameobjects, which are then created straight away
+    std::vector<PendingSpawn> spawns;
+    spawns.swap(pendingSpawns_);
+    for (PendingSpawn& spawn : spawns)
+    {
+        if (spawn.pooled)
+        {
+            spawnPooledGameObject(spawn.prefab, std::move(spawn.spawned));
+        }
+        else
+        {
+            spawnGameObject(spawn.name, spawn.prefab, std::move(spawn.spawned));
+        }
+    }
+}
+
+void SceneManager::deactivateGameObject(GameObject* gameObject)
+{
+    for (Transform* child : gameObject->transform()->children())
+    {
+        deactivateGameObject(child->gameObject());
+    }
+
+    for (Component* component : gameObject->components_)
+    {
+        component->resetForReuse();
+        componentDeleted(component);
+    }
+
+    gameObjectDeleted(gameObject);
+}
+
+void SceneManager::activateGameObject(GameObject* gameObject)
+{
+    // Don't draw a reused object moving from wherever it was last used
+    gameObject->transform()->skipInterpolation();
+    gameObjectCreated(gameObject);
+
+    for (Component* component : gameObject->components_)
+    {
+        componentCreated(component);
+    }
+
+    for (Transform* child : gameObject->transform()->children())
+    {
+        activateGameObject(child->gameObject());
+    }
+}
+
+void SceneManager::componentCreated(Component* component)
+{
+    const ComponentType type = component->componentType();
+    ComponentPool& pool = pools_[(int)type];
+    component->poolType_ = type;
+    component->poolIndex_ = (uint32_t)pool.size();
+    pool.push_back(component);
+
+    if (type == ComponentType::Camera)
+    {
+        mainCameraDirty_ = true;
+    }
+}
+
+void SceneManager::componentDeleted(Component* component)
+{
+    // The component's type can't be found from its destructor, so use the pool it was placed in
+    const ComponentType type = component->poolType_;
+    if (type == ComponentType::None)
+    {
+        return;
+    }
+
+    // Swap the last component in the pool into the removed component's place
+    ComponentPool& pool = pools_[(int)type];
+    Component* last = pool.back();
+    pool[component->poolIndex_] = last;
+    last->poolIndex_ = component->poolIndex_;
+    pool.pop_back();
+
+    component->poolType_ = ComponentType::None;
+
+    if (type == ComponentType::Camera)
     {
-        gameObjects_.erase(found);
+        mainCameraDirty_ = true;
     }
 }
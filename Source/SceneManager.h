@@ -1,29 +1,81 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
+#include "Utils/BlockPool.h"
 #include "Utils/Singleton.h"
+#include "Utils/SlotMap.h"
+#include "Utils/TimerWheel.h"
 
+#include "Scene/ComponentView.h"
 #include "Scene/Scene.h"
 #include "Scene/GameObject.h"
+#include "Scene/PrefabPool.h"
 #include "Scene/StaticMesh.h"
 #include "Scene/Terrain.h"
 #include "Scene/Shield.h"
+#include "Scene/TransformHierarchy.h"
 #include "Physics/BoxCollider.h"
 #include "Physics/SphereCollider.h"
 
 struct InputCmd;
+class Prefab;
 
 class SceneManager : public Singleton<SceneManager>
 {
     friend class GameObject;
+    friend class Component;
+    friend class PrefabPool;
 
 public:
     SceneManager();
 
-    // Called each frame.
+    // Called for each fixed simulation tick. startTick saves the transforms before the tick's input is
+    // dispatched, then tick updates the components of each simulation phase in turn, running updates
+    // that don't conflict at the same time.
+    void startTick();
+    void tick(float fixedDeltaTime);
+
+    // Called each frame, after the ticks.
+    // Runs the late phase, then works out where to draw everything between the last two ticks.
     void frameStart();
 
+    // Creates a gameobject from a prefab and passes it to the callback, which may be null.
+    // During the updates, the gameobject is only created once the current phase has finished.
+    // Safe to call from any update.
+    void spawnGameObject(const std::string &name, Prefab* prefab, std::function<void(GameObject*)> spawned = nullptr);
+
+    // Like spawnGameObject, but reuses an instance released to the prefab's pool when there is one.
+    // The spawned callback must set up everything that differs between uses, such as the position.
+    void spawnPooledGameObject(Prefab* prefab, std::function<void(GameObject*)> spawned = nullptr);
+
+    // Deletes a gameobject, along with its children, or releases it to the pool it was acquired from.
+    // During the updates, the gameobject is only deleted once the current phase has finished.
+    // Safe to call from any update, and more than once for the same gameobject during the updates
+    // or for a pooled gameobject, but not again for one that has been deleted outside the updates.
+    void destroyGameObject(GameObject* gameObject);
+
+    // Calls a function once after a delay, or repeatedly if the period isn't 0, counted in simulation ticks.
+    // Timers that are due run on the main thread at the start of each tick's gameplay phase, so components
+    // that only wait for something don't have to be updated every tick. Spawning and destroying from a
+    // callback is deferred like from an update. Must be called from the main thread.
+    TimerID scheduleTimer(float delaySeconds, std::function<void()> callback, float periodSeconds = 0.0f);
+
+    // Stops a timer. Does nothing if it has already finished. Must be called from the main thread.
+    void cancelTimer(TimerID id);
+
+    // Gets the pool of reusable instances of a prefab, creating an empty one the first time.
+    // The released instances are deleted when the scene changes.
+    PrefabPool& prefabPool(Prefab* prefab);
+
+    // Gets the gameobject with the given ID, or null if it has been deleted
+    GameObject* findGameObject(GameObjectID id) const { return gameObjects_.find(id); }
+
     // Gets the currently loaded scene
     const Scene* currentScene() const { return currentScene_; }
 
@@ -31,57 +83,69 @@ public:
     std::string sceneName() const { return currentScene_->resourceName(); }
     std::string scenePath() const { return currentScene_->resourcePath(); }
 
-    // Gets all gameobjects that currently exist
+    // Gets all gameobjects that currently exist, in the order they were created.
     // Note - This includes hidden objects and objects flagged to not be saved.
-    const std::vector<GameObject*>& gameObjects() const { return gameObjects_; }
+    // The list may be rebuilt when gameobjects are created or deleted, so don't keep it while doing either.
+    const std::vector<GameObject*>& gameObjects() { return gameObjects_.objects(); }
 
     // Gets a single instance of a specified component attached to a gameobject in the scene.
     // If none is found, returns null.
     template<typename T>
     T* findComponentInScene() const
     {
-        for (GameObject* gameObject : gameObjects_)
-        {
-            T* component = gameObject->findComponent<T>();
-            if (component != nullptr)
-            {
-                return component;
-            }
-        }
-
-        return nullptr;
+        const ComponentView<T> components = findAllComponentsInScene<T>();
+        return components.empty() ? nullptr : *components.begin();
     }
 
-    // Gets a list of all instances of a specified comonent, on any gameobject in the scene.
+    // Gets a live view of all instances of a specified component, on any gameobject in the scene.
+    // Nothing is copied, so the view can be iterated every frame without allocating.
     template<typename T>
-    std::vector<T*> findAllComponentsInScene() const
+    ComponentView<T> findAllComponentsInScene() const
     {
-        std::vector<T*> components;
+        return ComponentView<T>(poolsOfType_[(int)T::TYPE]);
+    }
 
-        for (GameObject* gameObject : gameObjects_)
+    // Calls a function with every instance of a specified component in the scene.
+    // Components of the type must not be created or deleted by the function.
+    template<typename T, typename Function>
+    void forEachComponentInScene(Function function) const
+    {
+        for (const ComponentPool* pool : poolsOfType_[(int)T::TYPE])
         {
-            T* component = gameObject->findComponent<T>();
-            if (component != nullptr)
+            for (Component* component : *pool)
             {
-                components.push_back(component);
+                function(static_cast<T*>(component));
             }
         }
-
-        return components;
     }
 
     // Closes the current scene and opens the one at the specified path.
     void openScene(const std::string &scenePath);
 
+    // Writes the current scene's gameobjects and settings, and replaces them with ones written before.
+    // Only the scene in memory is read and changed, the scene file is left as it is.
+    void snapshotScene(PropertyTable &sceneProperties);
+    void restoreScene(PropertyTable &sceneProperties);
+
+    // How long the last call to openScene took to delete the old scene's gameobjects, and to create the new ones
+    float lastSceneCloseMilliseconds() const { return lastSceneCloseMilliseconds_; }
+    float lastSceneOpenMilliseconds() const { return lastSceneOpenMilliseconds_; }
+
     // Closes the current scene and creates a new one, saved at the specified path.
     void createScene(const std::string &scenePath);
 
     // Updates the current scenes serialized gameobject list to match the gameobjects currently in the scene.
     void saveScene();
 
+    // Gets the positions, rotations and matrices of every transform
+    TransformHierarchy& transformHierarchy() { return transformHierarchy_; }
+
     // Gets the main camera, i.e. the scene camera that has existed for the longest
     Camera* mainCamera() const;
 
+    // Called by GameObject when its flags change, as they decide which camera is the main camera
+    void gameObjectFlagsChanged(GameObject* go);
+
     // Passes input struct to all gameobjects
     void handleInput(const InputCmd& inputs);
 
@@ -89,16 +153,102 @@ private:
     // The currently loaded scene
     Scene* currentScene_;
 
-    // A list of currently loaded gameobjects that *are* part of the scene.
-    std::vector<GameObject*> gameObjects_;
+    // The currently loaded gameobjects that *are* part of the scene, by ID
+    SlotMap<GameObject> gameObjects_;
+
+    // The memory gameobjects and components are allocated from, with a pool for each concrete component type.
+    // Objects of a type are packed together, and closing a scene frees their memory a chunk at a time.
+    BlockPool gameObjectMemory_;
+    std::unique_ptr<BlockPool> componentMemory_[COMPONENT_TYPE_COUNT];
+
+    float lastSceneCloseMilliseconds_;
+    float lastSceneOpenMilliseconds_;
+
+    // The values of every transform, in hierarchy order
+    TransformHierarchy transformHierarchy_;
+
+    // Every component in the scene, in a pool for each concrete type
+    ComponentPool pools_[COMPONENT_TYPE_COUNT];
+
+    // The pools of each type and every type derived from it
+    std::vector<const ComponentPool*> poolsOfType_[COMPONENT_TYPE_COUNT];
+
+    // The main camera is only searched for again after cameras or gameobject flags change
+    mutable Camera* mainCamera_;
+    mutable bool mainCameraDirty_;
+
+    // Callbacks waiting for a number of simulation ticks
+    TimerWheel timers_;
+
+    // Component types whose updates can run at the same time
+    struct UpdateGroup
+    {
+        std::vector<ComponentType> types;
+        bool readsTransforms;
+    };
+
+    // The groups in each phase, in the order they run
+    std::vector<UpdateGroup> updateGroups_[UPDATE_PHASE_COUNT];
+
+    // Gameobjects created and deleted by the updates, waiting for the end of the phase
+    struct PendingSpawn
+    {
+        std::string name;
+        Prefab* prefab;
+        bool pooled;
+        std::function<void(GameObject*)> spawned;
+    };
+
+    bool updating_;
+    std::mutex pendingMutex_;
+    std::vector<PendingSpawn> pendingSpawns_;
+    std::vector<GameObjectID> pendingDestroys_;
+
+    // The pool of each prefab spawned with spawnPooledGameObject.
+    // Declared last, so the released instances are deleted before the rest of the scene manager.
+    std::unordered_map<Prefab*, std::unique_ptr<PrefabPool>> prefabPools_;
+
+    // Splits the types updated in each phase into groups, keeping the order of the types
+    void buildUpdateGroups();
+
+    // Updates the components of a phase, then applies the changes they queued
+    void updatePhase(UpdatePhase phase, float deltaTime);
+
+    // Runs the timers that are due this tick, then applies the changes they queued
+    void runTimers();
+
+    // Updates every component in a group and waits for them to finish
+    void updateGroup(const UpdateGroup& group, float deltaTime);
+
+    // Creates and deletes the gameobjects queued during the last phase
+    void applyPendingChanges();
+
+    // Deletes the gameobjects of the previous scene and creates the current scene's
+    void recreateGameObjects(std::chrono::high_resolution_clock::time_point openStart);
+
+    // Takes a gameobject and its children out of the scene, or puts them back, keeping their components.
+    // Used by the prefab pools.
+    void deactivateGameObject(GameObject* gameObject);
+    void activateGameObject(GameObject* gameObject);
 
     // Adds a menu item for creating a new gameobject with the given component
     template<typename T>
     void addCreateGameObjectMenuItem(const std::string &gameObjectName);
 
+    // Called by the new operators of GameObject and Component
+    void* allocateGameObject(size_t size);
+    void* allocateComponent(ComponentType type, size_t size);
+
+    // Frees the memory that no gameobject or component is using any more
+    void releaseUnusedMemory();
+
     // Called by GameObject upon construction
     void gameObjectCreated(GameObject* go);
 
     // Called by GameObject upon destruction
     void gameObjectDeleted(GameObject* go);
+
+    // Called by GameObject when a component is added to or removed from it
+    void componentCreated(Component* component);
+    void componentDeleted(Component* component);
 };
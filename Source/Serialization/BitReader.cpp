@@ -18,7 +18,7 @@ BitReader::~BitReader()
 
 void BitReader::readWord()
 {
-    scratch_ |= (buffer_[wordIndex_] << scratchBits_);
+    scratch_ |= ((uint64_t)buffer_[wordIndex_] << scratchBits_);
     scratchBits_ += 32;
     wordIndex_ += 1;
 }
@@ -30,7 +30,7 @@ size_t BitReader::readBits(int bitcount)
         readWord();
     }
 
-    uint32_t mask = ~(-1 << bitcount);
+    const uint64_t mask = ((uint64_t)1 << bitcount) - 1;
     size_t bits = (scratch_ & mask);
     scratch_ >>= bitcount;
     scratchBits_ -= bitcount;
@@ -0,0 +1,135 @@
+#include "BlockPool.h"
+
+#include <malloc.h>
+
+BlockPool::BlockPool(size_t blockSize)
+    : blockSize_((blockSize + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT),
+    blocksPerChunk_(0),
+    chunkBytes_(CHUNK_SIZE),
+    blocksInUse_(0)
+{
+    // Every block must be able to hold the free list's link
+    if (blockSize_ < sizeof(void*))
+    {
+        blockSize_ = BLOCK_ALIGNMENT;
+    }
+
+    // Every block must start inside the first CHUNK_SIZE bytes, for free to find the header
+    blocksPerChunk_ = (CHUNK_SIZE - HEADER_SIZE) / blockSize_;
+    if (blocksPerChunk_ == 0)
+    {
+        blocksPerChunk_ = 1;
+        chunkBytes_ = HEADER_SIZE + blockSize_;
+    }
+}
+
+BlockPool::~BlockPool()
+{
+    for (ChunkHeader* chunk : chunks_)
+    {
+        _aligned_free(chunk);
+    }
+}
+
+void* BlockPool::allocate()
+{
+    ChunkHeader* chunk = availableChunks_.empty() ? allocateChunk() : availableChunks_.back();
+
+    void* block = chunk->freeBlocks;
+    chunk->freeBlocks = *(void**)block;
+    chunk->blocksInUse++;
+    blocksInUse_++;
+
+    if (chunk->freeBlocks == nullptr)
+    {
+        removeAvailable(chunk);
+    }
+
+    return block;
+}
+
+void BlockPool::free(void* block)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    // Chunks are aligned to their size, so the header is found by rounding the block's address down
+    ChunkHeader* chunk = (ChunkHeader*)((uintptr_t)block & ~(uintptr_t)(CHUNK_SIZE - 1));
+    BlockPool* pool = chunk->pool;
+
+    // A full chunk has a free block again
+    if (chunk->freeBlocks == nullptr)
+    {
+        chunk->availableIndex = pool->availableChunks_.size();
+        pool->availableChunks_.push_back(chunk);
+    }
+
+    *(void**)block = chunk->freeBlocks;
+    chunk->freeBlocks = block;
+    chunk->blocksInUse--;
+    pool->blocksInUse_--;
+}
+
+void BlockPool::releaseEmptyChunks()
+{
+    size_t kept = 0;
+    for (ChunkHeader* chunk : chunks_)
+    {
+        if (chunk->blocksInUse == 0)
+        {
+            _aligned_free(chunk);
+        }
+        else
+        {
+            chunks_[kept++] = chunk;
+        }
+    }
+    chunks_.resize(kept);
+
+    // Rebuild the list of chunks with free blocks from the ones that are left
+    availableChunks_.clear();
+    for (ChunkHeader* chunk : chunks_)
+    {
+        if (chunk->freeBlocks != nullptr)
+        {
+            chunk->availableIndex = availableChunks_.size();
+            availableChunks_.push_back(chunk);
+        }
+        else
+        {
+            chunk->availableIndex = NOT_AVAILABLE;
+        }
+    }
+}
+
+BlockPool::ChunkHeader* BlockPool::allocateChunk()
+{
+    ChunkHeader* chunk = (ChunkHeader*)_aligned_malloc(chunkBytes_, CHUNK_SIZE);
+    chunk->pool = this;
+    chunk->blocksInUse = 0;
+
+    // Link the blocks in address order, so blocks allocated one after another are next to each other
+    uint8_t* firstBlock = (uint8_t*)chunk + HEADER_SIZE;
+    for (size_t i = 0; i < blocksPerChunk_; ++i)
+    {
+        *(void**)(firstBlock + i * blockSize_) = (i + 1 < blocksPerChunk_) ? firstBlock + (i + 1) * blockSize_ : nullptr;
+    }
+    chunk->freeBlocks = firstBlock;
+
+    chunks_.push_back(chunk);
+    chunk->availableIndex = availableChunks_.size();
+    availableChunks_.push_back(chunk);
+    return chunk;
+}
+
+void BlockPool::removeAvailable(ChunkHeader* chunk)
+{
+    // Swap the last available chunk into the removed chunk's place
+    ChunkHeader* last = availableChunks_.back();
+    availableChunks_[chunk->availableIndex] = last;
+    last->availableIndex = chunk->availableIndex;
+    availableChunks_.pop_back();
+    chunk->availableIndex = NOT_AVAILABLE;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hands out blocks of memory of a single size, carved from large chunks.
+//
+// Blocks allocated one after another sit next to each other, so objects of the same type that are
+// allocated from the same pool stay close together in memory. Each chunk is aligned to its size and
+// starts with a header pointing back at its pool, so a block can be freed without knowing which pool
+// it came from. Chunks that become empty are kept for reuse until releaseEmptyChunks is called,
+// which frees them all at once.
+//
+// Pools are not thread safe.
+class BlockPool
+{
+public:
+    // The size and alignment of each chunk. Blocks too large to share a chunk get a larger chunk each.
+    const static size_t CHUNK_SIZE = 64 * 1024;
+
+    // Blocks are aligned to this, which is enough for any of the math types
+    const static size_t BLOCK_ALIGNMENT = 16;
+
+    explicit BlockPool(size_t blockSize);
+    ~BlockPool();
+
+    // Prevent the pool from being copied, as its chunks point back at it
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    // Gets an uninitialised block, allocating a new chunk if every chunk is full
+    void* allocate();
+
+    // Returns a block to the pool it was allocated from. Does nothing if the block is null.
+    static void free(void* block);
+
+    // Frees the memory of every chunk that has no blocks in use
+    void releaseEmptyChunks();
+
+    size_t blockSize() const { return blockSize_; }
+    size_t blocksPerChunk() const { return blocksPerChunk_; }
+    size_t blocksInUse() const { return blocksInUse_; }
+    size_t chunkCount() const { return chunks_.size(); }
+
+private:
+    // Placed at the start of every chunk, before its blocks
+    struct ChunkHeader
+    {
+        BlockPool* pool;
+
+        // Where the chunk is in the pool's list of chunks with free blocks
+        size_t availableIndex;
+
+        // The chunk's unused blocks, linked through their first bytes
+        void* freeBlocks;
+        size_t blocksInUse;
+    };
+
+    const static size_t HEADER_SIZE = (sizeof(ChunkHeader) + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+
+    // Marks a chunk that isn't in the list of chunks with free blocks
+    const static size_t NOT_AVAILABLE = (size_t)-1;
+
+    size_t blockSize_;
+    size_t blocksPerChunk_;
+    size_t chunkBytes_;
+    size_t blocksInUse_;
+
+    // Every chunk, and the chunks that have at least one free block.
+    // New blocks come from the most recently freed chunk, to keep the blocks in use packed together.
+    std::vector<ChunkHeader*> chunks_;
+    std::vector<ChunkHeader*> availableChunks_;
+
+    ChunkHeader* allocateChunk();
+    void removeAvailable(ChunkHeader* chunk);
+};
\ No newline at end of file
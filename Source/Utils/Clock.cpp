@@ -1,6 +1,7 @@
 #include "Clock.h"
 
 #include <Windows.h>
+#include <math.h>
 
 #include "Editor/MainWindowMenu.h"
 
@@ -14,6 +15,12 @@ Clock::Clock()
     deltaTime_ = 0.0f;
     realTime_ = 0.0f;
     realDeltaTime_ = 0.0f;
+    tickRate_ = 60.0f;
+    fixedDeltaTime_ = 1.0f / tickRate_;
+    maxTicksPerFrame_ = 8;
+    tickAccumulator_ = 0.0f;
+    previousTickAccumulator_ = 0.0f;
+    tickCount_ = 0;
     
     // Get clock frequency and initial time stamp
     QueryPerformanceFrequency((LARGE_INTEGER*)&clockFrequency_);
@@ -37,6 +44,8 @@ void Clock::restart()
     paused_ = false;
     timeScale_ = 1.0f;
     time_ = 0.0f;
+    tickAccumulator_ = 0.0f;
+    tickCount_ = 0;
 }
 
 void Clock::stop()
@@ -44,6 +53,8 @@ void Clock::stop()
     paused_ = true;
     timeScale_ = 1.0f;
     time_ = 0.0f;
+    tickAccumulator_ = 0.0f;
+    tickCount_ = 0;
 }
 
 // Return timescale
@@ -82,6 +93,17 @@ float Clock::realDeltaTime() const
     return realDeltaTime_;
 }
 
+void Clock::setTickRate(float ticksPerSecond)
+{
+    tickRate_ = ticksPerSecond;
+    fixedDeltaTime_ = 1.0f / ticksPerSecond;
+}
+
+void Clock::setMaxTicksPerFrame(int maxTicks)
+{
+    maxTicksPerFrame_ = maxTicks;
+}
+
 //On every frame start
 void Clock::frameStart()
 {
@@ -99,6 +121,25 @@ void Clock::frameStart()
     // Update time values
     realTime_ += realDeltaTime_;
     time_ += deltaTime_;
+
+    previousTickAccumulator_ = tickAccumulator_;
+    accumulateTicks();
+}
+
+void Clock::overrideRealDeltaTime(float realDeltaTime)
+{
+    // Undo the values added in frameStart
+    realTime_ -= realDeltaTime_;
+    time_ -= deltaTime_;
+
+    realDeltaTime_ = realDeltaTime;
+    deltaTime_ = realDeltaTime_ * timeScale_ * (paused_ ? 0.0f : 1.0f);
+
+    realTime_ += realDeltaTime_;
+    time_ += deltaTime_;
+
+    tickAccumulator_ = previousTickAccumulator_;
+    accumulateTicks();
 }
 
 // Return current time stamp using WINAPI
@@ -108,4 +149,21 @@ uint64_t Clock::getTimestamp() const
     QueryPerformanceCounter((LARGE_INTEGER*)&timeStamp);
 
     return timeStamp;
+}
+
+void Clock::accumulateTicks()
+{
+    tickAccumulator_ += deltaTime_;
+    tickCount_ = (int)(tickAccumulator_ / fixedDeltaTime_);
+
+    if (tickCount_ > maxTicksPerFrame_)
+    {
+        tickCount_ = maxTicksPerFrame_;
+        tickAccumulator_ = fmodf(tickAccumulator_, fixedDeltaTime_);
+    }
+    else
+    {
+        // Rounding can leave the remainder just below zero
+        tickAccumulator_ = fmaxf(tickAccumulator_ - tickCount_ * fixedDeltaTime_, 0.0f);
+    }
 }
\ No newline at end of file
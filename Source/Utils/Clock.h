@@ -34,9 +34,30 @@ public:
     float realTime() const;
     float realDeltaTime() const;
 
+    // The number of fixed simulation ticks per second of game time, and the length of each tick
+    float tickRate() const { return tickRate_; }
+    void setTickRate(float ticksPerSecond);
+    float fixedDeltaTime() const { return fixedDeltaTime_; }
+
+    // The most ticks run in a single frame. Game time beyond that is dropped, so a slow
+    // frame slows the game down instead of making the frames after it slower still.
+    int maxTicksPerFrame() const { return maxTicksPerFrame_; }
+    void setMaxTicksPerFrame(int maxTicks);
+
+    // The number of ticks to run this frame, from the game time that has built up since the last tick
+    int tickCount() const { return tickCount_; }
+
+    // How far the game time is between the last tick and the next one, from 0 to 1.
+    // Used to draw things between where they were at the last two ticks.
+    float interpolationFactor() const { return tickAccumulator_ / fixedDeltaTime_; }
+
     //Called on every frame
     void frameStart();
 
+    // Replaces the measured real delta time for the current frame.
+    // Used when replaying recorded sessions, so they advance exactly as they were recorded.
+    void overrideRealDeltaTime(float realDeltaTime);
+
 private:
     // Paused flag
     bool paused_;
@@ -58,6 +79,18 @@ private:
 
     //Real time since last frame
     float realDeltaTime_;
+
+    // Fixed tick settings
+    float tickRate_;
+    float fixedDeltaTime_;
+    int maxTicksPerFrame_;
+
+    // Game time not yet used by a tick, and its value before the current frame was added
+    float tickAccumulator_;
+    float previousTickAccumulator_;
+
+    // Ticks to run in the current frame
+    int tickCount_;
     
     // Timestamp of previous frame
     uint64_t prevFrameTimestamp_;
@@ -67,4 +100,7 @@ private:
 
     // Returns current time stamp
     uint64_t getTimestamp() const;
+
+    // Adds the current frame's delta time to the accumulator, and works out how many ticks it covers
+    void accumulateTicks();
 };
\ No newline at end of file
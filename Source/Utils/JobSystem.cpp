@@ -0,0 +1,334 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+
+namespace
+{
+    // The job system the calling thread belongs to, and its index within it
+    thread_local const JobSystem* threadJobSystem = nullptr;
+    thread_local int threadIndex = 0;
+}
+
+JobCounter::JobCounter()
+    : remaining_(0)
+{
+
+}
+
+JobSystem::JobSystem(int threadCount)
+    : queuedJobs_(0),
+    stopping_(false)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        queues_.push_back(std::make_unique<JobQueue>());
+        timings_.push_back(std::make_unique<ThreadTimings>());
+    }
+
+    // The creating thread is the main thread, and the rest are workers
+    threadJobSystem = this;
+    threadIndex = 0;
+    for (int i = 1; i < threadCount; ++i)
+    {
+        workers_.emplace_back(&JobSystem::workerMain, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wakeCondition_.notify_all();
+
+    for (std::thread& worker : workers_)
+    {
+        worker.join();
+    }
+
+    if (threadJobSystem == this)
+    {
+        threadJobSystem = nullptr;
+    }
+}
+
+int JobSystem::currentThreadIndex() const
+{
+    return (threadJobSystem == this) ? threadIndex : 0;
+}
+
+void JobSystem::run(const char* name, std::function<void()> function, JobCounter* counter, JobCounter* dependency)
+{
+    if (counter != nullptr)
+    {
+        ++counter->remaining_;
+    }
+
+    schedule(Job{ name, std::move(function), counter, false }, dependency);
+}
+
+void JobSystem::runOnMainThread(const char* name, std::function<void()> function, JobCounter* counter, JobCounter* dependency)
+{
+    if (counter != nullptr)
+    {
+        ++counter->remaining_;
+    }
+
+    schedule(Job{ name, std::move(function), counter, true }, dependency);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    const int index = currentThreadIndex();
+    while (!counter.finished())
+    {
+        // Help out rather than sit idle. The main thread also runs its own queue.
+        Job job;
+        bool found = false;
+        if (index == 0)
+        {
+            std::lock_guard<std::mutex> lock(mainThreadQueue_.mutex);
+            if (!mainThreadQueue_.jobs.empty())
+            {
+                job = std::move(mainThreadQueue_.jobs.front());
+                mainThreadQueue_.jobs.pop_front();
+                found = true;
+            }
+        }
+
+        if (found || tryTakeJob(index, job))
+        {
+            execute(index, job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // The last job may still hold the counter's lock just after finishing it.
+    // Wait for it to let go, so the counter can be destroyed as soon as this returns.
+    std::lock_guard<std::mutex> lock(counter.continuationsMutex_);
+}
+
+void JobSystem::parallelFor(const char* name, int count, int grainSize, const std::function<void(int, int)> &function)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    // Enough jobs for threads that finish early to steal from the others
+    if (grainSize <= 0)
+    {
+        grainSize = std::max(1, count / (threadCount() * 4));
+    }
+
+    // Run everything here if there is only one job's worth
+    if (grainSize >= count || threadCount() == 1)
+    {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (int begin = 0; begin < count; begin += grainSize)
+    {
+        const int end = std::min(begin + grainSize, count);
+        run(name, [&function, begin, end] { function(begin, end); }, &counter);
+    }
+
+    wait(counter);
+}
+
+void JobSystem::runMainThreadJobs()
+{
+    assert(currentThreadIndex() == 0);
+
+    // Only run the jobs that are already queued, as jobs may queue more
+    std::deque<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mainThreadQueue_.mutex);
+        jobs.swap(mainThreadQueue_.jobs);
+    }
+
+    for (Job& job : jobs)
+    {
+        execute(0, job);
+    }
+}
+
+std::vector<JobTiming> JobSystem::takeTimings()
+{
+    std::vector<JobTiming> merged;
+    for (std::unique_ptr<ThreadTimings>& threadTimings : timings_)
+    {
+        std::lock_guard<std::mutex> lock(threadTimings->mutex);
+        for (const JobTiming& timing : threadTimings->timings)
+        {
+            auto it = std::find_if(merged.begin(), merged.end(), [&](const JobTiming& existing) { return existing.name == timing.name; });
+            if (it == merged.end())
+            {
+                merged.push_back(timing);
+            }
+            else
+            {
+                it->count += timing.count;
+                it->milliseconds += timing.milliseconds;
+            }
+        }
+        threadTimings->timings.clear();
+    }
+
+    // Slowest first
+    std::sort(merged.begin(), merged.end(), [](const JobTiming& a, const JobTiming& b) { return a.milliseconds > b.milliseconds; });
+    return merged;
+}
+
+void JobSystem::schedule(Job job, JobCounter* dependency)
+{
+    if (dependency != nullptr)
+    {
+        // The counter's lock makes sure the job is either added before the last job finishes, or queued now
+        std::lock_guard<std::mutex> lock(dependency->continuationsMutex_);
+        if (!dependency->finished())
+        {
+            dependency->continuations_.push_back(std::move(job));
+            return;
+        }
+    }
+
+    push(std::move(job));
+}
+
+void JobSystem::push(Job job)
+{
+    if (job.mainThreadOnly)
+    {
+        std::lock_guard<std::mutex> lock(mainThreadQueue_.mutex);
+        mainThreadQueue_.jobs.push_back(std::move(job));
+        return;
+    }
+
+    JobQueue& queue = *queues_[currentThreadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    // Take the wake lock so a worker can't miss the job between checking for work and going to sleep
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        ++queuedJobs_;
+    }
+    wakeCondition_.notify_one();
+}
+
+bool JobSystem::tryTakeJob(int index, Job& job)
+{
+    if (queuedJobs_.load() == 0)
+    {
+        return false;
+    }
+
+    // The newest job of our own, which is likely to still be in cache
+    {
+        JobQueue& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            --queuedJobs_;
+            return true;
+        }
+    }
+
+    // Otherwise the oldest job of another thread, which is likely to be the largest piece of work left
+    const int count = threadCount();
+    for (int offset = 1; offset < count; ++offset)
+    {
+        JobQueue& queue = *queues_[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            --queuedJobs_;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(int index, Job& job)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    job.function();
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    {
+        ThreadTimings& threadTimings = *timings_[index];
+        std::lock_guard<std::mutex> lock(threadTimings.mutex);
+        auto it = std::find_if(threadTimings.timings.begin(), threadTimings.timings.end(), [&](const JobTiming& timing) { return timing.name == job.name; });
+        if (it == threadTimings.timings.end())
+        {
+            threadTimings.timings.push_back(JobTiming{ job.name, 0, 0.0f });
+            it = threadTimings.timings.end() - 1;
+        }
+        it->count++;
+        it->milliseconds += std::chrono::duration<float, std::milli>(end - start).count();
+    }
+
+    if (job.counter == nullptr)
+    {
+        return;
+    }
+
+    // Queue the jobs that were waiting for the counter, once the last of its jobs is done
+    std::vector<Job> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job.counter->continuationsMutex_);
+        if (--job.counter->remaining_ == 0)
+        {
+            continuations.swap(job.counter->continuations_);
+        }
+    }
+
+    for (Job& continuation : continuations)
+    {
+        push(std::move(continuation));
+    }
+}
+
+void JobSystem::workerMain(int index)
+{
+    threadJobSystem = this;
+    threadIndex = index;
+
+    while (true)
+    {
+        Job job;
+        if (tryTakeJob(index, job))
+        {
+            execute(index, job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        wakeCondition_.wait(lock, [&] { return stopping_.load() || queuedJobs_.load() > 0; });
+        if (stopping_)
+        {
+            return;
+        }
+    }
+}
\ No newline at end of file
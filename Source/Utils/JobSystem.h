@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Utils/Singleton.h"
+
+class JobCounter;
+
+// A unit of work queued on the job system
+struct Job
+{
+    // Used to group the job's timings. Must be a string that outlives the job, such as a literal.
+    const char* name;
+    std::function<void()> function;
+
+    // Decremented once the job has run. May be null.
+    JobCounter* counter;
+
+    // Jobs that touch OpenGL, or anything else that isn't thread safe, only run on the main thread
+    bool mainThreadOnly;
+};
+
+// Counts the unfinished jobs in a group.
+// Jobs can be made to wait for a counter to reach zero before they start.
+class JobCounter
+{
+public:
+    JobCounter();
+
+    // Prevent the counter from being copied, as jobs keep a pointer to it
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    // True once every job added to the counter has run
+    bool finished() const { return remaining_.load() == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int> remaining_;
+
+    // Jobs waiting for the counter to reach zero
+    std::mutex continuationsMutex_;
+    std::vector<Job> continuations_;
+};
+
+// The total time spent running jobs with the same name
+struct JobTiming
+{
+    std::string name;
+    int count;
+    float milliseconds;
+};
+
+// Runs jobs on a pool of worker threads, sized to the machine, shared by the whole engine.
+//
+// Each thread has its own deque of jobs. Threads take the newest job from their own deque,
+// which is usually the one whose data is still in cache, and when it is empty they steal the
+// oldest job from another thread's deque. The thread that created the job system is the main
+// thread. It has index 0, and only it runs jobs marked as main thread only.
+// A thread that waits for a counter runs other jobs until the counter reaches zero, so jobs
+// can wait on jobs of their own without blocking a worker.
+class JobSystem : public Singleton<JobSystem>
+{
+public:
+    // A thread count of 0 uses every available hardware thread, including the main thread.
+    explicit JobSystem(int threadCount = 0);
+    ~JobSystem();
+
+    // Prevent the job system from being copied
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // The number of threads that run jobs, including the main thread
+    int threadCount() const { return (int)queues_.size(); }
+
+    // The index of the calling thread, from 0 for the main thread up to threadCount() - 1.
+    // Threads that don't belong to the job system are counted as the main thread.
+    int currentThreadIndex() const;
+
+    // Queues a job. If a counter is given it is incremented now and decremented once the job has run.
+    // If a dependency is given the job doesn't start until the dependency has finished.
+    void run(const char* name, std::function<void()> function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+    // Queues a job that only runs on the main thread, when it waits for a counter or calls runMainThreadJobs
+    void runOnMainThread(const char* name, std::function<void()> function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+    // Runs other jobs until every job added to the counter has finished
+    void wait(JobCounter& counter);
+
+    // Calls function(begin, end) over [0, count), split into jobs of grainSize items, and waits for them all.
+    // A grain size of 0 splits the range into a few jobs per thread.
+    void parallelFor(const char* name, int count, int grainSize, const std::function<void(int, int)> &function);
+
+    // Runs the jobs queued for the main thread. Must be called from the main thread.
+    void runMainThreadJobs();
+
+    // Gets the time spent in each named job since the last call, and starts counting again
+    std::vector<JobTiming> takeTimings();
+
+private:
+    // A deque of jobs owned by a thread. The owner pushes and pops at the back, thieves take from the front.
+    struct JobQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    // Timings recorded by one thread, only locked when they are taken
+    struct ThreadTimings
+    {
+        std::mutex mutex;
+        std::vector<JobTiming> timings;
+    };
+
+    std::vector<std::unique_ptr<JobQueue>> queues_;
+    std::vector<std::unique_ptr<ThreadTimings>> timings_;
+    JobQueue mainThreadQueue_;
+    std::vector<std::thread> workers_;
+
+    // Workers sleep when no job is queued in any of the deques
+    std::atomic<int> queuedJobs_;
+    std::atomic<bool> stopping_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+
+    // Adds a job to the right queue, or to its dependency's continuations if it must wait
+    void schedule(Job job, JobCounter* dependency);
+    void push(Job job);
+
+    // Takes a job from the calling thread's deque, or steals one from another thread
+    bool tryTakeJob(int threadIndex, Job& job);
+
+    // Runs a job, records its timing, and releases the jobs waiting for its counter
+    void execute(int threadIndex, Job& job);
+
+    void workerMain(int threadIndex);
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "MappedFile.h"
+
+#include <Windows.h>
+
+MappedFile::MappedFile()
+    : file_(INVALID_HANDLE_VALUE),
+    mapping_(nullptr),
+    data_(nullptr),
+    size_(0),
+    writable_(false)
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &path, size_t size)
+{
+    close();
+
+    file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    // Mapping more than the file's size extends the file
+    return map(size, true);
+}
+
+bool MappedFile::openReadOnly(const std::string &path)
+{
+    close();
+
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    return map((size_t)fileSize.QuadPart, false);
+}
+
+void MappedFile::close()
+{
+    if (data_ != nullptr)
+    {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+
+    if (mapping_ != nullptr)
+    {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+
+    if (file_ != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+
+    size_ = 0;
+    writable_ = false;
+}
+
+void MappedFile::flush()
+{
+    if (data_ != nullptr && writable_)
+    {
+        FlushViewOfFile(data_, 0);
+    }
+}
+
+bool MappedFile::map(size_t size, bool writable)
+{
+    const uint64_t size64 = (uint64_t)size;
+    mapping_ = CreateFileMappingA(file_, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, (DWORD)(size64 >> 32), (DWORD)(size64 & 0xFFFFFFFF), nullptr);
+    if (mapping_ == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    data_ = (uint8_t*)MapViewOfFile(mapping_, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+    if (data_ == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    size_ = size;
+    writable_ = writable;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A file on disk mapped into memory.
+//
+// Reads and writes go straight to the mapped pages, and the operating system
+// loads and saves pages as they are touched. Only the parts of a large file
+// that are actually used take up memory.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Do not allow a mapped file to be copied
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Opens a file for reading and writing, creating it if needed, and maps the first size bytes.
+    // The file is extended with zeros if it is smaller than size. Returns false on failure.
+    bool open(const std::string &path, size_t size);
+
+    // Opens an existing file for reading only, mapping all of it. Returns false on failure.
+    bool openReadOnly(const std::string &path);
+
+    // Unmaps and closes the file, writing any changes back to disk
+    void close();
+
+    // Starts writing any changed pages back to disk
+    void flush();
+
+    bool isOpen() const { return data_ != nullptr; }
+    bool isWritable() const { return writable_; }
+
+    // The mapped contents of the file
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void* file_;
+    void* mapping_;
+    uint8_t* data_;
+    size_t size_;
+    bool writable_;
+
+    // Maps size bytes of the open file. Closes the file on failure.
+    bool map(size_t size, bool writable);
+};
\ No newline at end of file
@@ -11,6 +11,15 @@ public:
         instance_ = static_cast<T*>(this);
     }
 
+    // Clears the instance reference, so it doesn't point at a deleted object
+    ~Singleton()
+    {
+        if (instance_ == static_cast<T*>(this))
+        {
+            instance_ = nullptr;
+        }
+    }
+
     // Prevent the singleton from being moved or copied
     Singleton(const Singleton&) = delete;
     Singleton(Singleton&&) = delete;
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Identifies an object stored in a SlotMap
+typedef uint32_t SlotMapID;
+
+// Stores pointers to objects under generational IDs, with constant time adding, removing and lookup.
+//
+// The low bits of an ID are the index of the slot the object is stored in, and the high bits are the
+// slot's generation, which changes every time the slot is reused. An ID kept after its object was
+// removed no longer matches its slot, so looking it up finds nothing rather than a different object.
+// Freed slots are reused oldest first, and only once there are enough of them, so a generation takes a
+// long time to come around again.
+//
+// The objects are also kept in the order they were added. Removing an object leaves a gap in that list,
+// which is only closed up by compact, or the next time the whole list is asked for.
+template<typename T>
+class SlotMap
+{
+public:
+    // An ID that never refers to an object
+    const static SlotMapID INVALID_ID = 0;
+
+    // The number of bits of an ID used for the slot index. The rest are the generation.
+    const static int INDEX_BITS = 20;
+    const static uint32_t MAX_SLOTS = 1u << INDEX_BITS;
+
+    // The number of freed slots kept back before they start being reused
+    const static size_t MIN_FREE_SLOTS = 1024;
+
+    SlotMap()
+        : gaps_(0)
+    {
+
+    }
+
+    // Adds an object and returns its new ID.
+    // Returns INVALID_ID without adding the object if all MAX_SLOTS slots are in use.
+    SlotMapID add(T* object)
+    {
+        uint32_t index;
+        if (freeSlots_.size() <= MIN_FREE_SLOTS && slots_.size() < MAX_SLOTS)
+        {
+            index = (uint32_t)slots_.size();
+            slots_.push_back({ nullptr, 1, 0 });
+        }
+        else if (freeSlots_.empty())
+        {
+            return INVALID_ID;
+        }
+        else
+        {
+            index = freeSlots_.front();
+            freeSlots_.pop_front();
+        }
+
+        Slot& slot = slots_[index];
+        slot.object = object;
+        slot.orderIndex = (uint32_t)ordered_.size();
+        ordered_.push_back(object);
+        orderedSlots_.push_back(index);
+
+        return (slot.generation << INDEX_BITS) | index;
+    }
+
+    // Removes the object with the given ID. Returns false if there isn't one.
+    bool remove(SlotMapID id)
+    {
+        if (find(id) == nullptr)
+        {
+            return false;
+        }
+
+        const uint32_t index = id & INDEX_MASK;
+        Slot& slot = slots_[index];
+        ordered_[slot.orderIndex] = nullptr;
+        gaps_++;
+
+        // Generation 0 is skipped when it wraps around, so no ID is ever INVALID_ID
+        slot.object = nullptr;
+        slot.generation = (slot.generation + 1) & GENERATION_MASK;
+        if (slot.generation == 0)
+        {
+            slot.generation = 1;
+        }
+        freeSlots_.push_back(index);
+
+        return true;
+    }
+
+    // Gets the object with the given ID, or null if it has been removed
+    T* find(SlotMapID id) const
+    {
+        const uint32_t index = id & INDEX_MASK;
+        if (index >= slots_.size())
+        {
+            return nullptr;
+        }
+
+        const Slot& slot = slots_[index];
+        return (slot.generation == (id >> INDEX_BITS)) ? slot.object : nullptr;
+    }
+
+    // The number of objects in the map
+    size_t size() const { return ordered_.size() - gaps_; }
+    bool empty() const { return size() == 0; }
+
+    // Every object in the order they were added, with the gaps left by removed objects closed up
+    const std::vector<T*>& objects()
+    {
+        compact();
+        return ordered_;
+    }
+
+    // Closes up the gaps left by removed objects
+    void compact()
+    {
+        if (gaps_ == 0)
+        {
+            return;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < ordered_.size(); ++i)
+        {
+            if (ordered_[i] != nullptr)
+            {
+                ordered_[kept] = ordered_[i];
+                orderedSlots_[kept] = orderedSlots_[i];
+                slots_[orderedSlots_[kept]].orderIndex = (uint32_t)kept;
+                kept++;
+            }
+        }
+
+        ordered_.resize(kept);
+        orderedSlots_.resize(kept);
+        gaps_ = 0;
+    }
+
+    // Walks the objects in the order they were added without closing up the gaps, so objects can be
+    // removed part way through. Removed objects are null, and objects added part way through are included.
+    size_t orderedCount() const { return ordered_.size(); }
+    T* orderedAt(size_t i) const { return ordered_[i]; }
+
+private:
+    const static uint32_t INDEX_MASK = MAX_SLOTS - 1;
+    const static uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+    struct Slot
+    {
+        T* object;
+        uint32_t generation;
+
+        // Where the object is in the ordered list
+        uint32_t orderIndex;
+    };
+
+    std::vector<Slot> slots_;
+    std::deque<uint32_t> freeSlots_;
+
+    // The objects in the order they were added, and the slot each is stored in
+    std::vector<T*> ordered_;
+    std::vector<uint32_t> orderedSlots_;
+    size_t gaps_;
+};
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "TimerWheel.h"
+
+#include <cassert>
+
+TimerWheel::TimerWheel()
+    : now_(0),
+    ticking_(false)
+{
+    for (int32_t& bucket : buckets_)
+    {
+        bucket = NONE;
+    }
+}
+
+TimerID TimerWheel::schedule(uint64_t delayTicks, std::function<void()> callback, uint64_t periodTicks)
+{
+    int32_t index;
+    if (freeTimers_.empty())
+    {
+        if (timers_.size() >= MAX_TIMERS)
+        {
+            return INVALID_ID;
+        }
+        index = (int32_t)timers_.size();
+        timers_.push_back({ nullptr, 0, 0, 1, NONE, NONE, NONE });
+    }
+    else
+    {
+        index = freeTimers_.back();
+        freeTimers_.pop_back();
+    }
+
+    Timer& timer = timers_[index];
+    timer.callback = std::move(callback);
+    timer.due = now_ + ((delayTicks > 0) ? delayTicks : 1);
+    timer.period = periodTicks;
+    insert(index);
+
+    return (timer.generation << INDEX_BITS) | (uint32_t)index;
+}
+
+bool TimerWheel::cancel(TimerID id)
+{
+    const int32_t index = findTimer(id);
+    if (index < 0)
+    {
+        return false;
+    }
+
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::tick()
+{
+    assert(!ticking_);
+    ticking_ = true;
+    now_++;
+
+    // When a wheel comes round, bring down the timers in the next bucket of the wheel above
+    for (int level = 1; level < LEVELS; ++level)
+    {
+        if ((now_ & ((1ull << (level * SLOT_BITS)) - 1)) != 0)
+        {
+            break;
+        }
+        cascade(level, (int)((now_ >> (level * SLOT_BITS)) & (SLOTS - 1)));
+    }
+
+    // Every timer in the current bucket of the first wheel is due now.
+    // Callbacks can schedule and cancel timers, but new timers are never due this tick.
+    const int bucket = (int)(now_ & (SLOTS - 1));
+    while (buckets_[bucket] != NONE)
+    {
+        const int32_t index = buckets_[bucket];
+        unlink(index);
+
+        // The callback is moved out while it runs, as the timers may be reallocated by anything it schedules
+        Timer& timer = timers_[index];
+        const TimerID id = (timer.generation << INDEX_BITS) | (uint32_t)index;
+        std::function<void()> callback = std::move(timer.callback);
+        if (timer.period > 0)
+        {
+            timer.due += timer.period;
+            insert(index);
+        }
+        else
+        {
+            release(index);
+        }
+
+        callback();
+
+        // Repeating timers get their callback back, unless the callback cancelled them
+        const int32_t repeating = findTimer(id);
+        if (repeating >= 0)
+        {
+            timers_[repeating].callback = std::move(callback);
+        }
+    }
+
+    ticking_ = false;
+}
+
+int32_t TimerWheel::findTimer(TimerID id) const
+{
+    const uint32_t index = id & INDEX_MASK;
+    if (index >= timers_.size())
+    {
+        return NONE;
+    }
+
+    const Timer& timer = timers_[index];
+    // Scheduled timers are always in a bucket, even while their callback runs if they repeat
+    return (timer.generation == (id >> INDEX_BITS) && timer.bucket != NONE) ? (int32_t)index : NONE;
+}
+
+void TimerWheel::insert(int32_t index)
+{
+    Timer& timer = timers_[index];
+
+    // Find the lowest level whose span reaches the due tick.
+    // Timers beyond the last level go in its furthest bucket, and are placed again when it is emptied.
+    const uint64_t delay = timer.due - now_;
+    int level = 0;
+    while (level < LEVELS - 1 && delay >= (1ull << ((level + 1) * SLOT_BITS)))
+    {
+        level++;
+    }
+
+    uint64_t due = timer.due;
+    if (level == LEVELS - 1 && delay >= (1ull << (LEVELS * SLOT_BITS)))
+    {
+        due = now_ + (1ull << (LEVELS * SLOT_BITS)) - 1;
+    }
+
+    const int32_t bucket = level * SLOTS + (int32_t)((due >> (level * SLOT_BITS)) & (SLOTS - 1));
+    timer.bucket = bucket;
+    timer.previous = NONE;
+    timer.next = buckets_[bucket];
+    if (timer.next != NONE)
+    {
+        timers_[timer.next].previous = index;
+    }
+    buckets_[bucket] = index;
+}
+
+void TimerWheel::unlink(int32_t index)
+{
+    Timer& timer = timers_[index];
+    if (timer.previous != NONE)
+    {
+        timers_[timer.previous].next = timer.next;
+    }
+    else
+    {
+        buckets_[timer.bucket] = timer.next;
+    }
+
+    if (timer.next != NONE)
+    {
+        timers_[timer.next].previous = timer.previous;
+    }
+
+    timer.bucket = NONE;
+    timer.previous = NONE;
+    timer.next = NONE;
+}
+
+void TimerWheel::release(int32_t index)
+{
+    // Generation 0 is skipped when it wraps around, so no ID is ever INVALID_ID
+    Timer& timer = timers_[index];
+    timer.callback = nullptr;
+    timer.generation = (timer.generation + 1) & GENERATION_MASK;
+    if (timer.generation == 0)
+    {
+        timer.generation = 1;
+    }
+    freeTimers_.push_back(index);
+}
+
+void TimerWheel::cascade(int level, int slot)
+{
+    const int bucket = level * SLOTS + slot;
+    int32_t index = buckets_[bucket];
+    buckets_[bucket] = NONE;
+
+    while (index != NONE)
+    {
+        const int32_t next = timers_[index].next;
+        insert(index);
+        index = next;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Identifies a timer scheduled on a TimerWheel
+typedef uint32_t TimerID;
+
+// Calls functions after a number of ticks, once or repeatedly, without visiting the timers that aren't due.
+//
+// The timers are kept in LEVELS wheels of SLOTS buckets each. A bucket in the first wheel holds the timers
+// due on a single tick, and each bucket of the wheels above covers SLOTS times as many ticks as one below.
+// A timer goes in the lowest wheel whose span reaches its due tick. Each time a wheel comes round, the next
+// bucket of the wheel above is emptied into the ones below it. Scheduling and cancelling a timer take
+// constant time, and a tick costs the timers that are due plus the occasional move to a lower wheel.
+//
+// IDs are generational, like a SlotMap's, so cancelling a timer that has already finished does nothing.
+class TimerWheel
+{
+public:
+    // An ID that never refers to a timer
+    const static TimerID INVALID_ID = 0;
+
+    const static int SLOT_BITS = 6;
+    const static int SLOTS = 1 << SLOT_BITS;
+    const static int LEVELS = 4;
+
+    // The most timers that can be scheduled at once
+    const static uint32_t MAX_TIMERS = 1u << 20;
+
+    TimerWheel();
+
+    // Prevent the timer wheel from being copied
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Calls a function after delayTicks ticks, then every periodTicks ticks if the period isn't 0.
+    // A delay of 0 is treated as 1, so a timer scheduled by a callback never runs in the same tick.
+    // Returns INVALID_ID without scheduling anything if there are already MAX_TIMERS timers.
+    TimerID schedule(uint64_t delayTicks, std::function<void()> callback, uint64_t periodTicks = 0);
+
+    // Stops a timer. Safe to call from any callback, including the timer's own.
+    // Returns false if the timer has already finished or been cancelled.
+    bool cancel(TimerID id);
+
+    bool isScheduled(TimerID id) const { return findTimer(id) >= 0; }
+
+    // Moves on by one tick and calls the functions of the timers that are now due
+    void tick();
+
+    // The number of ticks since the wheel was created
+    uint64_t currentTick() const { return now_; }
+
+    // The number of timers waiting to run
+    size_t size() const { return timers_.size() - freeTimers_.size(); }
+
+private:
+    const static int32_t NONE = -1;
+    const static int INDEX_BITS = 20;
+    const static uint32_t INDEX_MASK = MAX_TIMERS - 1;
+    const static uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+    struct Timer
+    {
+        std::function<void()> callback;
+        uint64_t due;
+        uint64_t period;
+        uint32_t generation;
+
+        // The bucket the timer is in, and its neighbours in the bucket's list
+        int32_t bucket;
+        int32_t previous;
+        int32_t next;
+    };
+
+    std::vector<Timer> timers_;
+    std::vector<int32_t> freeTimers_;
+
+    // The first timer in each bucket, for each level in turn
+    int32_t buckets_[LEVELS * SLOTS];
+
+    uint64_t now_;
+    bool ticking_;
+
+    // Gets the index of the timer with an ID, or NONE if it isn't scheduled
+    int32_t findTimer(TimerID id) const;
+
+    // Puts a timer in the bucket for its due tick, and takes it out again
+    void insert(int32_t index);
+    void unlink(int32_t index);
+
+    // Frees a timer, so its ID no longer finds it
+    void release(int32_t index);
+
+    // Moves the timers in a bucket to the lower levels
+    void cascade(int level, int slot);
+};
\ No newline at end of file
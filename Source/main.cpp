@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "Application.h"
+#include "ReplayManager.h"
 
 // Contain the main application code in a class.
 Application* application;
@@ -98,6 +99,16 @@ int main(int argc, const char* argv[])
     application = new Application("Cardboard Copters", window);
     application->resize(windowWidth, windowHeight);
 
+    // "--replay <file>" replays a recorded session, then exits.
+    // This is used to compare performance and determinism between builds.
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--replay")
+        {
+            ReplayManager::instance()->startReplay(argv[i + 1], true);
+        }
+    }
+
     // Run game loop while window not closed
     while (!glfwWindowShouldClose(window) && application->running())
     {
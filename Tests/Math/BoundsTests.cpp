@@ -0,0 +1,40 @@
+#include "CppUnitTest.h"
+
+#include "Math/Bounds.h"
+#include "Math/Point3.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(BoundsTests)
+    {
+        const float tol = 0.000001f;
+
+    public:
+
+        TEST_METHOD(SqrDistance)
+        {
+            const Bounds bounds(Point3(1.0f, 2.0f, 3.0f), Point3(4.0f, 6.0f, 8.0f));
+
+            // Points inside or on the bounds are no distance from them
+            Assert::AreEqual(0.0f, bounds.sqrDistance(Point3(2.0f, 3.0f, 4.0f)), tol);
+            Assert::AreEqual(0.0f, bounds.sqrDistance(Point3(4.0f, 2.0f, 8.0f)), tol);
+
+            // Outside the bounds, the distance is measured to the closest face, edge or corner
+            Assert::AreEqual(3.0f * 3.0f, bounds.sqrDistance(Point3(2.0f, 9.0f, 4.0f)), tol);
+            Assert::AreEqual(1.0f * 1.0f + 2.0f * 2.0f, bounds.sqrDistance(Point3(0.0f, 4.0f, 10.0f)), tol);
+            Assert::AreEqual(1.0f + 1.0f + 1.0f, bounds.sqrDistance(Point3(5.0f, 1.0f, 9.0f)), tol);
+        }
+
+        TEST_METHOD(SqrFarthestDistance)
+        {
+            const Bounds bounds(Point3(1.0f, 2.0f, 3.0f), Point3(4.0f, 6.0f, 8.0f));
+
+            // The farthest point is always a corner
+            Assert::AreEqual(3.0f * 3.0f + 4.0f * 4.0f + 5.0f * 5.0f, bounds.sqrFarthestDistance(Point3(1.0f, 2.0f, 3.0f)), tol);
+            Assert::AreEqual(2.0f * 2.0f + 2.0f * 2.0f + 3.0f * 3.0f, bounds.sqrFarthestDistance(Point3(2.0f, 4.0f, 5.0f)), tol);
+            Assert::AreEqual(6.0f * 6.0f + 4.0f * 4.0f + 5.0f * 5.0f, bounds.sqrFarthestDistance(Point3(-2.0f, 6.0f, 8.0f)), tol);
+        }
+    };
+}
\ No newline at end of file
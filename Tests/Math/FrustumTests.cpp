@@ -0,0 +1,86 @@
+#include "CppUnitTest.h"
+
+#include "Math/Frustum.h"
+#include "Math/Quaternion.h"
+#include "Math/Vector3.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(FrustumTests)
+    {
+        // A box of the given size centred on a point
+        static Bounds box(float x, float y, float z, float halfSize)
+        {
+            return Bounds(Point3(x - halfSize, y - halfSize, z - halfSize), Point3(x + halfSize, y + halfSize, z + halfSize));
+        }
+
+    public:
+
+        TEST_METHOD(EverythingInsideByDefault)
+        {
+            Frustum frustum;
+            Assert::IsTrue(frustum.intersects(box(0.0f, 0.0f, 0.0f, 1.0f)));
+            Assert::IsTrue(frustum.intersects(box(-1e6f, 5e5f, 1e6f, 1.0f)));
+        }
+
+        TEST_METHOD(Perspective)
+        {
+            // A camera at the origin looking down +z, with a 90 degree field of view
+            const Frustum frustum(Matrix4x4::perspective(90.0f, 1.0f, 0.5f, 100.0f));
+
+            // In front of the camera
+            Assert::IsTrue(frustum.intersects(box(0.0f, 0.0f, 10.0f, 1.0f)));
+            Assert::IsTrue(frustum.intersects(box(8.0f, -8.0f, 10.0f, 1.0f)));
+
+            // Behind the camera, beyond the far plane, and off to each side
+            Assert::IsFalse(frustum.intersects(box(0.0f, 0.0f, -10.0f, 1.0f)));
+            Assert::IsFalse(frustum.intersects(box(0.0f, 0.0f, 110.0f, 1.0f)));
+            Assert::IsFalse(frustum.intersects(box(20.0f, 0.0f, 10.0f, 1.0f)));
+            Assert::IsFalse(frustum.intersects(box(-20.0f, 0.0f, 10.0f, 1.0f)));
+            Assert::IsFalse(frustum.intersects(box(0.0f, 20.0f, 10.0f, 1.0f)));
+            Assert::IsFalse(frustum.intersects(box(0.0f, -20.0f, 10.0f, 1.0f)));
+
+            // Boxes crossing a plane are inside
+            Assert::IsTrue(frustum.intersects(box(10.5f, 0.0f, 10.0f, 1.0f)));
+            Assert::IsTrue(frustum.intersects(box(0.0f, 0.0f, 0.0f, 1.0f)));
+        }
+
+        TEST_METHOD(TransformedCamera)
+        {
+            // A camera at (100, 0, 0) turned to look down -x
+            const Matrix4x4 worldToCamera = Matrix4x4::trsInverse(Vector3(100.0f, 0.0f, 0.0f), Quaternion::euler(0.0f, -90.0f, 0.0f), Vector3::one());
+            const Frustum frustum(Matrix4x4::perspective(60.0f, 1.5f, 0.5f, 200.0f) * worldToCamera);
+
+            Assert::IsTrue(frustum.intersects(box(50.0f, 0.0f, 0.0f, 1.0f)));
+            Assert::IsFalse(frustum.intersects(box(150.0f, 0.0f, 0.0f, 1.0f)));
+            Assert::IsFalse(frustum.intersects(box(50.0f, 0.0f, 80.0f, 1.0f)));
+        }
+
+        TEST_METHOD(Orthographic)
+        {
+            const Frustum frustum(Matrix4x4::orthographic(-10.0f, 10.0f, -5.0f, 5.0f, 0.0f, 50.0f));
+
+            Assert::IsTrue(frustum.intersects(box(9.0f, 4.0f, 25.0f, 0.5f)));
+            Assert::IsFalse(frustum.intersects(box(12.0f, 0.0f, 25.0f, 0.5f)));
+            Assert::IsFalse(frustum.intersects(box(0.0f, 7.0f, 25.0f, 0.5f)));
+            Assert::IsFalse(frustum.intersects(box(0.0f, 0.0f, 60.0f, 0.5f)));
+        }
+
+        TEST_METHOD(Containment)
+        {
+            const Frustum frustum(Matrix4x4::orthographic(-10.0f, 10.0f, -5.0f, 5.0f, 0.0f, 50.0f));
+
+            Assert::IsTrue(frustum.contains(box(0.0f, 0.0f, 25.0f, 4.0f)));
+
+            // Boxes crossing a plane intersect the frustum, but aren't contained by it
+            Assert::IsFalse(frustum.contains(box(9.0f, 0.0f, 25.0f, 2.0f)));
+            Assert::IsTrue(frustum.intersects(box(9.0f, 0.0f, 25.0f, 2.0f)));
+            Assert::IsFalse(frustum.contains(box(0.0f, 0.0f, 25.0f, 30.0f)));
+
+            // Everything is inside the default frustum
+            Assert::IsTrue(Frustum().contains(box(1e5f, -1e5f, 0.0f, 1e4f)));
+        }
+    };
+}
\ No newline at end of file
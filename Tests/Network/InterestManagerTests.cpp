@@ -0,0 +1,266 @@
+#include "CppUnitTest.h"
+
+#include "Network/InterestGrid.h"
+#include "Network/InterestManager.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(InterestManagerTests)
+    {
+    public:
+
+        TEST_METHOD(GridQueryMatchesBruteForce)
+        {
+            std::mt19937 rng(1234);
+            std::uniform_real_distribution<float> coord(-100.0f, 1100.0f);
+
+            // Include points outside the grid area, they should be clamped into edge cells
+            std::vector<Point3> positions;
+            for (int i = 0; i < 2000; ++i)
+            {
+                positions.push_back(Point3(coord(rng), 0.0f, coord(rng)));
+            }
+
+            InterestGrid grid(Rect(0.0f, 0.0f, 1024.0f, 1024.0f), 64.0f);
+            grid.build(positions.data(), (int)positions.size());
+
+            const Point3 centre(500.0f, 0.0f, 20.0f);
+            const float radius = 150.0f;
+
+            std::vector<uint32_t> found;
+            grid.query(centre, radius, [&](uint32_t index, float) { found.push_back(index); });
+            std::sort(found.begin(), found.end());
+
+            std::vector<uint32_t> expected;
+            for (unsigned int i = 0; i < positions.size(); ++i)
+            {
+                const float dx = positions[i].x - centre.x;
+                const float dz = positions[i].z - centre.z;
+                if (dx * dx + dz * dz <= radius * radius)
+                {
+                    expected.push_back(i);
+                }
+            }
+
+            Assert::IsTrue(found == expected);
+        }
+
+        TEST_METHOD(PacketBudgetIsRespected)
+        {
+            InterestManager manager(Rect(0.0f, 0.0f, 512.0f, 512.0f), 32.0f);
+
+            InterestClient client;
+            client.viewPosition = Point3(256.0f, 0.0f, 256.0f);
+            client.viewRadius = 1000.0f;
+            client.packetBudgetBits = 1000;
+            manager.addClient(client);
+
+            for (int i = 0; i < 100; ++i)
+            {
+                ReplicatedEntity entity;
+                entity.position = Point3((float)i * 5.0f, 0.0f, 256.0f);
+                entity.deltaSizeBits = 84; // 100 bits including the header
+                manager.addEntity(entity);
+            }
+
+            manager.update(0.1f);
+            Assert::AreEqual(10, (int)manager.sendList(0).size());
+            Assert::AreEqual(1000, manager.sendBits(0));
+
+            // The packet should contain exactly the picked objects
+            BitWriter writer;
+            manager.writePacket(0, writer, [](uint32_t, BitWriter& w)
+            {
+                w.writeBits(0, 20);
+                w.writeBits(0, 32);
+                w.writeBits(0, 32);
+            });
+            Assert::AreEqual(128, writer.sizeBytes());
+        }
+
+        TEST_METHOD(StarvedObjectsAreEventuallySent)
+        {
+            InterestManager manager(Rect(0.0f, 0.0f, 512.0f, 512.0f), 32.0f);
+
+            InterestClient client;
+            client.viewPosition = Point3(0.0f, 0.0f, 0.0f);
+            client.viewRadius = 400.0f;
+            client.packetBudgetBits = ReplicatedEntityBits;
+            manager.addClient(client);
+
+            // A very important object right next to the client and an unimportant one far away
+            ReplicatedEntity important;
+            important.priority = 10.0f;
+            important.deltaSizeBits = ReplicatedEntityBits - InterestManager::ENTITY_HEADER_BITS;
+            ReplicatedEntity unimportant = important;
+            unimportant.priority = 1.0f;
+            unimportant.position = Point3(300.0f, 0.0f, 0.0f);
+            manager.addEntity(important);
+            manager.addEntity(unimportant);
+
+            bool unimportantSent = false;
+            for (int tick = 0; tick < 100 && !unimportantSent; ++tick)
+            {
+                manager.update(0.05f);
+                Assert::AreEqual(1, (int)manager.sendList(0).size());
+                unimportantSent = (manager.sendList(0)[0] == 1);
+            }
+
+            Assert::IsTrue(unimportantSent);
+        }
+
+        TEST_METHOD(ObjectsOutsideViewRadiusAreNotSent)
+        {
+            InterestManager manager(Rect(0.0f, 0.0f, 512.0f, 512.0f), 32.0f);
+
+            InterestClient client;
+            client.viewPosition = Point3(0.0f, 0.0f, 0.0f);
+            client.viewRadius = 50.0f;
+            manager.addClient(client);
+
+            ReplicatedEntity entity;
+            entity.deltaSizeBits = 32;
+            entity.position = Point3(100.0f, 0.0f, 0.0f);
+            manager.addEntity(entity);
+
+            manager.update(0.05f);
+            Assert::AreEqual(0, (int)manager.sendList(0).size());
+
+            manager.entity(0).position = Point3(10.0f, 0.0f, 0.0f);
+            manager.update(0.05f);
+            Assert::AreEqual(1, (int)manager.sendList(0).size());
+        }
+
+        TEST_METHOD(EntityCountIsLimitedByHeader)
+        {
+            InterestManager manager(Rect(0.0f, 0.0f, 512.0f, 512.0f), 32.0f);
+
+            ReplicatedEntity entity;
+            for (int i = 0; i < InterestManager::MAX_ENTITIES; ++i)
+            {
+                Assert::AreEqual(i, manager.addEntity(entity));
+            }
+
+            // The next ID wouldn't fit in ENTITY_HEADER_BITS
+            Assert::AreEqual(-1, manager.addEntity(entity));
+            Assert::AreEqual(InterestManager::MAX_ENTITIES, manager.entityCount());
+
+            // Once every ID has been used, removed ones are handed out again
+            manager.removeEntity(5);
+            Assert::AreEqual(5, manager.addEntity(entity));
+        }
+
+        TEST_METHOD(IdsSurviveRemovingOtherObjects)
+        {
+            InterestManager manager(Rect(0.0f, 0.0f, 512.0f, 512.0f), 32.0f);
+
+            InterestClient client;
+            client.viewPosition = Point3(0.0f, 0.0f, 0.0f);
+            manager.addClient(client);
+
+            ReplicatedEntity entity;
+            const int first = manager.addEntity(entity);
+            const int second = manager.addEntity(entity);
+            entity.deltaSizeBits = 8;
+            entity.position = Point3(20.0f, 0.0f, 0.0f);
+            const int third = manager.addEntity(entity);
+
+            // Removing an object moves the last one in the storage, but not its ID
+            manager.removeEntity(first);
+            Assert::AreEqual(20.0f, manager.entity(third).position.x);
+            Assert::AreEqual(0, manager.entity(second).deltaSizeBits);
+
+            // A new object doesn't take the removed ID straight away
+            const int fourth = manager.addEntity(ReplicatedEntity());
+            Assert::AreNotEqual(first, fourth);
+
+            manager.update(0.05f);
+            Assert::AreEqual(1, (int)manager.sendList(0).size());
+            Assert::AreEqual((uint32_t)third, manager.sendList(0)[0]);
+
+            // The packet identifies the object by its ID
+            BitWriter writer;
+            manager.writePacket(0, writer, [&](uint32_t id, BitWriter& w)
+            {
+                Assert::AreEqual((uint32_t)third, id);
+                w.writeBits(0xAB, 8);
+            });
+            writer.flush();
+
+            BitReader reader(writer.getBuffer());
+            Assert::AreEqual((size_t)third, reader.readBits(InterestManager::ENTITY_HEADER_BITS));
+            Assert::AreEqual((size_t)0xAB, reader.readBits(8));
+        }
+
+        TEST_METHOD(Benchmark64Clients10kEntities)
+        {
+            const int clientCount = 64;
+            const int entityCount = 10000;
+            const int tickCount = 60;
+            const float worldSize = 4096.0f;
+
+            std::mt19937 rng(42);
+            std::uniform_real_distribution<float> coord(0.0f, worldSize);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            std::uniform_int_distribution<int> deltaSize(32, 256);
+
+            InterestManager manager(Rect(0.0f, 0.0f, worldSize, worldSize), 64.0f);
+
+            for (int i = 0; i < clientCount; ++i)
+            {
+                InterestClient client;
+                client.viewPosition = Point3(coord(rng), 0.0f, coord(rng));
+                manager.addClient(client);
+            }
+
+            for (int i = 0; i < entityCount; ++i)
+            {
+                ReplicatedEntity entity;
+                entity.position = Point3(coord(rng), 0.0f, coord(rng));
+                entity.priority = (i % 10 == 0) ? 10.0f : 1.0f;
+                manager.addEntity(entity);
+            }
+
+            double totalSeconds = 0.0;
+            double totalBits = 0.0;
+            for (int tick = 0; tick < tickCount; ++tick)
+            {
+                // Move every object a little and give a fifth of them new changes
+                for (int i = 0; i < entityCount; ++i)
+                {
+                    ReplicatedEntity& entity = manager.entity(i);
+                    entity.position.x += unit(rng) - 0.5f;
+                    entity.position.z += unit(rng) - 0.5f;
+                    entity.deltaSizeBits = (unit(rng) < 0.2f) ? deltaSize(rng) : 0;
+                }
+
+                const auto start = std::chrono::high_resolution_clock::now();
+                manager.update(1.0f / 20.0f);
+                const auto end = std::chrono::high_resolution_clock::now();
+                totalSeconds += std::chrono::duration<double>(end - start).count();
+
+                for (int client = 0; client < clientCount; ++client)
+                {
+                    Assert::IsTrue(manager.sendBits(client) <= manager.client(client).packetBudgetBits);
+                    totalBits += manager.sendBits(client);
+                }
+            }
+
+            char message[256];
+            snprintf(message, sizeof(message), "Interest management: %d clients, %d entities: %.3f ms server CPU per tick, %.1f bytes per client per tick\n",
+                clientCount, entityCount, totalSeconds * 1000.0 / tickCount, totalBits / 8.0 / tickCount / clientCount);
+            Logger::WriteMessage(message);
+        }
+
+    private:
+        const static int ReplicatedEntityBits = 128;
+    };
+}
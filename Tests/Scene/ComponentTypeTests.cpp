@@ -0,0 +1,77 @@
+#include "CppUnitTest.h"
+
+#include "Scene/ComponentType.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(ComponentTypeTests)
+    {
+    public:
+
+        TEST_METHOD(FindTypesByName)
+        {
+            // Every concrete type can be found by the name it is serialized under
+            for (int i = 0; i < COMPONENT_TYPE_COUNT; ++i)
+            {
+                const ComponentTypeInfo& info = componentTypeInfo((ComponentType)i);
+                if (info.create != nullptr)
+                {
+                    Assert::IsTrue(findComponentType(info.name) == (ComponentType)i);
+                }
+            }
+
+            Assert::IsTrue(findComponentType("BoxCollider") == ComponentType::BoxCollider);
+            Assert::IsTrue(findComponentType("class BoxCollider") == ComponentType::None);
+            Assert::IsTrue(findComponentType("") == ComponentType::None);
+
+            // Abstract types can't be created, so they aren't found by name
+            Assert::IsTrue(findComponentType("Collider") == ComponentType::None);
+        }
+
+        TEST_METHOD(BaseTypes)
+        {
+            Assert::IsTrue(isComponentType(ComponentType::SphereCollider, ComponentType::SphereCollider));
+            Assert::IsTrue(isComponentType(ComponentType::SphereCollider, ComponentType::Collider));
+            Assert::IsTrue(isComponentType(ComponentType::TerrainCollider, ComponentType::Collider));
+            Assert::IsFalse(isComponentType(ComponentType::Collider, ComponentType::SphereCollider));
+            Assert::IsFalse(isComponentType(ComponentType::Rigidbody, ComponentType::Collider));
+            Assert::IsFalse(isComponentType(ComponentType::SphereCollider, ComponentType::BoxCollider));
+        }
+
+        TEST_METHOD(UpdateConflicts)
+        {
+            for (int a = 0; a < COMPONENT_TYPE_COUNT; ++a)
+            {
+                for (int b = 0; b < COMPONENT_TYPE_COUNT; ++b)
+                {
+                    Assert::AreEqual(updatesConflict((ComponentType)a, (ComponentType)b), updatesConflict((ComponentType)b, (ComponentType)a));
+                }
+
+                // Types that can be split across jobs must not conflict with themselves
+                if (updatesInParallel((ComponentType)a))
+                {
+                    Assert::IsFalse(updatesConflict((ComponentType)a, (ComponentType)a));
+                }
+            }
+
+            // Turrets read the transforms that windmills move, so they can't run beside each other
+            Assert::IsTrue(updatesConflict(ComponentType::StaticTurret, ComponentType::Windmill));
+
+            // Types that only move their own transforms are split across jobs
+            Assert::IsTrue(updatesInParallel(ComponentType::Windmill));
+            Assert::IsTrue(updatesInParallel(ComponentType::StaticTurret));
+
+            // Types that move any transform can't be
+            Assert::IsTrue(updatesConflict(ComponentType::Rigidbody, ComponentType::Rigidbody));
+            Assert::IsFalse(updatesInParallel(ComponentType::Rigidbody));
+            Assert::IsFalse(updatesInParallel(ComponentType::Freecam));
+
+            // Types without an update touch nothing
+            Assert::IsTrue(componentTypeInfo(ComponentType::StaticMesh).updatePhase == UpdatePhase::None);
+            Assert::IsTrue(componentTypeInfo(ComponentType::TurretGun).updatePhase == UpdatePhase::None);
+            Assert::IsFalse(updatesConflict(ComponentType::StaticMesh, ComponentType::Rigidbody));
+        }
+    };
+}
\ No newline at end of file
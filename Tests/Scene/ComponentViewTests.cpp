@@ -0,0 +1,58 @@
+#include "CppUnitTest.h"
+
+#include "Scene/ComponentView.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(ComponentViewTests)
+    {
+        // Stand-in component pointers. The view never dereferences them.
+        static Component* fakeComponent(uintptr_t id)
+        {
+            return reinterpret_cast<Component*>(id * 16);
+        }
+
+    public:
+
+        TEST_METHOD(WalksEveryPool)
+        {
+            ComponentPool first = { fakeComponent(1), fakeComponent(2) };
+            ComponentPool empty;
+            ComponentPool last = { fakeComponent(3) };
+            const std::vector<const ComponentPool*> pools = { &empty, &first, &empty, &last, &empty };
+
+            const ComponentView<Component> view(pools);
+            Assert::IsFalse(view.empty());
+            Assert::AreEqual((size_t)3, view.size());
+
+            std::vector<Component*> visited;
+            for (Component* component : view)
+            {
+                visited.push_back(component);
+            }
+            Assert::AreEqual((size_t)3, visited.size());
+            Assert::IsTrue(visited[0] == fakeComponent(1));
+            Assert::IsTrue(visited[1] == fakeComponent(2));
+            Assert::IsTrue(visited[2] == fakeComponent(3));
+
+            // The view is live, so changes to the pools show up without making a new one
+            first.pop_back();
+            last.clear();
+            Assert::AreEqual((size_t)1, view.size());
+            Assert::IsTrue(*view.begin() == fakeComponent(1));
+        }
+
+        TEST_METHOD(EmptyPools)
+        {
+            ComponentPool empty;
+            const std::vector<const ComponentPool*> emptyPools = { &empty, &empty };
+            const std::vector<const ComponentPool*> noPools;
+
+            Assert::IsTrue(ComponentView<Component>(emptyPools).empty());
+            Assert::IsTrue(ComponentView<Component>(noPools).empty());
+            Assert::AreEqual((size_t)0, ComponentView<Component>(emptyPools).size());
+        }
+    };
+}
\ No newline at end of file
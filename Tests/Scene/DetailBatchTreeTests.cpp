@@ -0,0 +1,109 @@
+#include "CppUnitTest.h"
+
+#include <algorithm>
+
+#include "Scene/DetailBatchTree.h"
+
+#include "Math/Quaternion.h"
+#include "Math/Random.h"
+#include "Math/Vector3.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(DetailBatchTreeTests)
+    {
+        // Batches laid out like the terrain's - a grid of tiles, each with three draw distance tiers
+        static std::vector<DetailBatch> createBatches(int resolution, float size)
+        {
+            const float tileSize = size / resolution;
+            std::vector<DetailBatch> batches;
+            for (int z = 0; z < resolution; ++z)
+            {
+                for (int x = 0; x < resolution; ++x)
+                {
+                    for (int tier = 0; tier < 3; ++tier)
+                    {
+                        DetailBatch batch;
+                        batch.firstInstance = (uint32_t)batches.size() * 10;
+                        batch.count = ((x + z) % 5 == 0) ? 0 : 10;
+                        batch.bounds = Bounds(Point3(x * tileSize, 0.0f, z * tileSize), Point3((x + 1) * tileSize, 80.0f, (z + 1) * tileSize));
+                        batch.drawDistance = tileSize * 0.5f * (tier + 1);
+                        batches.push_back(batch);
+                    }
+                }
+            }
+            return batches;
+        }
+
+    public:
+
+        TEST_METHOD(MatchesTestingEveryBatch)
+        {
+            const std::vector<DetailBatch> batches = createBatches(12, 1024.0f);
+            DetailBatchTree tree;
+            tree.build(batches);
+            Assert::IsTrue(tree.nodeCount() > 1);
+
+            // Look around the terrain from random points
+            RandomStream random(7);
+            for (int view = 0; view < 50; ++view)
+            {
+                const Point3 position(random.nextFloat(-100.0f, 1100.0f), random.nextFloat(0.0f, 200.0f), random.nextFloat(-100.0f, 1100.0f));
+                const Quaternion rotation = Quaternion::euler(random.nextFloat(-30.0f, 30.0f), random.nextFloat(0.0f, 360.0f), 0.0f);
+                const Matrix4x4 worldToCamera = Matrix4x4::trsInverse(position, rotation, Vector3::one());
+                const Frustum frustum(Matrix4x4::perspective(70.0f, 1.5f, 0.5f, 2000.0f) * worldToCamera);
+                const float distanceScale = (view % 2 == 0) ? 1.0f : 2.5f;
+
+                std::vector<int> visible;
+                DetailCullingStats stats;
+                tree.findVisible(frustum, position, distanceScale, visible, stats);
+
+                std::vector<int> expected;
+                int nonEmpty = 0;
+                for (int i = 0; i < (int)batches.size(); ++i)
+                {
+                    const float drawDistance = batches[i].drawDistance * distanceScale;
+                    if (batches[i].count == 0)
+                    {
+                        continue;
+                    }
+
+                    nonEmpty++;
+                    if (batches[i].bounds.sqrDistance(position) <= drawDistance * drawDistance && frustum.intersects(batches[i].bounds))
+                    {
+                        expected.push_back(i);
+                    }
+                }
+
+                std::sort(visible.begin(), visible.end());
+                Assert::IsTrue(visible == expected);
+
+                // Every non-empty batch is counted once
+                Assert::AreEqual((int)expected.size(), stats.visibleBatches);
+                Assert::AreEqual((int)expected.size() * 10, stats.visibleInstances);
+                Assert::AreEqual(nonEmpty, stats.visibleBatches + stats.frustumCulledBatches + stats.distanceCulledBatches);
+            }
+        }
+
+        TEST_METHOD(EmptyTree)
+        {
+            DetailBatchTree tree;
+            std::vector<int> visible = { 1, 2 };
+            DetailCullingStats stats;
+            tree.findVisible(Frustum(), Point3::origin(), 1.0f, visible, stats);
+            Assert::IsTrue(visible.empty());
+            Assert::AreEqual(0, stats.visibleBatches);
+
+            // Trees of only empty batches have no nodes
+            std::vector<DetailBatch> batches = createBatches(1, 10.0f);
+            for (DetailBatch& batch : batches)
+            {
+                batch.count = 0;
+            }
+            tree.build(batches);
+            Assert::AreEqual(0, tree.nodeCount());
+        }
+    };
+}
\ No newline at end of file
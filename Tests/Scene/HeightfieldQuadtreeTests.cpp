@@ -0,0 +1,248 @@
+#include "CppUnitTest.h"
+#include "HeightfieldTestUtils.h"
+
+#include "Scene/HeightfieldQuadtree.h"
+#include "Scene/Heightfield.h"
+
+#include <chrono>
+#include <string>
+
+#include "Math/Random.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(HeightfieldQuadtreeTests)
+    {
+        const float tol = 0.001f;
+
+        // Builds a heightfield of random heights
+        static void buildRandom(Heightfield &heightfield, int resolution, float sizeX, float sizeZ, float heightOffset, uint64_t seed)
+        {
+            heightfield.heights().resize(resolution * resolution);
+            RandomStream random(seed);
+            random.fillFloat(heightfield.heights().data(), resolution * resolution, 0.0f, 40.0f);
+            heightfield.setDimensions(resolution, sizeX, sizeZ, heightOffset);
+            heightfield.rebuildNormals();
+        }
+
+    public:
+
+        TEST_METHOD(PlaneHit)
+        {
+            Heightfield heightfield;
+            buildPlane(heightfield, 65, 128.0f, 0.0f, 0.0f);
+            HeightfieldQuadtree quadtree;
+            quadtree.build(heightfield);
+            Assert::AreEqual(7, quadtree.levelCount());
+
+            // Straight down onto flat ground
+            HeightfieldHit hit;
+            Assert::IsTrue(quadtree.raycast(Point3(40.0f, 10.0f, 70.0f), Vector3(0.0f, -1.0f, 0.0f), 100.0f, hit));
+            Assert::AreEqual(10.0f, hit.distance, tol);
+            Assert::AreEqual(40.0f, hit.point.x, tol);
+            Assert::AreEqual(0.0f, hit.point.y, tol);
+            Assert::AreEqual(70.0f, hit.point.z, tol);
+            Assert::AreEqual(1.0f, hit.normal.y, tol);
+
+            // At an angle onto a slope
+            buildPlane(heightfield, 65, 128.0f, 0.5f, 0.0f);
+            quadtree.build(heightfield);
+            Assert::IsTrue(quadtree.raycast(Point3(0.0f, 50.0f, 30.0f), Vector3(1.0f, -1.0f, 0.0f), 1000.0f, hit));
+            Assert::AreEqual(50.0f / 1.5f, hit.point.x, tol);
+            Assert::AreEqual(heightfield.sampleHeight(hit.point.x, hit.point.z), hit.point.y, tol);
+        }
+
+        TEST_METHOD(Misses)
+        {
+            Heightfield heightfield;
+            buildPlane(heightfield, 65, 128.0f, 0.0f, 0.0f);
+            heightfield.setDimensions(65, 128.0f, 128.0f, -5.0f);
+            HeightfieldQuadtree quadtree;
+            quadtree.build(heightfield);
+
+            HeightfieldHit hit;
+
+            // Pointing away from the ground
+            Assert::IsFalse(quadtree.raycast(Point3(40.0f, 10.0f, 70.0f), Vector3(0.3f, 1.0f, 0.0f), 100.0f, hit));
+
+            // Parallel to the ground
+            Assert::IsFalse(quadtree.raycast(Point3(-10.0f, 1.0f, 70.0f), Vector3(1.0f, 0.0f, 0.0f), 1000.0f, hit));
+
+            // Too short to reach the ground, which is lowered by the height offset
+            Assert::IsFalse(quadtree.raycast(Point3(40.0f, 10.0f, 70.0f), Vector3(0.0f, -1.0f, 0.0f), 14.0f, hit));
+            Assert::IsTrue(quadtree.raycast(Point3(40.0f, 10.0f, 70.0f), Vector3(0.0f, -1.0f, 0.0f), 16.0f, hit));
+            Assert::AreEqual(15.0f, hit.distance, tol);
+
+            // Outside the heightfield
+            Assert::IsFalse(quadtree.raycast(Point3(-40.0f, 10.0f, 70.0f), Vector3(0.0f, -1.0f, 0.0f), 100.0f, hit));
+        }
+
+        TEST_METHOD(Sweeps)
+        {
+            Heightfield heightfield;
+            buildPlane(heightfield, 33, 64.0f, 0.0f, 0.0f);
+            HeightfieldQuadtree quadtree;
+            quadtree.build(heightfield);
+
+            // The hit distance of a sweep is the fraction along the segment
+            HeightfieldHit hit;
+            Assert::IsTrue(quadtree.sweepSegment(Point3(10.0f, 3.0f, 10.0f), Point3(10.0f, -1.0f, 10.0f), hit));
+            Assert::AreEqual(0.75f, hit.distance, tol);
+            Assert::IsFalse(quadtree.sweepSegment(Point3(10.0f, 3.0f, 10.0f), Point3(10.0f, 1.0f, 10.0f), hit));
+
+            // A sphere touches the ground when its centre is a radius above it
+            Assert::IsTrue(quadtree.sweepSphere(Point3(10.0f, 3.0f, 10.0f), Point3(10.0f, 1.0f, 10.0f), 2.0f, hit));
+            Assert::AreEqual(0.5f, hit.distance, tol);
+            Assert::AreEqual(2.0f, hit.point.y, tol);
+        }
+
+        TEST_METHOD(AgreesWithMarching)
+        {
+            // Compare against stepping along each ray and sampling the heightfield
+            Heightfield heightfield;
+            buildRandom(heightfield, 97, 150.0f, 220.0f, -12.0f, 8);
+            HeightfieldQuadtree quadtree;
+            quadtree.build(heightfield);
+
+            // The origins are above the highest point, which is 40 - 12
+            RandomStream random(9);
+            int hits = 0;
+            for (int i = 0; i < 300; ++i)
+            {
+                const Point3 origin(random.nextFloat(-20.0f, 170.0f), random.nextFloat(30.0f, 60.0f), random.nextFloat(-20.0f, 240.0f));
+                const Vector3 direction(random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 0.1f), random.nextFloat(-1.0f, 1.0f));
+                const float maxDistance = 300.0f;
+
+                HeightfieldHit hit;
+                const bool found = quadtree.raycast(origin, direction, maxDistance, hit);
+                if (found)
+                {
+                    ++hits;
+
+                    // Rays can enter through the sides of the heightfield below the surface.
+                    // Anywhere else they stop on the surface.
+                    const float surface = heightfield.sampleHeight(hit.point.x, hit.point.z);
+                    const bool onEdge = hit.point.x < 0.01f || hit.point.x > 149.99f || hit.point.z < 0.01f || hit.point.z > 219.99f;
+                    if (onEdge)
+                    {
+                        Assert::IsTrue(hit.point.y <= surface + tol);
+                    }
+                    else
+                    {
+                        Assert::AreEqual(surface, hit.point.y, tol);
+                    }
+                }
+
+                // No point before the hit, and inside the heightfield, may be below the surface
+                const float end = found ? hit.distance - 0.01f : maxDistance;
+                for (float t = 0.0f; t < end; t += 0.01f)
+                {
+                    const Point3 point = origin + direction * t;
+                    if (point.x >= 0.0f && point.x <= 150.0f && point.z >= 0.0f && point.z <= 220.0f)
+                    {
+                        Assert::IsTrue(point.y >= heightfield.sampleHeight(point.x, point.z) - tol);
+                    }
+                }
+            }
+            Assert::IsTrue(hits > 100);
+        }
+
+        TEST_METHOD(BatchMatchesSingle)
+        {
+            Heightfield heightfield;
+            buildRandom(heightfield, 128, 200.0f, 200.0f, 0.0f, 4);
+            HeightfieldQuadtree quadtree;
+            quadtree.build(heightfield);
+
+            RandomStream random(5);
+            const int count = 50;
+            HeightfieldRay rays[count];
+            HeightfieldHit hits[count];
+            for (int i = 0; i < count; ++i)
+            {
+                rays[i].origin = Point3(random.nextFloat(0.0f, 200.0f), 60.0f, random.nextFloat(0.0f, 200.0f));
+                rays[i].direction = random.nextDirection3d();
+                rays[i].maxDistance = 500.0f;
+            }
+            quadtree.raycastBatch(rays, hits, count);
+
+            for (int i = 0; i < count; ++i)
+            {
+                HeightfieldHit hit;
+                Assert::AreEqual(quadtree.raycast(rays[i].origin, rays[i].direction, rays[i].maxDistance, hit), hits[i].hit);
+                if (hit.hit)
+                {
+                    Assert::AreEqual(hit.distance, hits[i].distance);
+                }
+            }
+        }
+
+        TEST_METHOD(BenchmarkRaycasts)
+        {
+            // Rolling hills with some noise, as the terrain generator produces
+            const int resolution = 1024;
+            Heightfield heightfield;
+            heightfield.heights().resize(resolution * resolution);
+            RandomStream random(6);
+            for (int z = 0; z < resolution; ++z)
+            {
+                for (int x = 0; x < resolution; ++x)
+                {
+                    heightfield.heights()[x + z * resolution] = 40.0f + 20.0f * sinf(x * 0.02f) * cosf(z * 0.03f) + random.nextFloat(0.0f, 2.0f);
+                }
+            }
+            heightfield.setDimensions(resolution, 1024.0f, 1024.0f, 0.0f);
+            heightfield.rebuildNormals();
+
+            const auto buildStart = std::chrono::high_resolution_clock::now();
+            HeightfieldQuadtree quadtree;
+            quadtree.build(heightfield);
+            const auto buildEnd = std::chrono::high_resolution_clock::now();
+
+            // Long, shallow rays are the worst case for stepping along the ray
+            const int count = 20000;
+            std::vector<HeightfieldRay> rays(count);
+            std::vector<HeightfieldHit> hits(count);
+            for (HeightfieldRay &ray : rays)
+            {
+                ray.origin = Point3(random.nextFloat(0.0f, 1024.0f), 70.0f, random.nextFloat(0.0f, 1024.0f));
+                const Vector2 horizontal = random.nextInUnitCircle().normalized();
+                ray.direction = Vector3(horizontal.x, -0.05f, horizontal.y);
+                ray.maxDistance = 2000.0f;
+            }
+
+            const auto castStart = std::chrono::high_resolution_clock::now();
+            quadtree.raycastBatch(rays.data(), hits.data(), count);
+            const auto castEnd = std::chrono::high_resolution_clock::now();
+
+            // March along the rays a cell at a time for comparison
+            int marchingHits = 0;
+            const auto marchStart = std::chrono::high_resolution_clock::now();
+            for (const HeightfieldRay &ray : rays)
+            {
+                for (float t = 0.0f; t < ray.maxDistance; t += 1.0f)
+                {
+                    const Point3 point = ray.origin + ray.direction * t;
+                    if (point.y < heightfield.sampleHeight(point.x, point.z))
+                    {
+                        ++marchingHits;
+                        break;
+                    }
+                }
+            }
+            const auto marchEnd = std::chrono::high_resolution_clock::now();
+
+            auto mRaysPerSecond = [&](std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end)
+            {
+                return std::to_string(count / std::chrono::duration<float, std::micro>(end - start).count());
+            };
+
+            const std::string message = "Quadtree build: " + std::to_string(std::chrono::duration<float, std::milli>(buildEnd - buildStart).count()) + "ms\n"
+                + "Quadtree raycasts: " + mRaysPerSecond(castStart, castEnd) + " M/s\n"
+                + "Marching raycasts: " + mRaysPerSecond(marchStart, marchEnd) + " M/s (" + std::to_string(marchingHits) + " hits)\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
\ No newline at end of file
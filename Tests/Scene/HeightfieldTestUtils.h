@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Scene/Heightfield.h"
+
+namespace EngineTests
+{
+    // Builds a heightfield where height = slopeX * x + slopeZ * z
+    inline void buildPlane(Heightfield &heightfield, int resolution, float size, float slopeX, float slopeZ)
+    {
+        heightfield.heights().resize(resolution * resolution);
+        for (int z = 0; z < resolution; ++z)
+        {
+            for (int x = 0; x < resolution; ++x)
+            {
+                const float worldX = x * size / (resolution - 1);
+                const float worldZ = z * size / (resolution - 1);
+                heightfield.heights()[x + z * resolution] = slopeX * worldX + slopeZ * worldZ;
+            }
+        }
+        heightfield.setDimensions(resolution, size, size, 0.0f);
+        heightfield.rebuildNormals();
+    }
+}
\ No newline at end of file
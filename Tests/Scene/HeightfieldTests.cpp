@@ -0,0 +1,150 @@
+#include "CppUnitTest.h"
+#include "HeightfieldTestUtils.h"
+
+#include "Scene/Heightfield.h"
+
+#include <chrono>
+#include <string>
+
+#include "Math/Random.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(HeightfieldTests)
+    {
+        const float tol = 0.0001f;
+
+    public:
+
+        TEST_METHOD(BilinearHeights)
+        {
+            // Bilinear sampling reproduces a plane exactly, between texels too
+            Heightfield heightfield;
+            buildPlane(heightfield, 65, 128.0f, 0.5f, -0.25f);
+
+            Assert::AreEqual(0.0f, heightfield.sampleHeight(0.0f, 0.0f), tol);
+            Assert::AreEqual(0.5f * 10.3f - 0.25f * 77.7f, heightfield.sampleHeight(10.3f, 77.7f), tol);
+            Assert::AreEqual(0.5f * 128.0f - 0.25f * 1.0f, heightfield.sampleHeight(128.0f, 1.0f), tol);
+
+            // Points outside the heightfield are clamped to the edge
+            Assert::AreEqual(heightfield.sampleHeight(0.0f, 50.0f), heightfield.sampleHeight(-20.0f, 50.0f), tol);
+            Assert::AreEqual(heightfield.sampleHeight(128.0f, 50.0f), heightfield.sampleHeight(500.0f, 50.0f), tol);
+        }
+
+        TEST_METHOD(HeightOffset)
+        {
+            Heightfield heightfield;
+            buildPlane(heightfield, 33, 64.0f, 1.0f, 0.0f);
+            heightfield.setDimensions(33, 64.0f, 64.0f, -30.0f);
+
+            Assert::AreEqual(20.0f - 30.0f, heightfield.sampleHeight(20.0f, 5.0f), tol);
+        }
+
+        TEST_METHOD(FlatNormals)
+        {
+            Heightfield heightfield;
+            buildPlane(heightfield, 33, 64.0f, 0.0f, 0.0f);
+
+            const Vector3 normal = heightfield.sampleNormal(12.5f, 40.0f);
+            Assert::AreEqual(0.0f, normal.x, tol);
+            Assert::AreEqual(1.0f, normal.y, tol);
+            Assert::AreEqual(0.0f, normal.z, tol);
+        }
+
+        TEST_METHOD(SlopedNormals)
+        {
+            // A slope rising in x tilts the normal towards -x
+            Heightfield heightfield;
+            buildPlane(heightfield, 33, 64.0f, 0.1f, 0.0f);
+
+            const Vector3 normal = heightfield.sampleNormal(30.0f, 30.0f);
+            Assert::IsTrue(normal.x < 0.0f);
+            Assert::IsTrue(normal.y > 0.0f && normal.y < 1.0f);
+            Assert::AreEqual(0.0f, normal.z, tol);
+        }
+
+        TEST_METHOD(BatchMatchesSingle)
+        {
+            Heightfield heightfield;
+            heightfield.heights().resize(128 * 128);
+            RandomStream random(3);
+            random.fillFloat(heightfield.heights().data(), 128 * 128, 0.0f, 40.0f);
+            heightfield.setDimensions(128, 200.0f, 300.0f, -5.0f);
+            heightfield.rebuildNormals();
+
+            // Use a count that isn't a multiple of four
+            const int count = 103;
+            float x[count], z[count], heights[count], normalsX[count], normalsY[count], normalsZ[count];
+            random.fillFloat(x, count, -10.0f, 210.0f);
+            random.fillFloat(z, count, -10.0f, 310.0f);
+            heightfield.sampleHeights(x, z, heights, count);
+            heightfield.sampleNormals(x, z, normalsX, normalsY, normalsZ, count);
+
+            for (int i = 0; i < count; ++i)
+            {
+                Assert::AreEqual(heightfield.sampleHeight(x[i], z[i]), heights[i]);
+
+                const Vector3 normal = heightfield.sampleNormal(x[i], z[i]);
+                Assert::AreEqual(normal.x, normalsX[i]);
+                Assert::AreEqual(normal.y, normalsY[i]);
+                Assert::AreEqual(normal.z, normalsZ[i]);
+            }
+        }
+
+        TEST_METHOD(AssignMatchesRebuild)
+        {
+            Heightfield original;
+            buildPlane(original, 33, 64.0f, 0.3f, 0.7f);
+
+            // Copying the heights and normals gives the same samples without rebuilding the normals
+            Heightfield copy;
+            copy.assign(33, 64.0f, 64.0f, 0.0f, original.heights().data(), original.normals().data());
+            Assert::IsTrue(copy.normals() == original.normals());
+            Assert::AreEqual(original.sampleHeight(12.5f, 40.1f), copy.sampleHeight(12.5f, 40.1f));
+            Assert::AreEqual(original.sampleNormal(12.5f, 40.1f).y, copy.sampleNormal(12.5f, 40.1f).y);
+        }
+
+        TEST_METHOD(BenchmarkSampling)
+        {
+            Heightfield heightfield;
+            heightfield.heights().resize(1024 * 1024);
+            RandomStream random(5);
+            random.fillFloat(heightfield.heights().data(), 1024 * 1024, 0.0f, 80.0f);
+            heightfield.setDimensions(1024, 1024.0f, 1024.0f, 0.0f);
+
+            const auto normalsStart = std::chrono::high_resolution_clock::now();
+            heightfield.rebuildNormals();
+            const auto normalsEnd = std::chrono::high_resolution_clock::now();
+
+            const int count = 1 << 20;
+            std::vector<float> x(count), z(count), heights(count), normalsX(count), normalsY(count), normalsZ(count);
+            random.fillFloat(x.data(), count, 0.0f, 1024.0f);
+            random.fillFloat(z.data(), count, 0.0f, 1024.0f);
+
+            const auto singleStart = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < count; ++i)
+            {
+                heights[i] = heightfield.sampleHeight(x[i], z[i]);
+            }
+            const auto batchStart = std::chrono::high_resolution_clock::now();
+            heightfield.sampleHeights(x.data(), z.data(), heights.data(), count);
+            const auto normalStart = std::chrono::high_resolution_clock::now();
+            heightfield.sampleNormals(x.data(), z.data(), normalsX.data(), normalsY.data(), normalsZ.data(), count);
+            const auto normalEnd = std::chrono::high_resolution_clock::now();
+
+            // Report throughput in millions of samples per second
+            auto mSamplesPerSecond = [&](std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end)
+            {
+                return std::to_string(count / std::chrono::duration<float, std::micro>(end - start).count());
+            };
+
+            const std::string message = "Normal field build: " + std::to_string(std::chrono::duration<float, std::milli>(normalsEnd - normalsStart).count()) + "ms\n"
+                + "Single heights: " + mSamplesPerSecond(singleStart, batchStart) + " M/s\n"
+                + "Batch heights: " + mSamplesPerSecond(batchStart, normalStart) + " M/s\n"
+                + "Batch normals: " + mSamplesPerSecond(normalStart, normalEnd) + " M/s\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
\ No newline at end of file
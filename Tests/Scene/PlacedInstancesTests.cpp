@@ -0,0 +1,142 @@
+#include "CppUnitTest.h"
+
+#include "Scene/PlacedInstances.h"
+
+#include "Math/Vector3.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(PlacedInstancesTests)
+    {
+        // Stand in meshes and materials. Only their addresses are used.
+        const Mesh* meshA = (const Mesh*)0x10;
+        const Mesh* meshB = (const Mesh*)0x20;
+        const Material* material = (const Material*)0x30;
+        const Impostor* impostor = (const Impostor*)0x40;
+
+        const Bounds unitBounds = Bounds(Point3(-0.5f, 0.0f, -0.5f), Point3(0.5f, 1.0f, 0.5f));
+
+        static Matrix4x4 at(float x, float z)
+        {
+            return Matrix4x4::translation(Vector3(x, 0.0f, z));
+        }
+
+    public:
+
+        TEST_METHOD(SortsIntoCells)
+        {
+            // Four 25m cells along each side
+            PlacedInstances instances;
+            instances.reset(100.0f, 100.0f, 4);
+            instances.add(meshA, material, unitBounds, at(90.0f, 90.0f));
+            instances.add(meshA, material, unitBounds, at(10.0f, 10.0f));
+            instances.add(meshB, material, unitBounds, at(60.0f, 10.0f));
+            instances.add(meshA, material, unitBounds, at(12.0f, 14.0f));
+            instances.build();
+
+            Assert::AreEqual(2, (int)instances.groups().size());
+            Assert::AreEqual(4, instances.instanceCount());
+
+            // The first group has two instances in the first cell and one in the last
+            const PlacedInstances::Group& group = instances.groups()[0];
+            Assert::IsTrue(group.mesh == meshA);
+            Assert::AreEqual(0u, group.firstInstance);
+            Assert::AreEqual(0u, group.cellStarts[0]);
+            Assert::AreEqual(2u, group.cellStarts[1]);
+            Assert::AreEqual(2u, group.cellStarts[15]);
+            Assert::AreEqual(3u, group.cellStarts[16]);
+            Assert::AreEqual(90.0f, instances.transforms()[2].get(0, 3));
+
+            // The bounds of a cell cover all of its instances
+            Assert::AreEqual(9.5f, group.cellBounds[0].min().x);
+            Assert::AreEqual(14.5f, group.cellBounds[0].max().z);
+
+            // The second group follows the first
+            Assert::AreEqual(3u, instances.groups()[1].firstInstance);
+            Assert::AreEqual(60.0f, instances.transforms()[3].get(0, 3));
+        }
+
+        TEST_METHOD(VisibleCellsAreMerged)
+        {
+            PlacedInstances instances;
+            instances.reset(100.0f, 100.0f, 4);
+            for (int x = 0; x < 4; ++x)
+            {
+                instances.add(meshA, material, unitBounds, at(x * 25.0f + 12.0f, 12.0f));
+                instances.add(meshA, material, unitBounds, at(x * 25.0f + 12.0f, 12.0f));
+            }
+            instances.build();
+
+            // Everything is visible as one range
+            std::vector<PlacedInstances::DrawRange> ranges;
+            instances.findVisible(Frustum(), Point3::origin(), 1.0f, ranges);
+            Assert::AreEqual(1, (int)ranges.size());
+            Assert::AreEqual(0u, ranges[0].firstInstance);
+            Assert::AreEqual(8u, ranges[0].count);
+
+            // An orthographic view covering x = 0 to 70 sees the first three cells, looking down +z
+            instances.findVisible(Frustum(Matrix4x4::orthographic(0.0f, 70.0f, -10.0f, 10.0f, 0.0f, 100.0f)), Point3::origin(), 1.0f, ranges);
+            Assert::AreEqual(1, (int)ranges.size());
+            Assert::AreEqual(6u, ranges[0].count);
+
+            // A hidden cell between two visible cells splits the range
+            instances.reset(100.0f, 100.0f, 4);
+            instances.add(meshA, material, unitBounds, at(12.0f, 12.0f));
+            instances.add(meshA, material, unitBounds, at(37.0f, 12.0f));
+            instances.add(meshA, material, unitBounds, at(12.0f, 37.0f));
+            instances.build();
+            instances.findVisible(Frustum(Matrix4x4::orthographic(0.0f, 20.0f, -10.0f, 10.0f, 0.0f, 100.0f)), Point3::origin(), 1.0f, ranges);
+            Assert::AreEqual(2, (int)ranges.size());
+            Assert::AreEqual(0u, ranges[0].firstInstance);
+            Assert::AreEqual(2u, ranges[1].firstInstance);
+            Assert::AreEqual(1u, ranges[1].count);
+        }
+
+        TEST_METHOD(ImpostorsReplaceDistantMeshes)
+        {
+            // A row of instances, one in each 25m cell, replaced by impostors from 40m
+            PlacedInstances instances;
+            instances.reset(100.0f, 100.0f, 4);
+            for (int x = 0; x < 4; ++x)
+            {
+                instances.add(meshA, material, unitBounds, at(x * 25.0f + 12.0f, 12.0f), impostor, 40.0f);
+                instances.addImpostor(impostor, 40.0f, unitBounds, at(x * 25.0f + 12.0f, 12.0f));
+            }
+            instances.add(meshB, material, unitBounds, at(87.0f, 12.0f));
+            instances.build();
+
+            Assert::AreEqual(3, (int)instances.groups().size());
+            const PlacedInstances::Group& impostorGroup = instances.groups()[1];
+            Assert::IsTrue(impostorGroup.mesh == nullptr);
+            Assert::IsTrue(impostorGroup.impostor == impostor);
+
+            float fadeStart, fadeLength;
+            PlacedInstances::impostorFade(impostorGroup, 2.0f, fadeStart, fadeLength);
+            Assert::AreEqual(80.0f, fadeStart);
+            Assert::AreEqual(80.0f * PlacedInstances::IMPOSTOR_FADE_FRACTION, fadeLength);
+
+            // From x = 0, the first two meshes are before the fade ends at 44m, and the last two impostors are past its start
+            std::vector<PlacedInstances::DrawRange> ranges;
+            instances.findVisible(Frustum(), Point3(0.0f, 0.0f, 12.0f), 1.0f, ranges);
+            Assert::AreEqual(3, (int)ranges.size());
+            Assert::AreEqual(0, ranges[0].group);
+            Assert::AreEqual(0u, ranges[0].firstInstance);
+            Assert::AreEqual(2u, ranges[0].count);
+            Assert::AreEqual(1, ranges[1].group);
+            Assert::AreEqual(6u, ranges[1].firstInstance);
+            Assert::AreEqual(2u, ranges[1].count);
+
+            // Meshes without an impostor are drawn at any distance
+            Assert::AreEqual(2, ranges[2].group);
+            Assert::AreEqual(1u, ranges[2].count);
+
+            // Doubling the distances draws every mesh, and only the last impostor, which is fading in
+            instances.findVisible(Frustum(), Point3(0.0f, 0.0f, 12.0f), 2.0f, ranges);
+            Assert::AreEqual(4u, ranges[0].count);
+            Assert::AreEqual(7u, ranges[1].firstInstance);
+            Assert::AreEqual(1u, ranges[1].count);
+        }
+    };
+}
\ No newline at end of file
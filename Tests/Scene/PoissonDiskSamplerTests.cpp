@@ -0,0 +1,137 @@
+#include "CppUnitTest.h"
+
+#include "Scene/Heightfield.h"
+#include "Scene/PlacementMask.h"
+#include "Scene/PoissonDiskSampler.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(PoissonDiskSamplerTests)
+    {
+        // The smallest distance between any two points
+        static float closestPair(const std::vector<Vector2>& points)
+        {
+            float closest = 1e30f;
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                for (size_t j = i + 1; j < points.size(); ++j)
+                {
+                    closest = std::min(closest, (points[i] - points[j]).magnitude());
+                }
+            }
+            return closest;
+        }
+
+    public:
+
+        TEST_METHOD(PointsAreSpacedAndFillTheArea)
+        {
+            PoissonDiskSampler sampler;
+            RandomStream random(7);
+            std::vector<Vector2> points;
+            sampler.generate(Vector2(10.0f, 20.0f), Vector2(60.0f, 70.0f), 2.0f, nullptr, 100000, random, points);
+
+            Assert::IsTrue(closestPair(points) >= 2.0f);
+            for (const Vector2& point : points)
+            {
+                Assert::IsTrue(point.x >= 10.0f && point.x < 60.0f && point.y >= 20.0f && point.y < 70.0f);
+            }
+
+            // A maximal set leaves no gap wider than two radii, so it has well over one point per 4r^2
+            Assert::IsTrue(points.size() > 2500 / 16);
+
+            // Every point of a coarse grid is within two radii of a sample
+            for (float x = 10.0f; x < 60.0f; x += 1.0f)
+            {
+                for (float y = 20.0f; y < 70.0f; y += 1.0f)
+                {
+                    bool covered = false;
+                    for (const Vector2& point : points)
+                    {
+                        covered |= (point - Vector2(x, y)).sqrMagnitude() <= 16.0f;
+                    }
+                    Assert::IsTrue(covered);
+                }
+            }
+        }
+
+        TEST_METHOD(SameSeedSamePoints)
+        {
+            PoissonDiskSampler sampler;
+            std::vector<Vector2> first, second, other;
+
+            RandomStream random(3);
+            sampler.generate(Vector2::zero(), Vector2(40.0f, 40.0f), 1.5f, nullptr, 100000, random, first);
+            RandomStream sameRandom(3);
+            sampler.generate(Vector2::zero(), Vector2(40.0f, 40.0f), 1.5f, nullptr, 100000, sameRandom, second);
+            RandomStream otherRandom(4);
+            sampler.generate(Vector2::zero(), Vector2(40.0f, 40.0f), 1.5f, nullptr, 100000, otherRandom, other);
+
+            Assert::IsTrue(first == second);
+            Assert::IsFalse(first == other);
+        }
+
+        TEST_METHOD(SubsetStaysSpreadOut)
+        {
+            PoissonDiskSampler sampler;
+            RandomStream random(11);
+            std::vector<Vector2> points;
+            sampler.generate(Vector2::zero(), Vector2(100.0f, 100.0f), 1.0f, nullptr, 40, random, points);
+            Assert::AreEqual((size_t)40, points.size());
+
+            // The subset comes from every part of the area, not just around the first point
+            int quadrants[4] = {};
+            for (const Vector2& point : points)
+            {
+                quadrants[(point.x < 50.0f ? 0 : 1) + (point.y < 50.0f ? 0 : 2)]++;
+            }
+            for (int count : quadrants)
+            {
+                Assert::IsTrue(count > 0);
+            }
+        }
+
+        TEST_METHOD(MaskedPoints)
+        {
+            // A 64m slope, rising from 0 at x = 0 to 64 at x = 64
+            Heightfield heightfield;
+            const int resolution = 65;
+            heightfield.heights().resize(resolution * resolution);
+            for (int z = 0; z < resolution; ++z)
+            {
+                for (int x = 0; x < resolution; ++x)
+                {
+                    heightfield.heights()[x + z * resolution] = (float)x;
+                }
+            }
+            heightfield.setDimensions(resolution, 64.0f, 64.0f, 0.0f);
+            heightfield.rebuildNormals();
+
+            // Only allow a band of the slope
+            PlacementMask low;
+            low.build(heightfield, 5.0f, 15.0f, 0.0f);
+            Assert::AreEqual(11 * resolution, low.allowedCount());
+            Assert::IsTrue(low.allowed(10.0f, 30.0f));
+            Assert::IsFalse(low.allowed(30.0f, 30.0f));
+
+            PoissonDiskSampler sampler;
+            RandomStream random(5);
+            std::vector<Vector2> points;
+            sampler.generate(Vector2::zero(), Vector2(64.0f, 64.0f), 2.0f, &low, 100000, random, points);
+            Assert::IsTrue(points.size() > 20);
+            for (const Vector2& point : points)
+            {
+                Assert::IsTrue(low.allowed(point.x, point.y));
+            }
+
+            // Too steep everywhere
+            PlacementMask steep;
+            steep.build(heightfield, -100.0f, 100.0f, 0.9f);
+            Assert::AreEqual(0, steep.allowedCount());
+            sampler.generate(Vector2::zero(), Vector2(64.0f, 64.0f), 2.0f, &steep, 100000, random, points);
+            Assert::AreEqual((size_t)0, points.size());
+        }
+    };
+}
\ No newline at end of file
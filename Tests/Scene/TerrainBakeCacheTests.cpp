@@ -0,0 +1,137 @@
+#include "CppUnitTest.h"
+
+#include "Scene/TerrainBakeCache.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(TerrainBakeCacheTests)
+    {
+        const char* bakePath = "TerrainBakeCacheTests.cache";
+        const int resolution = 16;
+
+        // Bakes a small terrain with two object layers and a few detail batches
+        void bake(uint64_t key, std::vector<float> &heights, std::vector<float> &normals, std::vector<uint16_t> &textureHeights) const
+        {
+            const size_t texels = (size_t)resolution * resolution;
+            heights.resize(texels);
+            normals.resize(texels * 4);
+            textureHeights.resize(texels);
+            for (size_t i = 0; i < texels; ++i)
+            {
+                heights[i] = (float)i * 0.5f;
+                normals[i * 4 + 0] = 0.1f;
+                normals[i * 4 + 1] = (float)i;
+                normals[i * 4 + 2] = -0.1f;
+                normals[i * 4 + 3] = 0.0f;
+                textureHeights[i] = (uint16_t)(i * 7);
+            }
+
+            TerrainBakeContents contents;
+            contents.resolution = resolution;
+            contents.maxHeight = 42.0f;
+            contents.heights = heights.data();
+            contents.normals = normals.data();
+            contents.textureHeights = textureHeights.data();
+            contents.objectLayerCounts = { 2, 0, 1 };
+            contents.objects = {
+                { { 1.0f, 2.0f, 3.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } },
+                { { 4.0f, 5.0f, 6.0f }, { 0.0f, 1.0f, 0.0f, 0.0f } },
+                { { 7.0f, 8.0f, 9.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } }
+            };
+            contents.detailBatches = {
+                { 2, 0, { 0.0f, 0.0f, 0.0f }, { 8.0f, 80.0f, 8.0f }, 10.0f },
+                { 0, 2, { 8.0f, 0.0f, 0.0f }, { 16.0f, 80.0f, 8.0f }, 20.0f },
+                { 1, 2, { 0.0f, 0.0f, 8.0f }, { 8.0f, 80.0f, 16.0f }, 30.0f }
+            };
+            contents.detailPositions = { 1.0f, 2.0f, 3.0f, 1.0f, 4.0f, 5.0f, 6.0f, 1.5f, 1.0f, 9.0f, 9.0f, 0.5f };
+
+            Assert::IsTrue(TerrainBakeCache::save(bakePath, key, contents));
+        }
+
+    public:
+
+        TEST_METHOD(KeysDependOnEverySetting)
+        {
+            TerrainBakeKey a;
+            a.add(1);
+            a.add(2.0f);
+
+            TerrainBakeKey b;
+            b.add(1);
+            b.add(2.0f);
+            Assert::IsTrue(a.value() == b.value());
+
+            TerrainBakeKey c;
+            c.add(1);
+            c.add(2.5f);
+            Assert::IsFalse(a.value() == c.value());
+
+            // The order of the settings matters
+            TerrainBakeKey d;
+            d.add(2.0f);
+            d.add(1);
+            Assert::IsFalse(a.value() == d.value());
+        }
+
+        TEST_METHOD(SavedBakeLoadsBack)
+        {
+            std::vector<float> heights, normals;
+            std::vector<uint16_t> textureHeights;
+            bake(1234, heights, normals, textureHeights);
+
+            TerrainBakeCache cache;
+            Assert::IsTrue(cache.open(bakePath, 1234, resolution));
+            Assert::AreEqual(42.0f, cache.maxHeight());
+            Assert::IsTrue(std::equal(heights.begin(), heights.end(), cache.heights()));
+            Assert::IsTrue(std::equal(normals.begin(), normals.end(), cache.normals()));
+            Assert::IsTrue(std::equal(textureHeights.begin(), textureHeights.end(), cache.textureHeights()));
+
+            // Each object layer gets its own range of objects
+            Assert::AreEqual(3, cache.objectLayerCount());
+            int count = 0;
+            const TerrainBakeObject* objects = cache.objects(0, count);
+            Assert::AreEqual(2, count);
+            Assert::AreEqual(4.0f, objects[1].position[0]);
+            cache.objects(1, count);
+            Assert::AreEqual(0, count);
+            objects = cache.objects(2, count);
+            Assert::AreEqual(1, count);
+            Assert::AreEqual(9.0f, objects[0].position[2]);
+            Assert::AreEqual(1.0f, objects[0].rotation[2]);
+
+            Assert::AreEqual(3, cache.detailBatchCount());
+            const TerrainBakeDetailBatch& batch = cache.detailBatches()[2];
+            Assert::AreEqual(1, (int)batch.count);
+            Assert::AreEqual(30.0f, batch.drawDistance);
+            Assert::AreEqual(16.0f, batch.boundsMax[2]);
+            Assert::AreEqual(3, cache.detailPositionCount());
+            Assert::AreEqual(0.5f, cache.detailPositions()[batch.firstPosition * 4 + 3]);
+
+            cache.close();
+            std::remove(bakePath);
+        }
+
+        TEST_METHOD(MismatchedBakesAreRejected)
+        {
+            TerrainBakeCache cache;
+            std::remove(bakePath);
+            Assert::IsFalse(cache.open(bakePath, 1234, resolution));
+
+            std::vector<float> heights, normals;
+            std::vector<uint16_t> textureHeights;
+            bake(1234, heights, normals, textureHeights);
+
+            Assert::IsFalse(cache.open(bakePath, 1235, resolution));
+            Assert::IsFalse(cache.open(bakePath, 1234, resolution * 2));
+            Assert::IsTrue(cache.open(bakePath, 1234, resolution));
+            cache.close();
+
+            std::remove(bakePath);
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "CppUnitTest.h"
+
+#include "Scene/TerrainGenerator.h"
+#include "Utils/JobSystem.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(TerrainGeneratorTests)
+    {
+    public:
+
+        TEST_METHOD(SameResultOnAnyThreadCount)
+        {
+            TerrainGenerationSettings settings;
+            settings.resolution = 256;
+            settings.seed = 1234;
+
+            std::vector<float> singleHeights, multiHeights;
+            std::vector<uint16_t> singleTexels, multiTexels;
+
+            JobSystem singleJobSystem(1);
+            JobSystem multiJobSystem(8);
+            TerrainGenerator singleThreaded(&singleJobSystem);
+            TerrainGenerator multiThreaded(&multiJobSystem);
+            singleThreaded.generate(settings, singleHeights, singleTexels);
+            multiThreaded.generate(settings, multiHeights, multiTexels);
+
+            Assert::IsTrue(singleHeights == multiHeights);
+            Assert::IsTrue(singleTexels == multiTexels);
+
+
+        }
+
+        TEST_METHOD(HeightsAreNormalized)
+        {
+            TerrainGenerationSettings settings;
+            settings.resolution = 128;
+            settings.height = 50.0f;
+            settings.seed = 7;
+
+            std::vector<float> heights;
+            std::vector<uint16_t> texels;
+            TerrainGenerator generator;
+            generator.generate(settings, heights, texels);
+
+            Assert::AreEqual((size_t)(128 * 128), heights.size());
+            Assert::AreEqual((size_t)(128 * 128), texels.size());
+
+            // Heights lie in [0, height], and the texture matches the heights
+            float maxHeight = 0.0f;
+            for (size_t i = 0; i < heights.size(); ++i)
+            {
+                Assert::IsTrue(heights[i] >= 0.0f && heights[i] <= settings.height + 0.001f);
+                Assert::AreEqual(heights[i] / settings.height, texels[i] / 65535.0f, 0.0001f);
+                maxHeight = std::max(maxHeight, heights[i]);
+            }
+            Assert::AreEqual(settings.height, maxHeight, 0.001f);
+
+            // The edges are flattened
+            for (int i = 0; i < 128; ++i)
+            {
+                Assert::AreEqual(0.0f, heights[i]);
+                Assert::AreEqual(0.0f, heights[i * 128]);
+            }
+        }
+
+        TEST_METHOD(SeedChangesResult)
+        {
+            TerrainGenerationSettings settings;
+            settings.resolution = 64;
+
+            std::vector<float> heightsA, heightsB;
+            std::vector<uint16_t> texels;
+            TerrainGenerator generator;
+
+            settings.seed = 1;
+            generator.generate(settings, heightsA, texels);
+            settings.seed = 2;
+            generator.generate(settings, heightsB, texels);
+
+            Assert::IsFalse(heightsA == heightsB);
+        }
+
+        TEST_METHOD(StagesMatchFullGeneration)
+        {
+            TerrainGenerationSettings settings;
+            settings.resolution = 256;
+            settings.seed = 99;
+
+            std::vector<float> heights, freshHeights;
+            std::vector<uint16_t> texels, freshTexels;
+
+            // Generate, then change settings that only affect later stages
+            TerrainGenerator generator;
+            generator.generate(settings, heights, texels);
+            settings.islandFactor = 3.5f;
+            Assert::IsTrue(generator.generate(settings, heights, texels));
+            settings.mountainScale = 2.5f;
+            Assert::IsTrue(generator.generate(settings, heights, texels));
+
+            // The result must match generating from scratch
+            TerrainGenerator freshGenerator;
+            freshGenerator.generate(settings, freshHeights, freshTexels);
+            Assert::IsTrue(heights == freshHeights);
+            Assert::IsTrue(texels == freshTexels);
+
+            // Unchanged settings do no work, and mark nothing as changed
+            Assert::IsFalse(generator.generate(settings, heights, texels));
+            Assert::IsFalse(generator.regionChanged(0, 0, 255, 255));
+        }
+
+        TEST_METHOD(DirtyTiles)
+        {
+            TerrainGenerationSettings settings;
+            settings.resolution = 256;
+
+            std::vector<float> heights;
+            std::vector<uint16_t> texels;
+            TerrainGenerator generator;
+
+            // The first run marks every tile as changed
+            generator.generate(settings, heights, texels);
+            Assert::AreEqual(4, generator.dirtyTilesPerRow());
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    Assert::IsTrue(generator.tileChanged(x, y));
+                }
+            }
+
+            // Changing the island factor leaves the flattened corners unchanged
+            std::vector<uint16_t> oldTexels = texels;
+            settings.islandFactor = 4.0f;
+            generator.generate(settings, heights, texels);
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    bool changed = false;
+                    for (int ty = y * 64; ty < (y + 1) * 64; ++ty)
+                    {
+                        for (int tx = x * 64; tx < (x + 1) * 64; ++tx)
+                        {
+                            changed |= oldTexels[tx + ty * 256] != texels[tx + ty * 256];
+                        }
+                    }
+                    Assert::AreEqual(changed, generator.tileChanged(x, y));
+                }
+            }
+        }
+
+        TEST_METHOD(RegionsMatchFullGeneration)
+        {
+            TerrainGenerationSettings settings;
+            settings.resolution = 256;
+            settings.seed = 99;
+
+            std::vector<float> heights;
+            std::vector<uint16_t> texels;
+            TerrainGenerator generator;
+            generator.generate(settings, heights, texels);
+            const float heightScale = settings.height / generator.maxHeight();
+
+            // Regions of odd sizes and offsets, including ones that hang over the edges
+            const int regions[][4] = { { 0, 0, 256, 256 }, { 37, 101, 19, 53 }, { -3, 250, 10, 10 }, { 200, -1, 58, 3 } };
+            for (const int* region : regions)
+            {
+                const int x = region[0], y = region[1], width = region[2], height = region[3];
+                std::vector<float> regionHeights(width * height);
+                TerrainGenerator::generateRegion(settings, x, y, width, height, regionHeights.data());
+
+                for (int row = 0; row < height; ++row)
+                {
+                    for (int column = 0; column < width; ++column)
+                    {
+                        const int sourceX = std::min(std::max(x + column, 0), 255);
+                        const int sourceY = std::min(std::max(y + row, 0), 255);
+                        Assert::AreEqual(heights[sourceX + sourceY * 256], regionHeights[column + row * width] * heightScale);
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(Benchmark)
+        {
+            std::vector<float> heights;
+            std::vector<uint16_t> texels;
+            JobSystem jobSystem;
+            TerrainGenerator generator(&jobSystem);
+
+            for (int resolution : { 1024, 4096 })
+            {
+                TerrainGenerationSettings settings;
+                settings.resolution = resolution;
+
+                // The first run allocates the buffers, so time the second
+                generator.generate(settings, heights, texels);
+                settings.seed++;
+                generator.generate(settings, heights, texels);
+
+                std::string message = std::to_string(resolution) + "^2 heightmap: " + std::to_string(generator.lastGenerationMilliseconds()) + "ms";
+
+                // Changing only the island factor skips the fractal and mountain stages
+                settings.islandFactor += 0.5f;
+                generator.generate(settings, heights, texels);
+                message += ", island factor change: " + std::to_string(generator.lastGenerationMilliseconds()) + "ms\n";
+                Logger::WriteMessage(message.c_str());
+            }
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "CppUnitTest.h"
+
+#include "Scene/Heightfield.h"
+#include "Scene/TerrainLodTree.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(TerrainLodTreeTests)
+    {
+        // Whether two patches share part of an edge
+        static bool adjacent(const TerrainPatch& a, const TerrainPatch& b)
+        {
+            const float epsilon = 1e-6f;
+            const bool overlapX = a.x < b.x + b.size - epsilon && b.x < a.x + a.size - epsilon;
+            const bool overlapZ = a.z < b.z + b.size - epsilon && b.z < a.z + a.size - epsilon;
+            const bool touchX = fabsf(a.x + a.size - b.x) < epsilon || fabsf(b.x + b.size - a.x) < epsilon;
+            const bool touchZ = fabsf(a.z + a.size - b.z) < epsilon || fabsf(b.z + b.size - a.z) < epsilon;
+            return (touchX && overlapZ) || (touchZ && overlapX);
+        }
+
+    public:
+
+        TEST_METHOD(FinerLevelsNearTheViewer)
+        {
+            TerrainLodTree tree;
+            tree.buildFlat(Vector2::zero(), Vector2(1024.0f, 1024.0f), 0.0f, 10.0f, 6);
+            Assert::AreEqual(6, tree.levelCount());
+            Assert::AreEqual(32.0f * TerrainLodTree::LOD_RANGE_FACTOR, tree.finestRange());
+
+            std::vector<TerrainPatch> patches;
+            TerrainLodStats stats;
+            tree.select(Frustum(), Point3(100.0f, 20.0f, 100.0f), 1.0f, patches, stats);
+            Assert::AreEqual((int)patches.size(), stats.selectedPatches);
+            Assert::AreEqual(0, stats.frustumCulledNodes);
+
+            // The patches cover the whole area exactly once
+            float area = 0.0f;
+            for (const TerrainPatch& patch : patches)
+            {
+                area += patch.size * patch.size;
+            }
+            Assert::AreEqual(1.0f, area, 1e-5f);
+
+            for (const TerrainPatch& patch : patches)
+            {
+                // The size of a patch matches its level
+                Assert::AreEqual(patch.size, (float)(1 << (int)patch.level) / 32.0f, 1e-6f);
+
+                // The patch under the viewer is the finest, and the far corner is the coarsest level drawn
+                if (patch.x <= 100.0f / 1024.0f && patch.x + patch.size > 100.0f / 1024.0f
+                    && patch.z <= 100.0f / 1024.0f && patch.z + patch.size > 100.0f / 1024.0f)
+                {
+                    Assert::AreEqual(0.0f, patch.level);
+                }
+                if (patch.x + patch.size == 1.0f && patch.z + patch.size == 1.0f)
+                {
+                    Assert::IsTrue(patch.level >= 3.0f);
+                }
+            }
+
+            // Neighbouring patches are never more than one level apart, so morphing hides the seams between them
+            for (size_t i = 0; i < patches.size(); ++i)
+            {
+                for (size_t j = i + 1; j < patches.size(); ++j)
+                {
+                    if (adjacent(patches[i], patches[j]))
+                    {
+                        Assert::IsTrue(fabsf(patches[i].level - patches[j].level) <= 1.0f);
+                    }
+                }
+            }
+
+            // A larger range scale draws more of the area at finer levels
+            std::vector<TerrainPatch> scaledPatches;
+            tree.select(Frustum(), Point3(100.0f, 20.0f, 100.0f), 2.0f, scaledPatches, stats);
+            Assert::IsTrue(scaledPatches.size() > patches.size());
+        }
+
+        TEST_METHOD(OnlyVisiblePatches)
+        {
+            TerrainLodTree tree;
+            tree.buildFlat(Vector2::zero(), Vector2(1024.0f, 1024.0f), 0.0f, 10.0f, 6);
+
+            // A view down +z covering the strip of the area with x below 10
+            const Frustum frustum(Matrix4x4::orthographic(-10.0f, 10.0f, -50.0f, 50.0f, 0.0f, 2000.0f));
+
+            std::vector<TerrainPatch> patches;
+            TerrainLodStats stats;
+            tree.select(frustum, Point3(0.0f, 20.0f, 0.0f), 1.0f, patches, stats);
+            Assert::IsFalse(patches.empty());
+            Assert::IsTrue(stats.frustumCulledNodes > 0);
+
+            for (const TerrainPatch& patch : patches)
+            {
+                Assert::IsTrue(patch.x * 1024.0f < 10.0f);
+            }
+        }
+
+        TEST_METHOD(BoundsCoverTheHeights)
+        {
+            // A ramp rising by 1 per texel along x, with a spike near the middle
+            Heightfield heightfield;
+            const int resolution = 65;
+            heightfield.heights().resize(resolution * resolution);
+            for (int z = 0; z < resolution; ++z)
+            {
+                for (int x = 0; x < resolution; ++x)
+                {
+                    heightfield.heights()[x + z * resolution] = (float)x;
+                }
+            }
+            heightfield.heights()[40 + 20 * resolution] = 500.0f;
+            heightfield.setDimensions(resolution, 64.0f, 64.0f, -5.0f);
+
+            // Leaves of 8 texels
+            TerrainLodTree tree;
+            tree.build(heightfield, 4, 1.0f, false);
+
+            const Bounds leaf = tree.nodeBounds(0, 1, 0);
+            Assert::AreEqual(8.0f - 5.0f - 1.0f, leaf.min().y);
+            Assert::AreEqual(16.0f - 5.0f + 1.0f, leaf.max().y);
+            Assert::AreEqual(8.0f, leaf.min().x);
+            Assert::AreEqual(16.0f, leaf.max().x);
+
+            // The spike is in leaf (5, 2), and every node above it
+            Assert::AreEqual(500.0f - 5.0f + 1.0f, tree.nodeBounds(0, 5, 2).max().y);
+            Assert::AreEqual(500.0f - 5.0f + 1.0f, tree.nodeBounds(3, 0, 0).max().y);
+            Assert::AreEqual(-5.0f - 1.0f, tree.nodeBounds(3, 0, 0).min().y);
+
+            // Edge nodes stretch out when the edges are extended
+            tree.build(heightfield, 4, 1.0f, true);
+            Assert::AreEqual(-32.0f, tree.nodeBounds(0, 0, 3).min().x);
+            Assert::AreEqual(96.0f, tree.nodeBounds(0, 7, 3).max().x);
+            Assert::AreEqual(8.0f, tree.nodeBounds(0, 1, 3).min().x);
+        }
+    };
+}
\ No newline at end of file
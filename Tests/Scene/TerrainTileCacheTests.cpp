@@ -0,0 +1,104 @@
+#include "CppUnitTest.h"
+
+#include "Scene/TerrainTileCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(TerrainTileCacheTests)
+    {
+        const char* cachePath = "TerrainTileCacheTests.cache";
+
+        static TerrainGenerationSettings tiledSettings()
+        {
+            TerrainGenerationSettings settings;
+            settings.resolution = TerrainTileCache::TILE_SIZE * 4;
+            settings.seed = 21;
+            return settings;
+        }
+
+    public:
+
+        TEST_METHOD(TilesMatchGenerator)
+        {
+            // Normalize against a full heightmap, so the tiles can be compared with it
+            const TerrainGenerationSettings settings = tiledSettings();
+            std::vector<float> heights;
+            std::vector<uint16_t> texels;
+            TerrainGenerator generator;
+            generator.generate(settings, heights, texels);
+
+            TerrainTileCache cache;
+            Assert::IsTrue(cache.open(cachePath, settings, generator.maxHeight()));
+            Assert::AreEqual(4, cache.tilesPerSide());
+
+            // Tiles include a border from their neighbours, clamped at the edge of the heightmap
+            const int resolution = settings.resolution;
+            for (int tileY : { 0, 2, 3 })
+            {
+                for (int tileX : { 0, 1, 3 })
+                {
+                    const uint16_t* tile = cache.tile(tileX, tileY);
+                    for (int y = 0; y < TerrainTileCache::TILE_TEXELS; ++y)
+                    {
+                        for (int x = 0; x < TerrainTileCache::TILE_TEXELS; ++x)
+                        {
+                            const int sourceX = std::min(std::max(tileX * TerrainTileCache::TILE_SIZE + x - 1, 0), resolution - 1);
+                            const int sourceY = std::min(std::max(tileY * TerrainTileCache::TILE_SIZE + y - 1, 0), resolution - 1);
+                            Assert::AreEqual(texels[sourceX + sourceY * resolution], tile[x + y * TerrainTileCache::TILE_TEXELS]);
+                        }
+                    }
+                }
+            }
+
+            cache.close();
+            std::remove(cachePath);
+        }
+
+        TEST_METHOD(ReopeningKeepsTiles)
+        {
+            const TerrainGenerationSettings settings = tiledSettings();
+
+            TerrainTileCache cache;
+            Assert::IsTrue(cache.open(cachePath, settings, 20.0f));
+            Assert::IsFalse(cache.hasTile(1, 2));
+            const std::vector<uint16_t> tile(cache.tile(1, 2), cache.tile(1, 2) + TerrainTileCache::TILE_TEXELS * TerrainTileCache::TILE_TEXELS);
+            Assert::IsTrue(cache.hasTile(1, 2));
+            cache.close();
+
+            // The same settings reuse the generated tiles
+            Assert::IsTrue(cache.open(cachePath, settings, 20.0f));
+            Assert::IsTrue(cache.hasTile(1, 2));
+            Assert::IsFalse(cache.hasTile(2, 1));
+            Assert::IsTrue(std::equal(tile.begin(), tile.end(), cache.tile(1, 2)));
+            cache.close();
+
+            // Different settings clear them
+            TerrainGenerationSettings changed = settings;
+            changed.seed = 22;
+            Assert::IsTrue(cache.open(cachePath, changed, 20.0f));
+            Assert::IsFalse(cache.hasTile(1, 2));
+            cache.close();
+
+            std::remove(cachePath);
+        }
+
+        TEST_METHOD(EachSettingsHasItsOwnFile)
+        {
+            const TerrainGenerationSettings settings = tiledSettings();
+            TerrainGenerationSettings changed = settings;
+            changed.seed = 22;
+
+            const std::string path = TerrainTileCache::cachePath("Tiles", settings, 20.0f);
+            Assert::IsTrue(path == TerrainTileCache::cachePath("Tiles", settings, 20.0f));
+            Assert::IsTrue(path != TerrainTileCache::cachePath("Tiles", changed, 20.0f));
+            Assert::IsTrue(path != TerrainTileCache::cachePath("Tiles", settings, 21.0f));
+            Assert::IsTrue(path.compare(0, 19, "Tiles/TerrainTiles_") == 0);
+        }
+    };
+}
\ No newline at end of file
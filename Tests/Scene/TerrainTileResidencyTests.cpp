@@ -0,0 +1,82 @@
+#include "CppUnitTest.h"
+
+#include "Scene/TerrainTileResidency.h"
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(TerrainTileResidencyTests)
+    {
+    public:
+
+        TEST_METHOD(LoadsNearestFirst)
+        {
+            TerrainTileResidency residency(16, 64);
+            std::vector<TerrainTileResidency::TileLoad> loads;
+
+            // Only two loads are allowed, so the tile under the point and one neighbour come first
+            residency.update(5.5f, 5.5f, 1.0f, 2, loads);
+            Assert::AreEqual(2, (int)loads.size());
+            Assert::AreEqual(5, loads[0].tileX);
+            Assert::AreEqual(5, loads[0].tileY);
+            Assert::AreEqual(-1, loads[0].evictedTile);
+            Assert::AreEqual(loads[0].slot, residency.slot(5, 5));
+
+            // The rest of the circle fills in over later updates
+            loads.clear();
+            residency.update(5.5f, 5.5f, 1.0f, 100, loads);
+            Assert::AreEqual(7, (int)loads.size());
+            Assert::AreEqual(9, residency.residentCount());
+
+            // Nothing more to load once everything is resident
+            loads.clear();
+            residency.update(5.5f, 5.5f, 1.0f, 100, loads);
+            Assert::AreEqual(0, (int)loads.size());
+        }
+
+        TEST_METHOD(EvictsLeastRecentlyUsed)
+        {
+            TerrainTileResidency residency(16, 4);
+            std::vector<TerrainTileResidency::TileLoad> loads;
+
+            residency.update(0.5f, 0.5f, 0.1f, 10, loads);
+            residency.update(3.5f, 0.5f, 0.1f, 10, loads);
+            residency.update(6.5f, 0.5f, 0.1f, 10, loads);
+            residency.update(9.5f, 0.5f, 0.1f, 10, loads);
+            Assert::AreEqual(4, residency.residentCount());
+
+            // Revisit the first tile, so the second is now the oldest
+            loads.clear();
+            residency.update(0.5f, 0.5f, 0.1f, 10, loads);
+            Assert::AreEqual(0, (int)loads.size());
+
+            residency.update(12.5f, 0.5f, 0.1f, 10, loads);
+            Assert::AreEqual(1, (int)loads.size());
+            Assert::AreEqual(3, loads[0].evictedTile);
+            Assert::AreEqual(-1, residency.slot(3, 0));
+            Assert::IsTrue(residency.slot(0, 0) >= 0);
+            Assert::AreEqual(4, residency.residentCount());
+        }
+
+        TEST_METHOD(WantedTilesAreNeverEvicted)
+        {
+            // Asking for more tiles than there are slots only loads as many as fit
+            TerrainTileResidency residency(16, 4);
+            std::vector<TerrainTileResidency::TileLoad> loads;
+            residency.update(8.0f, 8.0f, 3.0f, 100, loads);
+            Assert::AreEqual(4, (int)loads.size());
+            for (const TerrainTileResidency::TileLoad &load : loads)
+            {
+                Assert::AreEqual(-1, load.evictedTile);
+            }
+
+            // The closest tiles are the ones kept
+            Assert::IsTrue(residency.slot(7, 7) >= 0);
+            Assert::IsTrue(residency.slot(8, 8) >= 0);
+            Assert::AreEqual(-1, residency.slot(5, 5));
+        }
+    };
+}
\ No newline at end of file
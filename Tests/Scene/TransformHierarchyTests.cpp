@@ -0,0 +1,382 @@
+#include "CppUnitTest.h"
+
+#include "Scene/TransformHierarchy.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "Math/Random.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(TransformHierarchyTests)
+    {
+        const float tol = 0.0001f;
+
+        static void assertMatricesEqual(const Matrix4x4& expected, const Matrix4x4& actual, float tolerance)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                Assert::AreEqual(expected.elements[i], actual.elements[i], tolerance);
+            }
+        }
+
+        // Gives a transform a random position, rotation and scale
+        static void randomise(TransformHierarchy& hierarchy, TransformID id, RandomStream& random)
+        {
+            const Quaternion rotation = Quaternion::euler(random.nextFloat(-180.0f, 180.0f), random.nextFloat(-180.0f, 180.0f), random.nextFloat(-180.0f, 180.0f));
+            const Point3 position(random.nextFloat(-5.0f, 5.0f), random.nextFloat(-5.0f, 5.0f), random.nextFloat(-5.0f, 5.0f));
+            const Vector3 scale(random.nextFloat(0.5f, 1.5f), random.nextFloat(0.5f, 1.5f), random.nextFloat(0.5f, 1.5f));
+            hierarchy.setLocal(id, position, rotation, scale);
+        }
+
+        // Multiplies the local matrices up the parent chain, as Transform used to
+        static Matrix4x4 expectedLocalToWorld(TransformHierarchy& hierarchy, TransformID id)
+        {
+            const Matrix4x4 local = Matrix4x4::trs(Vector3(hierarchy.positionLocal(id) - Point3::origin()), hierarchy.rotationLocal(id), hierarchy.scaleLocal(id));
+            const TransformID parent = hierarchy.parent(id);
+            return (parent == TransformHierarchy::INVALID_ID) ? local : expectedLocalToWorld(hierarchy, parent) * local;
+        }
+
+    public:
+
+        TEST_METHOD(WorldMatricesFollowParents)
+        {
+            RandomStream random(3);
+            TransformHierarchy hierarchy;
+            const TransformID root = hierarchy.create();
+            const TransformID child = hierarchy.create();
+            const TransformID grandchild = hierarchy.create();
+            hierarchy.setParent(child, root);
+            hierarchy.setParent(grandchild, child);
+            randomise(hierarchy, root, random);
+            randomise(hierarchy, child, random);
+            randomise(hierarchy, grandchild, random);
+
+            // Asking for a world matrix brings it up to date without a full pass
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, grandchild), hierarchy.localToWorld(grandchild), tol);
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, grandchild).invert(), hierarchy.worldToLocal(grandchild), tol);
+
+            const Point3 worldPosition = hierarchy.positionWorld(grandchild);
+            const Point3 expectedPosition = expectedLocalToWorld(hierarchy, child) * hierarchy.positionLocal(grandchild);
+            Assert::AreEqual(expectedPosition.x, worldPosition.x, tol);
+            Assert::AreEqual(expectedPosition.y, worldPosition.y, tol);
+            Assert::AreEqual(expectedPosition.z, worldPosition.z, tol);
+
+            const Quaternion worldRotation = hierarchy.rotationLocal(root) * hierarchy.rotationLocal(child) * hierarchy.rotationLocal(grandchild);
+            Assert::AreEqual(worldRotation.w, hierarchy.rotationWorld(grandchild).w, tol);
+            Assert::AreEqual(worldRotation.x, hierarchy.rotationWorld(grandchild).x, tol);
+
+            // Moving the root moves everything below it
+            hierarchy.setPositionLocal(root, Point3(100.0f, 0.0f, 0.0f));
+            hierarchy.updateWorldMatrices();
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, child), hierarchy.localToWorld(child), tol);
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, grandchild), hierarchy.localToWorld(grandchild), tol);
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, grandchild).invert(), hierarchy.worldToLocal(grandchild), tol);
+        }
+
+        TEST_METHOD(ParentCreatedAfterChild)
+        {
+            RandomStream random(4);
+            TransformHierarchy hierarchy;
+
+            // The child and its own child are stored before the new parent, so they have to move behind it
+            const TransformID child = hierarchy.create();
+            const TransformID grandchild = hierarchy.create();
+            const TransformID other = hierarchy.create();
+            const TransformID parent = hierarchy.create();
+            hierarchy.setParent(grandchild, child);
+            hierarchy.setParent(child, parent);
+            randomise(hierarchy, child, random);
+            randomise(hierarchy, grandchild, random);
+            randomise(hierarchy, other, random);
+            randomise(hierarchy, parent, random);
+
+            Assert::AreEqual((size_t)4, hierarchy.size());
+            Assert::AreEqual(parent, hierarchy.parent(child));
+            Assert::AreEqual(child, hierarchy.parent(grandchild));
+            Assert::AreEqual(TransformHierarchy::INVALID_ID, hierarchy.parent(other));
+
+            hierarchy.updateWorldMatrices();
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, grandchild), hierarchy.localToWorld(grandchild), tol);
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, other), hierarchy.localToWorld(other), tol);
+
+            // Unparenting keeps the local values
+            hierarchy.setParent(child, TransformHierarchy::INVALID_ID);
+            assertMatricesEqual(expectedLocalToWorld(hierarchy, grandchild), hierarchy.localToWorld(grandchild), tol);
+        }
+
+        TEST_METHOD(RenderMatricesInterpolateBetweenTicks)
+        {
+            TransformHierarchy hierarchy;
+            const TransformID root = hierarchy.create();
+            const TransformID child = hierarchy.create();
+            const TransformID still = hierarchy.create();
+            hierarchy.setParent(child, root);
+            hierarchy.setPositionLocal(child, Point3(0.0f, 1.0f, 0.0f));
+            hierarchy.setPositionLocal(still, Point3(5.0f, 0.0f, 0.0f));
+
+            // Changes outside of a tick aren't interpolated
+            hierarchy.updateRenderMatrices(0.5f);
+            assertMatricesEqual(hierarchy.localToWorld(child), hierarchy.renderLocalToWorld(child), tol);
+
+            // A tick moves the root from x = 0 to x = 10, so halfway between ticks it is drawn at x = 5, along with its child
+            hierarchy.beginTick();
+            hierarchy.setPositionLocal(root, Point3(10.0f, 0.0f, 0.0f));
+            hierarchy.endTick();
+            hierarchy.updateRenderMatrices(0.5f);
+            Assert::AreEqual(5.0f, hierarchy.renderLocalToWorld(root).elements[12], tol);
+            Assert::AreEqual(5.0f, hierarchy.renderLocalToWorld(child).elements[12], tol);
+            Assert::AreEqual(1.0f, hierarchy.renderLocalToWorld(child).elements[13], tol);
+            assertMatricesEqual(hierarchy.localToWorld(still), hierarchy.renderLocalToWorld(still), tol);
+            Assert::AreEqual(10.0f, hierarchy.positionWorld(child).x, tol);
+
+            // Changing the child between ticks snaps it, but it still follows the interpolated parent
+            hierarchy.setPositionLocal(child, Point3(0.0f, 2.0f, 0.0f));
+            hierarchy.updateRenderMatrices(0.25f);
+            Assert::AreEqual(2.5f, hierarchy.renderLocalToWorld(child).elements[12], tol);
+            Assert::AreEqual(2.0f, hierarchy.renderLocalToWorld(child).elements[13], tol);
+
+            // A tick that doesn't move the root leaves it where it is
+            hierarchy.beginTick();
+            hierarchy.endTick();
+            hierarchy.updateRenderMatrices(0.5f);
+            assertMatricesEqual(hierarchy.localToWorld(root), hierarchy.renderLocalToWorld(root), tol);
+            assertMatricesEqual(hierarchy.localToWorld(child), hierarchy.renderLocalToWorld(child), tol);
+        }
+
+        TEST_METHOD(NewTransformsArePlacedStraightAway)
+        {
+            TransformHierarchy hierarchy;
+            hierarchy.beginTick();
+            hierarchy.endTick();
+
+            // A transform created during a tick is drawn where it was first put, not moving there from the origin
+            hierarchy.beginTick();
+            const TransformID id = hierarchy.create();
+            hierarchy.setPositionLocal(id, Point3(10.0f, 0.0f, 0.0f));
+            hierarchy.setPositionLocal(id, Point3(20.0f, 0.0f, 0.0f));
+            hierarchy.endTick();
+            hierarchy.updateRenderMatrices(0.5f);
+            Assert::AreEqual(20.0f, hierarchy.renderLocalToWorld(id).elements[12], tol);
+
+            // Later ticks interpolate it as usual
+            hierarchy.beginTick();
+            hierarchy.setPositionLocal(id, Point3(30.0f, 0.0f, 0.0f));
+            hierarchy.endTick();
+            hierarchy.updateRenderMatrices(0.5f);
+            Assert::AreEqual(25.0f, hierarchy.renderLocalToWorld(id).elements[12], tol);
+        }
+
+        TEST_METHOD(SkipInterpolationPlacesTransformsStraightAway)
+        {
+            TransformHierarchy hierarchy;
+            const TransformID id = hierarchy.create();
+            hierarchy.setPositionLocal(id, Point3(5.0f, 0.0f, 0.0f));
+
+            // Reusing a transform during a tick draws it where it is put, but later ticks still interpolate
+            hierarchy.beginTick();
+            hierarchy.skipInterpolation(id);
+            hierarchy.setPositionLocal(id, Point3(20.0f, 0.0f, 0.0f));
+            hierarchy.endTick();
+            hierarchy.updateRenderMatrices(0.5f);
+            Assert::AreEqual(20.0f, hierarchy.renderLocalToWorld(id).elements[12], tol);
+
+            hierarchy.beginTick();
+            hierarchy.setPositionLocal(id, Point3(30.0f, 0.0f, 0.0f));
+            hierarchy.endTick();
+            hierarchy.updateRenderMatrices(0.5f);
+            Assert::AreEqual(25.0f, hierarchy.renderLocalToWorld(id).elements[12], tol);
+        }
+
+        TEST_METHOD(DestroyedTransformsAreRemoved)
+        {
+            RandomStream random(5);
+            TransformHierarchy hierarchy;
+
+            // Chains of four, where the second of each chain is destroyed
+            std::vector<TransformID> ids;
+            for (int chain = 0; chain < 100; ++chain)
+            {
+                TransformID parent = TransformHierarchy::INVALID_ID;
+                for (int depth = 0; depth < 4; ++depth)
+                {
+                    const TransformID id = hierarchy.create();
+                    hierarchy.setParent(id, parent);
+                    randomise(hierarchy, id, random);
+                    ids.push_back(id);
+                    parent = id;
+                }
+            }
+            for (int chain = 0; chain < 100; ++chain)
+            {
+                hierarchy.destroy(ids[chain * 4 + 1]);
+            }
+            Assert::AreEqual((size_t)300, hierarchy.size());
+
+            // The children of destroyed transforms become roots, and everything else is unchanged
+            for (int chain = 0; chain < 100; ++chain)
+            {
+                Assert::AreEqual(TransformHierarchy::INVALID_ID, hierarchy.parent(ids[chain * 4 + 2]));
+                Assert::AreEqual(ids[chain * 4 + 2], hierarchy.parent(ids[chain * 4 + 3]));
+                assertMatricesEqual(expectedLocalToWorld(hierarchy, ids[chain * 4 + 3]), hierarchy.localToWorld(ids[chain * 4 + 3]), tol);
+                assertMatricesEqual(expectedLocalToWorld(hierarchy, ids[chain * 4]), hierarchy.localToWorld(ids[chain * 4]), tol);
+            }
+
+            // Destroying the roots as well leaves half of the slots dead, so they are squeezed out
+            for (int chain = 0; chain < 100; ++chain)
+            {
+                hierarchy.destroy(ids[chain * 4]);
+            }
+            Assert::AreEqual((size_t)200, hierarchy.size());
+            for (int chain = 0; chain < 100; ++chain)
+            {
+                Assert::AreEqual(ids[chain * 4 + 2], hierarchy.parent(ids[chain * 4 + 3]));
+                assertMatricesEqual(expectedLocalToWorld(hierarchy, ids[chain * 4 + 3]), hierarchy.localToWorld(ids[chain * 4 + 3]), tol);
+            }
+
+            // Destroyed IDs are reused
+            const TransformID reused = hierarchy.create();
+            Assert::IsTrue(reused == ids[99 * 4]);
+            Assert::AreEqual(TransformHierarchy::INVALID_ID, hierarchy.parent(reused));
+        }
+
+        TEST_METHOD(SeparateSubtreesMoveOnDifferentThreads)
+        {
+            RandomStream random(7);
+            TransformHierarchy hierarchy;
+
+            // Chains of three under each root, as a turret's base and barrel are
+            std::vector<TransformID> ids;
+            for (int chain = 0; chain < 200; ++chain)
+            {
+                TransformID parent = TransformHierarchy::INVALID_ID;
+                for (int depth = 0; depth < 3; ++depth)
+                {
+                    const TransformID id = hierarchy.create();
+                    hierarchy.setParent(id, parent);
+                    randomise(hierarchy, id, random);
+                    ids.push_back(id);
+                    parent = id;
+                }
+            }
+            hierarchy.updateWorldMatrices();
+
+            // Each thread turns the children of its own chains, and reads back their world values
+            auto moveChains = [&hierarchy, &ids](int firstChain, int endChain, uint64_t seed)
+            {
+                RandomStream threadRandom(seed);
+                for (int repeat = 0; repeat < 50; ++repeat)
+                {
+                    for (int chain = firstChain; chain < endChain; ++chain)
+                    {
+                        hierarchy.setRotationLocal(ids[chain * 3 + 1], Quaternion::euler(0.0f, threadRandom.nextFloat(-180.0f, 180.0f), 0.0f));
+                        hierarchy.setRotationLocal(ids[chain * 3 + 2], Quaternion::euler(threadRandom.nextFloat(-90.0f, 90.0f), 0.0f, 0.0f));
+                        hierarchy.positionWorld(ids[chain * 3 + 2]);
+                    }
+                }
+            };
+            std::thread other(moveChains, 100, 200, 2);
+            moveChains(0, 100, 1);
+            other.join();
+
+            for (int chain = 0; chain < 200; ++chain)
+            {
+                assertMatricesEqual(expectedLocalToWorld(hierarchy, ids[chain * 3 + 2]), hierarchy.localToWorld(ids[chain * 3 + 2]), tol);
+            }
+        }
+
+        TEST_METHOD(BenchmarkDeepHierarchies)
+        {
+            // 1000 trees of 100 transforms, each a chain with a branch at every fourth transform
+            RandomStream random(7);
+            TransformHierarchy hierarchy;
+            std::vector<TransformID> roots;
+            std::vector<TransformID> all;
+            for (int tree = 0; tree < 1000; ++tree)
+            {
+                TransformID parent = TransformHierarchy::INVALID_ID;
+                TransformID branch = TransformHierarchy::INVALID_ID;
+                for (int depth = 0; depth < 100; ++depth)
+                {
+                    const TransformID id = hierarchy.create();
+                    hierarchy.setParent(id, (depth % 4 == 3) ? branch : parent);
+                    randomise(hierarchy, id, random);
+                    all.push_back(id);
+                    if (depth == 0)
+                    {
+                        roots.push_back(id);
+                    }
+                    if (depth % 4 != 3)
+                    {
+                        branch = parent;
+                        parent = id;
+                    }
+                }
+            }
+            Assert::AreEqual((size_t)100000, hierarchy.size());
+            hierarchy.updateWorldMatrices();
+
+            // Move every root several times, as gameplay code does within a frame, then update once
+            const int frames = 20;
+            const auto updateStart = std::chrono::high_resolution_clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                for (TransformID root : roots)
+                {
+                    hierarchy.setPositionLocal(root, hierarchy.positionLocal(root) + Vector3(0.1f, 0.0f, 0.0f));
+                    hierarchy.setRotationLocal(root, Quaternion::rotation(1.0f, Vector3::up()) * hierarchy.rotationLocal(root));
+                }
+                hierarchy.updateWorldMatrices();
+            }
+            const auto updateEnd = std::chrono::high_resolution_clock::now();
+
+            // Recompute everything the way Transform used to on every change: both matrices, multiplied down from each root
+            std::vector<Matrix4x4> localToWorld(all.size());
+            std::vector<Matrix4x4> worldToLocal(all.size());
+            const auto eagerStart = std::chrono::high_resolution_clock::now();
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                for (int change = 0; change < 2; ++change)
+                {
+                    for (size_t i = 0; i < all.size(); ++i)
+                    {
+                        const Vector3 position = hierarchy.positionLocal(all[i]) - Point3::origin();
+                        localToWorld[i] = Matrix4x4::trs(position, hierarchy.rotationLocal(all[i]), hierarchy.scaleLocal(all[i]));
+                        worldToLocal[i] = Matrix4x4::trsInverse(position, hierarchy.rotationLocal(all[i]), hierarchy.scaleLocal(all[i]));
+                        if (i % 100 != 0)
+                        {
+                            // Every transform in a tree comes after its parent, which is close enough for timing
+                            localToWorld[i] = localToWorld[i - 1] * localToWorld[i];
+                            worldToLocal[i] = worldToLocal[i] * worldToLocal[i - 1];
+                        }
+                    }
+                }
+            }
+            const auto eagerEnd = std::chrono::high_resolution_clock::now();
+
+            // The batched results match the old chain of products
+            for (size_t i = 0; i < all.size(); i += 997)
+            {
+                const Matrix4x4& matrix = hierarchy.localToWorld(all[i]);
+                const Matrix4x4 expected = expectedLocalToWorld(hierarchy, all[i]);
+                for (int e = 0; e < 16; ++e)
+                {
+                    Assert::AreEqual(expected.elements[e], matrix.elements[e], 0.01f * (1.0f + fabsf(expected.elements[e])));
+                }
+            }
+
+            auto milliseconds = [&](std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end)
+            {
+                return std::to_string(std::chrono::duration<float, std::milli>(end - start).count() / frames);
+            };
+
+            const std::string message = "Batched update of 100k transforms: " + milliseconds(updateStart, updateEnd) + "ms per frame\n"
+                + "Eager recompute of 100k transforms: " + milliseconds(eagerStart, eagerEnd) + "ms per frame\n";
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
\ No newline at end of file
@@ -53,5 +53,21 @@ namespace UtilTests
             Assert::AreEqual(5, t3);
         }
 
+        TEST_METHOD(CheckReadInts)
+        {
+            BitWriter b;
+            b.writeBits(1, 1);
+            b.writeInt(0xDEADBEEF);
+            b.writeInt(0xFFFFFFFF);
+            b.writeBits(2, 2);
+
+            uint32_t* buffer = b.getBuffer();
+            BitReader r = BitReader(buffer);
+            Assert::AreEqual(1u, (uint32_t)r.readBits(1));
+            Assert::AreEqual(0xDEADBEEFu, r.readInt());
+            Assert::AreEqual(0xFFFFFFFFu, r.readInt());
+            Assert::AreEqual(2u, (uint32_t)r.readBits(2));
+        }
+
     };
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "CppUnitTest.h"
+
+#include "Utils/BlockPool.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(BlockPoolTests)
+    {
+    public:
+
+        TEST_METHOD(BlocksArePackedTogether)
+        {
+            BlockPool pool(40);
+            Assert::AreEqual((size_t)48, pool.blockSize());
+
+            // Blocks allocated in a row come one after another, aligned for the math types
+            std::vector<uint8_t*> blocks;
+            for (size_t i = 0; i < pool.blocksPerChunk(); ++i)
+            {
+                blocks.push_back((uint8_t*)pool.allocate());
+                Assert::AreEqual((uintptr_t)0, (uintptr_t)blocks.back() % BlockPool::BLOCK_ALIGNMENT);
+                if (i > 0)
+                {
+                    Assert::IsTrue(blocks[i] == blocks[i - 1] + pool.blockSize());
+                }
+            }
+            Assert::AreEqual((size_t)1, pool.chunkCount());
+
+            // A full chunk makes the pool start another
+            blocks.push_back((uint8_t*)pool.allocate());
+            Assert::AreEqual((size_t)2, pool.chunkCount());
+
+            for (uint8_t* block : blocks)
+            {
+                BlockPool::free(block);
+            }
+            Assert::AreEqual((size_t)0, pool.blocksInUse());
+        }
+
+        TEST_METHOD(FreedBlocksAreReused)
+        {
+            BlockPool pool(64);
+            void* a = pool.allocate();
+            void* b = pool.allocate();
+            BlockPool::free(a);
+            Assert::IsTrue(pool.allocate() == a);
+
+            // Blocks are freed to the pool they came from
+            BlockPool other(64);
+            void* c = other.allocate();
+            BlockPool::free(c);
+            BlockPool::free(b);
+            Assert::AreEqual((size_t)1, pool.blocksInUse());
+            Assert::AreEqual((size_t)0, other.blocksInUse());
+            BlockPool::free(a);
+        }
+
+        TEST_METHOD(ReleaseEmptyChunks)
+        {
+            BlockPool pool(256);
+            std::vector<void*> blocks;
+            for (size_t i = 0; i < pool.blocksPerChunk() * 3; ++i)
+            {
+                blocks.push_back(pool.allocate());
+            }
+            Assert::AreEqual((size_t)3, pool.chunkCount());
+
+            // Keep one block in the middle chunk
+            void* kept = blocks[pool.blocksPerChunk()];
+            for (void* block : blocks)
+            {
+                if (block != kept)
+                {
+                    BlockPool::free(block);
+                }
+            }
+
+            pool.releaseEmptyChunks();
+            Assert::AreEqual((size_t)1, pool.chunkCount());
+            Assert::AreEqual((size_t)1, pool.blocksInUse());
+
+            // The chunk that is left is used before a new one is allocated
+            for (size_t i = 1; i < pool.blocksPerChunk(); ++i)
+            {
+                pool.allocate();
+            }
+            Assert::AreEqual((size_t)1, pool.chunkCount());
+        }
+
+        TEST_METHOD(LargeBlocks)
+        {
+            // Blocks bigger than a chunk get a chunk each, and can still be freed
+            BlockPool pool(BlockPool::CHUNK_SIZE * 2);
+            Assert::AreEqual((size_t)1, pool.blocksPerChunk());
+
+            void* a = pool.allocate();
+            void* b = pool.allocate();
+            memset(a, 0, pool.blockSize());
+            memset(b, 0, pool.blockSize());
+            BlockPool::free(a);
+            BlockPool::free(b);
+            Assert::AreEqual((size_t)0, pool.blocksInUse());
+
+            pool.releaseEmptyChunks();
+            Assert::AreEqual((size_t)0, pool.chunkCount());
+        }
+
+        TEST_METHOD(BenchmarkSceneChurn)
+        {
+            // Allocate and free 10k objects of a typical component size, like opening and closing a scene
+            const int count = 10000;
+            const size_t size = 160;
+            std::vector<void*> blocks(count);
+
+            const auto heapStart = std::chrono::high_resolution_clock::now();
+            for (void*& block : blocks)
+            {
+                block = ::operator new(size);
+            }
+            for (void* block : blocks)
+            {
+                ::operator delete(block);
+            }
+            const auto heapEnd = std::chrono::high_resolution_clock::now();
+
+            BlockPool pool(size);
+            for (void*& block : blocks)
+            {
+                block = pool.allocate();
+            }
+            for (void* block : blocks)
+            {
+                BlockPool::free(block);
+            }
+            pool.releaseEmptyChunks();
+            const auto poolEnd = std::chrono::high_resolution_clock::now();
+
+            const float heapMs = std::chrono::duration<float, std::milli>(heapEnd - heapStart).count();
+            const float poolMs = std::chrono::duration<float, std::milli>(poolEnd - heapEnd).count();
+            Logger::WriteMessage(("10k blocks: heap " + std::to_string(heapMs) + "ms, pool " + std::to_string(poolMs) + "ms\n").c_str());
+        }
+    };
+}
\ No newline at end of file
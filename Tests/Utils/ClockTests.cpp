@@ -0,0 +1,81 @@
+#include "CppUnitTest.h"
+
+#include "Utils/Clock.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(ClockTests)
+    {
+        const float tol = 0.0001f;
+
+        // Starts a frame that took the given time
+        static void runFrame(Clock& clock, float realDeltaTime)
+        {
+            clock.frameStart();
+            clock.overrideRealDeltaTime(realDeltaTime);
+        }
+
+    public:
+
+        TEST_METHOD(TicksAtAFixedRate)
+        {
+            Clock clock;
+            clock.setTickRate(50.0f);
+            clock.restart();
+            Assert::AreEqual(0.02f, clock.fixedDeltaTime(), tol);
+
+            // A frame shorter than a tick runs none, and the time carries over to the next frame
+            runFrame(clock, 0.015f);
+            Assert::AreEqual(0, clock.tickCount());
+            Assert::AreEqual(0.75f, clock.interpolationFactor(), tol);
+
+            runFrame(clock, 0.015f);
+            Assert::AreEqual(1, clock.tickCount());
+            Assert::AreEqual(0.5f, clock.interpolationFactor(), tol);
+
+            // A long frame runs several ticks
+            runFrame(clock, 0.05f);
+            Assert::AreEqual(3, clock.tickCount());
+            Assert::AreEqual(0.0f, clock.interpolationFactor(), tol);
+
+            // The same frame times at a different frame rate give the same number of ticks in total
+            Clock other;
+            other.setTickRate(50.0f);
+            other.restart();
+            int ticks = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                runFrame(other, 0.01f);
+                ticks += other.tickCount();
+            }
+            Assert::AreEqual(4, ticks);
+        }
+
+        TEST_METHOD(PausedAndCappedTicks)
+        {
+            Clock clock;
+            clock.setTickRate(100.0f);
+            clock.setMaxTicksPerFrame(4);
+            clock.restart();
+
+            // Time beyond the cap is dropped, rather than making the next frame run more ticks
+            runFrame(clock, 1.0f);
+            Assert::AreEqual(4, clock.tickCount());
+            runFrame(clock, 0.005f);
+            Assert::AreEqual(0, clock.tickCount());
+
+            // Nothing ticks while paused
+            clock.setPaused(true);
+            runFrame(clock, 0.5f);
+            Assert::AreEqual(0, clock.tickCount());
+
+            // Stopping forgets the time waiting for a tick
+            clock.setPaused(false);
+            runFrame(clock, 0.005f);
+            clock.stop();
+            Assert::AreEqual(0.0f, clock.interpolationFactor(), tol);
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "CppUnitTest.h"
+
+#include "Utils/JobSystem.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(JobSystemTests)
+    {
+    public:
+
+        TEST_METHOD(ParallelForCoversEveryItemOnce)
+        {
+            JobSystem jobSystem(4);
+            Assert::AreEqual(4, jobSystem.threadCount());
+
+            for (int grainSize : { 0, 1, 7, 1000, 5000 })
+            {
+                std::vector<std::atomic<int>> visits(1000);
+                for (std::atomic<int>& visit : visits)
+                {
+                    visit = 0;
+                }
+
+                jobSystem.parallelFor("Visit", (int)visits.size(), grainSize, [&](int begin, int end)
+                {
+                    Assert::IsTrue(end - begin <= std::max(grainSize, 1000));
+                    for (int i = begin; i < end; ++i)
+                    {
+                        visits[i]++;
+                    }
+                });
+
+                for (std::atomic<int>& visit : visits)
+                {
+                    Assert::AreEqual(1, visit.load());
+                }
+            }
+        }
+
+        TEST_METHOD(DependenciesRunInOrder)
+        {
+            JobSystem jobSystem(4);
+
+            // Each stage only starts once every job of the stage before has finished
+            std::atomic<int> firstStageDone(0);
+            std::atomic<int> secondStageSawAll(0);
+            JobCounter firstStage;
+            JobCounter secondStage;
+            for (int i = 0; i < 20; ++i)
+            {
+                jobSystem.run("First", [&]
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    firstStageDone++;
+                }, &firstStage);
+            }
+            for (int i = 0; i < 5; ++i)
+            {
+                jobSystem.run("Second", [&]
+                {
+                    if (firstStageDone.load() == 20)
+                    {
+                        secondStageSawAll++;
+                    }
+                }, &secondStage, &firstStage);
+            }
+
+            jobSystem.wait(secondStage);
+            Assert::IsTrue(firstStage.finished());
+            Assert::AreEqual(5, secondStageSawAll.load());
+
+            // A dependency that has already finished doesn't hold anything up
+            JobCounter late;
+            bool ran = false;
+            jobSystem.run("Late", [&] { ran = true; }, &late, &firstStage);
+            jobSystem.wait(late);
+            Assert::IsTrue(ran);
+        }
+
+        TEST_METHOD(MainThreadJobs)
+        {
+            JobSystem jobSystem(4);
+            const std::thread::id mainThread = std::this_thread::get_id();
+
+            // Jobs queued from workers still run on the main thread
+            std::atomic<int> onMainThread(0);
+            JobCounter counter;
+            jobSystem.parallelFor("Queue", 8, 1, [&](int, int)
+            {
+                jobSystem.runOnMainThread("Main", [&]
+                {
+                    if (std::this_thread::get_id() == mainThread)
+                    {
+                        onMainThread++;
+                    }
+                }, &counter);
+            });
+
+            jobSystem.wait(counter);
+            Assert::AreEqual(8, onMainThread.load());
+
+            // Without a wait, they run when the main thread asks
+            bool ran = false;
+            jobSystem.runOnMainThread("Main", [&] { ran = true; });
+            Assert::IsFalse(ran);
+            jobSystem.runMainThreadJobs();
+            Assert::IsTrue(ran);
+        }
+
+        TEST_METHOD(NestedJobsAndTimings)
+        {
+            JobSystem jobSystem(3);
+
+            // Jobs that wait on jobs of their own keep running other work, so this can't deadlock
+            std::atomic<int> total(0);
+            jobSystem.parallelFor("Outer", 6, 1, [&](int, int)
+            {
+                jobSystem.parallelFor("Inner", 100, 10, [&](int begin, int end)
+                {
+                    total += end - begin;
+                });
+            });
+            Assert::AreEqual(600, total.load());
+
+            const std::vector<JobTiming> timings = jobSystem.takeTimings();
+            Assert::AreEqual((size_t)2, timings.size());
+            for (const JobTiming& timing : timings)
+            {
+                Assert::AreEqual(timing.name == "Outer" ? 6 : 60, timing.count);
+                Assert::IsTrue(timing.milliseconds >= 0.0f);
+            }
+
+            // Taking the timings starts counting again
+            Assert::IsTrue(jobSystem.takeTimings().empty());
+        }
+    };
+}
\ No newline at end of file
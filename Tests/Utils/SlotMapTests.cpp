@@ -0,0 +1,132 @@
+#include "CppUnitTest.h"
+
+#include "Utils/SlotMap.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(SlotMapTests)
+    {
+    public:
+
+        TEST_METHOD(FindByID)
+        {
+            int objects[3];
+            SlotMap<int> map;
+            const SlotMapID a = map.add(&objects[0]);
+            const SlotMapID b = map.add(&objects[1]);
+            const SlotMapID c = map.add(&objects[2]);
+
+            Assert::IsTrue(a != SlotMap<int>::INVALID_ID && a != b && b != c);
+            Assert::IsTrue(map.find(a) == &objects[0]);
+            Assert::IsTrue(map.find(b) == &objects[1]);
+            Assert::IsTrue(map.find(c) == &objects[2]);
+            Assert::IsTrue(map.find(SlotMap<int>::INVALID_ID) == nullptr);
+            Assert::AreEqual((size_t)3, map.size());
+
+            Assert::IsTrue(map.remove(b));
+            Assert::IsFalse(map.remove(b));
+            Assert::IsTrue(map.find(b) == nullptr);
+            Assert::IsTrue(map.find(c) == &objects[2]);
+            Assert::AreEqual((size_t)2, map.size());
+        }
+
+        TEST_METHOD(RemovedIDsStayInvalidWhenSlotsAreReused)
+        {
+            // Keep adding and removing objects until the slots are reused many times over
+            int object = 0;
+            SlotMap<int> map;
+            std::vector<SlotMapID> removed;
+            for (size_t i = 0; i < SlotMap<int>::MIN_FREE_SLOTS * 20; ++i)
+            {
+                const SlotMapID id = map.add(&object);
+                Assert::IsTrue(id != SlotMap<int>::INVALID_ID);
+                map.remove(id);
+                removed.push_back(id);
+            }
+
+            const SlotMapID live = map.add(&object);
+            for (SlotMapID id : removed)
+            {
+                Assert::IsTrue(id != live);
+                Assert::IsTrue(map.find(id) == nullptr);
+            }
+        }
+
+        TEST_METHOD(AddingToAFullMapFails)
+        {
+            int object = 0;
+            SlotMap<int> map;
+            for (uint32_t i = 0; i < SlotMap<int>::MAX_SLOTS; ++i)
+            {
+                map.add(&object);
+            }
+
+            // Every slot is in use, so there's no ID left to give out
+            Assert::IsTrue(map.add(&object) == SlotMap<int>::INVALID_ID);
+            Assert::IsTrue(map.size() == SlotMap<int>::MAX_SLOTS);
+        }
+
+        TEST_METHOD(ObjectsKeepTheirOrder)
+        {
+            int objects[5];
+            SlotMap<int> map;
+            std::vector<SlotMapID> ids;
+            for (int& object : objects)
+            {
+                ids.push_back(map.add(&object));
+            }
+
+            // Removing leaves gaps while walking the objects, which are closed up when the list is asked for
+            map.remove(ids[1]);
+            map.remove(ids[3]);
+            Assert::AreEqual((size_t)5, map.orderedCount());
+            Assert::IsTrue(map.orderedAt(1) == nullptr);
+
+            const std::vector<int*> expected = { &objects[0], &objects[2], &objects[4] };
+            Assert::IsTrue(map.objects() == expected);
+
+            // The objects that were moved can still be removed
+            map.remove(ids[4]);
+            const SlotMapID added = map.add(&objects[1]);
+            const std::vector<int*> expectedAfter = { &objects[0], &objects[2], &objects[1] };
+            Assert::IsTrue(map.objects() == expectedAfter);
+            Assert::IsTrue(map.find(added) == &objects[1]);
+        }
+
+        TEST_METHOD(BenchmarkBulkRemove)
+        {
+            const int count = 10000;
+            std::vector<int> objects(count);
+            SlotMap<int> map;
+            std::vector<SlotMapID> ids;
+
+            const auto addStart = std::chrono::high_resolution_clock::now();
+            for (int& object : objects)
+            {
+                ids.push_back(map.add(&object));
+            }
+            const auto addEnd = std::chrono::high_resolution_clock::now();
+
+            // Remove the objects oldest first, the worst order for a list that is erased from
+            for (SlotMapID id : ids)
+            {
+                map.remove(id);
+            }
+            map.compact();
+            const auto removeEnd = std::chrono::high_resolution_clock::now();
+
+            Assert::IsTrue(map.empty());
+            Assert::AreEqual((size_t)0, map.objects().size());
+
+            const float addMs = std::chrono::duration<float, std::milli>(addEnd - addStart).count();
+            const float removeMs = std::chrono::duration<float, std::milli>(removeEnd - addEnd).count();
+            Logger::WriteMessage(("10k objects: add " + std::to_string(addMs) + "ms, remove " + std::to_string(removeMs) + "ms\n").c_str());
+        }
+    };
+}
\ No newline at end of file
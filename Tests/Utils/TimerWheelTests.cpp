@@ -0,0 +1,150 @@
+#include "CppUnitTest.h"
+
+#include "Math/Random.h"
+#include "Utils/TimerWheel.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace EngineTests
+{
+    TEST_CLASS(TimerWheelTests)
+    {
+    public:
+
+        TEST_METHOD(TimersRunWhenDue)
+        {
+            // Delays either side of each level's span, so timers have to move down the wheels
+            RandomStream random(3);
+            TimerWheel wheel;
+            std::vector<uint64_t> dueTicks;
+            std::vector<uint64_t> ranTicks;
+            for (int i = 0; i < 2000; ++i)
+            {
+                const uint32_t level = random.nextUint() % 3;
+                const uint64_t span = 1ull << (level * TimerWheel::SLOT_BITS);
+                const uint64_t delay = span + random.nextUint() % (span * TimerWheel::SLOTS) + 1;
+                const size_t timer = dueTicks.size();
+                dueTicks.push_back(delay);
+                ranTicks.push_back(0);
+                wheel.schedule(delay, [&, timer] { ranTicks[timer] = wheel.currentTick(); });
+            }
+
+            while (wheel.size() > 0)
+            {
+                wheel.tick();
+            }
+
+            for (size_t i = 0; i < dueTicks.size(); ++i)
+            {
+                Assert::AreEqual(dueTicks[i], ranTicks[i]);
+            }
+        }
+
+        TEST_METHOD(RepeatingTimers)
+        {
+            TimerWheel wheel;
+            std::vector<uint64_t> ticks;
+            TimerID id = TimerWheel::INVALID_ID;
+            id = wheel.schedule(10, [&]
+            {
+                ticks.push_back(wheel.currentTick());
+
+                // A timer can cancel itself from its own callback
+                if (ticks.size() == 4)
+                {
+                    Assert::IsTrue(wheel.cancel(id));
+                }
+            }, 100);
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                wheel.tick();
+            }
+
+            const std::vector<uint64_t> expected = { 10, 110, 210, 310 };
+            Assert::IsTrue(ticks == expected);
+            Assert::IsFalse(wheel.isScheduled(id));
+            Assert::AreEqual((size_t)0, wheel.size());
+        }
+
+        TEST_METHOD(CancelledTimersDontRun)
+        {
+            TimerWheel wheel;
+            int runs = 0;
+            const TimerID first = wheel.schedule(5, [&] { runs++; });
+            const TimerID second = wheel.schedule(5, [&] { runs++; });
+            const TimerID distant = wheel.schedule(5000, [&] { runs++; });
+            Assert::IsTrue(wheel.cancel(second));
+            Assert::IsFalse(wheel.cancel(second));
+            Assert::IsTrue(wheel.cancel(distant));
+
+            for (int i = 0; i < 10000; ++i)
+            {
+                wheel.tick();
+            }
+            Assert::AreEqual(1, runs);
+
+            // The finished timer's ID doesn't find the timer that reuses its slot
+            const TimerID reused = wheel.schedule(1, [&] { runs++; });
+            Assert::IsFalse(wheel.isScheduled(first));
+            Assert::IsFalse(wheel.cancel(first));
+            Assert::IsTrue(wheel.isScheduled(reused));
+        }
+
+        TEST_METHOD(DelaysBeyondTheLastLevel)
+        {
+            TimerWheel wheel;
+            const uint64_t delay = (1ull << (TimerWheel::LEVELS * TimerWheel::SLOT_BITS)) + 12345;
+            uint64_t ranTick = 0;
+            wheel.schedule(delay, [&] { ranTick = wheel.currentTick(); });
+
+            while (wheel.size() > 0)
+            {
+                wheel.tick();
+            }
+            Assert::AreEqual(delay, ranTick);
+        }
+
+        TEST_METHOD(SchedulingTooManyTimersFails)
+        {
+            TimerWheel wheel;
+            for (uint32_t i = 0; i < TimerWheel::MAX_TIMERS; ++i)
+            {
+                wheel.schedule(1, [] {});
+            }
+            Assert::IsTrue(wheel.schedule(1, [] {}) == TimerWheel::INVALID_ID);
+
+            // Timers that finish make room for more
+            wheel.tick();
+            Assert::IsTrue(wheel.schedule(1, [] {}) != TimerWheel::INVALID_ID);
+        }
+
+        TEST_METHOD(BenchmarkIdleTimers)
+        {
+            // Turrets that fire every couple of seconds at 60 ticks per second
+            const int count = 10000;
+            RandomStream random(7);
+            TimerWheel wheel;
+            int runs = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                wheel.schedule(1 + random.nextUint() % 150, [&runs] { runs++; }, 150);
+            }
+
+            const int ticks = 600;
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < ticks; ++i)
+            {
+                wheel.tick();
+            }
+            const float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            Assert::AreEqual(count * ticks / 150, runs);
+            Logger::WriteMessage(("10k timers firing every 150 ticks: " + std::to_string(milliseconds * 1000.0f / ticks) + "us per tick\n").c_str());
+        }
+    };
+}
\ No newline at end of file